@@ -0,0 +1,13 @@
+#include "analysis.h"
+#include "profiler.h"
+
+bool module_analysis_t::get(const void* module)
+{
+    std::call_once(once, [this, module]()
+    {
+        PROFILE_SCOPE("module_analysis_t::build");
+        ready = image.view(static_cast<const std::uint8_t*>(module)) && xrefs.build(image);
+    });
+
+    return ready;
+}
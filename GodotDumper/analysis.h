@@ -0,0 +1,34 @@
+#pragma once
+#include "pe.h"
+#include "xref.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/*
+ * The game's own image, parsed and cross-referenced once and shared by everything that analyzes code
+ * (the string anchored resolver, the vtable scanner)
+ *
+ * The first get builds it, about a second for Godot's .text, concurrent callers wait for that one build
+ * module is where the image is mapped (mem->get_base_address() in the game), only the first call's is used
+*/
+class module_analysis_t {
+public:
+	// false if the image couldn't be parsed
+	bool get(const void* module);
+
+	const pe_image_t& get_image() const { return image; }
+	const xref_index_t& get_xrefs() const { return xrefs; }
+
+	// Where the image is mapped, pointers inside it are base + rva
+	std::uintptr_t get_base() const { return reinterpret_cast<std::uintptr_t>(image.data()); }
+
+private:
+	std::once_flag once;
+	bool ready = false;
+
+	pe_image_t image;
+	xref_index_t xrefs;
+};
+
+inline std::unique_ptr<module_analysis_t> analysis = std::make_unique<module_analysis_t>();
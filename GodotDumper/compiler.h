@@ -0,0 +1,26 @@
+#pragma once
+
+// MSVC keywords used by the SDK headers, so they also build with GCC and Clang (tools reading dumps on Linux)
+#ifndef _MSC_VER
+#ifndef __forceinline
+#define __forceinline inline __attribute__((always_inline))
+#endif
+
+#ifndef __thiscall
+#define __thiscall
+#endif
+#endif
+
+/*
+ * No a * b + c -> fma contraction in the rest of the translation unit
+ * The batch math matches the scalar sdk.h math bit for bit only if neither side is contracted: MSVC only contracts with
+ * /fp:contract or /fp:fast, GCC and Clang do as soon as fma is available (-march=native), so the math files start with this
+ * and the tools also build with -ffp-contract=off for the sdk.h inlines they compile
+*/
+#if defined(_MSC_VER)
+#define SDK_FP_CONTRACT_OFF __pragma(fp_contract(off))
+#elif defined(__clang__)
+#define SDK_FP_CONTRACT_OFF _Pragma("clang fp contract(off)")
+#else
+#define SDK_FP_CONTRACT_OFF _Pragma("GCC optimize(\"fp-contract=off\")")
+#endif
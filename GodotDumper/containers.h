@@ -0,0 +1,412 @@
+#pragma once
+#include "compiler.h"
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <xmmintrin.h>
+
+/*
+ * Non-owning views over Godot 4.3+ containers (Vector/CowData, HashMap, List, RBMap)
+ *
+ * The views never copy the container, elements are read in place through a memory source
+ * A memory source turns an address of the game into a readable pointer, or nullptr if the range isn't readable:
+ *
+ *   const void* translate(std::uintptr_t address, std::size_t size) const;
+ *
+ * LocalMemory is the identity (we live inside the game), other sources can map a dump or a copy
+ * Pointers stored inside the containers are game addresses, so they're kept as std::uintptr_t and always go through the source
+ *
+ * Nothing read from the game is trusted: a size that doesn't fit in the address space gives an empty view, and the linked
+ * containers stop after the element count they store, so a torn or cyclic list ends instead of looping
+*/
+
+struct LocalMemory
+{
+    __forceinline const void* translate(std::uintptr_t address, std::size_t) const
+    {
+        return reinterpret_cast<const void*>(address);
+    }
+};
+
+template <typename Source>
+__forceinline void prefetch_address(const Source& source, std::uintptr_t address, std::size_t size)
+{
+    if (const void* ptr = address ? source.translate(address, size) : nullptr)
+        _mm_prefetch(reinterpret_cast<const char*>(ptr), _MM_HINT_T0);
+}
+
+template <typename K, typename V>
+struct KeyValue
+{
+    K key;
+    V value;
+};
+
+/*
+ * Vector<T> is { VectorWriteProxy<T> write; CowData<T> _cowdata; }, the proxy is empty but still takes 8 bytes
+ * CowData<T> is a single pointer to the first element, the header sits right before it:
+ *
+ * [ SafeNumeric<uint64_t> refcount ][ uint64_t size ][ T... ]
+ *                                                     ^ _ptr
+*/
+template <typename T, typename Source = LocalMemory>
+class VectorView
+{
+public:
+    static constexpr std::size_t VECTOR_COWDATA_OFFSET = 0x8;
+    static constexpr std::size_t COWDATA_SIZE_OFFSET = 0x8; // Subtracted from _ptr
+
+public:
+    VectorView() = default;
+
+    // cowdata_ptr is the value of CowData::_ptr
+    VectorView(std::uintptr_t cowdata_ptr, Source p_source = {}) : source(p_source)
+    {
+        if (!cowdata_ptr)
+            return;
+
+        const std::int64_t* size_ptr = static_cast<const std::int64_t*>(source.translate(cowdata_ptr - COWDATA_SIZE_OFFSET, sizeof(std::int64_t)));
+        if (!size_ptr || *size_ptr <= 0 || static_cast<std::uint64_t>(*size_ptr) > SIZE_MAX / sizeof(T))
+            return;
+
+        data = static_cast<const T*>(source.translate(cowdata_ptr, static_cast<std::size_t>(*size_ptr) * sizeof(T)));
+        if (data)
+            count = static_cast<std::size_t>(*size_ptr);
+    }
+
+    static VectorView from_cowdata(std::uintptr_t cowdata_address, Source p_source = {})
+    {
+        const std::uintptr_t* ptr = static_cast<const std::uintptr_t*>(p_source.translate(cowdata_address, sizeof(std::uintptr_t)));
+        return ptr ? VectorView(*ptr, p_source) : VectorView({}, p_source);
+    }
+
+    static VectorView from_vector(std::uintptr_t vector_address, Source p_source = {})
+    {
+        return from_cowdata(vector_address + VECTOR_COWDATA_OFFSET, p_source);
+    }
+
+public:
+    __forceinline const T* ptr() const { return data; }
+    __forceinline std::size_t size() const { return count; }
+    __forceinline bool empty() const { return count == 0; }
+
+    __forceinline const T& operator[](std::size_t p_index) const { return data[p_index]; }
+
+    // The elements are contiguous, the hardware prefetcher already follows a linear walk
+    __forceinline const T* begin() const { return data; }
+    __forceinline const T* end() const { return data + count; }
+
+private:
+    const T* data = nullptr;
+    std::size_t count = 0;
+    Source source;
+};
+
+/*
+ * HashMap<K, V> keeps its elements in a doubly linked list in insertion order, next to the open addressing table
+ *
+ * Allocator element_alloc;            // Empty, padded to 8
+ * HashMapElement** elements;          // The table, indexed by hash
+ * uint32_t* hashes;
+ * HashMapElement* head_element;
+ * HashMapElement* tail_element;
+ * uint32_t capacity_index;
+ * uint32_t num_elements;
+*/
+template <typename K, typename V, typename Source = LocalMemory>
+class HashMapView
+{
+public:
+    struct Element
+    {
+        std::uintptr_t next;
+        std::uintptr_t prev;
+        KeyValue<K, V> data;
+    };
+
+    struct Iterator
+    {
+        __forceinline const KeyValue<K, V>& operator*() const { return element->data; }
+        __forceinline const KeyValue<K, V>* operator->() const { return &element->data; }
+
+        __forceinline Iterator& operator++()
+        {
+            element = --remaining && element->next ? static_cast<const Element*>(source.translate(element->next, sizeof(Element))) : nullptr;
+
+            // The following node is the next cache miss, start loading it while the caller works on this one
+            if (element)
+                prefetch_address(source, element->next, sizeof(Element));
+
+            return *this;
+        }
+
+        __forceinline bool operator==(const Iterator& b) const { return element == b.element; }
+        __forceinline bool operator!=(const Iterator& b) const { return element != b.element; }
+
+        const Element* element = nullptr;
+        Source source;
+        std::size_t remaining = 0; // Elements left including this one, the container's own count
+    };
+
+private:
+    struct Data
+    {
+        std::uintptr_t element_alloc;
+        std::uintptr_t elements;
+        std::uintptr_t hashes;
+        std::uintptr_t head_element;
+        std::uintptr_t tail_element;
+        std::uint32_t capacity_index;
+        std::uint32_t num_elements;
+    };
+
+public:
+    HashMapView() = default;
+
+    // address is the address of the HashMap itself
+    HashMapView(std::uintptr_t address, Source p_source = {}) : source(p_source)
+    {
+        map = address ? static_cast<const Data*>(source.translate(address, sizeof(Data))) : nullptr;
+    }
+
+public:
+    __forceinline std::size_t size() const { return map ? map->num_elements : 0; }
+    __forceinline bool empty() const { return size() == 0; }
+
+    Iterator begin() const
+    {
+        if (!map || !map->head_element || !map->num_elements)
+            return end();
+
+        Iterator it{ static_cast<const Element*>(source.translate(map->head_element, sizeof(Element))), source, size() };
+        if (it.element)
+            prefetch_address(source, it.element->next, sizeof(Element));
+
+        return it;
+    }
+
+    __forceinline Iterator end() const { return Iterator{ nullptr, source, 0 }; }
+
+    // Linear search, the engine's hash functions aren't reproduced here
+    template <typename F>
+    const KeyValue<K, V>* find_if(F&& predicate) const
+    {
+        for (const KeyValue<K, V>& pair : *this)
+        {
+            if (predicate(pair))
+                return &pair;
+        }
+
+        return nullptr;
+    }
+
+private:
+    const Data* map = nullptr;
+    Source source;
+};
+
+/*
+ * List<T> only holds a pointer to its _Data { Element* first; Element* last; int size_cache; }
+ * Element is { T value; Element* next_ptr; Element* prev_ptr; _Data* data; }
+*/
+template <typename T, typename Source = LocalMemory>
+class ListView
+{
+public:
+    struct Element
+    {
+        T value;
+        std::uintptr_t next_ptr;
+        std::uintptr_t prev_ptr;
+        std::uintptr_t data;
+    };
+
+    struct Iterator
+    {
+        __forceinline const T& operator*() const { return element->value; }
+        __forceinline const T* operator->() const { return &element->value; }
+
+        __forceinline Iterator& operator++()
+        {
+            element = --remaining && element->next_ptr ? static_cast<const Element*>(source.translate(element->next_ptr, sizeof(Element))) : nullptr;
+
+            if (element)
+                prefetch_address(source, element->next_ptr, sizeof(Element));
+
+            return *this;
+        }
+
+        __forceinline bool operator==(const Iterator& b) const { return element == b.element; }
+        __forceinline bool operator!=(const Iterator& b) const { return element != b.element; }
+
+        const Element* element = nullptr;
+        Source source;
+        std::size_t remaining = 0; // Elements left including this one, the container's own count
+    };
+
+private:
+    struct Data
+    {
+        std::uintptr_t first;
+        std::uintptr_t last;
+        std::int32_t size_cache;
+    };
+
+public:
+    ListView() = default;
+
+    // address is the address of the List itself
+    ListView(std::uintptr_t address, Source p_source = {}) : source(p_source)
+    {
+        const std::uintptr_t* data_ptr = address ? static_cast<const std::uintptr_t*>(source.translate(address, sizeof(std::uintptr_t))) : nullptr;
+        if (data_ptr && *data_ptr)
+            list = static_cast<const Data*>(source.translate(*data_ptr, sizeof(Data)));
+    }
+
+public:
+    __forceinline std::size_t size() const { return list && list->size_cache > 0 ? static_cast<std::size_t>(list->size_cache) : 0; }
+    __forceinline bool empty() const { return size() == 0; }
+
+    Iterator begin() const
+    {
+        if (!list || !list->first || !size())
+            return end();
+
+        Iterator it{ static_cast<const Element*>(source.translate(list->first, sizeof(Element))), source, size() };
+        if (it.element)
+            prefetch_address(source, it.element->next_ptr, sizeof(Element));
+
+        return it;
+    }
+
+    __forceinline Iterator end() const { return Iterator{ nullptr, source, 0 }; }
+
+private:
+    const Data* list = nullptr;
+    Source source;
+};
+
+/*
+ * RBMap<K, V> is a red-black tree threaded with _next/_prev, so an in-order walk never climbs the tree
+ *
+ * _Data { Element* _root; Element* _nil; int size_cache; } is stored inline
+ * _root is a sentinel, the real root is _root->left, every missing child points to _nil
+ * Element is { int color; Element* right; Element* left; Element* parent; Element* _next; Element* _prev; KeyValue<K, V> _data; }
+*/
+template <typename K, typename V, typename Source = LocalMemory, typename Compare = std::less<K>>
+class RBMapView
+{
+public:
+    struct Element
+    {
+        std::int32_t color;
+        std::uintptr_t right;
+        std::uintptr_t left;
+        std::uintptr_t parent;
+        std::uintptr_t _next;
+        std::uintptr_t _prev;
+        KeyValue<K, V> data;
+    };
+
+    struct Iterator
+    {
+        __forceinline const KeyValue<K, V>& operator*() const { return element->data; }
+        __forceinline const KeyValue<K, V>* operator->() const { return &element->data; }
+
+        __forceinline Iterator& operator++()
+        {
+            element = --remaining && element->_next ? static_cast<const Element*>(source.translate(element->_next, sizeof(Element))) : nullptr;
+
+            if (element)
+                prefetch_address(source, element->_next, sizeof(Element));
+
+            return *this;
+        }
+
+        __forceinline bool operator==(const Iterator& b) const { return element == b.element; }
+        __forceinline bool operator!=(const Iterator& b) const { return element != b.element; }
+
+        const Element* element = nullptr;
+        Source source;
+        std::size_t remaining = 0; // Elements left including this one, the container's own count
+    };
+
+private:
+    struct Data
+    {
+        std::uintptr_t _root;
+        std::uintptr_t _nil;
+        std::int32_t size_cache;
+    };
+
+public:
+    RBMapView() = default;
+
+    // address is the address of the RBMap itself
+    RBMapView(std::uintptr_t address, Source p_source = {}) : source(p_source)
+    {
+        map = address ? static_cast<const Data*>(source.translate(address, sizeof(Data))) : nullptr;
+    }
+
+public:
+    __forceinline std::size_t size() const { return map && map->size_cache > 0 ? static_cast<std::size_t>(map->size_cache) : 0; }
+    __forceinline bool empty() const { return size() == 0; }
+
+    Iterator begin() const
+    {
+        const Element* element = get_root();
+        if (!element || !size())
+            return end();
+
+        // No path down the tree is longer than its element count
+        for (std::size_t depth = 0; element->left != map->_nil; depth++)
+        {
+            element = depth < size() ? static_cast<const Element*>(source.translate(element->left, sizeof(Element))) : nullptr;
+            if (!element)
+                return end();
+        }
+
+        Iterator it{ element, source, size() };
+        prefetch_address(source, element->_next, sizeof(Element));
+
+        return it;
+    }
+
+    __forceinline Iterator end() const { return Iterator{ nullptr, source, 0 }; }
+
+    // Same descent as RBMap::find, needs Compare to order keys like the engine does
+    const KeyValue<K, V>* find(const K& key) const
+    {
+        const Element* element = get_root();
+        Compare less;
+
+        for (std::size_t depth = 0; element && depth < size(); depth++)
+        {
+            if (less(key, element->data.key))
+                element = element->left != map->_nil ? static_cast<const Element*>(source.translate(element->left, sizeof(Element))) : nullptr;
+            else if (less(element->data.key, key))
+                element = element->right != map->_nil ? static_cast<const Element*>(source.translate(element->right, sizeof(Element))) : nullptr;
+            else
+                return &element->data;
+        }
+
+        return nullptr;
+    }
+
+private:
+    const Element* get_root() const
+    {
+        if (!map || !map->_root)
+            return nullptr;
+
+        const Element* sentinel = static_cast<const Element*>(source.translate(map->_root, sizeof(Element)));
+        if (!sentinel || sentinel->left == map->_nil)
+            return nullptr;
+
+        return static_cast<const Element*>(source.translate(sentinel->left, sizeof(Element)));
+    }
+
+private:
+    const Data* map = nullptr;
+    Source source;
+};
@@ -1,17 +1,103 @@
 // Godot Explorer made by NoKlyf_
-// It supports versions 4.3 and 4.4
+// It supports versions 4.3, 4.4 and 4.5
 
 /*
- * To set the version you want go to the preprocessor definitions
- * int project properties and edit or add a definition like this:
- * GODOT_VERSION_x_y
- * where x is the engine's major version and y is the engine's minor version
+ * The engine version is detected at startup and picks one of the
+ * layout tables in layout.cpp, to support a new version add an entry there
 */
 
 #include <Windows.h>
-#include <iostream>
+#include "font_cache.h"
+#include "frame_hook.h"
 #include "godot.h"
+#include "logger.h"
 #include "render.h"
+#include "profiler.h"
+#include "remote.h"
+#include "scheduler.h"
+#include "visuals.h"
+#include "vtables.h"
+#include "work_pool.h"
+#include <chrono>
+
+// GODOT_DUMPER_REMOTE=[host:]port streams the scene to tools/remoteview instead of drawing the overlay in the game
+static bool remote_requested(std::string& host, std::uint16_t& port)
+{
+    char value[128] = {};
+    DWORD length = GetEnvironmentVariableA("GODOT_DUMPER_REMOTE", value, sizeof(value));
+
+    return length && length < sizeof(value) && remote::parse_address(value, host, port);
+}
+
+static void remote_loop(const std::string& host, std::uint16_t port)
+{
+    remote_server_t server;
+    if (!server.start(host, port))
+    {
+        LOG_ERROR("Couldn't listen on {}:{}", host, port);
+        return;
+    }
+
+    LOG_INFO("Streaming the scene on {}:{}", host, port);
+
+    vtables->start(mem->get_base_address(), gd::Object::CLASS_NAME_INDEX);
+
+    frame_scheduler_t scheduler;
+    scheduler.target_rate = 60.f;
+
+    // Only woken for scenes of remote::PARALLEL_NODES or more
+    work_pool_t pool;
+
+    remote::scene_t scene;
+    auto start = std::chrono::steady_clock::now();
+    bool connected = false;
+
+    // Captured on the game's thread between two frames when SceneTree::process can be hooked, no torn reads then
+    // Polled from this thread otherwise
+    auto last_capture = start;
+    const std::chrono::duration<double> interval(1.0 / scheduler.target_rate);
+
+    if (frame_hook->install())
+    {
+        frame_hook->add([&](gd::SceneTree* tree, double)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_capture < interval || !server.is_ready())
+                return;
+
+            last_capture = now;
+            scene.time = std::chrono::duration<double>(now - start).count();
+            if (remote::capture(tree, scene, &pool))
+                server.publish(scene);
+        });
+    }
+
+    while (true)
+    {
+        PROFILE_FRAME();
+
+        // A viewer that's WINDOW frames behind isn't worth walking the tree for, its next delta covers the gap
+        if (!frame_hook->is_installed() && server.is_ready())
+        {
+            scene.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (remote::capture(gd::SceneTree::get_singleton(), scene, &pool))
+                server.publish(scene);
+        }
+
+        if (server.is_connected() != connected)
+        {
+            connected = !connected;
+            if (connected)
+                LOG_INFO("Viewer connected");
+            else
+                LOG_INFO("Viewer disconnected");
+        }
+
+        scheduler.set_idle(!connected);
+        PROFILE_SCOPE("wait");
+        scheduler.wait();
+    }
+}
 
 void WINAPI MainThread(HMODULE hModule)
 {
@@ -19,15 +105,43 @@ void WINAPI MainThread(HMODULE hModule)
     FILE *out;
     freopen_s(&out, "CONOUT$", "w", stdout);
 
+    logger->start("godot_dumper.log", stdout);
+
+    if (!gd::detect_layout())
+    {
+        LOG_ERROR("Unsupported Godot version");
+
+        logger->stop();
+        fclose(out);
+        FreeConsole();
+        FreeLibraryAndExitThread(hModule, 0);
+    }
+
+    LOG_INFO("Godot version: {}.{}", gd::layout->major, gd::layout->minor);
+
     SetConsoleTitleA(gd::SceneTree::get_singleton()->get_root()->get_title().append(" (Explorer by NoKlyf_)").c_str());
 
-    std::cout << "[+] Base: " << std::hex << mem->get_base_address() << std::endl;
-    std::cout << "[+] SceneTree: " << std::hex << gd::SceneTree::get_singleton() << std::endl;
+    LOG_INFO("Base: {:x}", mem->get_base_address());
+    LOG_INFO("SceneTree: {}", gd::SceneTree::get_singleton());
+
+    std::string remote_host;
+    std::uint16_t remote_port = 0;
+    if (remote_requested(remote_host, remote_port))
+    {
+        // Only returns if the port couldn't be opened
+        remote_loop(remote_host, remote_port);
+
+        logger->stop();
+        fclose(out);
+        FreeConsole();
+        FreeLibraryAndExitThread(hModule, 0);
+    }
 
     if (!render->create_window())
     {
-        std::cout << "[-] Failed to create the overlay's window" << std::endl;
+        LOG_ERROR("Failed to create the overlay's window");
 
+        logger->stop();
         fclose(out);
         FreeConsole();
         FreeLibraryAndExitThread(hModule, 0);
@@ -35,8 +149,9 @@ void WINAPI MainThread(HMODULE hModule)
 
     if (!render->create_device())
     {
-        std::cout << "[-] Failed to create the D3D11 Device" << std::endl;
+        LOG_ERROR("Failed to create the D3D11 Device");
 
+        logger->stop();
         fclose(out);
         FreeConsole();
         FreeLibraryAndExitThread(hModule, 0);
@@ -44,21 +159,34 @@ void WINAPI MainThread(HMODULE hModule)
 
     if (!render->create_imgui())
     {
-        std::cout << "[-] Failed to initialize ImGui" << std::endl;
+        LOG_ERROR("Failed to initialize ImGui");
 
+        logger->stop();
         fclose(out);
         FreeConsole();
         FreeLibraryAndExitThread(hModule, 0);
     }
 
-#ifdef GODOT_VERSION_4_4
-    ImGui::InsertNotification({ ImGuiToastType_Info, 3000, "Explorer initialized! (Godot version: 4.4)" });
-#elif defined GODOT_VERSION_4_3
-    ImGui::InsertNotification({ ImGuiToastType_Info, 3000, "Explorer initialized! (Godot version: 4.3)" });
-#endif
+    // Class names come from this table once it's built, the virtual call until then
+    vtables->start(mem->get_base_address(), gd::Object::CLASS_NAME_INDEX);
+
+    ImGui::InsertNotification({ ImGuiToastType_Info, 3000, "Explorer initialized! (Godot version: %d.%d)", gd::layout->major, gd::layout->minor });
+
+    // Visuals walk the whole scene, they're captured on the game's thread between two frames when SceneTree::process can be hooked
+    // The explorer only reads the nodes that are open and stays on this thread
+    if (frame_hook->install())
+    {
+        frame_hook->add([](gd::SceneTree* tree, double) { visuals->capture(tree); });
+        visuals->on_frame_hook = true;
+    }
+
+    frame_scheduler_t scheduler;
+    scheduler.interaction = []() { return render->poll_input(); };
 
     while (true)
     {
+        PROFILE_FRAME();
+
         render->start_render();
 
         if (render->running)
@@ -67,9 +195,14 @@ void WINAPI MainThread(HMODULE hModule)
         render->render_visuals();
         render->end_render();
 
-        Sleep(2);
+        font_cache->flush();
+
+        scheduler.set_idle(render->is_idle());
+        PROFILE_SCOPE("wait");
+        scheduler.wait();
     }
 
+    logger->stop();
     fclose(out);
     FreeConsole();
     FreeLibraryAndExitThread(hModule, 0);
@@ -0,0 +1,391 @@
+#include "font_cache.h"
+#include <imgui/imgui.h>
+#include <imgui/imgui_internal.h>
+#include <imgui/font_awesome_5.h>
+#include <imgui/fa_solid_900.h>
+#include <cstdio>
+#include <cstring>
+
+#pragma pack(push, 1)
+struct file_header_t {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t imgui_version;
+    std::uint32_t glyph_count;
+};
+
+struct file_glyph_t {
+    std::uint64_t key;
+    std::uint32_t codepoint;
+    float advance;
+    float x0, y0, x1, y1;
+    std::uint16_t width, height;
+};
+#pragma pack(pop)
+
+// UTF-8 of the ICON_FA_ macros to codepoints, all of them are 3 bytes long
+static constexpr ImWchar icon(const char* utf8)
+{
+    return static_cast<ImWchar>((utf8[0] & 0x0F) << 12 | (utf8[1] & 0x3F) << 6 | (utf8[2] & 0x3F));
+}
+
+// Only what imgui_notify's toasts draw, the rest of Font Awesome is never looked up
+static constexpr ImWchar icon_ranges[] =
+{
+    icon(ICON_FA_TIMES_CIRCLE), icon(ICON_FA_TIMES_CIRCLE),
+    icon(ICON_FA_CHECK_CIRCLE), icon(ICON_FA_CHECK_CIRCLE),
+    icon(ICON_FA_INFO_CIRCLE), icon(ICON_FA_INFO_CIRCLE),
+    icon(ICON_FA_EXCLAMATION_TRIANGLE), icon(ICON_FA_EXCLAMATION_TRIANGLE),
+    0
+};
+
+static constexpr float ICON_SIZE = 10.f;
+
+static std::uint64_t mix(std::uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// 8 bytes a step, the icon font alone is a few hundred KB and is hashed on every injection
+static std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed)
+{
+    const std::uint8_t* it = static_cast<const std::uint8_t*>(data);
+    std::uint64_t hash = mix(seed ^ size);
+
+    for (; size >= 8; size -= 8, it += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, it, sizeof(word));
+        hash = (hash ^ mix(word)) * 0x9E3779B97F4A7C15ull;
+    }
+
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, it, size);
+    return mix(hash ^ tail);
+}
+
+template <typename T>
+static std::uint64_t combine(std::uint64_t hash, const T& value)
+{
+    return hash_bytes(&value, sizeof(value), hash);
+}
+
+static bool in_ranges(const ImFontConfig* src, ImWchar codepoint)
+{
+    if (!src->GlyphRanges)
+        return true;
+
+    for (const ImWchar* range = src->GlyphRanges; range[0]; range += 2)
+    {
+        if (codepoint >= range[0] && codepoint <= range[1])
+            return true;
+    }
+
+    return false;
+}
+
+static const ImFontLoader* stb_loader()
+{
+    static const ImFontLoader* loader = ImFontAtlasGetFontLoaderForStbTruetype();
+    return loader;
+}
+
+// Everything about a source that changes its glyphs, the data itself is only hashed the first time
+static std::uint64_t source_key(ImFontConfig* src)
+{
+    auto [it, inserted] = font_cache->source_keys.try_emplace(src->FontLoaderData, 0);
+    if (!inserted)
+        return it->second;
+
+    std::uint64_t key = hash_bytes(src->FontData, static_cast<std::size_t>(src->FontDataSize), src->FontNo);
+    key = combine(key, src->SizePixels);
+    key = combine(key, src->DstFont->Sources[0]->SizePixels);
+    key = combine(key, src->OversampleH);
+    key = combine(key, src->OversampleV);
+    key = combine(key, src->PixelSnapH);
+    key = combine(key, src->PixelSnapV);
+    key = combine(key, src->GlyphOffset);
+    key = combine(key, src->RasterizerDensity);
+
+    it->second = key;
+    return key;
+}
+
+static bool loader_src_init(ImFontAtlas* atlas, ImFontConfig* src)
+{
+    return stb_loader()->FontSrcInit(atlas, src);
+}
+
+static void loader_src_destroy(ImFontAtlas* atlas, ImFontConfig* src)
+{
+    font_cache->source_keys.erase(src->FontLoaderData);
+    stb_loader()->FontSrcDestroy(atlas, src);
+}
+
+static bool loader_src_contains_glyph(ImFontAtlas* atlas, ImFontConfig* src, ImWchar codepoint)
+{
+    return in_ranges(src, codepoint) && stb_loader()->FontSrcContainsGlyph(atlas, src, codepoint);
+}
+
+static bool loader_baked_init(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* data)
+{
+    return stb_loader()->FontBakedInit(atlas, src, baked, data);
+}
+
+static bool loader_baked_load_glyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* data, ImWchar codepoint, ImFontGlyph* out_glyph, float* out_advance_x)
+{
+    if (!in_ranges(src, codepoint))
+        return false;
+
+    // Metrics only (huge sizes), nothing is rasterized
+    if (out_advance_x || src->RasterizerMultiply != 1.f)
+        return stb_loader()->FontBakedLoadGlyph(atlas, src, baked, data, codepoint, out_glyph, out_advance_x);
+
+    std::uint64_t key = source_key(src);
+    key = combine(key, baked->Size);
+    key = combine(key, baked->RasterizerDensity);
+    key = combine(key, static_cast<std::uint32_t>(codepoint));
+
+    if (const font_cache_t::glyph_t* glyph = font_cache->find(key, codepoint))
+    {
+        font_cache->hits++;
+
+        out_glyph->Codepoint = codepoint;
+        out_glyph->AdvanceX = glyph->advance;
+
+        if (!glyph->width || !glyph->height)
+            return true;
+
+        ImFontAtlasRectId pack_id = ImFontAtlasPackAddRect(atlas, glyph->width, glyph->height);
+        if (pack_id == ImFontAtlasRectId_Invalid)
+            return false;
+
+        ImTextureRect* rect = ImFontAtlasPackGetRect(atlas, pack_id);
+
+        out_glyph->X0 = glyph->x0;
+        out_glyph->Y0 = glyph->y0;
+        out_glyph->X1 = glyph->x1;
+        out_glyph->Y1 = glyph->y1;
+        out_glyph->Visible = true;
+        out_glyph->PackId = pack_id;
+        ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, out_glyph, rect, font_cache->get_pixels(*glyph), ImTextureFormat_Alpha8, glyph->width);
+
+        return true;
+    }
+
+    if (!stb_loader()->FontBakedLoadGlyph(atlas, src, baked, data, codepoint, out_glyph, out_advance_x))
+        return false;
+
+    font_cache->misses++;
+
+    font_cache_t::glyph_t glyph = {};
+    glyph.key = key;
+    glyph.codepoint = codepoint;
+    glyph.advance = out_glyph->AdvanceX;
+
+    std::vector<std::uint8_t> pixels;
+    if (out_glyph->Visible)
+    {
+        // Read back what stb_truetype just wrote, as alpha whatever the texture's format
+        ImTextureRect* rect = ImFontAtlasPackGetRect(atlas, out_glyph->PackId);
+        ImTextureData* texture = atlas->TexData;
+
+        glyph.x0 = out_glyph->X0;
+        glyph.y0 = out_glyph->Y0;
+        glyph.x1 = out_glyph->X1;
+        glyph.y1 = out_glyph->Y1;
+        glyph.width = rect->w;
+        glyph.height = rect->h;
+
+        pixels.resize(static_cast<std::size_t>(rect->w) * rect->h);
+        for (int y = 0; y < rect->h; y++)
+        {
+            const std::uint8_t* row = static_cast<const std::uint8_t*>(texture->GetPixelsAt(rect->x, rect->y + y));
+            for (int x = 0; x < rect->w; x++)
+                pixels[y * rect->w + x] = texture->Format == ImTextureFormat_Alpha8 ? row[x] : row[x * 4 + 3];
+        }
+    }
+
+    font_cache->add(glyph, pixels.data());
+    return true;
+}
+
+static const ImFontLoader* caching_loader()
+{
+    static ImFontLoader loader = []()
+    {
+        ImFontLoader loader;
+        loader.Name = "stb_truetype (cached)";
+        loader.FontSrcInit = loader_src_init;
+        loader.FontSrcDestroy = loader_src_destroy;
+        loader.FontSrcContainsGlyph = loader_src_contains_glyph;
+        loader.FontBakedInit = loader_baked_init;
+        loader.FontBakedLoadGlyph = loader_baked_load_glyph;
+        return loader;
+    }();
+
+    return &loader;
+}
+
+bool font_cache_t::load(ImFontAtlas* atlas, const std::string& path)
+{
+    this->path = path;
+
+    hits = 0;
+    misses = 0;
+    glyphs.clear();
+    pool.clear();
+    index.clear();
+    dirty = false;
+
+    atlas->SetFontLoader(caching_loader());
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    std::vector<std::uint8_t> data(size > 0 ? static_cast<std::size_t>(size) : 0);
+    const bool read = !data.empty() && std::fread(data.data(), 1, data.size(), file) == data.size();
+    std::fclose(file);
+
+    file_header_t header = {};
+    if (!read || data.size() < sizeof(header))
+        return false;
+
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    // A different ImGui may place glyphs differently, everything is rebuilt
+    if (header.magic != MAGIC || header.version != VERSION || header.imgui_version != IMGUI_VERSION_NUM || header.glyph_count > MAX_GLYPHS)
+        return false;
+
+    const std::size_t table = sizeof(header) + static_cast<std::size_t>(header.glyph_count) * sizeof(file_glyph_t);
+    if (data.size() < table)
+        return false;
+
+    std::size_t offset = table;
+    glyphs.reserve(header.glyph_count);
+
+    for (std::uint32_t i = 0; i < header.glyph_count; i++)
+    {
+        file_glyph_t entry;
+        std::memcpy(&entry, data.data() + sizeof(header) + i * sizeof(file_glyph_t), sizeof(entry));
+
+        const std::size_t pixels = static_cast<std::size_t>(entry.width) * entry.height;
+        if (data.size() - offset < pixels)
+        {
+            glyphs.clear();
+            index.clear();
+            return false;
+        }
+
+        glyph_t glyph = { entry.key, entry.codepoint, entry.advance, entry.x0, entry.y0, entry.x1, entry.y1, entry.width, entry.height, static_cast<std::uint32_t>(offset - table) };
+        index.emplace(glyph.key, static_cast<std::uint32_t>(glyphs.size()));
+        glyphs.push_back(glyph);
+
+        offset += pixels;
+    }
+
+    pool.assign(data.begin() + table, data.begin() + offset);
+    return true;
+}
+
+bool font_cache_t::save()
+{
+    if (path.empty())
+        return false;
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    file_header_t header = { MAGIC, VERSION, IMGUI_VERSION_NUM, static_cast<std::uint32_t>(glyphs.size()) };
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (const glyph_t& glyph : glyphs)
+    {
+        file_glyph_t entry = { glyph.key, glyph.codepoint, glyph.advance, glyph.x0, glyph.y0, glyph.x1, glyph.y1, glyph.width, glyph.height };
+        written = written && std::fwrite(&entry, sizeof(entry), 1, file) == 1;
+    }
+
+    // Glyphs are only ever appended, the pool is already in their order
+    written = written && (pool.empty() || std::fwrite(pool.data(), pool.size(), 1, file) == 1);
+    written = std::fclose(file) == 0 && written;
+
+    if (written)
+        dirty = false;
+
+    return written;
+}
+
+void font_cache_t::flush()
+{
+    if (dirty && std::chrono::steady_clock::now() - last_added > std::chrono::seconds(5))
+    {
+        // A failed write isn't retried every frame, the next new glyph tries again
+        if (!save())
+            dirty = false;
+    }
+}
+
+const font_cache_t::glyph_t* font_cache_t::find(std::uint64_t key, std::uint32_t codepoint) const
+{
+    auto it = index.find(key);
+    if (it == index.end() || glyphs[it->second].codepoint != codepoint)
+        return nullptr;
+
+    return &glyphs[it->second];
+}
+
+void font_cache_t::add(const glyph_t& glyph, const std::uint8_t* pixels)
+{
+    if (glyphs.size() >= MAX_GLYPHS || index.contains(glyph.key))
+        return;
+
+    glyph_t entry = glyph;
+    entry.pixels = static_cast<std::uint32_t>(pool.size());
+    pool.insert(pool.end(), pixels, pixels + static_cast<std::size_t>(glyph.width) * glyph.height);
+
+    index.emplace(entry.key, static_cast<std::uint32_t>(glyphs.size()));
+    glyphs.push_back(entry);
+
+    dirty = true;
+    last_added = std::chrono::steady_clock::now();
+}
+
+void font_cache_t::add_fonts(ImFontAtlas* atlas)
+{
+    atlas->AddFontDefault();
+
+    // Same as imgui_notify's MergeIconsWithLatestFont, with the ranges cut down to the icons in use
+    ImFontConfig config;
+    config.MergeMode = true;
+    config.PixelSnapH = true;
+    config.FontDataOwnedByAtlas = false;
+
+    atlas->AddFontFromMemoryTTF(const_cast<unsigned char*>(fa_solid_900), sizeof(fa_solid_900), ICON_SIZE, &config, icon_ranges);
+}
+
+void font_cache_t::preload(ImFontAtlas* atlas, float scale)
+{
+    for (ImFont* font : atlas->Fonts)
+    {
+        ImFontBaked* baked = font->GetFontBaked(font->LegacySize * scale);
+
+        for (ImWchar c = 0x20; c < 0x7F; c++)
+            baked->FindGlyph(c);
+
+        for (const ImWchar* range = icon_ranges; range[0]; range += 2)
+        {
+            for (std::uint32_t c = range[0]; c <= range[1]; c++)
+                baked->FindGlyph(static_cast<ImWchar>(c));
+        }
+    }
+}
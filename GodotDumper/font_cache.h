@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ImFontAtlas;
+
+/*
+ * Disk cache of rasterized glyphs for the overlay's fonts
+ *
+ * ImGui 1.92 bakes glyphs on first use, every injection rasterizes the same few hundred with stb_truetype
+ * The cache is a font loader wrapped around stb_truetype's: a glyph already in the cache is packed and copied
+ * into the atlas, a new one is rasterized by stb_truetype and its pixels read back from the atlas
+ *
+ * A glyph's key hashes the font data, the source's config (size, oversampling, offsets), the baked size
+ * (font size * DPI scale), the rasterizer density and the codepoint, a stale entry is never hit
+ * The source's GlyphRanges are honored, so a merged icon font only ever answers for the icons that are used
+ *
+ * File layout:
+ *
+ * header { u32 magic, u32 version, u32 IMGUI_VERSION_NUM, u32 glyph_count }
+ * glyphs { u64 key, u32 codepoint, f32 advance, f32 x0, f32 y0, f32 x1, f32 y1, u16 width, u16 height } * glyph_count
+ * pixels { u8 alpha * width * height } * glyph_count, in the same order
+*/
+class font_cache_t {
+public:
+	static constexpr std::uint32_t MAGIC = 'G' | 'D' << 8 | 'F' << 16 | 'C' << 24;
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::size_t MAX_GLYPHS = 1 << 16;
+
+	// Installs the caching loader on atlas, has to come before the fonts are added, false if path couldn't be read
+	bool load(ImFontAtlas* atlas, const std::string& path);
+	bool save();
+
+	// Saves once no glyph was added for a few seconds, called every frame
+	void flush();
+
+	// The explorer's fonts, the default one and the icons it draws merged into it
+	static void add_fonts(ImFontAtlas* atlas);
+	// Bakes printable ASCII and the icons at the default size times scale, what the cache builder runs
+	static void preload(ImFontAtlas* atlas, float scale);
+
+	std::size_t get_glyph_count() const { return glyphs.size(); }
+	std::uint64_t get_hits() const { return hits; }
+	std::uint64_t get_misses() const { return misses; }
+
+public:
+	// For the loader callbacks
+	struct glyph_t {
+		std::uint64_t key;
+		std::uint32_t codepoint;
+		float advance;
+		float x0, y0, x1, y1;
+		std::uint16_t width, height;
+		std::uint32_t pixels; // Into the pixel pool
+	};
+
+	const glyph_t* find(std::uint64_t key, std::uint32_t codepoint) const;
+	void add(const glyph_t& glyph, const std::uint8_t* pixels);
+
+	const std::uint8_t* get_pixels(const glyph_t& glyph) const { return pool.data() + glyph.pixels; }
+
+	// Per stb_truetype source data, hashed once
+	std::unordered_map<const void*, std::uint64_t> source_keys;
+
+	std::uint64_t hits = 0;
+	std::uint64_t misses = 0;
+
+private:
+	std::string path;
+
+	std::vector<glyph_t> glyphs;
+	std::vector<std::uint8_t> pool;
+	std::unordered_map<std::uint64_t, std::uint32_t> index; // Key -> glyphs
+
+	bool dirty = false;
+	std::chrono::steady_clock::time_point last_added;
+};
+
+inline std::unique_ptr<font_cache_t> font_cache = std::make_unique<font_cache_t>();
@@ -0,0 +1,132 @@
+#include "frame_hook.h"
+#include "analysis.h"
+#include "godot.h"
+#include "logger.h"
+#include "resolver.h"
+#include <algorithm>
+
+std::uint8_t* frame_hook_t::find_process(gd::SceneTree* tree)
+{
+    if (!tree || !analysis->get(mem->get_base_address()))
+        return nullptr;
+
+    const pe_image_t& image = analysis->get_image();
+    const xref_index_t& xrefs = analysis->get_xrefs();
+
+    // SceneTree::process does emit_signal(SNAME("process_frame"))
+    resolver_t resolver;
+    resolver.rules = { { "SceneTree::process", "process_frame", resolver_t::FUNCTION } };
+    resolver.resolve(image, xrefs);
+
+    const std::vector<std::uint32_t>& candidates = resolver.get_results()[0].candidates;
+    if (candidates.empty())
+        return nullptr;
+
+    const auto is_candidate = [&](std::uint32_t rva)
+    {
+        return std::find(candidates.begin(), candidates.end(), rva) != candidates.end();
+    };
+
+    // The vtable's entries, up to the first one that isn't code in the image
+    std::vector<std::uint32_t> entries;
+    void* const* vtable = *reinterpret_cast<void* const* const*>(tree);
+
+    for (std::size_t i = 0; i < MAX_VTABLE_ENTRIES; i++)
+    {
+        const std::uint32_t rva = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(vtable[i]) - analysis->get_base());
+        const pe_image_t::section_t* section = image.get_section(rva);
+        if (!section || !section->is_executable())
+            break;
+
+        entries.push_back(rva);
+    }
+
+    // Exactly one entry has to match, a guess would patch the wrong function
+    std::uint32_t found = 0;
+    for (std::uint32_t entry : entries)
+    {
+        if (!is_candidate(entry))
+            continue;
+
+        if (found && found != entry)
+            return nullptr;
+
+        found = entry;
+    }
+
+    if (!found)
+    {
+        for (std::uint32_t entry : entries)
+        {
+            const pe_image_t::function_t* function = image.get_function(entry);
+            if (!function)
+                continue;
+
+            for (const xref_index_t::xref_t& xref : xrefs.get_references_from(function->begin, function->end))
+            {
+                if (xref.kind != xref_index_t::CALL || !is_candidate(xref.target))
+                    continue;
+
+                if (found && found != entry)
+                    return nullptr;
+
+                found = entry;
+            }
+        }
+    }
+
+    return found ? reinterpret_cast<std::uint8_t*>(analysis->get_base() + found) : nullptr;
+}
+
+bool frame_hook_t::detour(gd::SceneTree* tree, double delta)
+{
+    const bool quit = frame_hook->hook.get_original<bool (*)(gd::SceneTree*, double)>()(tree, delta);
+
+    {
+        std::lock_guard lock(frame_hook->mutex);
+        for (callback_t& callback : frame_hook->callbacks)
+            callback(tree, delta);
+    }
+
+    frame_hook->frame.fetch_add(1, std::memory_order_relaxed);
+    return quit;
+}
+
+bool frame_hook_t::install()
+{
+    if (hook.is_installed())
+        return true;
+
+    std::uint8_t* process = find_process(gd::SceneTree::get_singleton());
+    if (!process)
+    {
+        LOG_WARNING("SceneTree::process not found");
+        return false;
+    }
+
+    if (!hook.install(process, reinterpret_cast<void*>(&frame_hook_t::detour)))
+    {
+        LOG_WARNING("Couldn't hook SceneTree::process at {:x}", static_cast<void*>(process));
+        return false;
+    }
+
+    LOG_INFO("SceneTree::process hooked at {:x} ({} bytes moved)", static_cast<void*>(process), hook.get_stolen_size());
+    return true;
+}
+
+void frame_hook_t::remove()
+{
+    hook.remove();
+}
+
+void frame_hook_t::add(callback_t callback)
+{
+    std::lock_guard lock(mutex);
+    callbacks.push_back(std::move(callback));
+}
+
+void frame_hook_t::clear()
+{
+    std::lock_guard lock(mutex);
+    callbacks.clear();
+}
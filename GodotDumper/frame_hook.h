@@ -0,0 +1,56 @@
+#pragma once
+#include "hook.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gd
+{
+	class SceneTree;
+}
+
+/*
+ * Runs callbacks on the game's main thread when SceneTree::process returns, the boundary between two frames
+ *
+ * By then scripts, timers, tweens and deferred calls are done and rendering hasn't started, nothing adds, frees or
+ * moves nodes while a callback runs so the tree (children_cache included) is read whole, one capture per engine frame
+ *
+ * SceneTree::process is the entry of the tree's vtable that emits "process_frame": every function referencing the
+ * literal is a candidate (other classes connect to the signal too), the one the vtable points at wins, or the one it
+ * calls directly if the SNAME lambda wasn't inlined
+*/
+class frame_hook_t {
+public:
+	using callback_t = std::function<void(gd::SceneTree* tree, double delta)>;
+
+	static constexpr std::size_t MAX_VTABLE_ENTRIES = 256;
+
+	// false if SceneTree::process couldn't be told apart or patched, the caller keeps polling then
+	bool install();
+	void remove();
+
+	bool is_installed() const { return hook.is_installed(); }
+
+	// Runs inside the game's frame, every frame waits for it
+	void add(callback_t callback);
+	void clear();
+
+	std::uint64_t get_frame() const { return frame.load(std::memory_order_relaxed); }
+
+private:
+	static std::uint8_t* find_process(gd::SceneTree* tree);
+	static bool detour(gd::SceneTree* tree, double delta);
+
+private:
+	inline_hook_t hook;
+
+	std::mutex mutex;
+	std::vector<callback_t> callbacks;
+
+	std::atomic<std::uint64_t> frame = 0;
+};
+
+inline std::unique_ptr<frame_hook_t> frame_hook = std::make_unique<frame_hook_t>();
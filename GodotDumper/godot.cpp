@@ -1,8 +1,27 @@
 #include "godot.h"
-#include <Windows.h>
+#include "analysis.h"
+#include "hierarchy.h"
+#include "profiler.h"
+#include "resolver.h"
+#include "vtables.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// Signature-less fallback, the first call resolves every rule of resolver.cpp at once
+static std::uint8_t* resolve_anchored(const char* name)
+{
+    static resolver_t resolver;
+    static bool resolved = analysis->get(mem->get_base_address()) && (resolver.resolve(analysis->get_image(), analysis->get_xrefs()), true);
+
+    std::uint32_t rva = resolved ? resolver.get(name) : 0;
+    return rva ? reinterpret_cast<std::uint8_t*>(analysis->get_base() + rva) : nullptr;
+}
 
 std::string gd::String::get_string()
 {
+    PROFILE_SCOPE("String::get_string");
+
     std::uint32_t* it = data;
 
     std::string result = "";
@@ -17,15 +36,190 @@ std::string gd::String::get_string()
 
 std::string gd::StringName::get_name()
 {
+    PROFILE_SCOPE("StringName::get_name");
+
     if (!ptr)
         return "No Name";
 
-    return ptr->name.get_string();
+    return ptr->name().get_string();
 }
 
 bool gd::Object::inherits_from(AncestralClass ancestral_class)
 {
-    return ancestry & (std::uint32_t)ancestral_class;
+    return ancestry() & (std::uint32_t)ancestral_class;
+}
+
+// Every slot below slot_max is either free (validator 0, no object) or holds an object whose vtable is in the image
+// slot_max only ever doubles, which tells it apart from slot_count right next to it
+static bool is_object_db(std::uint8_t* slots_global, std::uint8_t* slot_max_global)
+{
+    if (!slots_global || !slot_max_global || !mem->is_readable(slots_global, sizeof(void*)) || !mem->is_readable(slot_max_global, sizeof(std::uint32_t)))
+        return false;
+
+    const std::uint32_t slot_max = *reinterpret_cast<std::uint32_t*>(slot_max_global);
+    if (slot_max == 0 || slot_max > (1u << gd::ObjectDB::SLOT_MAX_COUNT_BITS) || (slot_max & (slot_max - 1)) != 0)
+        return false;
+
+    gd::ObjectDB::ObjectSlot* slots = *reinterpret_cast<gd::ObjectDB::ObjectSlot**>(slots_global);
+    const std::uint32_t checked = std::min<std::uint32_t>(slot_max, 256);
+
+    if ((reinterpret_cast<std::uintptr_t>(slots) & 0x7) != 0 || !mem->is_readable(slots, checked * sizeof(gd::ObjectDB::ObjectSlot)))
+        return false;
+
+    std::uint32_t used = 0;
+    for (std::uint32_t i = 0; i < checked; i++)
+    {
+        if (slots[i].validator == 0)
+        {
+            if (slots[i].object)
+                return false;
+
+            continue;
+        }
+
+        if (!mem->is_readable(slots[i].object, sizeof(void*)) || !gd::ObjectDB::is_valid_slot(slots[i]))
+            return false;
+
+        used++;
+    }
+
+    return used != 0;
+}
+
+struct object_db_globals_t {
+    std::uint8_t* slots = nullptr;
+    std::uint8_t* slot_max = nullptr;
+};
+
+static object_db_globals_t find_object_db()
+{
+    /*
+     * ObjectDB::get_instance is inlined everywhere an ObjectID is resolved
+     * Look for a "slot >= slot_max" check followed by an index into object_slots like this
+     *
+     * slot = id & 0xFFFFFF;
+     * if (slot >= slot_max) ...
+     * if (object_slots[slot].validator != validator) ...
+     *
+     * object_slots is a pointer, slot_max is the uint32_t right before the comparison
+    */
+    object_db_globals_t globals;
+
+    if (std::uint8_t* site = mem->find_pattern(gd::layout->object_slots_pattern))
+        globals.slots = mem->resolve_rel_addr(site, gd::layout->object_slots_rva_offset, gd::layout->object_slots_rip_offset);
+
+    if (std::uint8_t* site = mem->find_pattern(gd::layout->slot_max_pattern))
+        globals.slot_max = mem->resolve_rel_addr(site, gd::layout->slot_max_rva_offset, gd::layout->slot_max_rip_offset);
+
+    if (is_object_db(globals.slots, globals.slot_max))
+        return globals;
+
+    /*
+     * The patterns are generic, when they miss or land elsewhere try the globals ObjectDB::cleanup touches
+     * (slot_count, slot_max and object_slots, besides the lock and OS::singleton), the pair that passes
+     * is_object_db is taken
+    */
+    std::uint8_t* cleanup = resolve_anchored("ObjectDB::cleanup");
+    const pe_image_t::function_t* function = cleanup ? analysis->get_image().get_function(static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(cleanup) - analysis->get_base())) : nullptr;
+
+    if (function)
+    {
+        std::vector<std::uint8_t*> candidates;
+        for (const xref_index_t::xref_t& xref : analysis->get_xrefs().get_references_from(function->begin, function->end))
+        {
+            const pe_image_t::section_t* section = analysis->get_image().get_section(xref.target);
+            if ((xref.kind != xref_index_t::READ && xref.kind != xref_index_t::WRITE) || !section || !section->is_writable())
+                continue;
+
+            std::uint8_t* global = reinterpret_cast<std::uint8_t*>(analysis->get_base() + xref.target);
+            if (std::find(candidates.begin(), candidates.end(), global) == candidates.end())
+                candidates.push_back(global);
+        }
+
+        for (std::uint8_t* slots : candidates)
+        {
+            for (std::uint8_t* slot_max : candidates)
+            {
+                if (slots != slot_max && is_object_db(slots, slot_max))
+                    return { slots, slot_max };
+            }
+        }
+    }
+
+    return {};
+}
+
+static const object_db_globals_t& get_object_db()
+{
+    static const object_db_globals_t globals = find_object_db();
+    return globals;
+}
+
+gd::ObjectDB::ObjectSlot* gd::ObjectDB::get_slots()
+{
+    std::uint8_t* addr = get_object_db().slots;
+    return addr ? *(ObjectSlot**)(addr) : nullptr;
+}
+
+std::uint32_t gd::ObjectDB::get_slot_max()
+{
+    std::uint8_t* addr = get_object_db().slot_max;
+    return addr ? *(std::uint32_t*)(addr) : 0;
+}
+
+bool gd::ObjectDB::is_valid_slot(const ObjectSlot& slot)
+{
+    if (slot.validator == 0 || !slot.object)
+        return false;
+
+    std::uintptr_t object = reinterpret_cast<std::uintptr_t>(slot.object);
+    if ((object & 0x7) != 0 || object >= 0x800000000000)
+        return false;
+
+    std::uintptr_t vtable = reinterpret_cast<std::uintptr_t>(slot.object->get_vtable());
+    std::uintptr_t image = reinterpret_cast<std::uintptr_t>(mem->get_base_address());
+
+    return vtable >= image && vtable < image + mem->get_image_size();
+}
+
+gd::Object* gd::ObjectDB::get_instance(std::uint64_t instance_id)
+{
+    ObjectSlot* slots = get_slots();
+    if (!slots)
+        return nullptr;
+
+    std::uint32_t index = static_cast<std::uint32_t>(instance_id & ((1ull << SLOT_MAX_COUNT_BITS) - 1));
+    std::uint64_t validator = (instance_id >> SLOT_MAX_COUNT_BITS) & ((1ull << VALIDATOR_BITS) - 1);
+
+    if (index >= get_slot_max() || slots[index].validator != validator)
+        return nullptr;
+
+    return slots[index].object;
+}
+
+std::uint64_t gd::ObjectDB::find_instance_id(const Object* object)
+{
+    ObjectSlot* slots = get_slots();
+    if (!slots || !object)
+        return 0;
+
+    std::uint32_t slot_max = get_slot_max();
+    for (std::uint32_t i = 0; i < slot_max; i++)
+    {
+        if (slots[i].object == object && slots[i].validator != 0)
+            return get_instance_id(slots[i], i);
+    }
+
+    return 0;
+}
+
+std::uint64_t gd::ObjectDB::get_instance_id(const ObjectSlot& slot, std::uint32_t index)
+{
+    std::uint64_t id = (static_cast<std::uint64_t>(slot.validator) << SLOT_MAX_COUNT_BITS) | index;
+    if (slot.is_ref_counted)
+        id |= REFERENCE_BIT;
+
+    return id;
 }
 
 gd::Node* gd::Node::find_child(std::string_view path)
@@ -45,7 +239,7 @@ gd::Node* gd::Node::find_child(std::string_view path)
             return nullptr;
 
         bool found = false;
-        for (Node* child : current->children_cache)
+        for (Node* child : current->children_cache())
         {
             if (!child)
                 continue;
@@ -72,55 +266,176 @@ gd::Node* gd::Node::find_child(std::string_view path)
 
 std::string gd::Node::get_scene_file_path()
 {
-    return scene_file_path.get_string();
+    return scene_file_path().get_string();
 }
 
 LocalVector<gd::Node*>& gd::Node::get_children()
 {
-    return children_cache;
+    return children_cache();
 }
 
 std::string gd::Node::get_name()
 {
-    return name.get_name();
+    return name().get_name();
 }
 
-std::string gd::Node::get_class_name()
+std::string gd::Object::get_class_name()
 {
-    if (!IsBadReadPtr(this, sizeof(this))) // I have to check for this because sometimes the vtable is null and crashes the game
-        return mem->call_vfunc<gd::String, 10>(this).get_string();
+    PROFILE_SCOPE("Object::get_class_name");
 
+    if (!mem->is_readable(this, sizeof(this))) // I have to check for this because sometimes the vtable is null and crashes the game
+        return "";
+
+    if (const std::string* name = vtables->find(get_vtable()))
+        return *name;
+
+#ifdef _WIN32
+    return mem->call_vfunc<gd::String, CLASS_NAME_INDEX>(this).get_string();
+#else
+    // A dump's code can't run here, only the vtable scan names classes
     return "";
+#endif
+}
+
+/*
+ * The engine's node classes (Godot 4.3 to 4.5, editor classes left out), by the base the node readers care about
+ * Objects always carry an engine vtable, a GDExtension or script class shows up as the native class it extends
+ * Some names lie: NavigationAgent3D and XRFaceModifier3D are plain Nodes, GridMap and TileMap are Node3D and Node2D
+*/
+static const std::unordered_map<std::string_view, gd::Object::Kind> node_classes = []()
+{
+    static const char* const NODE_3D[] = {
+        "Node3D", "AimModifier3D", "AnimatableBody3D", "AnimatedSprite3D", "Area3D", "AudioListener3D", "AudioStreamPlayer3D",
+        "BoneAttachment3D", "Camera3D", "CharacterBody3D", "CollisionObject3D", "CollisionPolygon3D", "CollisionShape3D",
+        "ConeTwistJoint3D", "ConvertTransformModifier3D", "CopyTransformModifier3D", "CPUParticles3D", "CSGBox3D", "CSGCombiner3D",
+        "CSGCylinder3D", "CSGMesh3D", "CSGPolygon3D", "CSGPrimitive3D", "CSGShape3D", "CSGSphere3D", "CSGTorus3D", "Decal",
+        "DirectionalLight3D", "FogVolume", "Generic6DOFJoint3D", "GeometryInstance3D", "GPUParticles3D", "GPUParticlesAttractor3D",
+        "GPUParticlesAttractorBox3D", "GPUParticlesAttractorSphere3D", "GPUParticlesAttractorVectorField3D", "GPUParticlesCollision3D",
+        "GPUParticlesCollisionBox3D", "GPUParticlesCollisionHeightField3D", "GPUParticlesCollisionSDF3D", "GPUParticlesCollisionSphere3D",
+        "GridMap", "HingeJoint3D", "ImporterMeshInstance3D", "Joint3D", "Label3D", "Light3D", "LightmapGI", "LightmapProbe",
+        "LookAtModifier3D", "Marker3D", "MeshInstance3D", "ModifierBoneTarget3D", "MultiMeshInstance3D", "NavigationLink3D",
+        "NavigationObstacle3D", "NavigationRegion3D", "OccluderInstance3D", "OmniLight3D", "OpenXRCompositionLayer",
+        "OpenXRCompositionLayerCylinder", "OpenXRCompositionLayerEquirect", "OpenXRCompositionLayerQuad", "OpenXRHand", "Path3D",
+        "PathFollow3D", "PhysicalBone3D", "PhysicalBoneSimulator3D", "PhysicsBody3D", "PinJoint3D", "RayCast3D", "ReflectionProbe",
+        "RemoteTransform3D", "RetargetModifier3D", "RigidBody3D", "RootMotionView", "ShapeCast3D", "Skeleton3D", "SkeletonIK3D",
+        "SkeletonModifier3D", "SliderJoint3D", "SoftBody3D", "SpotLight3D", "SpringArm3D", "SpringBoneCollision3D",
+        "SpringBoneCollisionCapsule3D", "SpringBoneCollisionPlane3D", "SpringBoneCollisionSphere3D", "SpringBoneSimulator3D",
+        "Sprite3D", "SpriteBase3D", "StaticBody3D", "VehicleBody3D", "VehicleWheel3D", "VisibleOnScreenEnabler3D",
+        "VisibleOnScreenNotifier3D", "VisualInstance3D", "VoxelGI", "XRAnchor3D", "XRBodyModifier3D", "XRCamera3D", "XRController3D",
+        "XRHandModifier3D", "XRNode3D", "XROrigin3D",
+    };
+
+    static const char* const NODE_2D[] = {
+        "Node2D", "AnimatableBody2D", "AnimatedSprite2D", "Area2D", "AudioListener2D", "AudioStreamPlayer2D", "BackBufferCopy",
+        "Bone2D", "Camera2D", "CanvasGroup", "CanvasModulate", "CharacterBody2D", "CollisionObject2D", "CollisionPolygon2D",
+        "CollisionShape2D", "CPUParticles2D", "DampedSpringJoint2D", "DirectionalLight2D", "GPUParticles2D", "GrooveJoint2D",
+        "Joint2D", "Light2D", "LightOccluder2D", "Line2D", "Marker2D", "MeshInstance2D", "MultiMeshInstance2D", "NavigationLink2D",
+        "NavigationObstacle2D", "NavigationRegion2D", "Parallax2D", "ParallaxLayer", "Path2D", "PathFollow2D", "PhysicalBone2D",
+        "PhysicsBody2D", "PinJoint2D", "PointLight2D", "Polygon2D", "RayCast2D", "RemoteTransform2D", "RigidBody2D", "ShapeCast2D",
+        "Skeleton2D", "Sprite2D", "StaticBody2D", "TileMap", "TileMapLayer", "TouchScreenButton", "VisibleOnScreenEnabler2D",
+        "VisibleOnScreenNotifier2D",
+    };
+
+    // Nodes without a transform of their own: controls, windows and the logic nodes
+    static const char* const NODE[] = {
+        "Node", "AcceptDialog", "AnimationMixer", "AnimationPlayer", "AnimationTree", "AspectRatioContainer", "AudioStreamPlayer",
+        "BaseButton", "BoxContainer", "Button", "CanvasItem", "CanvasLayer", "CenterContainer", "CheckBox", "CheckButton", "CodeEdit",
+        "ColorPicker", "ColorPickerButton", "ColorRect", "ConfirmationDialog", "Container", "Control", "FileDialog", "FlowContainer",
+        "FoldableContainer", "GraphEdit", "GraphElement", "GraphFrame", "GraphNode", "GridContainer", "HBoxContainer",
+        "HFlowContainer", "HScrollBar", "HSeparator", "HSlider", "HSplitContainer", "HTTPRequest", "InstancePlaceholder", "ItemList",
+        "Label", "LineEdit", "LinkButton", "MarginContainer", "MenuBar", "MenuButton", "MissingNode", "MultiplayerSpawner",
+        "MultiplayerSynchronizer", "NavigationAgent2D", "NavigationAgent3D", "NinePatchRect", "OptionButton", "Panel",
+        "PanelContainer", "ParallaxBackground", "Popup", "PopupMenu", "PopupPanel", "ProgressBar", "Range", "ReferenceRect",
+        "ResourcePreloader", "RichTextLabel", "ScrollBar", "ScrollContainer", "Separator", "ShaderGlobalsOverride", "Slider",
+        "SpinBox", "SplitContainer", "StatusIndicator", "SubViewport", "SubViewportContainer", "TabBar", "TabContainer", "TextEdit",
+        "TextureButton", "TextureProgressBar", "TextureRect", "Timer", "Tree", "VBoxContainer", "VFlowContainer", "VideoStreamPlayer",
+        "Viewport", "VScrollBar", "VSeparator", "VSlider", "VSplitContainer", "Window", "WorldEnvironment", "XRFaceModifier3D",
+    };
+
+    std::unordered_map<std::string_view, gd::Object::Kind> classes;
+    for (const char* name : NODE_3D)
+        classes.emplace(name, gd::Object::Kind::NODE_3D);
+    for (const char* name : NODE_2D)
+        classes.emplace(name, gd::Object::Kind::NODE_2D);
+    for (const char* name : NODE)
+        classes.emplace(name, gd::Object::Kind::NODE);
+
+    return classes;
+}();
+
+gd::Object::Kind gd::Object::get_kind(std::string_view class_name)
+{
+    auto it = node_classes.find(class_name);
+    return it != node_classes.end() ? it->second : Kind::OBJECT;
+}
+
+gd::Object::Kind gd::Object::get_kind()
+{
+    // The table's name is used in place, the fallback copies it out of a virtual call
+    if (const std::string* name = vtables->find(get_vtable()))
+        return get_kind(*name);
+
+    return get_kind(get_class_name());
+}
+
+gd::Node3D* gd::Node3D::get_parent_3d()
+{
+    if (is_top_level())
+        return nullptr;
+
+    Node* parent = get_parent();
+    return parent && parent->is_node3d() ? parent->as<Node3D>() : nullptr;
+}
+
+Transform3D gd::Node3D::compute_global_transform()
+{
+    std::vector<Node3D*> chain;
+    for (Node3D* it = this; it != nullptr; it = it->get_parent_3d())
+        chain.push_back(it);
+
+    // One node per level, the outermost ancestor first
+    std::vector<std::int32_t> parents(chain.size());
+    for (std::size_t i = 0; i < parents.size(); i++)
+        parents[i] = static_cast<std::int32_t>(i) - 1;
+
+    TransformHierarchy hierarchy;
+    hierarchy.build(parents);
+
+    for (std::size_t i = 0; i < chain.size(); i++)
+        hierarchy.set_local(i, chain[chain.size() - 1 - i]->local_transform());
+
+    hierarchy.update();
+    return hierarchy.get_global(chain.size() - 1);
 }
 
 gd::Node* gd::Node::get_parent()
 {
-    return parent;
+    return parent();
 }
 
 gd::Node* gd::Node::get_owner()
 {
-    return owner;
+    return owner();
 }
 
 std::string gd::Window::get_title()
 {
-    return title.get_string();
+    return title().get_string();
 }
 
 std::string gd::Window::get_displayed_title()
 {
-    return displayed_title.get_string();
+    return displayed_title().get_string();
 }
 
 gd::Window* gd::SceneTree::get_root()
 {
-    return root;
+    return root();
 }
 
 gd::Node* gd::SceneTree::get_current_scene()
 {
-    return current_scene;
+    return current_scene();
 }
 
 gd::SceneTree* gd::SceneTree::get_singleton()
@@ -135,23 +450,27 @@ gd::SceneTree* gd::SceneTree::get_singleton()
      * OFFSET is the offset to the singleton pointer
     */
 
-#ifdef GODOT_VERSION_4_4
-    static std::uint8_t* addr = mem->resolve_rel_addr(mem->find_pattern("48 39 1D ? ? ? ? 0F 84 ? ? ? ? 48 8B 8B ? ? ? ? 48 85 C9 0F 84"), 0x3, 0x7);
-#elif defined GODOT_VERSION_4_3
-    static std::uint8_t* addr = mem->resolve_rel_addr(mem->find_pattern("48 8B 05 ? ? ? ? 48 85 C0 74 ? 80 B8"), 0x3, 0x7);
-#endif
-    return *(SceneTree**)(addr);
+    static std::uint8_t* addr = []()
+    {
+        if (std::uint8_t* site = mem->find_pattern(gd::layout->scene_tree_pattern))
+            return mem->resolve_rel_addr(site, gd::layout->scene_tree_rva_offset, gd::layout->scene_tree_rip_offset);
+
+        // Same global, found through the constructor's "debug/shapes/collision/shape_color" literal
+        return resolve_anchored("SceneTree::singleton");
+    }();
+
+    return addr ? *(SceneTree**)(addr) : nullptr;
 }
 
 Projection gd::Camera3D::get_camera_projection()
 {
-    if (mode != PROJECTION_PERSPECTIVE)
+    if (mode() != PROJECTION_PERSPECTIVE)
         return Projection{ };
     
     Vector2 viewport_size = { 1920.f, 1080.f };
     
     Projection cm;
-    cm.set_perspective(fov, viewport_size.x / viewport_size.y, _near, _far, keep_aspect == KEEP_WIDTH);
+    cm.set_perspective(fov(), viewport_size.x / viewport_size.y, _near(), _far(), keep_aspect() == KEEP_WIDTH);
     
     return cm;
 }
@@ -180,25 +499,25 @@ bool gd::Camera3D::world_to_screen(const Vector3& world, Vector2& screen)
 
 bool gd::Camera3D::is_position_behind(const Vector3& world) const
 {
-    Vector3 eyedir = -global_transform.basis.get_column(2).normalized();
-    return eyedir.dot(world - global_transform.origin) < _near;
+    Vector3 eyedir = -global_transform().basis.get_column(2).normalized();
+    return eyedir.dot(world - global_transform().origin) < _near();
 }
 
 void gd::Camera3D::look_at(const Vector3& world)
 {
-    global_transform.set_look_at(global_transform.origin, world);
+    global_transform().set_look_at(global_transform().origin, world);
 }
 
 Transform3D gd::Camera3D::get_camera_transform()
 {
-    Transform3D tr = global_transform.orthonormalized();
-    tr.origin += tr.basis.get_column(1) * v_offset;
-    tr.origin += tr.basis.get_column(0) * h_offset;
+    Transform3D tr = global_transform().orthonormalized();
+    tr.origin += tr.basis.get_column(1) * v_offset();
+    tr.origin += tr.basis.get_column(0) * h_offset();
 
     return tr;
 }
 
 gd::Camera3D* gd::Viewport::get_camera_3d()
 {
-    return camera_3d;
+    return camera_3d();
 }
\ No newline at end of file
@@ -1,10 +1,22 @@
 #pragma once
 #include "sdk.h"
 #include "memory.h"
+#include "layout.h"
 #include <string>
+#include <xmmintrin.h>
+
+/*
+ * Declares an accessor for an engine field whose offset comes from the active gd::layout
+ * The offset is a plain load from the layout table, there's no per-version branching on access
+*/
+#define GODOT_FIELD(TYPE, NAME, OFFSET) \
+    __forceinline TYPE& NAME() { return *reinterpret_cast<TYPE*>(reinterpret_cast<std::uint8_t*>(this) + gd::layout->OFFSET); } \
+    __forceinline TYPE const& NAME() const { return *reinterpret_cast<TYPE const*>(reinterpret_cast<const std::uint8_t*>(this) + gd::layout->OFFSET); }
 
 namespace gd
 {
+    class Node;
+
     class String
     {
         GODOT_CLASS(String)
@@ -20,10 +32,8 @@ namespace gd
         GODOT_CLASS(StringName);
 
         struct _Data {
-            std::uint32_t refcount;
-            std::uint32_t static_count;
-            const char* cname; // This field got removed in Godot 4.5
-            String name;
+            // refcount, static_count and (before Godot 4.5) cname come first
+            GODOT_FIELD(String, name, string_name_data_name)
         };
 
         _Data* ptr;
@@ -35,14 +45,7 @@ namespace gd
     {
         GODOT_CLASS(Object);
 
-        PAD(0x5C); // TODO: Check if this is the correct offset
-        std::uint32_t ancestry; // Bitfield to check if the node inherits a base class
-
-#ifdef GODOT_VERSION_4_4
-        PAD(0xC8);
-#elif defined GODOT_VERSION_4_3
-        PAD(0xB8);
-#endif
+        GODOT_FIELD(std::uint32_t, ancestry, object_ancestry) // Bitfield to check if the node inherits a base class
 
     public:
         enum class AncestralClass : std::uint32_t
@@ -66,28 +69,89 @@ namespace gd
             MESH_INSTANCE_3D = 1 << 14,
         };
 
+        // Which node base an engine class derives from, OBJECT for everything that isn't a Node
+        enum class Kind : std::uint8_t
+        {
+            OBJECT,
+            NODE,
+            NODE_2D,
+            NODE_3D,
+        };
+
     public:
+        static constexpr std::size_t CLASS_NAME_INDEX = 10; // Object::get_class in the vtable
+
         bool inherits_from(AncestralClass ancestral_class);
+        std::string get_class_name();
+
+        // The class the vtable table names for this object, looked up in a list of the engine's node classes
+        // Unlike inherits_from nothing but the vtable pointer is read from the object
+        Kind get_kind();
+        bool is_node() { return get_kind() != Kind::OBJECT; }
+        bool is_node2d() { return get_kind() == Kind::NODE_2D; }
+        bool is_node3d() { return get_kind() == Kind::NODE_3D; }
+
+        static Kind get_kind(std::string_view class_name);
+
+        // Floats the capture code copies out of a node of that kind: a Node3D's global transform or a Node2D's position
+        static constexpr std::uint8_t get_dims(Kind kind) { return kind == Kind::NODE_3D ? 12 : kind == Kind::NODE_2D ? 2 : 0; }
+
+        __forceinline void* get_vtable() const
+        {
+            return *reinterpret_cast<void* const*>(this);
+        }
 
     public:
         template <typename T = Node>
         T* as();
     };
 
+    class ObjectDB
+    {
+        GODOT_CLASS(ObjectDB);
+
+    public:
+        static constexpr std::uint32_t VALIDATOR_BITS = 39;
+        static constexpr std::uint32_t SLOT_MAX_COUNT_BITS = 24;
+        static constexpr std::uint64_t REFERENCE_BIT = 1ull << (SLOT_MAX_COUNT_BITS + VALIDATOR_BITS);
+
+        struct ObjectSlot
+        {
+            std::uint64_t validator : VALIDATOR_BITS; // Never 0 while the slot is in use
+            std::uint64_t next_free : SLOT_MAX_COUNT_BITS;
+            std::uint64_t is_ref_counted : 1;
+            Object* object;
+        };
+
+    public:
+        static ObjectSlot* get_slots();
+        static std::uint32_t get_slot_max();
+
+        // Rejects free slots and slots whose object doesn't point at a vtable inside the game's image
+        static bool is_valid_slot(const ObjectSlot& slot);
+        static std::uint64_t get_instance_id(const ObjectSlot& slot, std::uint32_t index);
+
+        // Same checks as ObjectDB::get_instance, nullptr if the object was freed
+        static Object* get_instance(std::uint64_t instance_id);
+        // Reverse lookup with a pass over the slot array, 0 if the object isn't in it
+        static std::uint64_t find_instance_id(const Object* object);
+
+        // Visits every live object with one sequential pass over the slot array
+        template <typename F>
+        static void for_each(F&& visit);
+    };
+
     class SceneTree;
     class Node : public Object
     {
         GODOT_CLASS(Node);
 
-        String scene_file_path; // Only available if the Node is the current loaded scene
-        PAD(0x10);
-        Node* parent;
-        Node* owner;
-        PAD(0x38);
-        LocalVector<Node*> children_cache;
-        PAD(0x50);
-        StringName name;
-        SceneTree* tree;
+        GODOT_FIELD(String, scene_file_path, node_scene_file_path) // Only available if the Node is the current loaded scene
+        GODOT_FIELD(Node*, parent, node_parent)
+        GODOT_FIELD(Node*, owner, node_owner)
+        GODOT_FIELD(LocalVector<Node*>, children_cache, node_children_cache)
+        GODOT_FIELD(StringName, name, node_name)
+        GODOT_FIELD(SceneTree*, tree, node_tree)
 
     public:
         Node* find_child(std::string_view path);
@@ -98,7 +162,6 @@ namespace gd
     public:
         std::string get_scene_file_path();
         std::string get_name();
-        std::string get_class_name();
 
         Node* get_parent();
         Node* get_owner();
@@ -113,29 +176,28 @@ namespace gd
     {
         GODOT_CLASS(Node2D);
 
-#ifdef GODOT_VERSION_4_4
-        PAD(0x2FC);
-#elif defined GODOT_VERSION_4_3
-        PAD(0x29C);
-#endif
-
     public:
-        Vector2 position;
+        GODOT_FIELD(Vector2, position, node2d_position)
     };
 
     class Node3D : public Node
     {
         GODOT_CLASS(Node3D);
 
-#if GODOT_VERSION_4_4
-        PAD(0x1F8);
-#elif defined GODOT_VERSION_4_3
-        PAD(0x1D8);
-#endif
+    public:
+        GODOT_FIELD(Transform3D, global_transform, node3d_global_transform) // Actual position inside the world
+        GODOT_FIELD(Transform3D, local_transform, node3d_local_transform)
+        GODOT_FIELD(std::uint8_t, top_level_flags, node3d_top_level) // Node3D::Data's bitfield, top_level comes first
 
     public:
-        Transform3D global_transform; // Actual position inside the world
-        Transform3D local_transform;
+        // A top level node ignores its parent's transform
+        bool is_top_level() const { return top_level_flags() & 1; }
+
+        // Parent the transform is relative to: the direct parent if it's a Node3D and this node isn't top level, else nullptr
+        Node3D* get_parent_3d();
+
+        // The engine's global_transform is only refreshed on its own frame, this one is the product of the local chain
+        Transform3D compute_global_transform();
     };
 
     class Camera3D;
@@ -143,12 +205,7 @@ namespace gd
     {
         GODOT_CLASS(Viewport);
 
-#ifdef GODOT_VERSION_4_4
-        PAD(0x6F8);
-#elif defined GODOT_VERSION_4_3
-        PAD(0x6E8);
-#endif
-        Camera3D* camera_3d;
+        GODOT_FIELD(Camera3D*, camera_3d, viewport_camera_3d)
 
     public:
         Camera3D* get_camera_3d();
@@ -158,8 +215,6 @@ namespace gd
     {
         GODOT_CLASS(Camera3D);
 
-        PAD(0x6E);
-
     public:
         enum ProjectionType
         {
@@ -175,25 +230,25 @@ namespace gd
         };
 
     public:
-        bool force_change;
-        bool current;
+        GODOT_FIELD(bool, force_change, camera3d_force_change)
+        GODOT_FIELD(bool, current, camera3d_current)
 
-        Viewport* viewport;
+        GODOT_FIELD(Viewport*, viewport, camera3d_viewport)
 
-        ProjectionType mode;
+        GODOT_FIELD(ProjectionType, mode, camera3d_mode)
 
-        float fov;
-        float size;
+        GODOT_FIELD(float, fov, camera3d_fov)
+        GODOT_FIELD(float, size, camera3d_size)
 
-        Vector2 frustum_offset;
+        GODOT_FIELD(Vector2, frustum_offset, camera3d_frustum_offset)
 
-        float _near;
-        float _far;
+        GODOT_FIELD(float, _near, camera3d_near)
+        GODOT_FIELD(float, _far, camera3d_far)
 
-        float v_offset;
-        float h_offset;
+        GODOT_FIELD(float, v_offset, camera3d_v_offset)
+        GODOT_FIELD(float, h_offset, camera3d_h_offset)
 
-        KeepAspect keep_aspect;
+        GODOT_FIELD(KeepAspect, keep_aspect, camera3d_keep_aspect)
 
     public:
         bool world_to_screen(const Vector3& world, Vector2& screen);
@@ -210,13 +265,8 @@ namespace gd
     {
         GODOT_CLASS(Window);
 
-#ifdef GODOT_VERSION_4_4
-        PAD(0x40);
-#elif defined GODOT_VERSION_4_3
-        PAD(0x48);
-#endif
-        String title; // The game's name
-        String displayed_title; // The name displayed as the window's title
+        GODOT_FIELD(String, title, window_title) // The game's name
+        GODOT_FIELD(String, displayed_title, window_displayed_title) // The name displayed as the window's title
 
     public:
         std::string get_title();
@@ -227,14 +277,8 @@ namespace gd
     {
         GODOT_CLASS(SceneTree);
 
-#ifdef GODOT_VERSION_4_4
-        PAD(0x318);
-#elif defined GODOT_VERSION_4_3
-        PAD(0x2B8)
-#endif
-        Window* root;
-        PAD(0xE8);
-        Node* current_scene;
+        GODOT_FIELD(Window*, root, scene_tree_root)
+        GODOT_FIELD(Node*, current_scene, scene_tree_current_scene)
 
     public:
         Window* get_root();
@@ -250,6 +294,26 @@ namespace gd
         return reinterpret_cast<T*>(this);
     }
 
+    template <typename F>
+    inline void ObjectDB::for_each(F&& visit)
+    {
+        ObjectSlot* slots = get_slots();
+        std::uint32_t slot_max = get_slot_max();
+
+        if (!slots)
+            return;
+
+        for (std::uint32_t i = 0; i < slot_max; i++)
+        {
+            // The vtable read in is_valid_slot is the only cache miss, start it a few slots early
+            if (i + 8 < slot_max && slots[i + 8].object)
+                _mm_prefetch(reinterpret_cast<const char*>(slots[i + 8].object), _MM_HINT_T0);
+
+            if (is_valid_slot(slots[i]))
+                visit(slots[i].object, get_instance_id(slots[i], i));
+        }
+    }
+
     template <typename T>
     inline T* Node::find_child(std::string_view path)
     {
@@ -259,6 +323,6 @@ namespace gd
     template <typename T>
     inline LocalVector<T*>& Node::get_children()
     {
-        return reinterpret_cast<LocalVector<T*>>(children_cache);
+        return reinterpret_cast<LocalVector<T*>&>(children_cache());
     }
 }
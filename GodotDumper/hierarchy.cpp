@@ -0,0 +1,162 @@
+#include "compiler.h"
+SDK_FP_CONTRACT_OFF
+#include "hierarchy.h"
+#include <xmmintrin.h>
+#include <algorithm>
+
+static constexpr float IDENTITY[12] = {
+    1.f, 0.f, 0.f,
+    0.f, 1.f, 0.f,
+    0.f, 0.f, 1.f,
+    0.f, 0.f, 0.f
+};
+
+bool TransformHierarchy::build(const std::vector<std::int32_t>& parents)
+{
+    const std::size_t count = parents.size();
+
+    std::vector<std::uint32_t> depth(count);
+    std::uint32_t max_depth = 0;
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (parents[i] >= static_cast<std::int32_t>(i) || parents[i] < -1)
+            return false;
+
+        depth[i] = parents[i] < 0 ? 0 : depth[parents[i]] + 1;
+        max_depth = std::max(max_depth, depth[i]);
+    }
+
+    std::vector<std::uint32_t> level_size(count ? max_depth + 1 : 0, 0);
+    for (std::size_t i = 0; i < count; i++)
+        level_size[depth[i]]++;
+
+    // Group 0 holds the world slot, every level starts on a 4 slot boundary
+    std::vector<std::uint32_t> level_cursor(level_size.size());
+    std::uint32_t slot_count = 4;
+
+    for (std::size_t d = 0; d < level_size.size(); d++)
+    {
+        level_cursor[d] = slot_count;
+        slot_count += (level_size[d] + 3) & ~3u;
+    }
+
+    slot_of.assign(count, 0);
+    for (std::size_t i = 0; i < count; i++)
+        slot_of[i] = level_cursor[depth[i]]++;
+
+    parent_slot.assign(slot_count, 0);
+    for (std::size_t i = 0; i < count; i++)
+        parent_slot[slot_of[i]] = parents[i] < 0 ? 0 : slot_of[parents[i]];
+
+    for (int c = 0; c < COMPONENTS; c++)
+    {
+        local[c].assign(slot_count, IDENTITY[c]);
+        global[c].assign(slot_count, IDENTITY[c]);
+    }
+
+    dirty.assign(slot_count, 1);
+    std::fill(dirty.begin(), dirty.begin() + 4, 0);
+
+    return true;
+}
+
+void TransformHierarchy::set_local(std::size_t index, const Transform3D& transform)
+{
+    std::uint32_t slot = slot_of[index];
+
+    store(slot, transform, local);
+    dirty[slot] = 1;
+}
+
+Transform3D TransformHierarchy::get_local(std::size_t index) const
+{
+    return load(slot_of[index], local);
+}
+
+Transform3D TransformHierarchy::get_global(std::size_t index) const
+{
+    return load(slot_of[index], global);
+}
+
+void TransformHierarchy::update()
+{
+    // Slots are sorted by depth, so a parent's flag is always final before its children read it
+    for (std::size_t first = 4; first < dirty.size(); first += 4)
+    {
+        std::uint8_t any = 0;
+        for (std::size_t s = first; s < first + 4; s++)
+        {
+            dirty[s] |= dirty[parent_slot[s]];
+            any |= dirty[s];
+        }
+
+        if (any)
+            compute_group(first);
+    }
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+}
+
+void TransformHierarchy::compute_group(std::size_t first)
+{
+    const std::uint32_t* ps = &parent_slot[first];
+
+    __m128 p[COMPONENTS];
+    __m128 l[COMPONENTS];
+
+    for (int c = 0; c < COMPONENTS; c++)
+    {
+        const float* g = global[c].data();
+
+        p[c] = _mm_set_ps(g[ps[3]], g[ps[2]], g[ps[1]], g[ps[0]]);
+        l[c] = _mm_loadu_ps(&local[c][first]);
+    }
+
+    // global = parent_global * local, same operation order as Transform3D::operator*
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            __m128 r = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(p[i * 3 + 0], l[0 + j]), _mm_mul_ps(p[i * 3 + 1], l[3 + j])),
+                _mm_mul_ps(p[i * 3 + 2], l[6 + j]));
+
+            _mm_storeu_ps(&global[i * 3 + j][first], r);
+        }
+
+        __m128 o = _mm_add_ps(
+            _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(p[i * 3 + 0], l[9]), _mm_mul_ps(p[i * 3 + 1], l[10])),
+                _mm_mul_ps(p[i * 3 + 2], l[11])),
+            p[9 + i]);
+
+        _mm_storeu_ps(&global[9 + i][first], o);
+    }
+}
+
+void TransformHierarchy::store(std::uint32_t slot, const Transform3D& transform, std::vector<float>* components)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        components[i * 3 + 0][slot] = transform.basis.rows[i].x;
+        components[i * 3 + 1][slot] = transform.basis.rows[i].y;
+        components[i * 3 + 2][slot] = transform.basis.rows[i].z;
+    }
+
+    components[9][slot] = transform.origin.x;
+    components[10][slot] = transform.origin.y;
+    components[11][slot] = transform.origin.z;
+}
+
+Transform3D TransformHierarchy::load(std::uint32_t slot, const std::vector<float>* components) const
+{
+    Transform3D transform;
+
+    for (int i = 0; i < 3; i++)
+        transform.basis.rows[i] = Vector3(components[i * 3 + 0][slot], components[i * 3 + 1][slot], components[i * 3 + 2][slot]);
+
+    transform.origin = Vector3(components[9][slot], components[10][slot], components[11][slot]);
+
+    return transform;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "sdk.h"
+#include <vector>
+#include <cstdint>
+
+/*
+ * Recomputes global transforms from local ones for a whole flattened hierarchy
+ *
+ * The input is a parent-index array in topological order (parents[i] < i, -1 for roots)
+ * Internally the nodes are regrouped by depth and every level is padded to 4 slots,
+ * so each group of 4 nodes only depends on already computed parents and can be multiplied with SSE
+ * Slot 0 is the identity "world" every root is parented to, this keeps the inner loop branchless
+*/
+class TransformHierarchy
+{
+public:
+    bool build(const std::vector<std::int32_t>& parents);
+
+    void set_local(std::size_t index, const Transform3D& local);
+    Transform3D get_local(std::size_t index) const;
+    Transform3D get_global(std::size_t index) const;
+
+    // Recomputes only the dirty nodes and their descendants
+    void update();
+
+    __forceinline std::size_t size() const
+    {
+        return slot_of.size();
+    }
+
+private:
+    void compute_group(std::size_t first);
+
+    void store(std::uint32_t slot, const Transform3D& transform, std::vector<float>* components);
+    Transform3D load(std::uint32_t slot, const std::vector<float>* components) const;
+
+private:
+    static constexpr int COMPONENTS = 12; // 9 basis floats (row major) + 3 origin floats
+
+    std::vector<float> local[COMPONENTS];
+    std::vector<float> global[COMPONENTS];
+
+    std::vector<std::uint32_t> parent_slot;
+    std::vector<std::uint8_t> dirty;
+
+    std::vector<std::uint32_t> slot_of; // External index -> slot
+};
@@ -0,0 +1,404 @@
+#include "hook.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr std::uint64_t RANGE = 0x7FF00000; // What a rel32 reaches, a bit less so the far end of a block still does
+    constexpr std::size_t BLOCK_SIZE = 0x10000; // Allocation granularity on Windows
+    constexpr std::size_t SLOT_SIZE = 128; // Relay + trampoline, a loop rel8 grows from 2 to 9 bytes
+    constexpr std::size_t RELAY_SIZE = 16;
+    constexpr std::size_t SCAN_SIZE = 512;
+    constexpr std::uintptr_t PAGE_SIZE = 0x1000;
+
+    bool fits_rel32(std::int64_t value)
+    {
+        return value >= std::numeric_limits<std::int32_t>::min() && value <= std::numeric_limits<std::int32_t>::max();
+    }
+
+    void put_rel32(std::vector<std::uint8_t>& out, std::int64_t value)
+    {
+        const std::int32_t rel = static_cast<std::int32_t>(value);
+        const std::size_t at = out.size();
+        out.resize(at + sizeof(rel));
+        std::memcpy(out.data() + at, &rel, sizeof(rel));
+    }
+
+    // Ends the function: nothing after it is guaranteed to belong to the same one
+    bool is_terminal(const x86::instruction_t& ins)
+    {
+        if (ins.map != x86::MAP_PRIMARY)
+            return false;
+
+        if (ins.is_return() || ins.is_jump() || ins.opcode == 0xCC)
+            return true;
+
+        // jmp r/m
+        return ins.opcode == 0xFF && ins.has_modrm && (ins.reg() == 4 || ins.reg() == 5);
+    }
+
+    void flush_code(void* address, std::size_t size)
+    {
+#ifdef _WIN32
+        FlushInstructionCache(GetCurrentProcess(), address, size);
+#else
+        __builtin___clear_cache(static_cast<char*>(address), static_cast<char*>(address) + size);
+#endif
+    }
+
+    // Relay and trampoline slots, taken from blocks near their targets, a removed hook's slot is never handed out again
+    class slot_pool_t {
+    public:
+        std::uint8_t* take(const void* target)
+        {
+            std::lock_guard lock(mutex);
+
+            const std::uintptr_t origin = reinterpret_cast<std::uintptr_t>(target);
+            for (std::size_t i = 0; i < free_slots.size(); i++)
+            {
+                const std::uintptr_t slot = reinterpret_cast<std::uintptr_t>(free_slots[i]);
+                if ((slot > origin ? slot - origin : origin - slot) < RANGE)
+                {
+                    std::uint8_t* found = free_slots[i];
+                    free_slots.erase(free_slots.begin() + i);
+                    return found;
+                }
+            }
+
+            std::uint8_t* block = hook::allocate_near(target, BLOCK_SIZE);
+            if (!block)
+                return nullptr;
+
+            for (std::size_t offset = BLOCK_SIZE; offset > SLOT_SIZE; offset -= SLOT_SIZE)
+                free_slots.push_back(block + offset - SLOT_SIZE);
+
+            return block;
+        }
+
+        // For a slot that never got a hook
+        void give_back(std::uint8_t* slot)
+        {
+            std::lock_guard lock(mutex);
+            free_slots.push_back(slot);
+        }
+
+    private:
+        std::mutex mutex;
+        std::vector<std::uint8_t*> free_slots;
+    };
+
+    slot_pool_t slots;
+}
+
+std::size_t hook::relocate(const std::uint8_t* code, std::size_t available, std::size_t size, std::uint64_t source, std::uint64_t destination, std::vector<std::uint8_t>& out)
+{
+    out.clear();
+
+    struct entry_t {
+        x86::instruction_t ins;
+        std::size_t offset;
+    };
+
+    entry_t entries[MAX_STOLEN];
+    std::size_t count = 0;
+    std::size_t taken = 0;
+
+    while (taken < size)
+    {
+        entry_t& entry = entries[count++];
+        entry.offset = taken;
+
+        if (!x86::decode(code + taken, available - taken, entry.ins))
+            return 0;
+
+        taken += entry.ins.length;
+
+        // A jmp or ret that doesn't cover the patch, the bytes after it are another function's or padding
+        if (taken < size && is_terminal(entry.ins))
+            return 0;
+    }
+
+    // A loop back to the prologue from the code that stays would land in the middle of the jmp, the rest of code up to
+    // padding is searched for one
+    for (std::size_t offset = taken; offset < available;)
+    {
+        x86::instruction_t ins;
+        if (code[offset] == 0xCC || !x86::decode(code + offset, available - offset, ins))
+            break;
+
+        if (ins.relative && ins.target(source + offset, code + offset) - source - 1 < taken - 1)
+            return 0;
+
+        offset += ins.length;
+    }
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const x86::instruction_t& ins = entries[i].ins;
+        const std::uint8_t* bytes = code + entries[i].offset;
+        const std::uint64_t address = source + entries[i].offset;
+
+        if (!ins.rip_relative && !ins.relative)
+        {
+            out.insert(out.end(), bytes, bytes + ins.length);
+            continue;
+        }
+
+        const std::uint64_t target = ins.target(address, bytes);
+
+        // Into the bytes the jmp replaces, there's nothing left to land on
+        if (target - source < taken)
+            return 0;
+
+        if (ins.rip_relative)
+        {
+            const std::size_t at = out.size();
+            out.insert(out.end(), bytes, bytes + ins.length);
+
+            const std::int64_t disp = static_cast<std::int64_t>(target - (destination + at + ins.length));
+            if (!fits_rel32(disp))
+                return 0;
+
+            const std::int32_t disp32 = static_cast<std::int32_t>(disp);
+            std::memcpy(out.data() + at + ins.disp_offset, &disp32, sizeof(disp32));
+            continue;
+        }
+
+        // The branches below end with their rel32, the displacement is from the end of what's emitted
+        const auto emit_rel32 = [&]()
+        {
+            const std::int64_t rel = static_cast<std::int64_t>(target - (destination + out.size() + sizeof(std::int32_t)));
+            if (!fits_rel32(rel))
+                return false;
+
+            put_rel32(out, rel);
+            return true;
+        };
+
+        if (ins.map == x86::MAP_PRIMARY && ins.opcode >= 0xE0 && ins.opcode <= 0xE3)
+        {
+            // loop / jrcxz only have a rel8: taken goes over a short jmp to a jmp rel32
+            out.insert(out.end(), bytes, bytes + ins.imm_offset);
+            out.insert(out.end(), { 0x02, 0xEB, 0x05, 0xE9 });
+        }
+        else if (ins.is_call())
+        {
+            out.push_back(0xE8);
+        }
+        else if (ins.is_jump())
+        {
+            out.push_back(0xE9);
+        }
+        else if (ins.map == x86::MAP_PRIMARY && ins.opcode >= 0x70 && ins.opcode <= 0x7F)
+        {
+            out.insert(out.end(), { 0x0F, static_cast<std::uint8_t>(0x80 | (ins.opcode & 0x0F)) });
+        }
+        else if (ins.imm_size == 4 && ins.imm_offset + 4 == ins.length)
+        {
+            // jcc rel32, xbegin: only the displacement changes
+            out.insert(out.end(), bytes, bytes + ins.imm_offset);
+        }
+        else
+        {
+            return 0;
+        }
+
+        if (!emit_rel32())
+            return 0;
+    }
+
+    // Back to the first instruction that stayed
+    out.push_back(0xE9);
+    const std::int64_t back = static_cast<std::int64_t>(source + taken - (destination + out.size() + sizeof(std::int32_t)));
+    if (!fits_rel32(back))
+        return 0;
+
+    put_rel32(out, back);
+    return taken;
+}
+
+std::uint8_t* hook::allocate_near(const void* where, std::size_t size)
+{
+    const std::uintptr_t origin = reinterpret_cast<std::uintptr_t>(where) & ~(BLOCK_SIZE - 1);
+
+    const auto try_at = [size](std::uintptr_t address) -> std::uint8_t*
+    {
+        void* hint = reinterpret_cast<void*>(address);
+
+#ifdef _WIN32
+        MEMORY_BASIC_INFORMATION info;
+        if (!VirtualQuery(hint, &info, sizeof(info)) || info.State != MEM_FREE || info.RegionSize < size)
+            return nullptr;
+
+        return static_cast<std::uint8_t*>(VirtualAlloc(hint, size, MEM_RESERVE | MEM_COMMIT, PAGE_EXECUTE_READWRITE));
+#else
+        void* block = mmap(hint, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if (block == MAP_FAILED)
+            return nullptr;
+
+        // Kernels before 4.17 take the flag as a hint
+        if (block == hint)
+            return static_cast<std::uint8_t*>(block);
+
+        munmap(block, size);
+        return nullptr;
+#endif
+    };
+
+    // Closest free block first, alternating below and above
+    for (std::uintptr_t distance = BLOCK_SIZE; distance + size < RANGE; distance += BLOCK_SIZE)
+    {
+        if (distance < origin)
+        {
+            if (std::uint8_t* block = try_at(origin - distance))
+                return block;
+        }
+
+        if (std::uint8_t* block = try_at(origin + distance))
+            return block;
+    }
+
+    return nullptr;
+}
+
+bool hook::write_code(std::uint8_t* address, const std::uint8_t* bytes, std::size_t size)
+{
+    if (!size || size > MAX_STOLEN)
+        return false;
+
+    const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(address);
+
+    // The jmp-to-self is one 2 byte store, it has to stay inside a cache line
+    const bool single = (begin & 7) + size <= 8;
+    if (!single && (begin & 63) == 63)
+        return false;
+
+#ifdef _WIN32
+    DWORD protection;
+    if (!VirtualProtect(address, size, PAGE_EXECUTE_READWRITE, &protection))
+        return false;
+#else
+    const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const std::uintptr_t first = begin & ~(page - 1);
+    const std::size_t length = (begin + size - first + page - 1) & ~(page - 1);
+
+    if (mprotect(reinterpret_cast<void*>(first), length, PROT_READ | PROT_WRITE | PROT_EXEC))
+        return false;
+#endif
+
+    if (single)
+    {
+        // Everything lands in one aligned qword, one store and no thread sees half of it
+        std::uint64_t* qword = reinterpret_cast<std::uint64_t*>(begin & ~std::uintptr_t(7));
+        std::atomic_ref<std::uint64_t> target(*qword);
+
+        std::uint64_t value = target.load();
+        std::memcpy(reinterpret_cast<std::uint8_t*>(&value) + (begin & 7), bytes, size);
+        target.store(value);
+    }
+    else
+    {
+        const auto store_head = [address](const std::uint8_t* head)
+        {
+            std::uint16_t value;
+            std::memcpy(&value, head, sizeof(value));
+            *reinterpret_cast<volatile std::uint16_t*>(address) = value;
+        };
+
+        static constexpr std::uint8_t jmp_self[] = { 0xEB, 0xFE };
+
+        store_head(jmp_self);
+        flush_code(address, 2);
+
+        std::memcpy(address + 2, bytes + 2, size - 2);
+        flush_code(address, size);
+
+        store_head(bytes);
+    }
+
+    flush_code(address, size);
+
+#ifdef _WIN32
+    VirtualProtect(address, size, protection, &protection);
+#else
+    mprotect(reinterpret_cast<void*>(first), length, PROT_READ | PROT_EXEC);
+#endif
+
+    return true;
+}
+
+bool inline_hook_t::install(void* target_function, void* detour)
+{
+    if (installed || !target_function || !detour)
+        return false;
+
+    std::uint8_t* function = static_cast<std::uint8_t*>(target_function);
+
+    std::uint8_t* slot = slots.take(function);
+    if (!slot)
+        return false;
+
+    // Whatever follows on the same page is decoded too, looking for branches back into the stolen bytes
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(function);
+    const std::size_t available = std::max<std::size_t>(hook::MAX_STOLEN, std::min<std::size_t>(SCAN_SIZE, PAGE_SIZE - address % PAGE_SIZE));
+
+    std::vector<std::uint8_t> code;
+    const std::size_t stolen = hook::relocate(function, available, hook::JMP_SIZE, reinterpret_cast<std::uintptr_t>(function),
+        reinterpret_cast<std::uintptr_t>(slot + RELAY_SIZE), code);
+
+    if (!stolen || code.size() > SLOT_SIZE - RELAY_SIZE)
+    {
+        slots.give_back(slot);
+        return false;
+    }
+
+    // Relay: jmp [rip + 0] followed by the detour's address
+    static constexpr std::uint8_t jmp_absolute[] = { 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00 };
+    const std::uint64_t detour_address = reinterpret_cast<std::uintptr_t>(detour);
+
+    std::memcpy(slot, jmp_absolute, sizeof(jmp_absolute));
+    std::memcpy(slot + sizeof(jmp_absolute), &detour_address, sizeof(detour_address));
+    std::memcpy(slot + RELAY_SIZE, code.data(), code.size());
+    flush_code(slot, SLOT_SIZE);
+
+    std::uint8_t patch[hook::JMP_SIZE] = { 0xE9 };
+    const std::int32_t rel = static_cast<std::int32_t>(reinterpret_cast<std::intptr_t>(slot) - reinterpret_cast<std::intptr_t>(function + hook::JMP_SIZE));
+    std::memcpy(patch + 1, &rel, sizeof(rel));
+
+    std::memcpy(original, function, sizeof(original));
+
+    if (!hook::write_code(function, patch, sizeof(patch)))
+    {
+        slots.give_back(slot);
+        return false;
+    }
+
+    target = function;
+    trampoline = slot + RELAY_SIZE;
+    stolen_size = stolen;
+    installed = true;
+
+    return true;
+}
+
+bool inline_hook_t::remove()
+{
+    if (!installed)
+        return false;
+
+    if (!hook::write_code(target, original, sizeof(original)))
+        return false;
+
+    installed = false;
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "x86.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * x86-64 inline hooks
+ *
+ * The first whole instructions of the target (at least 5 bytes) move to a trampoline and a jmp rel32 to a relay takes
+ * their place, the relay jumps to the detour through an absolute address and the trampoline runs the moved instructions
+ * then jumps back after them, so calling the trampoline calls the original function
+ *
+ * Moved instructions are re-encoded for their new address: rip relative operands get a new disp32, rel8 branches are
+ * widened to rel32 (loop / jrcxz through a jmp rel32 they skip over), a branch back into the moved bytes (from them or from
+ * the code following them on the same page) is refused
+ * Trampolines live in pages allocated within 2 GB of their target so every rel32 still reaches
+ *
+ * Patching code another thread may be running goes through a jmp-to-self: the first 2 bytes become "jmp $" in one store,
+ * the tail of the patch is written behind it and the first 2 bytes last, a thread fetching the target meanwhile spins
+ * instead of running half written bytes (unpatching is the same with the original bytes)
+ * Trampoline pages are never freed, a thread can still be inside one after remove
+*/
+namespace hook
+{
+	constexpr std::size_t JMP_SIZE = 5; // jmp rel32
+	constexpr std::size_t MAX_STOLEN = JMP_SIZE + x86::MAX_LENGTH - 1;
+
+	// Copies the whole instructions covering at least size bytes of code (which runs at source) into out, re-encoded to run
+	// at destination, returns the bytes taken from code or 0 if one can't move (invalid, ends the function, branches into them)
+	// The rest of available is only decoded for branches back into the taken bytes, up to the first int3
+	std::size_t relocate(const std::uint8_t* code, std::size_t available, std::size_t size, std::uint64_t source, std::uint64_t destination, std::vector<std::uint8_t>& out);
+
+	// Executable memory within 2 GB of where, nullptr if none could be found
+	std::uint8_t* allocate_near(const void* where, std::size_t size);
+
+	// Overwrites code that may be executing (size <= MAX_STOLEN), through a jmp-to-self when it's more than one store
+	bool write_code(std::uint8_t* address, const std::uint8_t* bytes, std::size_t size);
+}
+
+class inline_hook_t {
+public:
+	inline_hook_t() = default;
+	inline_hook_t(const inline_hook_t&) = delete;
+	inline_hook_t& operator=(const inline_hook_t&) = delete;
+	~inline_hook_t() { remove(); }
+
+	bool install(void* target, void* detour);
+	bool remove();
+
+	bool is_installed() const { return installed; }
+
+	// Calls the original function
+	template <typename F>
+	F get_original() const { return reinterpret_cast<F>(trampoline); }
+
+	std::size_t get_stolen_size() const { return stolen_size; }
+
+private:
+	std::uint8_t* target = nullptr;
+	std::uint8_t* trampoline = nullptr;
+
+	std::uint8_t original[hook::JMP_SIZE] = {};
+	std::size_t stolen_size = 0;
+
+	bool installed = false;
+};
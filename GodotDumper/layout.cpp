@@ -0,0 +1,300 @@
+#include "layout.h"
+#include "memory.h"
+#include <cctype>
+#include <vector>
+
+const gd::layout_t gd::layouts[] = {
+    {
+        .major = 4,
+        .minor = 3,
+
+        .scene_tree_pattern = "48 8B 05 ? ? ? ? 48 85 C0 74 ? 80 B8",
+        .scene_tree_rva_offset = 0x3,
+        .scene_tree_rip_offset = 0x7,
+
+        // TODO: Check if these are the correct signatures
+        .object_slots_pattern = "48 8B 05 ? ? ? ? 48 C1 E1 04",
+        .object_slots_rva_offset = 0x3,
+        .object_slots_rip_offset = 0x7,
+
+        .slot_max_pattern = "25 FF FF FF 00 3B 05 ? ? ? ?",
+        .slot_max_rva_offset = 0x7,
+        .slot_max_rip_offset = 0xB,
+
+        .string_name_data_name = 0x10,
+
+        .object_ancestry = 0x5C, // TODO: Check if this is the correct offset
+
+        .node_scene_file_path = 0x118,
+        .node_parent = 0x130,
+        .node_owner = 0x138,
+        .node_children_cache = 0x178,
+        .node_name = 0x1D8,
+        .node_tree = 0x1E0,
+
+        .node2d_position = 0x484,
+
+        .node3d_global_transform = 0x3C0,
+        .node3d_local_transform = 0x3F0,
+        .node3d_top_level = 0x450, // TODO: Check if this is the correct offset
+
+        .viewport_camera_3d = 0x8D0,
+
+        .camera3d_force_change = 0x48E,
+        .camera3d_current = 0x48F,
+        .camera3d_viewport = 0x490,
+        .camera3d_mode = 0x498,
+        .camera3d_fov = 0x49C,
+        .camera3d_size = 0x4A0,
+        .camera3d_frustum_offset = 0x4A4,
+        .camera3d_near = 0x4AC,
+        .camera3d_far = 0x4B0,
+        .camera3d_v_offset = 0x4B4,
+        .camera3d_h_offset = 0x4B8,
+        .camera3d_keep_aspect = 0x4BC,
+
+        .window_title = 0x920,
+        .window_displayed_title = 0x928,
+
+        .scene_tree_root = 0x2B8,
+        .scene_tree_current_scene = 0x3A8,
+    },
+    {
+        .major = 4,
+        .minor = 4,
+
+        .scene_tree_pattern = "48 39 1D ? ? ? ? 0F 84 ? ? ? ? 48 8B 8B ? ? ? ? 48 85 C9 0F 84",
+        .scene_tree_rva_offset = 0x3,
+        .scene_tree_rip_offset = 0x7,
+
+        // TODO: Check if these are the correct signatures
+        .object_slots_pattern = "48 8B 05 ? ? ? ? 48 C1 E1 04",
+        .object_slots_rva_offset = 0x3,
+        .object_slots_rip_offset = 0x7,
+
+        .slot_max_pattern = "25 FF FF FF 00 3B 05 ? ? ? ?",
+        .slot_max_rva_offset = 0x7,
+        .slot_max_rip_offset = 0xB,
+
+        .string_name_data_name = 0x10,
+
+        .object_ancestry = 0x5C, // TODO: Check if this is the correct offset
+
+        .node_scene_file_path = 0x128,
+        .node_parent = 0x140,
+        .node_owner = 0x148,
+        .node_children_cache = 0x188,
+        .node_name = 0x1E8,
+        .node_tree = 0x1F0,
+
+        .node2d_position = 0x4F4,
+
+        .node3d_global_transform = 0x3F0,
+        .node3d_local_transform = 0x420,
+        .node3d_top_level = 0x480, // TODO: Check if this is the correct offset
+
+        .viewport_camera_3d = 0x8F0,
+
+        .camera3d_force_change = 0x4BE,
+        .camera3d_current = 0x4BF,
+        .camera3d_viewport = 0x4C0,
+        .camera3d_mode = 0x4C8,
+        .camera3d_fov = 0x4CC,
+        .camera3d_size = 0x4D0,
+        .camera3d_frustum_offset = 0x4D4,
+        .camera3d_near = 0x4DC,
+        .camera3d_far = 0x4E0,
+        .camera3d_v_offset = 0x4E4,
+        .camera3d_h_offset = 0x4E8,
+        .camera3d_keep_aspect = 0x4EC,
+
+        .window_title = 0x938,
+        .window_displayed_title = 0x940,
+
+        .scene_tree_root = 0x318,
+        .scene_tree_current_scene = 0x408,
+    },
+    {
+        // StringName::_Data::cname got removed, everything else is still the 4.4 layout
+        // TODO: Check if the other offsets and the signature are still correct
+        .major = 4,
+        .minor = 5,
+
+        .scene_tree_pattern = "48 39 1D ? ? ? ? 0F 84 ? ? ? ? 48 8B 8B ? ? ? ? 48 85 C9 0F 84",
+        .scene_tree_rva_offset = 0x3,
+        .scene_tree_rip_offset = 0x7,
+
+        // TODO: Check if these are the correct signatures
+        .object_slots_pattern = "48 8B 05 ? ? ? ? 48 C1 E1 04",
+        .object_slots_rva_offset = 0x3,
+        .object_slots_rip_offset = 0x7,
+
+        .slot_max_pattern = "25 FF FF FF 00 3B 05 ? ? ? ?",
+        .slot_max_rva_offset = 0x7,
+        .slot_max_rip_offset = 0xB,
+
+        .string_name_data_name = 0x8,
+
+        .object_ancestry = 0x5C,
+
+        .node_scene_file_path = 0x128,
+        .node_parent = 0x140,
+        .node_owner = 0x148,
+        .node_children_cache = 0x188,
+        .node_name = 0x1E8,
+        .node_tree = 0x1F0,
+
+        .node2d_position = 0x4F4,
+
+        .node3d_global_transform = 0x3F0,
+        .node3d_local_transform = 0x420,
+        .node3d_top_level = 0x480, // TODO: Check if this is the correct offset
+
+        .viewport_camera_3d = 0x8F0,
+
+        .camera3d_force_change = 0x4BE,
+        .camera3d_current = 0x4BF,
+        .camera3d_viewport = 0x4C0,
+        .camera3d_mode = 0x4C8,
+        .camera3d_fov = 0x4CC,
+        .camera3d_size = 0x4D0,
+        .camera3d_frustum_offset = 0x4D4,
+        .camera3d_near = 0x4DC,
+        .camera3d_far = 0x4E0,
+        .camera3d_v_offset = 0x4E4,
+        .camera3d_h_offset = 0x4E8,
+        .camera3d_keep_aspect = 0x4EC,
+
+        .window_title = 0x938,
+        .window_displayed_title = 0x940,
+
+        .scene_tree_root = 0x318,
+        .scene_tree_current_scene = 0x408,
+    },
+};
+
+const std::size_t gd::layout_count = sizeof(gd::layouts) / sizeof(gd::layouts[0]);
+
+static const gd::layout_t* find_layout(int major, int minor)
+{
+    for (std::size_t i = 0; i < gd::layout_count; i++)
+    {
+        if (gd::layouts[i].major == major && gd::layouts[i].minor == minor)
+            return &gd::layouts[i];
+    }
+
+    return nullptr;
+}
+
+static const gd::layout_t* layout_from_version_string()
+{
+    /*
+     * Every build prints a banner like "Godot Engine v4.3.stable.official.77dcf97d8 - https://godotengine.org"
+     * so the literal is always in .rdata
+    */
+    static constexpr char prefix[] = "Godot Engine v";
+
+    const char* str = reinterpret_cast<const char*>(mem->find_string(prefix));
+    if (!str)
+        return nullptr;
+
+    str += sizeof(prefix) - 1;
+
+    int major = 0;
+    while (std::isdigit(static_cast<unsigned char>(*str)))
+        major = major * 10 + (*str++ - '0');
+
+    if (*str++ != '.')
+        return nullptr;
+
+    int minor = 0;
+    while (std::isdigit(static_cast<unsigned char>(*str)))
+        minor = minor * 10 + (*str++ - '0');
+
+    return find_layout(major, minor);
+}
+
+template <typename T>
+static bool read_value(const std::uint8_t* address, T& out)
+{
+    if (!address || !mem->is_readable(address, sizeof(T)))
+        return false;
+
+    out = *reinterpret_cast<const T*>(address);
+    return true;
+}
+
+/*
+ * Layouts can share their signatures (4.5 only removed StringName::_Data::cname, the code around the SceneTree
+ * singleton didn't change), those are told apart by reading the live tree with each candidate's offsets
+ * The root Window is always named "root", only the right layout reaches that String through the StringName
+*/
+static bool names_root(std::uint8_t* site, const gd::layout_t& candidate)
+{
+    const std::uint8_t* tree = nullptr;
+    const std::uint8_t* root = nullptr;
+    const std::uint8_t* name_data = nullptr;
+    const std::uint8_t* chars = nullptr;
+
+    if (!read_value(mem->resolve_rel_addr(site, candidate.scene_tree_rva_offset, candidate.scene_tree_rip_offset), tree) ||
+        !read_value(tree ? tree + candidate.scene_tree_root : nullptr, root) ||
+        !read_value(root ? root + candidate.node_name : nullptr, name_data) ||
+        !read_value(name_data ? name_data + candidate.string_name_data_name : nullptr, chars))
+        return false;
+
+    static constexpr std::uint32_t expected[] = { 'r', 'o', 'o', 't', 0 };
+    for (std::size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        std::uint32_t c = 0;
+        if (!read_value(chars + i * sizeof(std::uint32_t), c) || c != expected[i])
+            return false;
+    }
+
+    return true;
+}
+
+static const gd::layout_t* layout_from_signatures()
+{
+    std::vector<std::uint8_t*> sites(gd::layout_count);
+    std::size_t matched = 0;
+    const gd::layout_t* found = nullptr;
+
+    for (std::size_t i = 0; i < gd::layout_count; i++)
+    {
+        sites[i] = mem->find_pattern(gd::layouts[i].scene_tree_pattern);
+        if (!sites[i])
+            continue;
+
+        matched++;
+        if (!found)
+            found = &gd::layouts[i];
+    }
+
+    if (matched <= 1)
+        return found;
+
+    // Several layouts match, exactly one of them has to read the tree correctly or none is taken
+    const gd::layout_t* named = nullptr;
+
+    for (std::size_t i = 0; i < gd::layout_count; i++)
+    {
+        if (!sites[i] || !names_root(sites[i], gd::layouts[i]))
+            continue;
+
+        if (named)
+            return nullptr;
+
+        named = &gd::layouts[i];
+    }
+
+    return named;
+}
+
+const gd::layout_t* gd::detect_layout()
+{
+    layout = layout_from_version_string();
+    if (!layout)
+        layout = layout_from_signatures();
+
+    return layout;
+}
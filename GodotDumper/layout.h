@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace gd
+{
+    /*
+     * Field offsets of one engine version
+     *
+     * Every gd:: field accessor reads its offset from the active layout, so a single build
+     * supports every version listed in layouts[] (layout.cpp)
+     * To add a version, copy the closest entry and fix the offsets that moved
+    */
+    struct layout_t
+    {
+        int major;
+        int minor;
+
+        // See SceneTree::get_singleton
+        const char* scene_tree_pattern;
+        std::uint32_t scene_tree_rva_offset;
+        std::uint32_t scene_tree_rip_offset;
+
+        // See ObjectDB::get_slots and ObjectDB::get_slot_max
+        const char* object_slots_pattern;
+        std::uint32_t object_slots_rva_offset;
+        std::uint32_t object_slots_rip_offset;
+
+        const char* slot_max_pattern;
+        std::uint32_t slot_max_rva_offset;
+        std::uint32_t slot_max_rip_offset;
+
+        std::uint32_t string_name_data_name;
+
+        std::uint32_t object_ancestry;
+
+        std::uint32_t node_scene_file_path;
+        std::uint32_t node_parent;
+        std::uint32_t node_owner;
+        std::uint32_t node_children_cache;
+        std::uint32_t node_name;
+        std::uint32_t node_tree;
+
+        std::uint32_t node2d_position;
+
+        std::uint32_t node3d_global_transform;
+        std::uint32_t node3d_local_transform;
+        std::uint32_t node3d_top_level; // Bit 0
+
+        std::uint32_t viewport_camera_3d;
+
+        std::uint32_t camera3d_force_change;
+        std::uint32_t camera3d_current;
+        std::uint32_t camera3d_viewport;
+        std::uint32_t camera3d_mode;
+        std::uint32_t camera3d_fov;
+        std::uint32_t camera3d_size;
+        std::uint32_t camera3d_frustum_offset;
+        std::uint32_t camera3d_near;
+        std::uint32_t camera3d_far;
+        std::uint32_t camera3d_v_offset;
+        std::uint32_t camera3d_h_offset;
+        std::uint32_t camera3d_keep_aspect;
+
+        std::uint32_t window_title;
+        std::uint32_t window_displayed_title;
+
+        std::uint32_t scene_tree_root;
+        std::uint32_t scene_tree_current_scene;
+    };
+
+    extern const layout_t layouts[];
+    extern const std::size_t layout_count;
+
+    // Set once by detect_layout before any accessor is used
+    inline const layout_t* layout = nullptr;
+
+    // Reads the engine version from the image ("Godot Engine vX.Y"), falls back to the per-version signatures
+    // Versions sharing a signature are told apart on the live SceneTree, nullptr if that doesn't settle it
+    const layout_t* detect_layout();
+}
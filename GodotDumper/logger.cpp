@@ -0,0 +1,267 @@
+#include "logger.h"
+#include <chrono>
+#include <cinttypes>
+#include <filesystem>
+
+logger_t::~logger_t()
+{
+    stop();
+}
+
+bool logger_t::start(const std::string& path, std::FILE* console)
+{
+    if (running)
+        return true;
+
+    this->path = path;
+    this->console = console;
+
+    file = std::fopen(path.c_str(), "a");
+    if (file)
+    {
+        std::fseek(file, 0, SEEK_END);
+        file_size = static_cast<std::size_t>(std::ftell(file));
+    }
+
+    // Still useful with only the console
+    running = true;
+    thread = std::thread(&logger_t::run, this);
+
+    return file != nullptr;
+}
+
+void logger_t::stop()
+{
+    if (!running.exchange(false))
+        return;
+
+    if (thread.joinable())
+        thread.join();
+
+    if (file)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+logger_t::thread_buffer_t& logger_t::get_thread_buffer()
+{
+    static thread_local thread_buffer_t* buffer = nullptr;
+
+    if (!buffer)
+    {
+        std::lock_guard lock(threads_mutex);
+
+        threads.push_back(std::make_unique<thread_buffer_t>());
+        buffer = threads.back().get();
+    }
+
+    return *buffer;
+}
+
+std::string logger_t::format(const record_t& record) const
+{
+    static constexpr const char* prefixes[] = { "[+] ", "[!] ", "[-] " };
+
+    std::string line = prefixes[record.level];
+    const std::uint8_t* payload = record.payload;
+    std::uint8_t arg = 0;
+
+    char number[32];
+
+    for (const char* it = record.format; *it; it++)
+    {
+        if (it[0] == '}' && it[1] == '}')
+        {
+            line += '}';
+            it++;
+            continue;
+        }
+
+        if (it[0] != '{')
+        {
+            line += *it;
+            continue;
+        }
+
+        if (it[1] == '{')
+        {
+            line += '{';
+            it++;
+            continue;
+        }
+
+        const char* close = std::strchr(it, '}');
+        if (!close)
+        {
+            line += it;
+            break;
+        }
+
+        bool hex = std::string_view(it + 1, close - it - 1) == ":x";
+        it = close;
+
+        if (arg >= record.arg_count)
+        {
+            line += "{?}";
+            continue;
+        }
+
+        switch (record.types[arg++])
+        {
+        case ARG_INT:
+        {
+            std::int64_t value;
+            std::memcpy(&value, payload, sizeof(value));
+            payload += sizeof(value);
+            std::snprintf(number, sizeof(number), hex ? "%" PRIx64 : "%" PRId64, value);
+            line += number;
+            break;
+        }
+        case ARG_UINT:
+        case ARG_POINTER:
+        {
+            std::uint64_t value;
+            std::memcpy(&value, payload, sizeof(value));
+            payload += sizeof(value);
+            std::snprintf(number, sizeof(number), hex || record.types[arg - 1] == ARG_POINTER ? "%" PRIx64 : "%" PRIu64, value);
+            line += number;
+            break;
+        }
+        case ARG_DOUBLE:
+        {
+            double value;
+            std::memcpy(&value, payload, sizeof(value));
+            payload += sizeof(value);
+            std::snprintf(number, sizeof(number), "%g", value);
+            line += number;
+            break;
+        }
+        case ARG_BOOL:
+        {
+            std::uint64_t value;
+            std::memcpy(&value, payload, sizeof(value));
+            payload += sizeof(value);
+            line += value ? "true" : "false";
+            break;
+        }
+        case ARG_STRING:
+        {
+            std::uint8_t length = *payload;
+            line.append(reinterpret_cast<const char*>(payload + 1), length);
+            payload += 1 + length;
+            break;
+        }
+        }
+    }
+
+    return line;
+}
+
+void logger_t::rotate()
+{
+    std::fclose(file);
+    file = nullptr;
+
+    // path.(n - 2) -> path.(n - 1) ... path -> path.1
+    std::error_code error;
+    for (int i = max_files - 1; i > 0; i--)
+    {
+        std::string from = i == 1 ? path : path + "." + std::to_string(i - 1);
+        std::filesystem::rename(from, path + "." + std::to_string(i), error);
+    }
+
+    file = std::fopen(path.c_str(), "w");
+    file_size = 0;
+}
+
+void logger_t::write(const std::string& line, std::int64_t ticks)
+{
+    if (console)
+    {
+        std::fwrite(line.data(), 1, line.size(), console);
+        std::fputc('\n', console);
+    }
+
+    if (!file)
+        return;
+
+    if (max_files > 1 && file_size + line.size() > max_file_size)
+    {
+        rotate();
+        if (!file)
+            return;
+    }
+
+    // File lines carry the time since the logger started
+    char time[32];
+    int length = std::snprintf(time, sizeof(time), "[%12.6f] ", clock.since_start(ticks) * 1e-9);
+
+    std::fwrite(time, 1, length, file);
+    std::fwrite(line.data(), 1, line.size(), file);
+    std::fputc('\n', file);
+    file_size += length + line.size() + 1;
+}
+
+void logger_t::run()
+{
+    std::vector<record_t> records(256);
+    std::vector<std::uint64_t> reported; // Drops already written, per thread
+
+    auto drain = [&]() -> bool
+    {
+        clock.calibrate();
+
+        bool wrote = false;
+        std::lock_guard lock(threads_mutex);
+
+        reported.resize(threads.size());
+
+        // Records are merged per batch, not globally by timestamp, threads rarely log at the same time
+        for (std::size_t t = 0; t < threads.size(); t++)
+        {
+            thread_buffer_t& buffer = *threads[t];
+
+            std::size_t count;
+            while ((count = buffer.ring.pop(records.data(), records.size())) != 0)
+            {
+                for (std::size_t i = 0; i < count; i++)
+                    write(format(records[i]), records[i].ticks);
+
+                wrote = true;
+            }
+
+            std::uint64_t dropped = buffer.dropped.load(std::memory_order_relaxed);
+            if (dropped != reported[t])
+            {
+                write("[!] " + std::to_string(dropped - reported[t]) + " log records dropped", tsc_clock_t::ticks());
+                reported[t] = dropped;
+                wrote = true;
+            }
+        }
+
+        return wrote;
+    };
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        if (drain())
+        {
+            if (console)
+                std::fflush(console);
+            if (file)
+                std::fflush(file);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Whatever was logged before stop
+    drain();
+
+    if (console)
+        std::fflush(console);
+    if (file)
+        std::fflush(file);
+}
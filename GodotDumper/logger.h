@@ -0,0 +1,208 @@
+#pragma once
+#include "compiler.h"
+#include "ring.h"
+#include "tsc.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Asynchronous logger
+ *
+ * A log call only packs its format pointer, a TSC timestamp and the raw arguments into a fixed 128 byte record
+ * and pushes it to the calling thread's ring, formatting and I/O happen on the logger thread
+ * The format string must outlive the logger (use literals), string arguments are copied and truncated to fit the record
+ *
+ * Formats use {} placeholders, {:x} prints integers and pointers in hex
+*/
+class logger_t {
+public:
+	enum level_t : std::uint8_t {
+		INFO,
+		WARNING,
+		ERR
+	};
+
+	enum arg_t : std::uint8_t {
+		ARG_INT,
+		ARG_UINT,
+		ARG_DOUBLE,
+		ARG_BOOL,
+		ARG_POINTER,
+		ARG_STRING // Length byte followed by the characters
+	};
+
+	static constexpr std::size_t MAX_ARGS = 8;
+	static constexpr std::size_t PAYLOAD_SIZE = 96;
+
+	struct record_t {
+		const char* format;
+		std::int64_t ticks;
+		level_t level;
+		std::uint8_t arg_count;
+		std::uint8_t payload_size;
+		arg_t types[MAX_ARGS];
+		std::uint8_t payload[PAYLOAD_SIZE];
+	};
+
+	static_assert(sizeof(record_t) <= 128);
+
+	struct thread_buffer_t {
+		spsc_ring_t<record_t, 1 << 12> ring;
+		std::atomic<std::uint64_t> dropped = 0;
+	};
+
+	std::size_t max_file_size = 4 * 1024 * 1024;
+	int max_files = 3; // path, path.1 ... path.(max_files - 1)
+
+public:
+	~logger_t();
+
+	// Starts the writer thread, console is where formatted lines go besides the file (stdout after AllocConsole)
+	bool start(const std::string& path, std::FILE* console = stdout);
+	// Writes everything still queued and stops the thread
+	void stop();
+
+	template <typename... Args>
+	__forceinline void log(level_t level, const char* format, const Args&... args)
+	{
+		static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+
+		// Packed straight into the ring, the arguments are written piecewise and copying the record after stalls
+		thread_buffer_t& buffer = get_thread_buffer();
+		record_t* record = buffer.ring.begin_push();
+		if (!record)
+		{
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		record->format = format;
+		record->ticks = tsc_clock_t::ticks();
+		record->level = level;
+		// The counts stay in registers while packing, through record they'd be reloaded after every byte store
+		cursor_t cursor = { *record };
+		(pack(cursor, args), ...);
+
+		record->arg_count = static_cast<std::uint8_t>(cursor.count);
+		record->payload_size = static_cast<std::uint8_t>(cursor.size);
+
+		buffer.ring.end_push();
+	}
+
+	thread_buffer_t& get_thread_buffer();
+
+	// Formats one record, used by the writer thread
+	std::string format(const record_t& record) const;
+
+private:
+	struct cursor_t {
+		record_t& record;
+		std::size_t size = 0; // Payload bytes used
+		std::size_t count = 0; // Arguments packed
+	};
+
+	template <typename T>
+	static __forceinline void pack_raw(cursor_t& cursor, arg_t type, const T& value)
+	{
+		if (cursor.size + sizeof(T) > PAYLOAD_SIZE)
+			return;
+
+		std::memcpy(cursor.record.payload + cursor.size, &value, sizeof(T));
+		cursor.size += sizeof(T);
+		cursor.record.types[cursor.count++] = type;
+	}
+
+	static __forceinline void pack_string(cursor_t& cursor, const char* str, std::size_t length)
+	{
+		if (cursor.size + 1 > PAYLOAD_SIZE)
+			return;
+
+		std::size_t room = PAYLOAD_SIZE - cursor.size - 1;
+		std::uint8_t size = static_cast<std::uint8_t>(length < room ? length : room);
+
+		cursor.record.payload[cursor.size] = size;
+		copy_short(cursor.record.payload + cursor.size + 1, str, size);
+		cursor.size += 1 + size;
+		cursor.record.types[cursor.count++] = ARG_STRING;
+	}
+
+	// A memcpy bounded by the payload size becomes rep movs, whose startup alone is over the budget of a log call
+	// Overlapping 8 byte moves instead, the last one ends at the last character
+	static __forceinline void copy_short(std::uint8_t* to, const char* from, std::size_t size)
+	{
+		if (size < 8)
+		{
+			for (std::size_t i = 0; i < size; i++)
+				to[i] = static_cast<std::uint8_t>(from[i]);
+			return;
+		}
+
+		std::uint64_t chunk;
+		for (std::size_t i = 0; i < size - 8; i += 8)
+		{
+			std::memcpy(&chunk, from + i, 8);
+			std::memcpy(to + i, &chunk, 8);
+		}
+
+		std::memcpy(&chunk, from + size - 8, 8);
+		std::memcpy(to + size - 8, &chunk, 8);
+	}
+
+	template <typename T>
+	static __forceinline void pack(cursor_t& cursor, const T& value)
+	{
+		using U = std::decay_t<T>;
+
+		if constexpr (std::is_same_v<U, bool>)
+			pack_raw(cursor, ARG_BOOL, static_cast<std::uint64_t>(value));
+		else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>)
+			pack_string(cursor, value ? value : "(null)", value ? std::strlen(value) : 6);
+		else if constexpr (std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view>)
+			pack_string(cursor, value.data(), value.size());
+		else if constexpr (std::is_floating_point_v<U>)
+			pack_raw(cursor, ARG_DOUBLE, static_cast<double>(value));
+		else if constexpr (std::is_enum_v<U>)
+			pack_raw(cursor, ARG_INT, static_cast<std::int64_t>(value));
+		else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+			pack_raw(cursor, ARG_INT, static_cast<std::int64_t>(value));
+		else if constexpr (std::is_integral_v<U>)
+			pack_raw(cursor, ARG_UINT, static_cast<std::uint64_t>(value));
+		else if constexpr (std::is_pointer_v<U>)
+			pack_raw(cursor, ARG_POINTER, reinterpret_cast<std::uintptr_t>(value));
+		else
+			static_assert(sizeof(U) == 0, "Unsupported log argument");
+	}
+
+	void run();
+	void write(const std::string& line, std::int64_t ticks);
+	void rotate();
+
+private:
+	std::mutex threads_mutex;
+	std::vector<std::unique_ptr<thread_buffer_t>> threads;
+
+	tsc_clock_t clock;
+
+	std::string path;
+	std::FILE* file = nullptr;
+	std::FILE* console = nullptr;
+	std::size_t file_size = 0;
+
+	std::atomic<bool> running = false;
+	std::thread thread;
+};
+
+inline std::unique_ptr<logger_t> logger = std::make_unique<logger_t>();
+
+#define LOG_INFO(FORMAT, ...) logger->log(logger_t::INFO, FORMAT, ##__VA_ARGS__)
+#define LOG_WARNING(FORMAT, ...) logger->log(logger_t::WARNING, FORMAT, ##__VA_ARGS__)
+#define LOG_ERROR(FORMAT, ...) logger->log(logger_t::ERR, FORMAT, ##__VA_ARGS__)
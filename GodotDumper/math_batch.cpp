@@ -0,0 +1,229 @@
+#include "compiler.h"
+SDK_FP_CONTRACT_OFF
+#include "math_batch.h"
+
+#ifndef SDK_MATH_SCALAR
+#include <xmmintrin.h>
+
+struct Vector3x4
+{
+    __m128 x, y, z;
+};
+
+// 4 packed Vector3 (48 bytes) -> x0..x3, y0..y3, z0..z3
+static __forceinline Vector3x4 load_x4(const Vector3* v)
+{
+    const float* f = &v->x;
+
+    __m128 a = _mm_loadu_ps(f + 0); // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(f + 4); // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(f + 8); // z2 x3 y3 z3
+
+    Vector3x4 r;
+    r.x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+    r.y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    r.z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+    return r;
+}
+
+static __forceinline void store_x4(Vector3* v, const Vector3x4& r)
+{
+    float* f = &v->x;
+
+    _mm_storeu_ps(f + 0, _mm_shuffle_ps(_mm_shuffle_ps(r.x, r.y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(r.z, r.x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(f + 4, _mm_shuffle_ps(_mm_shuffle_ps(r.y, r.z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(r.x, r.y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(f + 8, _mm_shuffle_ps(_mm_shuffle_ps(r.z, r.x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(r.y, r.z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static __forceinline __m128 dot_x4(const Vector3x4& a, const Vector3x4& b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+static __forceinline Vector3x4 cross_x4(const Vector3x4& a, const Vector3x4& b)
+{
+    return {
+        _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+        _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+        _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))
+    };
+}
+
+// Same as Vector3::normalize, zero length vectors become zero instead of NaN
+static __forceinline Vector3x4 normalized_x4(const Vector3x4& v)
+{
+    __m128 len = _mm_sqrt_ps(dot_x4(v, v));
+    __m128 zero = _mm_cmpeq_ps(len, _mm_setzero_ps());
+
+    return {
+        _mm_andnot_ps(zero, _mm_div_ps(v.x, len)),
+        _mm_andnot_ps(zero, _mm_div_ps(v.y, len)),
+        _mm_andnot_ps(zero, _mm_div_ps(v.z, len))
+    };
+}
+
+// a - b * s
+static __forceinline Vector3x4 sub_scaled_x4(const Vector3x4& a, const Vector3x4& b, __m128 s)
+{
+    return {
+        _mm_sub_ps(a.x, _mm_mul_ps(b.x, s)),
+        _mm_sub_ps(a.y, _mm_mul_ps(b.y, s)),
+        _mm_sub_ps(a.z, _mm_mul_ps(b.z, s))
+    };
+}
+
+static __forceinline Vector3x4 column_x4(const Basis* b, int column)
+{
+    return {
+        _mm_set_ps(b[3].rows[0][column], b[2].rows[0][column], b[1].rows[0][column], b[0].rows[0][column]),
+        _mm_set_ps(b[3].rows[1][column], b[2].rows[1][column], b[1].rows[1][column], b[0].rows[1][column]),
+        _mm_set_ps(b[3].rows[2][column], b[2].rows[2][column], b[1].rows[2][column], b[0].rows[2][column])
+    };
+}
+
+static __forceinline void set_column_x4(Basis* b, int column, const Vector3x4& v)
+{
+    alignas(16) float x[4], y[4], z[4];
+    _mm_store_ps(x, v.x);
+    _mm_store_ps(y, v.y);
+    _mm_store_ps(z, v.z);
+
+    for (int i = 0; i < 4; i++)
+        b[i].set_column(column, Vector3(x[i], y[i], z[i]));
+}
+#endif
+
+void batch::xform(const Transform3D& transform, const Vector3* in, Vector3* out, std::size_t count)
+{
+    std::size_t i = 0;
+
+#ifndef SDK_MATH_SCALAR
+    __m128 m[3][3];
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 3; c++)
+            m[r][c] = _mm_set1_ps(transform.basis.rows[r][c]);
+    }
+
+    __m128 ox = _mm_set1_ps(transform.origin.x);
+    __m128 oy = _mm_set1_ps(transform.origin.y);
+    __m128 oz = _mm_set1_ps(transform.origin.z);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        Vector3x4 v = load_x4(in + i);
+
+        Vector3x4 r = {
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], v.x), _mm_mul_ps(m[0][1], v.y)), _mm_mul_ps(m[0][2], v.z)), ox),
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1][0], v.x), _mm_mul_ps(m[1][1], v.y)), _mm_mul_ps(m[1][2], v.z)), oy),
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2][0], v.x), _mm_mul_ps(m[2][1], v.y)), _mm_mul_ps(m[2][2], v.z)), oz)
+        };
+
+        store_x4(out + i, r);
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = transform.xform(in[i]);
+}
+
+void batch::xform_inv(const Transform3D& transform, const Vector3* in, Vector3* out, std::size_t count)
+{
+    std::size_t i = 0;
+
+#ifndef SDK_MATH_SCALAR
+    __m128 m[3][3];
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 3; c++)
+            m[r][c] = _mm_set1_ps(transform.basis.rows[r][c]);
+    }
+
+    __m128 ox = _mm_set1_ps(transform.origin.x);
+    __m128 oy = _mm_set1_ps(transform.origin.y);
+    __m128 oz = _mm_set1_ps(transform.origin.z);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        Vector3x4 v = load_x4(in + i);
+        v.x = _mm_sub_ps(v.x, ox);
+        v.y = _mm_sub_ps(v.y, oy);
+        v.z = _mm_sub_ps(v.z, oz);
+
+        // Multiplies by the transposed basis
+        Vector3x4 r = {
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][0], v.x), _mm_mul_ps(m[1][0], v.y)), _mm_mul_ps(m[2][0], v.z)),
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][1], v.x), _mm_mul_ps(m[1][1], v.y)), _mm_mul_ps(m[2][1], v.z)),
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][2], v.x), _mm_mul_ps(m[1][2], v.y)), _mm_mul_ps(m[2][2], v.z))
+        };
+
+        store_x4(out + i, r);
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = transform.xform_inv(in[i]);
+}
+
+void batch::orthonormalize(Basis* bases, std::size_t count)
+{
+    std::size_t i = 0;
+
+#ifndef SDK_MATH_SCALAR
+    for (; i + 4 <= count; i += 4)
+    {
+        // Gram-Schmidt, same steps as Basis::orthonormalize
+        Vector3x4 x = column_x4(bases + i, 0);
+        Vector3x4 y = column_x4(bases + i, 1);
+        Vector3x4 z = column_x4(bases + i, 2);
+
+        x = normalized_x4(x);
+        y = normalized_x4(sub_scaled_x4(y, x, dot_x4(x, y)));
+        z = normalized_x4(sub_scaled_x4(sub_scaled_x4(z, x, dot_x4(x, z)), y, dot_x4(y, z)));
+
+        set_column_x4(bases + i, 0, x);
+        set_column_x4(bases + i, 1, y);
+        set_column_x4(bases + i, 2, z);
+    }
+#endif
+
+    for (; i < count; i++)
+        bases[i].orthonormalize();
+}
+
+void batch::look_at(const Vector3* eyes, const Vector3* targets, Transform3D* out, std::size_t count, const Vector3& up, bool use_model_front)
+{
+    std::size_t i = 0;
+
+#ifndef SDK_MATH_SCALAR
+    const Vector3x4 up4 = { _mm_set1_ps(up.x), _mm_set1_ps(up.y), _mm_set1_ps(up.z) };
+    const __m128 sign = _mm_set1_ps(use_model_front ? 0.f : -0.f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        Vector3x4 eye = load_x4(eyes + i);
+        Vector3x4 target = load_x4(targets + i);
+
+        Vector3x4 vz = normalized_x4({ _mm_sub_ps(target.x, eye.x), _mm_sub_ps(target.y, eye.y), _mm_sub_ps(target.z, eye.z) });
+        vz = { _mm_xor_ps(vz.x, sign), _mm_xor_ps(vz.y, sign), _mm_xor_ps(vz.z, sign) };
+
+        Vector3x4 vx = normalized_x4(cross_x4(up4, vz));
+        Vector3x4 vy = cross_x4(vz, vx);
+
+        Basis bases[4];
+        set_column_x4(bases, 0, vx);
+        set_column_x4(bases, 1, vy);
+        set_column_x4(bases, 2, vz);
+
+        for (int j = 0; j < 4; j++)
+        {
+            out[i + j].basis = bases[j];
+            out[i + j].origin = eyes[i + j];
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i].set_look_at(eyes[i], targets[i], up, use_model_front);
+}
@@ -0,0 +1,202 @@
+#pragma once
+#include "sdk.h"
+#include <cstddef>
+
+#ifndef SDK_MATH_SCALAR
+#include <xmmintrin.h>
+#endif
+
+#if defined(_M_FP_CONTRACT) || defined(_M_FP_FAST)
+#error "The batch math must round like the scalar sdk.h math, build without /fp:contract and /fp:fast"
+#endif
+
+/*
+ * Batched versions of the sdk.h math
+ *
+ * By default the kernels run 4 elements at a time with SSE, define SDK_MATH_SCALAR
+ * in the preprocessor definitions to fall back to the scalar sdk.h methods
+ * Both paths use the same operation order as Godot's formulas (no FMA contraction, see SDK_FP_CONTRACT_OFF),
+ * so their results are bit-identical to the scalar ones, tools/mathtest checks it
+*/
+namespace batch
+{
+    void xform(const Transform3D& transform, const Vector3* in, Vector3* out, std::size_t count);
+    void xform_inv(const Transform3D& transform, const Vector3* in, Vector3* out, std::size_t count);
+
+    void orthonormalize(Basis* bases, std::size_t count);
+
+    void look_at(const Vector3* eyes, const Vector3* targets, Transform3D* out, std::size_t count, const Vector3& up = { 0.f, 1.f, 0.f }, bool use_model_front = false);
+}
+
+/*
+ * Vector3 / Transform3D held in registers, for a chain of math on a few values (walking up a node's parents)
+ *
+ * The sdk.h types mirror the engine's memory (12 and 48 byte structs) so they can't be aligned or padded,
+ * these are converted from them at the start of the chain and back at the end
+ * SSE by default, the sdk.h types themselves with SDK_MATH_SCALAR, every operation rounds like its sdk.h counterpart
+*/
+class alignas(16) Vector3A
+{
+public:
+    Vector3A() = default;
+    explicit Vector3A(const Vector3& v);
+
+    Vector3 get() const;
+
+    Vector3A operator+(const Vector3A& v) const;
+    Vector3A operator-(const Vector3A& v) const;
+    Vector3A operator*(float scalar) const;
+
+    float dot(const Vector3A& v) const;
+    Vector3A cross(const Vector3A& v) const;
+
+private:
+    friend class Transform3DA;
+
+#ifdef SDK_MATH_SCALAR
+    Vector3 v;
+    float pad;
+#else
+    explicit Vector3A(__m128 v) : v(v) { }
+
+    __m128 v; // x y z 0
+#endif
+};
+
+class alignas(16) Transform3DA
+{
+public:
+    Transform3DA() = default;
+    explicit Transform3DA(const Transform3D& transform);
+
+    Transform3D get() const;
+
+    Vector3A xform(const Vector3A& v) const;
+    Vector3A xform_inv(const Vector3A& v) const;
+
+    Transform3DA operator*(const Transform3DA& transform) const;
+
+private:
+    Vector3A rows[3];
+    Vector3A origin;
+};
+
+#ifdef SDK_MATH_SCALAR
+inline Vector3A::Vector3A(const Vector3& v) : v(v), pad(0.f) { }
+inline Vector3 Vector3A::get() const { return v; }
+
+inline Vector3A Vector3A::operator+(const Vector3A& other) const { return Vector3A(v + other.v); }
+inline Vector3A Vector3A::operator-(const Vector3A& other) const { return Vector3A(v - other.v); }
+inline Vector3A Vector3A::operator*(float scalar) const { return Vector3A(v * scalar); }
+
+inline float Vector3A::dot(const Vector3A& other) const { return v.dot(other.v); }
+inline Vector3A Vector3A::cross(const Vector3A& other) const { return Vector3A(v.cross(other.v)); }
+
+inline Transform3DA::Transform3DA(const Transform3D& transform)
+    : rows{ Vector3A(transform.basis.rows[0]), Vector3A(transform.basis.rows[1]), Vector3A(transform.basis.rows[2]) }, origin(transform.origin) { }
+
+inline Transform3D Transform3DA::get() const
+{
+    Transform3D transform;
+    transform.basis.rows[0] = rows[0].v;
+    transform.basis.rows[1] = rows[1].v;
+    transform.basis.rows[2] = rows[2].v;
+    transform.origin = origin.v;
+
+    return transform;
+}
+
+inline Vector3A Transform3DA::xform(const Vector3A& v) const { return Vector3A(get().xform(v.v)); }
+inline Vector3A Transform3DA::xform_inv(const Vector3A& v) const { return Vector3A(get().xform_inv(v.v)); }
+inline Transform3DA Transform3DA::operator*(const Transform3DA& transform) const { return Transform3DA(get() * transform.get()); }
+#else
+inline Vector3A::Vector3A(const Vector3& v) : v(_mm_set_ps(0.f, v.z, v.y, v.x)) { }
+
+inline Vector3 Vector3A::get() const
+{
+    alignas(16) float f[4];
+    _mm_store_ps(f, v);
+
+    return Vector3(f[0], f[1], f[2]);
+}
+
+inline Vector3A Vector3A::operator+(const Vector3A& other) const { return Vector3A(_mm_add_ps(v, other.v)); }
+inline Vector3A Vector3A::operator-(const Vector3A& other) const { return Vector3A(_mm_sub_ps(v, other.v)); }
+inline Vector3A Vector3A::operator*(float scalar) const { return Vector3A(_mm_mul_ps(v, _mm_set1_ps(scalar))); }
+
+// (x * x' + y * y') + z * z', the scalar order
+inline float Vector3A::dot(const Vector3A& other) const
+{
+    __m128 m = _mm_mul_ps(v, other.v);
+    __m128 xy = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    return _mm_cvtss_f32(_mm_add_ss(xy, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2))));
+}
+
+inline Vector3A Vector3A::cross(const Vector3A& other) const
+{
+    __m128 a_yzx = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 a_zxy = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 b_yzx = _mm_shuffle_ps(other.v, other.v, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_zxy = _mm_shuffle_ps(other.v, other.v, _MM_SHUFFLE(3, 1, 0, 2));
+
+    return Vector3A(_mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx)));
+}
+
+inline Transform3DA::Transform3DA(const Transform3D& transform)
+    : rows{ Vector3A(transform.basis.rows[0]), Vector3A(transform.basis.rows[1]), Vector3A(transform.basis.rows[2]) }, origin(transform.origin) { }
+
+inline Transform3D Transform3DA::get() const
+{
+    Transform3D transform;
+    transform.basis.rows[0] = rows[0].get();
+    transform.basis.rows[1] = rows[1].get();
+    transform.basis.rows[2] = rows[2].get();
+    transform.origin = origin.get();
+
+    return transform;
+}
+
+// Lane i of column c is rows[i][c], so every lane sums its row's products in the scalar order
+inline Vector3A Transform3DA::xform(const Vector3A& v) const
+{
+    __m128 c0 = rows[0].v, c1 = rows[1].v, c2 = rows[2].v, c3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    __m128 x = _mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 y = _mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 z = _mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(2, 2, 2, 2));
+
+    return Vector3A(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)), _mm_mul_ps(c2, z)), origin.v));
+}
+
+inline Vector3A Transform3DA::xform_inv(const Vector3A& v) const
+{
+    __m128 d = _mm_sub_ps(v.v, origin.v);
+
+    __m128 x = _mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 y = _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 z = _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2));
+
+    return Vector3A(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rows[0].v, x), _mm_mul_ps(rows[1].v, y)), _mm_mul_ps(rows[2].v, z)));
+}
+
+// Row i of the product is rows[i].x * other.rows[0] + rows[i].y * other.rows[1] + rows[i].z * other.rows[2], like Basis::operator*
+inline Transform3DA Transform3DA::operator*(const Transform3DA& transform) const
+{
+    Transform3DA result;
+
+    for (int i = 0; i < 3; i++)
+    {
+        __m128 r = rows[i].v;
+        __m128 x = _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 y = _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 z = _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2));
+
+        result.rows[i].v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, transform.rows[0].v), _mm_mul_ps(y, transform.rows[1].v)), _mm_mul_ps(z, transform.rows[2].v));
+    }
+
+    result.origin = xform(transform.origin);
+    return result;
+}
+#endif
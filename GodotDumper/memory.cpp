@@ -1,10 +1,66 @@
 #include "memory.h"
 #include <cctype>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
 #include <Windows.h>
+#endif
+
+// SizeOfImage from the image's own headers, 0 if base isn't a PE32+ image
+static std::size_t read_image_size(const void* base)
+{
+    if (!base)
+        return 0;
+
+    const std::uint8_t* image = static_cast<const std::uint8_t*>(base);
+
+    std::uint16_t magic = 0;
+    std::int32_t nt_offset = 0;
+    std::memcpy(&magic, image, sizeof(magic));
+    std::memcpy(&nt_offset, image + 0x3C, sizeof(nt_offset)); // e_lfanew
+
+    if (magic != 0x5A4D) // MZ
+        return 0;
+
+    std::uint32_t signature = 0, size = 0;
+    std::memcpy(&signature, image + nt_offset, sizeof(signature));
+    std::memcpy(&size, image + nt_offset + 0x50, sizeof(size)); // OptionalHeader.SizeOfImage
+
+    return signature == 0x4550 ? size : 0; // PE\0\0
+}
 
 Memory::Memory()
 {
+#ifdef _WIN32
     base = (void*)GetModuleHandleA(nullptr);
+#else
+    base = nullptr;
+#endif
+}
+
+void Memory::set_base_address(void* address)
+{
+    base = address;
+    image_size = 0;
+}
+
+void Memory::set_readable(readable_t callback, const void* context)
+{
+    readable = callback;
+    readable_context = context;
+}
+
+bool Memory::is_readable(const void* address, std::size_t size) const
+{
+    if (readable)
+        return readable(readable_context, reinterpret_cast<std::uintptr_t>(address), size);
+
+#ifdef _WIN32
+    return !IsBadReadPtr(address, size);
+#else
+    return address != nullptr;
+#endif
 }
 
 constexpr std::uint32_t Memory::CharToHexInt(const std::uint8_t uChar)
@@ -21,7 +77,9 @@ std::size_t Memory::pattern_to_bytes(const char* pattern, std::uint8_t* byte_buf
     {
         if (*pattern == '?')
         {
-            ++pattern;
+            // "??" is one byte, a single '?' can be the last character
+            if (pattern[1] == '?')
+                ++pattern;
 
             *current_byte++ = 0;
             *mask_buf++ = '?';
@@ -79,27 +137,42 @@ std::uint8_t* Memory::find_pattern(const char* pattern, const char* mask)
 {
     const std::uint8_t* base_addr = reinterpret_cast<const std::uint8_t*>(base);
 
-    const IMAGE_DOS_HEADER* dos = reinterpret_cast<const IMAGE_DOS_HEADER*>(base);
-    if (dos->e_magic != IMAGE_DOS_SIGNATURE)
-        return nullptr;
-
-    const IMAGE_NT_HEADERS* nt = reinterpret_cast<const IMAGE_NT_HEADERS*>(base_addr + dos->e_lfanew);
-    if (nt->Signature != IMAGE_NT_SIGNATURE)
+    const std::size_t size = get_image_size();
+    if (!size)
         return nullptr;
 
     const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(pattern);
     const std::size_t byte_count = strlen(mask);
 
-    std::uint8_t* found_addr = find_pattern_ex(base_addr, nt->OptionalHeader.SizeOfImage, bytes, byte_count, mask);
+    std::uint8_t* found_addr = find_pattern_ex(base_addr, size, bytes, byte_count, mask);
     return found_addr;
 }
 
 std::uint8_t* Memory::find_pattern(const char* pattern)
 {
     const std::size_t approx_buff_size = (strlen(pattern) >> 1) + 1;
-    std::uint8_t* bytes = static_cast<std::uint8_t*>(_malloca(approx_buff_size));
-    char* mask = static_cast<char*>(_malloca(approx_buff_size));
-    pattern_to_bytes(pattern, bytes, mask);
+    std::vector<std::uint8_t> bytes(approx_buff_size + 1);
+    std::vector<char> mask(approx_buff_size + 1);
+    pattern_to_bytes(pattern, bytes.data(), mask.data());
+
+    return find_pattern(reinterpret_cast<const char*>(bytes.data()), mask.data());
+}
+
+std::uint8_t* Memory::find_string(const char* str)
+{
+    const std::uint8_t* base_addr = reinterpret_cast<const std::uint8_t*>(base);
+
+    const std::size_t size = get_image_size();
+    if (!size)
+        return nullptr;
+
+    return find_pattern_ex(base_addr, size, reinterpret_cast<const std::uint8_t*>(str), strlen(str), nullptr);
+}
+
+std::size_t Memory::get_image_size()
+{
+    if (!image_size)
+        image_size = read_image_size(base);
 
-    return find_pattern(reinterpret_cast<const char*>(bytes), mask);
-}
\ No newline at end of file
+    return image_size;
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "compiler.h"
 #include <memory>
 #include <cstdint>
 
@@ -21,6 +22,7 @@ private:
 
 public:
     std::uint8_t* find_pattern(const char* pattern);
+    std::uint8_t* find_string(const char* str);
 
 public:
     __forceinline std::uint8_t* resolve_rel_addr(std::uint8_t* addr, std::uint32_t rva_offset, std::uint32_t rip_offset)
@@ -36,6 +38,20 @@ public:
         return base;
     }
 
+    std::size_t get_image_size();
+
+    /*
+     * Outside the game the image isn't the process' own executable, a dump mapped at its original addresses
+     * sets the base of the game's image and a check for the ranges it holds
+    */
+    using readable_t = bool (*)(const void* context, std::uintptr_t address, std::size_t size);
+
+    void set_base_address(void* address);
+    void set_readable(readable_t callback, const void* context);
+
+    // IsBadReadPtr in the game, the dump's regions once set_readable was called
+    bool is_readable(const void* address, std::size_t size) const;
+
     template <typename T, std::size_t idx, class base_class, typename... args>
     static __forceinline T call_vfunc(base_class* thisptr, args... arguments)
     {
@@ -45,6 +61,10 @@ public:
 
 private:
     void* base;
+    std::size_t image_size = 0;
+
+    readable_t readable = nullptr;
+    const void* readable_context = nullptr;
 };
 
 inline std::unique_ptr<Memory> mem = std::make_unique<Memory>();
\ No newline at end of file
@@ -0,0 +1,434 @@
+#include "minidump.h"
+#include "memory.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Stream types and record sizes of minidumpapiset.h, only the memory and module lists are read
+static constexpr std::uint32_t MODULE_LIST_STREAM = 4;
+static constexpr std::uint32_t MEMORY_LIST_STREAM = 5;
+static constexpr std::uint32_t MEMORY64_LIST_STREAM = 9;
+
+static constexpr std::size_t HEADER_SIZE = 32;
+static constexpr std::size_t DIRECTORY_SIZE = 12;
+static constexpr std::size_t MODULE_SIZE = 108;
+static constexpr std::size_t MEMORY_DESCRIPTOR_SIZE = 16;
+
+minidump_t::~minidump_t()
+{
+    close();
+}
+
+bool minidump_t::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    mapping = GetFileSizeEx(file, &size) && size.QuadPart ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mapping)
+    {
+        view = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        view_size = static_cast<std::size_t>(size.QuadPart);
+    }
+#else
+    file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        void* address = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (address != MAP_FAILED)
+        {
+            view = static_cast<const std::uint8_t*>(address);
+            view_size = static_cast<std::size_t>(info.st_size);
+        }
+    }
+#endif
+
+    if (!view || !parse())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void minidump_t::close()
+{
+    detach();
+
+#ifdef _WIN32
+    if (view)
+        UnmapViewOfFile(view);
+
+    if (mapping)
+        CloseHandle(mapping);
+
+    if (file)
+        CloseHandle(file);
+
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (view)
+        munmap(const_cast<std::uint8_t*>(view), view_size);
+
+    if (file >= 0)
+        ::close(file);
+
+    file = -1;
+#endif
+
+    view = nullptr;
+    view_size = 0;
+    modules.clear();
+    regions.clear();
+}
+
+bool minidump_t::parse()
+{
+    auto read = [&](std::uint64_t offset, auto& out)
+    {
+        if (offset > view_size || sizeof(out) > view_size - offset)
+            return false;
+
+        std::memcpy(&out, view + offset, sizeof(out));
+        return true;
+    };
+
+    std::uint32_t signature = 0, stream_count = 0, directory = 0;
+    if (!read(0, signature) || signature != SIGNATURE || !read(8, stream_count) || !read(12, directory) || view_size < HEADER_SIZE)
+        return false;
+
+    for (std::uint32_t i = 0; i < stream_count; i++)
+    {
+        const std::uint64_t entry = directory + static_cast<std::uint64_t>(i) * DIRECTORY_SIZE;
+
+        std::uint32_t type = 0, size = 0, rva = 0;
+        if (!read(entry, type) || !read(entry + 4, size) || !read(entry + 8, rva))
+            return false;
+
+        if (type == MEMORY64_LIST_STREAM)
+        {
+            // { u64 count, u64 base rva, (u64 start, u64 size) * count }, the data of every range follows the previous one
+            std::uint64_t count = 0, offset = 0;
+            if (!read(rva, count) || !read(rva + 8, offset))
+                return false;
+
+            for (std::uint64_t j = 0; j < count; j++)
+            {
+                region_t region = {};
+                if (!read(rva + 16 + j * 16, region.base) || !read(rva + 24 + j * 16, region.size))
+                    return false;
+
+                region.offset = offset;
+                offset += region.size;
+
+                if (offset <= view_size)
+                    regions.push_back(region);
+            }
+        }
+        else if (type == MEMORY_LIST_STREAM)
+        {
+            // { u32 count, (u64 start, u32 size, u32 rva) * count }, small dumps (stacks and the like)
+            std::uint32_t count = 0;
+            if (!read(rva, count))
+                return false;
+
+            for (std::uint32_t j = 0; j < count; j++)
+            {
+                const std::uint64_t descriptor = rva + 4 + static_cast<std::uint64_t>(j) * MEMORY_DESCRIPTOR_SIZE;
+
+                region_t region = {};
+                std::uint32_t data_size = 0, data_rva = 0;
+                if (!read(descriptor, region.base) || !read(descriptor + 8, data_size) || !read(descriptor + 12, data_rva))
+                    return false;
+
+                region.size = data_size;
+                region.offset = data_rva;
+
+                if (region.offset + region.size <= view_size)
+                    regions.push_back(region);
+            }
+        }
+        else if (type == MODULE_LIST_STREAM)
+        {
+            // { u32 count, (u64 base, u32 size, u32 checksum, u32 timestamp, u32 name rva, ...) * count }
+            std::uint32_t count = 0;
+            if (!read(rva, count))
+                return false;
+
+            for (std::uint32_t j = 0; j < count; j++)
+            {
+                const std::uint64_t record = rva + 4 + static_cast<std::uint64_t>(j) * MODULE_SIZE;
+
+                module_t module;
+                std::uint32_t size_of_image = 0, name_rva = 0, name_length = 0;
+                if (!read(record, module.base) || !read(record + 8, size_of_image) || !read(record + 20, name_rva) || !read(name_rva, name_length))
+                    return false;
+
+                module.size = size_of_image;
+
+                // UTF-16 path, only the file name is kept and everything outside ASCII becomes '?'
+                for (std::uint32_t k = 0; k < name_length / 2; k++)
+                {
+                    std::uint16_t c = 0;
+                    if (!read(name_rva + 4 + k * 2ull, c))
+                        break;
+
+                    if (c == '\\' || c == '/')
+                        module.name.clear();
+                    else
+                        module.name.push_back(c < 0x80 ? static_cast<char>(c) : '?');
+                }
+
+                modules.push_back(std::move(module));
+            }
+        }
+    }
+
+    std::sort(regions.begin(), regions.end(), [](const region_t& a, const region_t& b) { return a.base < b.base; });
+
+    // Ranges that follow each other in memory and in the file become one, a read can then span them
+    std::vector<region_t> merged;
+    for (const region_t& region : regions)
+    {
+        if (!merged.empty() && merged.back().base + merged.back().size == region.base && merged.back().offset + merged.back().size == region.offset)
+            merged.back().size += region.size;
+        else if (region.size)
+            merged.push_back(region);
+    }
+
+    regions = std::move(merged);
+    return !regions.empty();
+}
+
+const minidump_t::region_t* minidump_t::get_region(std::uint64_t address) const
+{
+    auto it = std::upper_bound(regions.begin(), regions.end(), address, [](std::uint64_t value, const region_t& region) { return value < region.base; });
+    if (it == regions.begin())
+        return nullptr;
+
+    --it;
+    return it->contains(address) ? &*it : nullptr;
+}
+
+const void* minidump_t::translate(std::uintptr_t address, std::size_t size) const
+{
+    const region_t* region = get_region(address);
+    if (!region || size > region->size - (address - region->base))
+        return nullptr;
+
+    return view + region->offset + (address - region->base);
+}
+
+const minidump_t::module_t* minidump_t::get_module(std::string_view name) const
+{
+    for (const module_t& module : modules)
+    {
+        if (module.name == name)
+            return &module;
+    }
+
+    return nullptr;
+}
+
+std::uint64_t minidump_t::get_memory_size() const
+{
+    std::uint64_t total = 0;
+    for (const region_t& region : regions)
+        total += region.size;
+
+    return total;
+}
+
+std::uint64_t minidump_t::get_mapped_size() const
+{
+    std::uint64_t total = 0;
+    for (const region_t& region : regions)
+        total += region.mapped ? region.size : 0;
+
+    return total;
+}
+
+#ifdef _WIN32
+bool minidump_t::map_region(region_t& region)
+{
+    void* address = VirtualAlloc(reinterpret_cast<void*>(region.base), region.size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (address != reinterpret_cast<void*>(region.base))
+    {
+        if (address)
+            VirtualFree(address, 0, MEM_RELEASE);
+
+        return false;
+    }
+
+    std::memcpy(address, view + region.offset, region.size);
+
+    DWORD old;
+    VirtualProtect(address, region.size, PAGE_READONLY, &old);
+    return true;
+}
+
+void minidump_t::detach()
+{
+    for (region_t& region : regions)
+    {
+        if (region.mapped)
+            VirtualFree(reinterpret_cast<void*>(region.base), 0, MEM_RELEASE);
+
+        region.mapped = false;
+    }
+
+    mem->set_readable(nullptr, nullptr);
+}
+#else
+static const minidump_t* faulting = nullptr; // The attached dump, its unaligned regions are filled by on_fault
+static struct sigaction previous_action;
+
+/*
+ * A region whose file offset isn't page aligned can't be mapped from the file, it's reserved without access and
+ * every page is copied on its first touch: the copy goes to a scratch page that mremap then moves over the
+ * reserved one in one step, so another thread never sees a half filled page
+*/
+static void on_fault(int signal, siginfo_t* info, void* context)
+{
+    static const std::uint64_t page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    const std::uint64_t address = reinterpret_cast<std::uint64_t>(info->si_addr);
+
+    const minidump_t::region_t* region = faulting ? faulting->get_region(address) : nullptr;
+    if (region && region->mapped)
+    {
+        const std::uint64_t start = address & ~(page - 1);
+
+        void* scratch = mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (scratch != MAP_FAILED)
+        {
+            const void* source = faulting->translate(static_cast<std::uintptr_t>(start), static_cast<std::size_t>(page));
+            std::memcpy(scratch, source, page);
+            mprotect(scratch, page, PROT_READ);
+
+            if (mremap(scratch, page, page, MREMAP_MAYMOVE | MREMAP_FIXED, reinterpret_cast<void*>(start)) != MAP_FAILED)
+                return;
+
+            munmap(scratch, page);
+        }
+    }
+
+    // Not ours, whoever handled it before (or the default crash)
+    if (previous_action.sa_flags & SA_SIGINFO)
+        previous_action.sa_sigaction(signal, info, context);
+    else if (previous_action.sa_handler != SIG_DFL && previous_action.sa_handler != SIG_IGN)
+        previous_action.sa_handler(signal);
+    else
+    {
+        sigaction(signal, &previous_action, nullptr);
+        raise(signal);
+    }
+}
+
+bool minidump_t::map_region(region_t& region)
+{
+    static const std::uint64_t page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    if ((region.base | region.size) & (page - 1))
+        return false;
+
+    void* wanted = reinterpret_cast<void*>(region.base);
+    const bool direct = !(region.offset & (page - 1));
+
+    // NOREPLACE fails instead of replacing one of our own mappings, older kernels take it as a hint
+    void* address = direct
+        ? mmap(wanted, region.size, PROT_READ, MAP_PRIVATE | MAP_FIXED_NOREPLACE, file, static_cast<off_t>(region.offset))
+        : mmap(wanted, region.size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (address == MAP_FAILED)
+        return false;
+
+    if (address != wanted)
+    {
+        munmap(address, region.size);
+        return false;
+    }
+
+    if (!direct && faulting != this)
+    {
+        struct sigaction action = {};
+        action.sa_sigaction = &on_fault;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+
+        if (!faulting)
+            sigaction(SIGSEGV, &action, &previous_action);
+
+        faulting = this;
+    }
+
+    return true;
+}
+
+void minidump_t::detach()
+{
+    for (region_t& region : regions)
+    {
+        if (region.mapped)
+            munmap(reinterpret_cast<void*>(region.base), region.size);
+
+        region.mapped = false;
+    }
+
+    if (faulting == this)
+    {
+        sigaction(SIGSEGV, &previous_action, nullptr);
+        faulting = nullptr;
+    }
+
+    mem->set_readable(nullptr, nullptr);
+}
+#endif
+
+bool minidump_t::attach()
+{
+    if (!view || modules.empty())
+        return false;
+
+    detach();
+
+    for (region_t& region : regions)
+        region.mapped = map_region(region);
+
+    const module_t& executable = modules.front();
+    const region_t* header = get_region(executable.base);
+    if (!header || !header->mapped)
+        return false;
+
+    mem->set_base_address(reinterpret_cast<void*>(executable.base));
+    mem->set_readable(&minidump_t::is_mapped, this);
+    return true;
+}
+
+bool minidump_t::is_mapped(const void* context, std::uintptr_t address, std::size_t size)
+{
+    const minidump_t* dump = static_cast<const minidump_t*>(context);
+
+    const region_t* region = dump->get_region(address);
+    return region && region->mapped && size <= region->size - (address - region->base);
+}
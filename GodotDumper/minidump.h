@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Minidump reader, lets the gd:: readers run against a crash dump of the game on any OS
+ *
+ * The file is memory mapped and only its directory is parsed on open, the memory lists become a region index
+ * sorted by address (adjacent ranges merged), a read is a binary search plus a pointer into the file view so pages
+ * are only loaded when touched and multi GB dumps open instantly
+ *
+ * translate() is a memory source for the containers.h views, attach() maps every region at its original address
+ * instead so the raw gd:: field accessors work unchanged (mem then points at the dump's executable)
+ * Regions are mapped straight from the file where its offsets are page aligned, elsewhere (Linux) each page is
+ * copied from the file on first touch, on Windows copied up front; a region whose address is already taken here
+ * is left out and reads as unreadable
+*/
+class minidump_t {
+public:
+	static constexpr std::uint32_t SIGNATURE = 'M' | 'D' << 8 | 'M' << 16 | 'P' << 24;
+
+	struct module_t {
+		std::string name;
+		std::uint64_t base;
+		std::uint64_t size;
+
+		bool contains(std::uint64_t address) const { return address >= base && address - base < size; }
+	};
+
+	struct region_t {
+		std::uint64_t base;
+		std::uint64_t size;
+		std::uint64_t offset; // In the file
+		bool mapped = false; // At base, by attach
+
+		bool contains(std::uint64_t address) const { return address >= base && address - base < size; }
+	};
+
+public:
+	~minidump_t();
+
+	bool open(const std::string& path);
+	void close();
+
+	// Pointer into the file view for [address, address + size), nullptr if the dump doesn't hold all of it
+	const void* translate(std::uintptr_t address, std::size_t size) const;
+
+	template <typename T>
+	bool read(std::uint64_t address, T& out) const
+	{
+		const void* data = translate(static_cast<std::uintptr_t>(address), sizeof(T));
+		if (!data)
+			return false;
+
+		std::memcpy(&out, data, sizeof(T));
+		return true;
+	}
+
+	// Maps the regions at their original addresses and points mem at the first module (the executable)
+	bool attach();
+	void detach();
+
+	const std::vector<module_t>& get_modules() const { return modules; }
+	const std::vector<region_t>& get_regions() const { return regions; }
+	const module_t* get_module(std::string_view name) const;
+	const region_t* get_region(std::uint64_t address) const;
+
+	std::uint64_t get_memory_size() const;
+	std::uint64_t get_mapped_size() const;
+
+private:
+	bool parse();
+	bool map_region(region_t& region);
+
+	static bool is_mapped(const void* context, std::uintptr_t address, std::size_t size);
+
+private:
+	const std::uint8_t* view = nullptr;
+	std::size_t view_size = 0;
+
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#else
+	int file = -1;
+#endif
+
+	std::vector<module_t> modules;
+	std::vector<region_t> regions;
+};
+
+// Memory source over a dump for the containers.h views
+struct DumpMemory
+{
+	const minidump_t* dump = nullptr;
+
+	const void* translate(std::uintptr_t address, std::size_t size) const
+	{
+		return dump->translate(address, size);
+	}
+};
@@ -0,0 +1,35 @@
+#include "objects.h"
+#include "godot.h"
+
+void object_list_t::refresh()
+{
+    entries.clear();
+    for (class_t& entry : classes)
+        entry.count = 0;
+
+    slot_count = gd::ObjectDB::get_slot_max();
+    entries.reserve(slot_count);
+
+    gd::ObjectDB::for_each([&](gd::Object* object, std::uint64_t instance_id)
+    {
+        std::uint32_t class_index = classify(object);
+        classes[class_index].count++;
+
+        entries.push_back({ object, instance_id, class_index });
+    });
+}
+
+std::uint32_t object_list_t::classify(gd::Object* object)
+{
+    void* vtable = object->get_vtable();
+
+    auto it = class_of_vtable.find(vtable);
+    if (it != class_of_vtable.end())
+        return it->second;
+
+    std::uint32_t class_index = static_cast<std::uint32_t>(classes.size());
+    classes.push_back({ object->get_class_name(), vtable });
+    class_of_vtable.emplace(vtable, class_index);
+
+    return class_index;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace gd
+{
+	class Object;
+}
+
+/*
+ * Every live Object of the game, read straight from the ObjectDB slot array
+ *
+ * Unlike the scene tree walk this also finds resources, orphan nodes and anything else the engine allocated
+ * Objects are classified by vtable: get_class_name is only called the first time a vtable is seen
+*/
+class object_list_t {
+public:
+	struct entry_t {
+		gd::Object* object;
+		std::uint64_t instance_id;
+		std::uint32_t class_index; // Into classes
+	};
+
+	struct class_t {
+		std::string name;
+		void* vtable;
+		std::uint32_t count = 0;
+	};
+
+	// One pass over the ObjectDB, replaces the previous snapshot
+	void refresh();
+
+	const std::vector<entry_t>& get_entries() const { return entries; }
+	const std::vector<class_t>& get_classes() const { return classes; }
+
+	// Total amount of slots scanned by the last refresh
+	std::uint32_t get_slot_count() const { return slot_count; }
+
+private:
+	std::uint32_t classify(gd::Object* object);
+
+private:
+	std::vector<entry_t> entries;
+	std::vector<class_t> classes;
+
+	// Vtables never move while the game is running, so this cache is never cleared
+	std::unordered_map<void*, std::uint32_t> class_of_vtable;
+
+	std::uint32_t slot_count = 0;
+};
+
+inline std::unique_ptr<object_list_t> objects = std::make_unique<object_list_t>();
@@ -0,0 +1,302 @@
+#include "pe.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    template <typename T>
+    bool read_at(const std::uint8_t* data, std::size_t available, std::size_t offset, T& out)
+    {
+        if (offset > available || sizeof(T) > available - offset)
+            return false;
+
+        std::memcpy(&out, data + offset, sizeof(T));
+        return true;
+    }
+
+    constexpr std::uint16_t DOS_MAGIC = 0x5A4D; // MZ
+    constexpr std::uint32_t NT_MAGIC = 0x00004550; // PE\0\0
+    constexpr std::uint16_t PE32_PLUS = 0x20B;
+
+    constexpr std::size_t FILE_HEADER_SIZE = 20;
+    constexpr std::size_t SECTION_HEADER_SIZE = 40;
+
+    // Offsets into IMAGE_OPTIONAL_HEADER64
+    constexpr std::size_t OPTIONAL_IMAGE_BASE = 24;
+    constexpr std::size_t OPTIONAL_SIZE_OF_IMAGE = 56;
+    constexpr std::size_t OPTIONAL_SIZE_OF_HEADERS = 60;
+    constexpr std::size_t OPTIONAL_DIRECTORY_COUNT = 108;
+    constexpr std::size_t OPTIONAL_DIRECTORIES = 112;
+}
+
+bool pe_image_t::parse_headers(const std::uint8_t* headers, std::size_t available)
+{
+    std::uint16_t dos_magic;
+    std::uint32_t nt_offset;
+    if (!read_at(headers, available, 0, dos_magic) || dos_magic != DOS_MAGIC || !read_at(headers, available, 0x3C, nt_offset))
+        return false;
+
+    std::uint32_t nt_magic;
+    if (!read_at(headers, available, nt_offset, nt_magic) || nt_magic != NT_MAGIC)
+        return false;
+
+    const std::size_t file_header = nt_offset + 4;
+    const std::size_t optional_header = file_header + FILE_HEADER_SIZE;
+
+    std::uint16_t section_count, optional_size, optional_magic;
+    if (!read_at(headers, available, file_header, machine) || !read_at(headers, available, file_header + 2, section_count) ||
+        !read_at(headers, available, file_header + 16, optional_size) || !read_at(headers, available, optional_header, optional_magic))
+        return false;
+
+    // Only 64-bit images, the machine isn't checked (CoreCLR's ReadyToRun images use OS specific values)
+    if (optional_magic != PE32_PLUS)
+        return false;
+
+    std::uint32_t size_of_image;
+    if (!read_at(headers, available, optional_header + OPTIONAL_IMAGE_BASE, image_base) ||
+        !read_at(headers, available, optional_header + OPTIONAL_SIZE_OF_IMAGE, size_of_image) ||
+        !read_at(headers, available, optional_header + OPTIONAL_DIRECTORY_COUNT, directory_count))
+        return false;
+
+    image_size = size_of_image;
+    directory_count = std::min<std::uint32_t>(directory_count, 16);
+
+    for (std::uint32_t i = 0; i < directory_count; i++)
+    {
+        if (!read_at(headers, available, optional_header + OPTIONAL_DIRECTORIES + i * 8, directories[i]))
+            return false;
+    }
+
+    sections.clear();
+
+    const std::size_t section_table = optional_header + optional_size;
+    for (std::uint16_t i = 0; i < section_count; i++)
+    {
+        const std::size_t header = section_table + i * SECTION_HEADER_SIZE;
+
+        section_t section{};
+        std::uint32_t virtual_size = 0, raw_size = 0;
+
+        if (header + SECTION_HEADER_SIZE > available)
+            return false;
+
+        std::memcpy(section.name, headers + header, 8);
+        read_at(headers, available, header + 8, virtual_size);
+        read_at(headers, available, header + 12, section.rva);
+        read_at(headers, available, header + 16, raw_size);
+        read_at(headers, available, header + 36, section.characteristics);
+
+        section.size = virtual_size ? virtual_size : raw_size;
+        sections.push_back(section);
+    }
+
+    return true;
+}
+
+bool pe_image_t::load(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    std::vector<std::uint8_t> contents;
+
+    std::fseek(file, 0, SEEK_END);
+    long file_size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+
+    if (file_size > 0)
+    {
+        contents.resize(static_cast<std::size_t>(file_size));
+        contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+    }
+
+    std::fclose(file);
+
+    if (!parse_headers(contents.data(), contents.size()))
+        return false;
+
+    // Same layout as the loader, sections at their RVA and zero filled past their raw data
+    storage.assign(image_size, 0);
+
+    std::uint32_t size_of_headers = 0;
+    std::uint32_t nt_offset = 0;
+    read_at(contents.data(), contents.size(), 0x3C, nt_offset);
+    read_at(contents.data(), contents.size(), nt_offset + 4 + FILE_HEADER_SIZE + OPTIONAL_SIZE_OF_HEADERS, size_of_headers);
+    std::memcpy(storage.data(), contents.data(), std::min<std::size_t>({ size_of_headers, contents.size(), storage.size() }));
+
+    const std::uint8_t* table = contents.data() + nt_offset + 4 + FILE_HEADER_SIZE;
+    std::uint16_t optional_size;
+    std::memcpy(&optional_size, contents.data() + nt_offset + 4 + 16, sizeof(optional_size));
+    table += optional_size;
+
+    for (std::size_t i = 0; i < sections.size(); i++)
+    {
+        std::uint32_t raw_size, raw_offset;
+        std::memcpy(&raw_size, table + i * SECTION_HEADER_SIZE + 16, sizeof(raw_size));
+        std::memcpy(&raw_offset, table + i * SECTION_HEADER_SIZE + 20, sizeof(raw_offset));
+
+        const section_t& section = sections[i];
+        if (raw_offset >= contents.size() || section.rva >= storage.size())
+            continue;
+
+        std::size_t count = std::min<std::size_t>({ raw_size, section.size, contents.size() - raw_offset, storage.size() - section.rva });
+        std::memcpy(storage.data() + section.rva, contents.data() + raw_offset, count);
+    }
+
+    base = storage.data();
+
+    parse_functions();
+    parse_relocations();
+
+    return true;
+}
+
+bool pe_image_t::view(const std::uint8_t* module)
+{
+    storage.clear();
+
+    // The headers are mapped as their own page
+    if (!parse_headers(module, 0x1000))
+        return false;
+
+    base = module;
+
+    parse_functions();
+    parse_relocations();
+
+    return true;
+}
+
+const pe_image_t::section_t* pe_image_t::get_section(std::uint32_t rva) const
+{
+    for (const section_t& section : sections)
+    {
+        if (section.contains(rva))
+            return &section;
+    }
+
+    return nullptr;
+}
+
+const pe_image_t::section_t* pe_image_t::get_section(const char* name) const
+{
+    for (const section_t& section : sections)
+    {
+        if (std::strncmp(section.name, name, 8) == 0)
+            return &section;
+    }
+
+    return nullptr;
+}
+
+const pe_image_t::function_t* pe_image_t::get_function(std::uint32_t rva) const
+{
+    auto it = std::upper_bound(functions.begin(), functions.end(), rva, [](std::uint32_t value, const function_t& function) { return value < function.begin; });
+    if (it == functions.begin())
+        return nullptr;
+
+    --it;
+    return rva < it->end ? &*it : nullptr;
+}
+
+const pe_image_t::function_t* pe_image_t::get_root_function(const function_t* function) const
+{
+    // UNWIND_INFO { u8 version : 3, flags : 5; u8 prolog size; u8 code count; u8 frame; u16 codes[even count]; RUNTIME_FUNCTION chained (UNW_FLAG_CHAININFO) }
+    for (int depth = 0; function && depth < 32; depth++)
+    {
+        function_t parent;
+
+        if (function->unwind & 1)
+        {
+            // The unwind field directly points to the parent's entry
+            if (!read(function->unwind & ~1u, parent))
+                return function;
+        }
+        else
+        {
+            std::uint8_t header[4];
+            if (!read(function->unwind, header) || !(header[0] >> 3 & 4))
+                return function;
+
+            const std::uint32_t codes = (header[2] + 1u) & ~1u;
+            if (!read(function->unwind + 4 + codes * 2, parent))
+                return function;
+        }
+
+        const function_t* next = get_function(parent.begin);
+        if (!next || next == function)
+            return function;
+
+        function = next;
+    }
+
+    return function;
+}
+
+bool pe_image_t::is_relocated(std::uint32_t rva, std::size_t size) const
+{
+    // A slot covers [slot, slot + 8)
+    auto it = std::lower_bound(relocations.begin(), relocations.end(), rva >= 7 ? rva - 7 : 0);
+    return it != relocations.end() && *it < rva + size;
+}
+
+bool pe_image_t::get_directory(directory_t index, std::uint32_t& rva, std::uint32_t& size) const
+{
+    if (static_cast<std::uint32_t>(index) >= directory_count || !directories[index][0] || !directories[index][1])
+        return false;
+
+    rva = directories[index][0];
+    size = directories[index][1];
+    return is_valid(rva, size);
+}
+
+void pe_image_t::parse_functions()
+{
+    functions.clear();
+
+    std::uint32_t rva, size;
+    if (!get_directory(DIRECTORY_EXCEPTION, rva, size))
+        return;
+
+    functions.resize(size / sizeof(function_t));
+    std::memcpy(functions.data(), base + rva, functions.size() * sizeof(function_t));
+
+    // Chained entries share the parent's range, keep one entry per range
+    std::sort(functions.begin(), functions.end(), [](const function_t& a, const function_t& b) { return a.begin < b.begin; });
+    functions.erase(std::remove_if(functions.begin(), functions.end(), [this](const function_t& function) { return function.end <= function.begin || function.end > image_size; }), functions.end());
+}
+
+void pe_image_t::parse_relocations()
+{
+    relocations.clear();
+
+    std::uint32_t rva, size;
+    if (!get_directory(DIRECTORY_RELOCATION, rva, size))
+        return;
+
+    // Blocks of { u32 page, u32 block size, u16 entries[] }, entry = type << 12 | offset
+    std::uint32_t offset = 0;
+    while (offset + 8 <= size)
+    {
+        std::uint32_t page, block_size;
+        std::memcpy(&page, base + rva + offset, sizeof(page));
+        std::memcpy(&block_size, base + rva + offset + 4, sizeof(block_size));
+
+        if (block_size < 8 || offset + block_size > size)
+            break;
+
+        for (std::uint32_t entry = 8; entry + 2 <= block_size; entry += 2)
+        {
+            std::uint16_t value;
+            std::memcpy(&value, base + rva + offset + entry, sizeof(value));
+
+            if ((value >> 12) == 10) // IMAGE_REL_BASED_DIR64
+                relocations.push_back(page + (value & 0xFFF));
+        }
+
+        offset += block_size;
+    }
+
+    std::sort(relocations.begin(), relocations.end());
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * Portable PE32+ reader, doesn't need Windows.h so tools can run on any OS
+ *
+ * load maps a file from disk the way the loader would (sections at their RVA, no relocations applied),
+ * view wraps a module already mapped in this process, both give the same RVA based accessors
+*/
+class pe_image_t {
+public:
+	struct section_t {
+		char name[9];
+		std::uint32_t rva;
+		std::uint32_t size;
+		std::uint32_t characteristics;
+
+		bool is_executable() const { return characteristics & (0x20000000 | 0x20); } // MEM_EXECUTE | CNT_CODE
+		bool is_writable() const { return characteristics & 0x80000000; }
+		bool contains(std::uint32_t offset) const { return offset >= rva && offset - rva < size; }
+	};
+
+	// RUNTIME_FUNCTION from .pdata
+	struct function_t {
+		std::uint32_t begin;
+		std::uint32_t end;
+		std::uint32_t unwind;
+	};
+
+	enum directory_t {
+		DIRECTORY_EXPORT = 0,
+		DIRECTORY_IMPORT = 1,
+		DIRECTORY_EXCEPTION = 3,
+		DIRECTORY_RELOCATION = 5
+	};
+
+public:
+	bool load(const std::string& path);
+	bool view(const std::uint8_t* base);
+
+	const std::uint8_t* data() const { return base; }
+	std::size_t size() const { return image_size; }
+	std::uint64_t get_image_base() const { return image_base; }
+	// Absolute pointers inside the image are this + rva (the preferred base for a file, where it's mapped for a view)
+	std::uint64_t get_pointer_base() const { return storage.empty() ? reinterpret_cast<std::uintptr_t>(base) : image_base; }
+	std::uint16_t get_machine() const { return machine; }
+
+	const std::vector<section_t>& get_sections() const { return sections; }
+	const section_t* get_section(std::uint32_t rva) const;
+	const section_t* get_section(const char* name) const;
+
+	// Sorted by begin, empty if the image has no exception directory
+	const std::vector<function_t>& get_functions() const { return functions; }
+	const function_t* get_function(std::uint32_t rva) const;
+	// Follows chained unwind info to the entry holding the prologue, cold / split parts of a function chain to it
+	const function_t* get_root_function(const function_t* function) const;
+
+	// Sorted RVAs of the 8 byte slots the loader patches (IMAGE_REL_BASED_DIR64)
+	const std::vector<std::uint32_t>& get_relocations() const { return relocations; }
+	bool is_relocated(std::uint32_t rva, std::size_t size) const;
+
+	bool get_directory(directory_t index, std::uint32_t& rva, std::uint32_t& size) const;
+
+	bool is_valid(std::uint32_t rva, std::size_t size) const { return rva <= image_size && size <= image_size - rva; }
+
+	template <typename T>
+	const T* at(std::uint32_t rva) const
+	{
+		return is_valid(rva, sizeof(T)) ? reinterpret_cast<const T*>(base + rva) : nullptr;
+	}
+
+	template <typename T>
+	bool read(std::uint32_t rva, T& out) const
+	{
+		if (!is_valid(rva, sizeof(T)))
+			return false;
+
+		std::memcpy(&out, base + rva, sizeof(T));
+		return true;
+	}
+
+	std::uint32_t to_rva(std::uint64_t address) const { return static_cast<std::uint32_t>(address - image_base); }
+
+private:
+	bool parse_headers(const std::uint8_t* headers, std::size_t available);
+	void parse_functions();
+	void parse_relocations();
+
+private:
+	std::vector<std::uint8_t> storage; // Mapped file, empty for a view
+	const std::uint8_t* base = nullptr;
+	std::size_t image_size = 0;
+	std::uint64_t image_base = 0;
+	std::uint16_t machine = 0;
+
+	std::uint32_t directories[16][2] = {};
+	std::uint32_t directory_count = 0;
+
+	std::vector<section_t> sections;
+	std::vector<function_t> functions;
+	std::vector<std::uint32_t> relocations;
+};
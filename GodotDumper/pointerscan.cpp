@@ -0,0 +1,586 @@
+#include "pointerscan.h"
+#include "profiler.h"
+#include "varint.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+bool pointer_path_t::operator<(const pointer_path_t& other) const
+{
+    if (module != other.module)
+        return module < other.module;
+
+    if (rva != other.rva)
+        return rva < other.rva;
+
+    if (level != other.level)
+        return level < other.level;
+
+    return std::lexicographical_compare(offsets, offsets + level, other.offsets, other.offsets + other.level);
+}
+
+void pointer_map_t::build(const memory_snapshot_t& snapshot, work_pool_t& pool)
+{
+    PROFILE_SCOPE("pointer_map_t::build");
+
+    static constexpr std::size_t CHUNK_SIZE = 1 << 22;
+
+    entries.clear();
+
+    const std::vector<memory_snapshot_t::region_t>& regions = snapshot.get_regions();
+    if (regions.empty())
+        return;
+
+    const std::uint64_t low = regions.front().base;
+    const std::uint64_t high = regions.back().base + regions.back().size;
+
+    // Every worker collects into its own list, then a sample sort puts them together
+    std::vector<std::vector<entry_t>> found(pool.get_worker_count());
+
+    for (const memory_snapshot_t::region_t& region : regions)
+    {
+        for (std::uint64_t offset = 0; offset < region.size; offset += CHUNK_SIZE)
+        {
+            pool.submit([&, offset]()
+            {
+                std::vector<entry_t>& out = found[work_pool_t::get_worker_index()];
+
+                const std::uint8_t* data = snapshot.get_data(region) + offset;
+                const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(CHUNK_SIZE, region.size - offset) / sizeof(std::uint64_t));
+
+                // Neighbouring pointers usually land in the same region, check that one before searching
+                const memory_snapshot_t::region_t* last = &region;
+
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    std::uint64_t value;
+                    std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+
+                    if (value < low || value >= high || (value & 7))
+                        continue;
+
+                    if (!last->contains(value))
+                    {
+                        const memory_snapshot_t::region_t* target = snapshot.get_region(value);
+                        if (!target)
+                            continue;
+
+                        last = target;
+                    }
+
+                    out.push_back({ value, region.base + offset + i * sizeof(value) });
+                }
+            });
+        }
+    }
+
+    pool.wait();
+
+    std::size_t total = 0;
+    for (const std::vector<entry_t>& list : found)
+        total += list.size();
+
+    if (total == 0)
+        return;
+
+    // Splitters from an even sample of every list, then each bucket is sorted on its own
+    const std::size_t bucket_count = pool.get_worker_count() * 4;
+
+    std::vector<std::uint64_t> sample;
+    for (const std::vector<entry_t>& list : found)
+    {
+        const std::size_t step = std::max<std::size_t>(1, list.size() / (bucket_count * 16));
+        for (std::size_t i = 0; i < list.size(); i += step)
+            sample.push_back(list[i].value);
+    }
+
+    std::sort(sample.begin(), sample.end());
+
+    std::vector<std::uint64_t> splitters;
+    for (std::size_t i = 1; i < bucket_count; i++)
+        splitters.push_back(sample[i * sample.size() / bucket_count]);
+
+    auto bucket_of = [&](std::uint64_t value) { return static_cast<std::size_t>(std::upper_bound(splitters.begin(), splitters.end(), value) - splitters.begin()); };
+
+    // counts[list][bucket], turned into write positions
+    std::vector<std::vector<std::size_t>> counts(found.size(), std::vector<std::size_t>(bucket_count, 0));
+
+    for (std::size_t list = 0; list < found.size(); list++)
+    {
+        pool.submit([&, list]()
+        {
+            for (const entry_t& entry : found[list])
+                counts[list][bucket_of(entry.value)]++;
+        });
+    }
+
+    pool.wait();
+
+    std::vector<std::size_t> bucket_start(bucket_count + 1, 0);
+    std::size_t position = 0;
+
+    for (std::size_t bucket = 0; bucket < bucket_count; bucket++)
+    {
+        bucket_start[bucket] = position;
+
+        for (std::size_t list = 0; list < found.size(); list++)
+        {
+            const std::size_t size = counts[list][bucket];
+            counts[list][bucket] = position;
+            position += size;
+        }
+    }
+
+    bucket_start[bucket_count] = position;
+    entries.resize(total);
+
+    for (std::size_t list = 0; list < found.size(); list++)
+    {
+        pool.submit([&, list]()
+        {
+            for (const entry_t& entry : found[list])
+                entries[counts[list][bucket_of(entry.value)]++] = entry;
+
+            std::vector<entry_t>().swap(found[list]);
+        });
+    }
+
+    pool.wait();
+
+    for (std::size_t bucket = 0; bucket < bucket_count; bucket++)
+    {
+        pool.submit([&, bucket]()
+        {
+            std::sort(entries.begin() + bucket_start[bucket], entries.begin() + bucket_start[bucket + 1], [](const entry_t& a, const entry_t& b)
+            {
+                return a.value != b.value ? a.value < b.value : a.address < b.address;
+            });
+        });
+    }
+
+    pool.wait();
+}
+
+std::span<const pointer_map_t::entry_t> pointer_map_t::find(std::uint64_t low, std::uint64_t high) const
+{
+    auto begin = std::lower_bound(entries.begin(), entries.end(), low, [](const entry_t& entry, std::uint64_t value) { return entry.value < value; });
+    auto end = std::upper_bound(begin, entries.end(), high, [](std::uint64_t value, const entry_t& entry) { return value < entry.value; });
+
+    return { entries.data() + (begin - entries.begin()), static_cast<std::size_t>(end - begin) };
+}
+
+void pointer_path_set_t::encode(std::vector<std::uint8_t>& out, const pointer_path_t& path, const pointer_path_t& previous)
+{
+    // Module delta first, the rva is only delta coded inside the same module
+    write_varint(out, path.module - previous.module);
+    write_varint(out, path.module == previous.module ? path.rva - previous.rva : path.rva);
+    write_varint(out, path.level);
+
+    for (std::uint32_t i = 0; i < path.level; i++)
+        write_varint(out, path.offsets[i]);
+}
+
+void pointer_path_set_t::decode(const std::uint8_t*& it, const std::uint8_t* end, pointer_path_t& path)
+{
+    const std::uint32_t module_delta = static_cast<std::uint32_t>(read_varint(it, end));
+    const std::uint32_t rva = static_cast<std::uint32_t>(read_varint(it, end));
+
+    path.rva = module_delta ? rva : path.rva + rva;
+    path.module += module_delta;
+    path.level = std::min<std::uint32_t>(static_cast<std::uint32_t>(read_varint(it, end)), pointer_path_t::MAX_LEVEL);
+
+    for (std::uint32_t i = 0; i < path.level; i++)
+        path.offsets[i] = static_cast<std::uint32_t>(read_varint(it, end));
+}
+
+void pointer_path_set_t::add(std::vector<pointer_path_t>& paths)
+{
+    if (paths.empty())
+        return;
+
+    std::sort(paths.begin(), paths.end());
+
+    block_t block;
+    block.count = static_cast<std::uint32_t>(paths.size());
+
+    pointer_path_t previous;
+    for (const pointer_path_t& path : paths)
+    {
+        encode(block.data, path, previous);
+        previous = path;
+    }
+
+    block.data.shrink_to_fit();
+
+    std::lock_guard<std::mutex> guard(lock);
+    count += block.count;
+    blocks.push_back(std::move(block));
+}
+
+bool pointer_path_set_t::resolve(const memory_snapshot_t& snapshot, const pointer_path_t& path, std::uint64_t& out) const
+{
+    if (path.module >= modules.size())
+        return false;
+
+    const memory_snapshot_t::module_t* module = snapshot.get_module(modules[path.module]);
+    if (!module)
+        return false;
+
+    std::uint64_t address = module->base + path.rva;
+    for (std::uint32_t i = 0; i < path.level; i++)
+    {
+        if (!snapshot.read(address, address))
+            return false;
+
+        address += path.offsets[i];
+    }
+
+    out = address;
+    return true;
+}
+
+std::size_t pointer_path_set_t::rescan(const memory_snapshot_t& snapshot, std::uint64_t target, work_pool_t& pool)
+{
+    PROFILE_SCOPE("pointer_path_set_t::rescan");
+
+    std::vector<block_t> kept(blocks.size());
+
+    for (std::size_t i = 0; i < blocks.size(); i++)
+    {
+        pool.submit([&, i]()
+        {
+            const std::uint8_t* it = blocks[i].data.data();
+            const std::uint8_t* end = it + blocks[i].data.size();
+
+            pointer_path_t path, previous;
+            for (std::uint32_t j = 0; j < blocks[i].count; j++)
+            {
+                decode(it, end, path);
+
+                std::uint64_t address;
+                if (!resolve(snapshot, path, address) || address != target)
+                    continue;
+
+                // Still sorted, the block can be encoded again as is
+                encode(kept[i].data, path, previous);
+                previous = path;
+                kept[i].count++;
+            }
+
+            kept[i].data.shrink_to_fit();
+        });
+    }
+
+    pool.wait();
+
+    blocks.clear();
+    count = 0;
+
+    for (block_t& block : kept)
+    {
+        if (block.count == 0)
+            continue;
+
+        count += block.count;
+        blocks.push_back(std::move(block));
+    }
+
+    return count;
+}
+
+std::string pointer_path_set_t::to_string(const pointer_path_t& path) const
+{
+    std::string result = path.module < modules.size() ? modules[path.module] : "?";
+
+    char number[16];
+    std::snprintf(number, sizeof(number), "+%X", path.rva);
+    result += number;
+
+    for (std::uint32_t i = 0; i < path.level; i++)
+    {
+        std::snprintf(number, sizeof(number), " -> %X", path.offsets[i]);
+        result += number;
+    }
+
+    return result;
+}
+
+std::size_t pointer_path_set_t::get_compressed_size() const
+{
+    std::size_t size = 0;
+    for (const block_t& block : blocks)
+        size += block.data.size();
+
+    return size;
+}
+
+void pointer_path_set_t::clear()
+{
+    modules.clear();
+    blocks.clear();
+    count = 0;
+}
+
+bool pointer_path_set_t::save(const std::string& path) const
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = true;
+    auto write = [&](const void* data, std::size_t size) { ok &= std::fwrite(data, 1, size, file) == size; };
+
+    const std::uint32_t header[4] = { FILE_MAGIC, VERSION, static_cast<std::uint32_t>(modules.size()), static_cast<std::uint32_t>(blocks.size()) };
+    write(header, sizeof(header));
+
+    for (const std::string& module : modules)
+    {
+        const std::uint16_t length = static_cast<std::uint16_t>(std::min<std::size_t>(module.size(), UINT16_MAX));
+        write(&length, sizeof(length));
+        write(module.data(), length);
+    }
+
+    for (const block_t& block : blocks)
+    {
+        const std::uint32_t sizes[2] = { block.count, static_cast<std::uint32_t>(block.data.size()) };
+        write(sizes, sizeof(sizes));
+        write(block.data.data(), block.data.size());
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+bool pointer_path_set_t::load(const std::string& path)
+{
+    clear();
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    auto read = [&](void* data, std::size_t size) { return std::fread(data, 1, size, file) == size; };
+
+    std::uint32_t header[4];
+    bool ok = read(header, sizeof(header)) && header[0] == FILE_MAGIC && header[1] == VERSION;
+
+    for (std::uint32_t i = 0; ok && i < header[2]; i++)
+    {
+        std::uint16_t length = 0;
+        ok = read(&length, sizeof(length));
+
+        std::string module(length, '\0');
+        ok = ok && read(module.data(), length);
+
+        modules.push_back(std::move(module));
+    }
+
+    for (std::uint32_t i = 0; ok && i < header[3]; i++)
+    {
+        std::uint32_t sizes[2];
+        ok = read(sizes, sizeof(sizes));
+
+        block_t block;
+        block.count = ok ? sizes[0] : 0;
+        block.data.resize(ok ? sizes[1] : 0);
+        ok = ok && read(block.data.data(), block.data.size());
+
+        count += block.count;
+        blocks.push_back(std::move(block));
+    }
+
+    std::fclose(file);
+
+    if (!ok)
+        clear();
+
+    return ok;
+}
+
+bool pointer_scanner_t::scan(const memory_snapshot_t& snapshot, const pointer_map_t& map, std::uint64_t target, const options_t& options, work_pool_t& pool, pointer_path_set_t& out)
+{
+    PROFILE_SCOPE("pointer_scanner_t::scan");
+
+    out.clear();
+
+    // Chains start in the executable's (or every module's) static data
+    const std::vector<memory_snapshot_t::module_t>& modules = snapshot.get_modules();
+    const std::size_t static_modules = options.all_modules ? modules.size() : std::min<std::size_t>(modules.size(), 1);
+
+    for (std::size_t i = 0; i < static_modules; i++)
+        out.modules.push_back(modules[i].name);
+
+    auto find_static = [&](std::uint64_t address, pointer_path_t& path) -> bool
+    {
+        for (std::size_t i = 0; i < static_modules; i++)
+        {
+            if (!modules[i].contains(address))
+                continue;
+
+            const memory_snapshot_t::region_t* region = snapshot.get_region(address);
+            if (!region || !(region->flags & memory_snapshot_t::REGION_IMAGE))
+                return false;
+
+            path.module = static_cast<std::uint32_t>(i);
+            path.rva = static_cast<std::uint32_t>(address - modules[i].base);
+            return true;
+        }
+
+        return false;
+    };
+
+    // Offsets are found from the target backwards, found[0] is the last one of the chain
+    struct state_t {
+        std::uint64_t target;
+        std::uint32_t depth;
+        std::uint32_t found[pointer_path_t::MAX_LEVEL];
+        std::uint64_t visited[pointer_path_t::MAX_LEVEL]; // Addresses already on the chain, a cycle would only repeat itself
+    };
+
+    const std::uint32_t max_level = std::min<std::uint32_t>(options.max_level, pointer_path_t::MAX_LEVEL);
+
+    std::vector<std::vector<pointer_path_t>> pending(pool.get_worker_count());
+    std::atomic<std::size_t> result_count = 0;
+    std::atomic<bool> stop = false;
+
+    auto emit = [&](const state_t& state, const pointer_path_t& base, std::uint32_t offset)
+    {
+        pointer_path_t path = base;
+        path.level = state.depth + 1;
+        path.offsets[0] = offset;
+
+        for (std::uint32_t i = 0; i < state.depth; i++)
+            path.offsets[i + 1] = state.found[state.depth - 1 - i];
+
+        std::vector<pointer_path_t>& list = pending[work_pool_t::get_worker_index()];
+        list.push_back(path);
+
+        if (list.size() >= pointer_path_set_t::BLOCK_PATHS)
+        {
+            out.add(list);
+            list.clear();
+        }
+
+        if (result_count.fetch_add(1, std::memory_order_relaxed) + 1 >= options.max_results)
+            stop.store(true, std::memory_order_relaxed);
+    };
+
+    std::function<void(const state_t&)> visit = [&](const state_t& state)
+    {
+        if (stop.load(std::memory_order_relaxed))
+            return;
+
+        const std::uint64_t low = state.target >= options.max_offset ? state.target - options.max_offset : 0;
+
+        for (const pointer_map_t::entry_t& entry : map.find(low, state.target))
+        {
+            const std::uint32_t offset = static_cast<std::uint32_t>(state.target - entry.value);
+
+            if (std::find(state.visited, state.visited + state.depth, entry.address) != state.visited + state.depth)
+                continue;
+
+            pointer_path_t path;
+            if (find_static(entry.address, path))
+            {
+                emit(state, path, offset);
+                continue;
+            }
+
+            if (state.depth + 1 >= max_level)
+                continue;
+
+            state_t child = state;
+            child.target = entry.address;
+            child.found[state.depth] = offset;
+            child.visited[state.depth] = entry.address;
+            child.depth++;
+
+            // Split while some worker is idle, otherwise keep going depth first on this one
+            if (pool.wants_work())
+                pool.submit([&visit, child]() { visit(child); });
+            else
+                visit(child);
+
+            if (stop.load(std::memory_order_relaxed))
+                return;
+        }
+    };
+
+    state_t root = {};
+    root.target = target;
+
+    pool.submit([&visit, root]() { visit(root); });
+    pool.wait();
+
+    for (std::vector<pointer_path_t>& list : pending)
+        out.add(list);
+
+    return out.size() != 0;
+}
+
+pointer_scan_job_t::~pointer_scan_job_t()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+bool pointer_scan_job_t::start(std::uint64_t target, bool rescan)
+{
+    if (is_running())
+        return false;
+
+    if (thread.joinable())
+        thread.join();
+
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&pointer_scan_job_t::run, this, target, rescan);
+    return true;
+}
+
+void pointer_scan_job_t::run(std::uint64_t target, bool rescan)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto seconds = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+
+    char line[128];
+
+    memory_snapshot_t snapshot;
+    work_pool_t pool;
+
+    if (!snapshot.capture())
+        status = "Couldn't capture the process' memory";
+    else if (rescan)
+    {
+        if (results.size() == 0 && !results.load(RESULTS_PATH))
+            status = std::string("Nothing to rescan, couldn't read ") + RESULTS_PATH;
+        else
+        {
+            const std::size_t before = results.size();
+            results.rescan(snapshot, target, pool);
+            results.save(RESULTS_PATH);
+
+            std::snprintf(line, sizeof(line), "%zu of %zu paths still lead to the node (%.1f s)", results.size(), before, seconds());
+            status = line;
+        }
+    }
+    else
+    {
+        pointer_map_t map;
+        map.build(snapshot, pool);
+
+        pointer_scanner_t::scan(snapshot, map, target, options, pool, results);
+        results.save(RESULTS_PATH);
+
+        std::snprintf(line, sizeof(line), "%zu paths, %zu pointers in %.0f MB (%.1f s)", results.size(), map.size(), snapshot.get_size() / (1024.0 * 1024.0), seconds());
+        status = line;
+    }
+
+    preview.clear();
+    results.for_each([&](const pointer_path_t& path)
+    {
+        if (preview.size() < PREVIEW_PATHS)
+            preview.push_back(results.to_string(path));
+    });
+
+    running.store(false, std::memory_order_release);
+}
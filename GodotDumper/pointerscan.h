@@ -0,0 +1,175 @@
+#pragma once
+#include "snapshot.h"
+#include "work_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Pointer path scanner, finds chains like [[[game.exe + rva] + a] + b] + c that end on a target address
+ *
+ * Scanning goes backwards from the target: the reverse pointer map gives every pointer whose value is at most
+ * max_offset below the current address, a pointer stored in a module's static data ends a chain, any other one
+ * becomes the next address to look for, up to max_level dereferences
+ *
+ * Pointer addresses change every run but a chain from a static address doesn't, rescanning a result set against a
+ * new snapshot keeps the chains that still reach the (new) target address, a couple of rescans leave the stable ones
+*/
+struct pointer_path_t {
+	static constexpr std::uint32_t MAX_LEVEL = 8;
+
+	std::uint32_t module = 0; // Into the set's modules
+	std::uint32_t rva = 0;
+	std::uint32_t level = 0; // Dereferences
+	std::uint32_t offsets[MAX_LEVEL] = {}; // offsets[i] is added after the i-th dereference
+
+	bool operator<(const pointer_path_t& other) const;
+};
+
+// Every pointer sized, pointer aligned value of a snapshot that points into it, sorted by that value
+class pointer_map_t {
+public:
+	struct entry_t {
+		std::uint64_t value;
+		std::uint64_t address; // Where the pointer is stored
+	};
+
+	void build(const memory_snapshot_t& snapshot, work_pool_t& pool);
+
+	// Pointers with a value in [low, high]
+	std::span<const entry_t> find(std::uint64_t low, std::uint64_t high) const;
+
+	std::size_t size() const { return entries.size(); }
+
+private:
+	std::vector<entry_t> entries;
+};
+
+/*
+ * Paths are kept in blocks of up to BLOCK_PATHS, sorted and varint encoded with the rva delta coded
+ * against the previous path, 12 to 17 bytes for 5 to 7 level paths instead of 44
+ *
+ * File layout:
+ *
+ * header  { u32 magic, u32 version, u32 module_count, u32 block_count }
+ * modules { u16 length, chars } * module_count
+ * blocks  { u32 path count, u32 size, bytes } * block_count
+*/
+class pointer_path_set_t {
+public:
+	static constexpr std::uint32_t FILE_MAGIC = 'G' | 'D' << 8 | 'P' << 16 | 'S' << 24;
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::size_t BLOCK_PATHS = 4096;
+
+	std::vector<std::string> modules;
+
+public:
+	// Sorts paths and appends them as one block, safe to call from several threads
+	void add(std::vector<pointer_path_t>& paths);
+
+	template <typename F>
+	void for_each(F&& f) const
+	{
+		pointer_path_t path;
+
+		for (const block_t& block : blocks)
+		{
+			const std::uint8_t* it = block.data.data();
+			const std::uint8_t* end = it + block.data.size();
+
+			path = {};
+			for (std::uint32_t i = 0; i < block.count; i++)
+			{
+				decode(it, end, path);
+				f(path);
+			}
+		}
+	}
+
+	// Keeps the paths that end on target in snapshot, modules are matched by name
+	std::size_t rescan(const memory_snapshot_t& snapshot, std::uint64_t target, work_pool_t& pool);
+
+	// Follows path in snapshot, false if a pointer on the way wasn't captured
+	bool resolve(const memory_snapshot_t& snapshot, const pointer_path_t& path, std::uint64_t& out) const;
+
+	// game.exe+3A1F28 -> 10 -> 2B8
+	std::string to_string(const pointer_path_t& path) const;
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+
+	void clear();
+
+	std::size_t size() const { return count; }
+	std::size_t get_compressed_size() const;
+
+private:
+	struct block_t {
+		std::uint32_t count = 0;
+		std::vector<std::uint8_t> data;
+	};
+
+	static void encode(std::vector<std::uint8_t>& out, const pointer_path_t& path, const pointer_path_t& previous);
+	static void decode(const std::uint8_t*& it, const std::uint8_t* end, pointer_path_t& path);
+
+private:
+	std::vector<block_t> blocks;
+	std::size_t count = 0;
+	std::mutex lock;
+};
+
+class pointer_scanner_t {
+public:
+	struct options_t {
+		std::uint32_t max_level = 5;
+		std::uint32_t max_offset = 0x1000;
+		std::size_t max_results = 1000000;
+		bool all_modules = false; // Otherwise only the executable's statics start a chain
+	};
+
+	// Fills out with the paths from static addresses to target
+	static bool scan(const memory_snapshot_t& snapshot, const pointer_map_t& map, std::uint64_t target, const options_t& options, work_pool_t& pool, pointer_path_set_t& out);
+};
+
+/*
+ * In-process scan of the running game, snapshot, map and scan run on their own thread
+ * Results are kept in memory and in pointer_scan.gdps so they survive a restart of the game for rescans
+*/
+class pointer_scan_job_t {
+public:
+	static constexpr const char* RESULTS_PATH = "pointer_scan.gdps";
+	static constexpr std::size_t PREVIEW_PATHS = 10;
+
+	pointer_scanner_t::options_t options;
+
+public:
+	~pointer_scan_job_t();
+
+	// New scan for target, or a rescan of the previous results (loaded from disk if there are none in memory)
+	bool start(std::uint64_t target, bool rescan);
+
+	bool is_running() const { return running.load(std::memory_order_acquire); }
+
+	// Only valid while not running
+	const pointer_path_set_t& get_results() const { return results; }
+	const std::string& get_status() const { return status; }
+	const std::vector<std::string>& get_preview() const { return preview; } // First paths as text
+
+private:
+	void run(std::uint64_t target, bool rescan);
+
+private:
+	pointer_path_set_t results;
+	std::string status = "No scan yet";
+	std::vector<std::string> preview;
+
+	std::atomic<bool> running = false;
+	std::thread thread;
+};
+
+inline std::unique_ptr<pointer_scan_job_t> pointer_scan = std::make_unique<pointer_scan_job_t>();
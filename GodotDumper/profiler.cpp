@@ -0,0 +1,251 @@
+#ifdef ENABLE_PROFILER
+#include "profiler.h"
+#include <imgui/imgui.h>
+#include <imgui/imgui_notify.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <format>
+
+profiler_t::thread_buffer_t& profiler_t::get_thread_buffer()
+{
+    static thread_local thread_buffer_t* buffer = nullptr;
+
+    if (!buffer)
+    {
+        std::lock_guard lock(threads_mutex);
+
+        threads.push_back(std::make_unique<thread_buffer_t>());
+        buffer = threads.back().get();
+        buffer->thread = static_cast<std::uint32_t>(threads.size());
+    }
+
+    return *buffer;
+}
+
+void profiler_t::drain()
+{
+    static std::vector<event_t> events(1 << 15);
+
+    clock.calibrate();
+
+    std::lock_guard lock(threads_mutex);
+
+    for (std::unique_ptr<thread_buffer_t>& buffer : threads)
+    {
+        std::size_t count;
+        while ((count = buffer->ring.pop(events.data(), events.size())) != 0)
+        {
+            if (paused)
+                continue;
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                event_t& event = events[i];
+                event.start = clock.to_ns(event.start);
+                event.end = clock.to_ns(event.end);
+                history.push_back(event);
+
+                stats_t& entry = stats[event.name];
+                float duration = static_cast<float>(event.end - event.start) * 1e-3f;
+
+                if (entry.durations.size() < SAMPLES)
+                    entry.durations.push_back(duration);
+                else
+                    entry.durations[entry.next] = duration;
+
+                entry.next = (entry.next + 1) % SAMPLES;
+            }
+        }
+    }
+}
+
+void profiler_t::frame_mark()
+{
+    main_thread = get_thread_buffer().thread;
+
+    drain();
+
+    if (paused)
+        return;
+
+    std::int64_t time = tsc_clock_t::now();
+    frames.push_back(time);
+
+    const std::int64_t oldest = time - static_cast<std::int64_t>(history_seconds * 1e9);
+
+    while (!history.empty() && history.front().end < oldest)
+        history.pop_front();
+
+    while (frames.size() > 2 && frames.front() < oldest)
+        frames.pop_front();
+}
+
+static ImU32 color_of(const char* name)
+{
+    // Stable color per scope, the name pointer is unique per literal
+    std::uint32_t hash = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(name) * 2654435761u);
+    return ImColor::HSV((hash % 360) / 360.f, 0.5f, 0.8f);
+}
+
+void profiler_t::draw()
+{
+    ImGui::SetNextWindowSize({ 600, 400 }, ImGuiCond_FirstUseEver);
+    ImGui::Begin("Profiler");
+
+    ImGui::Checkbox("Pause", &paused);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Export trace"))
+    {
+        std::string path = std::format("profile_{}.json", tsc_clock_t::now());
+        if (export_chrome_trace(path))
+            ImGui::InsertNotification({ ImGuiToastType_Success, 3000, "Saved %s", path.c_str() });
+        else
+            ImGui::InsertNotification({ ImGuiToastType_Error, 3000, "Couldn't write %s", path.c_str() });
+    }
+
+    std::uint64_t dropped = 0;
+    {
+        std::lock_guard lock(threads_mutex);
+        for (const std::unique_ptr<thread_buffer_t>& buffer : threads)
+            dropped += buffer->dropped;
+    }
+
+    if (dropped)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%llu events dropped)", static_cast<unsigned long long>(dropped));
+    }
+
+    // Flame graph of the last complete frame of the main thread
+    if (frames.size() >= 2)
+    {
+        const std::int64_t f0 = frames[frames.size() - 2];
+        const std::int64_t f1 = frames[frames.size() - 1];
+
+        ImGui::Text("Frame: %.3f ms", (f1 - f0) * 1e-6);
+
+        const float row = ImGui::GetTextLineHeight() + 4.f;
+        const float width = ImGui::GetContentRegionAvail().x;
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+        std::uint32_t max_depth = 0;
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+        for (const event_t& event : history)
+        {
+            if (event.thread != main_thread || event.start < f0 || event.end > f1)
+                continue;
+
+            max_depth = std::max(max_depth, event.depth + 1);
+
+            const float x0 = origin.x + static_cast<float>(event.start - f0) / static_cast<float>(f1 - f0) * width;
+            const float x1 = std::max(x0 + 1.f, origin.x + static_cast<float>(event.end - f0) / static_cast<float>(f1 - f0) * width);
+            const float y0 = origin.y + event.depth * row;
+
+            draw_list->AddRectFilled({ x0, y0 }, { x1, y0 + row - 1.f }, color_of(event.name));
+
+            if (x1 - x0 > ImGui::CalcTextSize(event.name).x + 4.f)
+                draw_list->AddText({ x0 + 2.f, y0 + 2.f }, IM_COL32_BLACK, event.name);
+
+            if (ImGui::IsMouseHoveringRect({ x0, y0 }, { x1, y0 + row }))
+                ImGui::SetTooltip("%s: %.3f us", event.name, (event.end - event.start) * 1e-3);
+        }
+
+        ImGui::Dummy({ width, std::max(max_depth, 1u) * row });
+    }
+
+    ImGui::Separator();
+
+    if (ImGui::BeginTable("##profile_stats", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+    {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Samples");
+        ImGui::TableSetupColumn("p50 (us)");
+        ImGui::TableSetupColumn("p90 (us)");
+        ImGui::TableSetupColumn("p99 (us)");
+        ImGui::TableSetupColumn("Max (us)");
+        ImGui::TableHeadersRow();
+
+        static std::vector<float> sorted;
+
+        for (const auto& [name, entry] : stats)
+        {
+            sorted = entry.durations;
+            std::sort(sorted.begin(), sorted.end());
+
+            auto percentile = [](float p) { return sorted.empty() ? 0.f : sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * sorted.size()))]; };
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            bool open = ImGui::TreeNodeEx(name, ImGuiTreeNodeFlags_SpanFullWidth);
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", sorted.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", percentile(0.5f));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", percentile(0.9f));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", percentile(0.99f));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", sorted.empty() ? 0.f : sorted.back());
+
+            if (open)
+            {
+                // Histogram of the kept samples, 32 buckets up to the max
+                float buckets[32] = {};
+                float max = sorted.empty() ? 1.f : std::max(sorted.back(), 1e-3f);
+
+                for (float duration : sorted)
+                    buckets[std::min(31, static_cast<int>(duration / max * 32.f))] += 1.f;
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::PlotHistogram("##histogram", buckets, 32, 0, nullptr, 0.f, FLT_MAX, { 0.f, 60.f });
+                ImGui::TreePop();
+            }
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+bool profiler_t::export_chrome_trace(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    const std::int64_t base = history.empty() ? 0 : history.front().start;
+
+    // Complete events ("X") with microsecond timestamps, plus an instant event per frame mark
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    for (const event_t& event : history)
+    {
+        std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", first ? "" : ",\n",
+            event.name, event.thread, (event.start - base) * 1e-3, (event.end - event.start) * 1e-3);
+        first = false;
+    }
+
+    for (std::int64_t frame : frames)
+    {
+        if (frame < base)
+            continue;
+
+        std::fprintf(file, "%s{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", first ? "" : ",\n", main_thread, (frame - base) * 1e-3);
+        first = false;
+    }
+
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+
+    return true;
+}
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+/*
+ * Scoped frame profiler
+ *
+ * Define ENABLE_PROFILER in the preprocessor definitions (Debug does) to record PROFILE_SCOPE regions,
+ * otherwise the macros expand to nothing and none of this is compiled
+ *
+ * Every thread writes its events into its own SPSC ring, PROFILE_FRAME (once per overlay frame)
+ * drains them into a short history used by the flame graph, the percentiles and the Chrome trace export
+*/
+#ifdef ENABLE_PROFILER
+#include "memory.h"
+#include "ring.h"
+#include "tsc.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class profiler_t {
+public:
+	struct event_t {
+		const char* name; // Must be a string literal, only the pointer is stored
+		std::int64_t start; // TSC ticks in the thread rings, nanoseconds once drained
+		std::int64_t end;
+		std::uint32_t depth;
+		std::uint32_t thread;
+	};
+
+	struct thread_buffer_t {
+		spsc_ring_t<event_t, 1 << 15> ring;
+		std::uint32_t thread = 0;
+		std::uint32_t depth = 0;
+		std::uint64_t dropped = 0;
+	};
+
+	float history_seconds = 2.f; // Kept for the trace export
+
+public:
+
+	// Lazily registers the calling thread
+	thread_buffer_t& get_thread_buffer();
+
+	// Call once per overlay frame on the main thread
+	void frame_mark();
+
+	void draw();
+
+	bool export_chrome_trace(const std::string& path);
+
+private:
+	struct stats_t {
+		std::vector<float> durations; // Microseconds, ring of the last SAMPLES
+		std::size_t next = 0;
+	};
+
+	static constexpr std::size_t SAMPLES = 512;
+
+	void drain();
+
+private:
+	tsc_clock_t clock;
+
+	std::mutex threads_mutex;
+	std::vector<std::unique_ptr<thread_buffer_t>> threads;
+
+	std::deque<event_t> history;
+	std::deque<std::int64_t> frames; // Frame mark timestamps
+	std::uint32_t main_thread = 0;
+
+	std::unordered_map<const char*, stats_t> stats;
+
+	bool paused = false;
+};
+
+inline std::unique_ptr<profiler_t> profiler = std::make_unique<profiler_t>();
+
+class profile_scope_t {
+public:
+	__forceinline profile_scope_t(const char* name) : buffer(profiler->get_thread_buffer()), name(name), start(tsc_clock_t::ticks())
+	{
+		buffer.depth++;
+	}
+
+	__forceinline ~profile_scope_t()
+	{
+		buffer.depth--;
+
+		if (!buffer.ring.push({ name, start, tsc_clock_t::ticks(), buffer.depth, buffer.thread }))
+			buffer.dropped++;
+	}
+
+private:
+	profiler_t::thread_buffer_t& buffer;
+	const char* name;
+	std::int64_t start;
+};
+
+#define PROFILE_SCOPE(NAME) profile_scope_t CONCATENATE(profile_scope_, __COUNTER__)(NAME)
+#define PROFILE_FRAME() profiler->frame_mark()
+#else
+#define PROFILE_SCOPE(NAME) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
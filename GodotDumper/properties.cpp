@@ -0,0 +1,218 @@
+#include "properties.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+struct property_info_t
+{
+    const char* name;
+    std::uint32_t gd::layout_t::* offset;
+    property_reader_t::field_t field;
+};
+
+struct class_info_t
+{
+    const char* name;
+    const char* parent;
+    std::vector<property_info_t> properties;
+};
+
+using field_t = property_reader_t::field_t;
+
+// Only the fields present in gd::layout_t, add the offset there first to expose a new property
+static const class_info_t classes[] = {
+    {
+        "Node", nullptr,
+        {
+            { "name", &gd::layout_t::node_name, field_t::STRING_NAME },
+            { "scene_file_path", &gd::layout_t::node_scene_file_path, field_t::STRING },
+            { "parent", &gd::layout_t::node_parent, field_t::OBJECT },
+            { "owner", &gd::layout_t::node_owner, field_t::OBJECT },
+        }
+    },
+    {
+        "Node2D", "Node",
+        {
+            { "position", &gd::layout_t::node2d_position, field_t::VECTOR2 },
+        }
+    },
+    {
+        "Node3D", "Node",
+        {
+            { "transform", &gd::layout_t::node3d_local_transform, field_t::TRANSFORM3D },
+            { "global_transform", &gd::layout_t::node3d_global_transform, field_t::TRANSFORM3D },
+        }
+    },
+    {
+        "Camera3D", "Node3D",
+        {
+            { "current", &gd::layout_t::camera3d_current, field_t::BOOL },
+            { "projection", &gd::layout_t::camera3d_mode, field_t::INT32 },
+            { "fov", &gd::layout_t::camera3d_fov, field_t::FLOAT },
+            { "size", &gd::layout_t::camera3d_size, field_t::FLOAT },
+            { "frustum_offset", &gd::layout_t::camera3d_frustum_offset, field_t::VECTOR2 },
+            { "near", &gd::layout_t::camera3d_near, field_t::FLOAT },
+            { "far", &gd::layout_t::camera3d_far, field_t::FLOAT },
+            { "v_offset", &gd::layout_t::camera3d_v_offset, field_t::FLOAT },
+            { "h_offset", &gd::layout_t::camera3d_h_offset, field_t::FLOAT },
+            { "keep_aspect", &gd::layout_t::camera3d_keep_aspect, field_t::INT32 },
+        }
+    },
+    {
+        "Viewport", "Node",
+        {
+            { "camera_3d", &gd::layout_t::viewport_camera_3d, field_t::OBJECT },
+        }
+    },
+    {
+        "Window", "Viewport",
+        {
+            { "title", &gd::layout_t::window_title, field_t::STRING },
+        }
+    },
+};
+
+static const class_info_t* find_class(std::string_view name)
+{
+    for (const class_info_t& info : classes)
+    {
+        if (name == info.name)
+            return &info;
+    }
+
+    return nullptr;
+}
+
+property_reader_t::plan_t property_reader_t::build_plan(const std::string& class_name)
+{
+    plan_t plan;
+    plan.class_name = class_name;
+
+    const class_info_t* info = find_class(class_name);
+    plan.exact = info != nullptr;
+
+    // Unknown node classes get their base's properties
+    if (!info)
+    {
+        const gd::Object::Kind kind = gd::Object::get_kind(class_name);
+        info = find_class(kind == gd::Object::Kind::NODE_3D ? "Node3D" : kind == gd::Object::Kind::NODE_2D ? "Node2D" : "Node");
+    }
+
+    // Base class properties first, like the editor lists them
+    std::vector<const class_info_t*> chain;
+    for (; info != nullptr; info = info->parent ? find_class(info->parent) : nullptr)
+        chain.insert(chain.begin(), info);
+
+    for (const class_info_t* it : chain)
+    {
+        for (const property_info_t& property : it->properties)
+        {
+            plan.steps.push_back({ gd::layout->*property.offset, property.field, static_cast<std::uint32_t>(plan.names.size()) });
+            plan.names.push_back(property.name);
+        }
+    }
+
+    // Walk the object front to back
+    std::sort(plan.steps.begin(), plan.steps.end(), [](const plan_t::step_t& a, const plan_t::step_t& b) { return a.offset < b.offset; });
+
+    return plan;
+}
+
+const property_reader_t::plan_t* property_reader_t::get_plan(gd::Object* object, bool assume_node)
+{
+    if (!object)
+        return nullptr;
+
+    void* vtable = object->get_vtable();
+
+    auto it = plans.find(vtable);
+    if (it == plans.end())
+        it = plans.emplace(vtable, build_plan(object->get_class_name())).first;
+
+    if (!it->second.exact && !assume_node)
+        return nullptr;
+
+    return &it->second;
+}
+
+void property_reader_t::read(gd::Object* object, const plan_t* plan, std::vector<value_t>& out)
+{
+    read_many(&object, 1, plan, out);
+}
+
+void property_reader_t::read_many(gd::Object* const* objects, std::size_t count, const plan_t* plan, std::vector<value_t>& out)
+{
+    const std::size_t stride = plan->names.size();
+    out.resize(count * stride);
+
+    for (std::size_t row = 0; row < count; row++)
+    {
+        const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(objects[row]);
+        value_t* values = out.data() + row * stride;
+
+        for (const plan_t::step_t& step : plan->steps)
+            decode(step.field, base + step.offset, values[step.property]);
+    }
+}
+
+static_assert(sizeof(Transform3D) == sizeof(property_reader_t::value_t::_real));
+
+void property_reader_t::decode(field_t field, const std::uint8_t* src, value_t& out)
+{
+    out._string.clear();
+    out.field = field;
+
+    switch (field)
+    {
+    case field_t::BOOL:
+        out._bool = *reinterpret_cast<const bool*>(src);
+        break;
+    case field_t::INT32:
+        out._int = *reinterpret_cast<const std::int32_t*>(src);
+        break;
+    case field_t::FLOAT:
+        out._float = *reinterpret_cast<const float*>(src);
+        break;
+    case field_t::VECTOR2:
+        std::memcpy(out._real, src, sizeof(float) * 2);
+        break;
+    case field_t::TRANSFORM3D:
+        std::memcpy(out._real, src, sizeof(Transform3D));
+        break;
+    case field_t::STRING:
+        out._string = const_cast<gd::String*>(reinterpret_cast<const gd::String*>(src))->get_string();
+        break;
+    case field_t::STRING_NAME:
+        out._string = const_cast<gd::StringName*>(reinterpret_cast<const gd::StringName*>(src))->get_name();
+        break;
+    case field_t::OBJECT:
+        out._object = *reinterpret_cast<gd::Object* const*>(src);
+        break;
+    }
+}
+
+std::string property_reader_t::to_string(const value_t& value)
+{
+    const float* r = value._real;
+
+    switch (value.field)
+    {
+    case field_t::BOOL:
+        return value._bool ? "true" : "false";
+    case field_t::INT32:
+        return std::format("{}", value._int);
+    case field_t::FLOAT:
+        return std::format("{:.3f}", value._float);
+    case field_t::VECTOR2:
+        return std::format("({:.3f}, {:.3f})", r[0], r[1]);
+    case field_t::TRANSFORM3D:
+        return std::format("origin ({:.3f}, {:.3f}, {:.3f})", r[9], r[10], r[11]);
+    case field_t::STRING:
+    case field_t::STRING_NAME:
+        return value._string;
+    case field_t::OBJECT:
+        return value._object ? std::format("{}", static_cast<void*>(value._object)) : "null";
+    }
+
+    return {};
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "godot.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/*
+ * Generic property inspection
+ *
+ * Each class gets a read plan the first time one of its objects is inspected: the offsets of its own
+ * and inherited properties, resolved from the active layout and sorted by address
+ * Plans are cached by vtable, so reading the properties of many objects of the same class is only raw memory reads
+*/
+class property_reader_t {
+public:
+	// How a property is stored inside the engine object
+	enum class field_t {
+		BOOL,
+		INT32,
+		FLOAT,
+		VECTOR2,
+		TRANSFORM3D,
+		STRING,
+		STRING_NAME,
+		OBJECT
+	};
+
+	// A decoded property, everything is copied out of the game
+	struct value_t {
+		field_t field = field_t::INT32;
+
+		union {
+			bool _bool;
+			std::int64_t _int = 0;
+			double _float;
+			float _real[12];
+			gd::Object* _object;
+		};
+
+		std::string _string;
+	};
+
+	struct plan_t {
+		struct step_t {
+			std::uint32_t offset;
+			field_t field;
+			std::uint32_t property; // Into names
+		};
+
+		std::string class_name;
+		bool exact = false; // False if the class isn't in the table and a base class was guessed from its name
+
+		std::vector<const char*> names;
+		std::vector<step_t> steps;
+	};
+
+public:
+	// assume_node allows guessing a base node class for unknown classes, only pass true for objects of the scene tree
+	const plan_t* get_plan(gd::Object* object, bool assume_node);
+
+	// out[i] is the value of plan->names[i]
+	void read(gd::Object* object, const plan_t* plan, std::vector<value_t>& out);
+
+	// Row-major, out[row * names.size() + i], every object must share the plan's class
+	void read_many(gd::Object* const* objects, std::size_t count, const plan_t* plan, std::vector<value_t>& out);
+
+	static void decode(field_t field, const std::uint8_t* src, value_t& out);
+
+	static std::string to_string(const value_t& value);
+
+private:
+	plan_t build_plan(const std::string& class_name);
+
+private:
+	std::unordered_map<void*, plan_t> plans;
+};
+
+inline std::unique_ptr<property_reader_t> properties = std::make_unique<property_reader_t>();
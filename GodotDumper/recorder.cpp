@@ -0,0 +1,831 @@
+#include "recorder.h"
+#include "godot.h"
+#include <algorithm>
+#include <cstring>
+
+template <typename T>
+static void write_raw(std::vector<std::uint8_t>& out, const T& value)
+{
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool read_raw(const std::uint8_t*& it, const std::uint8_t* end, T& value)
+{
+    if (static_cast<std::size_t>(end - it) < sizeof(T))
+        return false;
+
+    std::memcpy(&value, it, sizeof(T));
+    it += sizeof(T);
+    return true;
+}
+
+static void write_name(std::vector<std::uint8_t>& out, std::uint64_t key, const std::string& name)
+{
+    std::uint16_t length = static_cast<std::uint16_t>(std::min<std::size_t>(name.size(), UINT16_MAX));
+
+    write_raw(out, key);
+    write_raw(out, length);
+    out.insert(out.end(), name.begin(), name.begin() + length);
+}
+
+// 64 bit offsets, recordings easily pass 2 GB
+static std::int64_t file_tell(std::FILE* file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return ftello(file);
+#endif
+}
+
+static int file_seek(std::FILE* file, std::int64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, static_cast<off_t>(offset), origin);
+#endif
+}
+
+static bool read_name(const std::uint8_t*& it, const std::uint8_t* end, std::uint64_t& key, std::string& name)
+{
+    std::uint16_t length = 0;
+    if (!read_raw(it, end, key) || !read_raw(it, end, length) || end - it < length)
+        return false;
+
+    name.assign(reinterpret_cast<const char*>(it), length);
+    it += length;
+    return true;
+}
+
+recorder_t::~recorder_t()
+{
+    close();
+}
+
+bool recorder_t::open(const std::string& path)
+{
+    close();
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    std::uint32_t header[2] = { recording::FILE_MAGIC, recording::VERSION };
+    std::fwrite(header, sizeof(header), 1, file);
+
+    frame_count = 0;
+    last_record = -1.0;
+    names.clear();
+    index.clear();
+    node_of_key.clear();
+    node_info.clear();
+    bytes_written = sizeof(header);
+
+    stopping = false;
+    writer = std::thread(&recorder_t::writer_loop, this);
+
+    return true;
+}
+
+void recorder_t::close()
+{
+    if (!file)
+        return;
+
+    if (frame_open)
+        end_frame();
+
+    if (chunk && !chunk->times.empty())
+        flush_chunk(std::move(chunk));
+    chunk.reset();
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    if (writer.joinable())
+        writer.join();
+
+    std::vector<std::uint8_t> out;
+    write_raw(out, recording::INDEX_MAGIC);
+    write_raw(out, static_cast<std::uint32_t>(index.size()));
+    for (const index_entry_t& entry : index)
+    {
+        write_raw(out, entry.first_frame);
+        write_raw(out, entry.offset);
+    }
+
+    write_raw(out, static_cast<std::uint32_t>(names.size()));
+    for (const auto& [key, name] : names)
+        write_name(out, key, name);
+
+    std::uint64_t index_offset = static_cast<std::uint64_t>(file_tell(file));
+    write_raw(out, index_offset);
+    write_raw(out, recording::INDEX_MAGIC);
+
+    std::fwrite(out.data(), 1, out.size(), file);
+    std::fclose(file);
+    file = nullptr;
+
+    spare.clear();
+}
+
+void recorder_t::start_chunk()
+{
+    {
+        std::lock_guard lock(mutex);
+        if (!spare.empty())
+        {
+            chunk = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+
+    if (!chunk)
+        chunk = std::make_unique<chunk_t>();
+
+    chunk->first_frame = frame_count;
+    chunk->times.clear();
+    chunk->nodes.clear();
+    chunk->presence.clear();
+    chunk->values.clear();
+    chunk->names.clear();
+    chunk->stride = 0;
+}
+
+void recorder_t::carry_nodes(const chunk_t& previous)
+{
+    // Scenes rarely change between chunks, reuse the node table so the next first frame stays on the fast path
+    const std::uint64_t last = 1ull << (previous.times.size() - 1);
+
+    bool all_alive = std::all_of(previous.presence.begin(), previous.presence.end(), [last](std::uint64_t presence) { return presence & last; });
+    if (all_alive)
+    {
+        chunk->nodes = previous.nodes;
+        chunk->stride = previous.stride;
+        chunk->presence.assign(previous.nodes.size(), 0);
+        return;
+    }
+
+    // Drop the nodes that are gone, the table is rebuilt once
+    node_of_key.clear();
+    for (std::size_t i = 0; i < previous.nodes.size(); i++)
+    {
+        if (!(previous.presence[i] & last))
+            continue;
+
+        node_of_key.emplace(previous.nodes[i].key, static_cast<std::uint32_t>(chunk->nodes.size()));
+        chunk->nodes.push_back({ previous.nodes[i].key, previous.nodes[i].dims, chunk->stride });
+        chunk->stride += previous.nodes[i].dims;
+    }
+
+    chunk->presence.assign(chunk->nodes.size(), 0);
+}
+
+void recorder_t::flush_chunk(std::unique_ptr<chunk_t> done)
+{
+    {
+        std::lock_guard lock(mutex);
+        pending.push_back(std::move(done));
+    }
+    cv.notify_one();
+}
+
+void recorder_t::begin_frame(double time)
+{
+    if (!file)
+        return;
+
+    if (frame_open)
+        end_frame();
+
+    std::unique_ptr<chunk_t> previous;
+    if (chunk)
+    {
+        std::size_t max_frames = std::clamp<std::size_t>(recording::CHUNK_VALUES / std::max<std::uint32_t>(chunk->stride, 1), 1, recording::CHUNK_FRAMES);
+        if (chunk->times.size() >= max_frames)
+            previous = std::move(chunk);
+    }
+
+    if (!chunk)
+    {
+        start_chunk();
+
+        if (previous)
+        {
+            carry_nodes(*previous);
+            flush_chunk(std::move(previous));
+        }
+        else
+        {
+            node_of_key.clear();
+        }
+    }
+
+    // Reused chunks keep their capacity, so this only allocates for the first few chunks
+    if (chunk->times.empty() && chunk->stride)
+        chunk->values.reserve(std::min<std::size_t>(static_cast<std::size_t>(chunk->stride) * recording::CHUNK_FRAMES, recording::CHUNK_VALUES + chunk->stride));
+
+    chunk->times.push_back(time);
+    chunk->values.resize(chunk->values.size() + chunk->stride);
+
+    cursor = 0;
+    frame_open = true;
+}
+
+void recorder_t::add(std::uint64_t key, const float* values, std::uint8_t dims)
+{
+    if (!frame_open)
+        return;
+
+    std::uint32_t frame = static_cast<std::uint32_t>(chunk->times.size() - 1);
+    std::uint32_t node_index;
+
+    if (cursor < chunk->nodes.size() && chunk->nodes[cursor].key == key)
+    {
+        node_index = cursor;
+    }
+    else if (auto it = node_of_key.find(key); it != node_of_key.end())
+    {
+        node_index = it->second;
+    }
+    else
+    {
+        // The node table of a chunk is fixed once a frame is complete, start a new chunk that carries the current frame over
+        if (frame > 0)
+        {
+            std::unique_ptr<chunk_t> previous = std::move(chunk);
+            start_chunk();
+            node_of_key.clear();
+
+            chunk->first_frame = previous->first_frame + frame;
+            chunk->times.push_back(previous->times.back());
+
+            // Nodes gone since the last frame stay behind, with nodes spawning every few frames the table would only grow
+            // One that's only late in this frame's order comes back as a new column
+            const std::uint64_t current = 1ull << frame;
+            const float* row = previous->values.data() + static_cast<std::size_t>(frame) * previous->stride;
+
+            for (std::size_t i = 0; i < previous->nodes.size(); i++)
+            {
+                const node_t& carried = previous->nodes[i];
+                const std::uint64_t presence = previous->presence[i];
+                previous->presence[i] &= ~current;
+
+                if (!(presence & (current | current >> 1)))
+                    continue;
+
+                node_of_key.emplace(carried.key, static_cast<std::uint32_t>(chunk->nodes.size()));
+                chunk->nodes.push_back({ carried.key, carried.dims, chunk->stride });
+                chunk->presence.push_back(presence & current ? 1 : 0);
+                chunk->values.insert(chunk->values.end(), row + carried.offset, row + carried.offset + carried.dims);
+                chunk->stride += carried.dims;
+            }
+
+            previous->times.pop_back();
+            previous->values.resize(previous->values.size() - previous->stride);
+
+            flush_chunk(std::move(previous));
+
+            frame = 0;
+        }
+
+        // With a single frame in the chunk the new columns simply go at the end
+        node_index = static_cast<std::uint32_t>(chunk->nodes.size());
+        chunk->nodes.push_back({ key, dims, chunk->stride });
+        chunk->presence.push_back(0);
+        chunk->stride += dims;
+        chunk->values.resize(chunk->stride);
+
+        node_of_key.emplace(key, node_index);
+    }
+
+    cursor = node_index + 1;
+
+    const node_t& node = chunk->nodes[node_index];
+    if (node.dims != dims)
+        return;
+
+    std::memcpy(chunk->values.data() + static_cast<std::size_t>(frame) * chunk->stride + node.offset, values, dims * sizeof(float));
+    chunk->presence[node_index] |= 1ull << frame;
+}
+
+void recorder_t::end_frame()
+{
+    if (!frame_open)
+        return;
+
+    std::uint32_t frame = static_cast<std::uint32_t>(chunk->times.size() - 1);
+
+    // Missing nodes keep their last value, so they encode as zeros
+    if (frame > 0)
+    {
+        float* current = chunk->values.data() + static_cast<std::size_t>(frame) * chunk->stride;
+        for (std::size_t i = 0; i < chunk->nodes.size(); i++)
+        {
+            if (!(chunk->presence[i] & (1ull << frame)))
+                std::memcpy(current + chunk->nodes[i].offset, current - chunk->stride + chunk->nodes[i].offset, chunk->nodes[i].dims * sizeof(float));
+        }
+    }
+
+    frame_count++;
+    frame_open = false;
+}
+
+recorder_t::node_info_t* recorder_t::find_info(gd::Node* node)
+{
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(node);
+
+    auto it = node_info.find(address);
+    if (it == node_info.end() || it->second.vtable != node->get_vtable())
+        return nullptr;
+
+    // Same class at the same address can still be another object
+    if (it->second.key != address && gd::ObjectDB::get_instance(it->second.key) != node)
+        return nullptr;
+
+    return &it->second;
+}
+
+void recorder_t::add_new_nodes()
+{
+    gd::ObjectDB::ObjectSlot* slots = gd::ObjectDB::get_slots();
+    std::uint32_t slot_max = gd::ObjectDB::get_slot_max();
+
+    for (std::uint32_t i = 0; slots && i < slot_max; i++)
+    {
+        if (slots[i].validator == 0 || !slots[i].object)
+            continue;
+
+        auto it = new_ids.find(reinterpret_cast<std::uintptr_t>(slots[i].object));
+        if (it != new_ids.end())
+            it->second = gd::ObjectDB::get_instance_id(slots[i], i);
+    }
+
+    for (auto& [node, info] : walked)
+    {
+        if (info)
+            continue;
+
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(node);
+        const std::uint64_t id = new_ids[address];
+        const std::uint64_t key = id ? id : address;
+
+        const void* vtable = node->get_vtable();
+        auto dims = dims_of_vtable.find(vtable);
+        if (dims == dims_of_vtable.end())
+            dims = dims_of_vtable.emplace(vtable, gd::Object::get_dims(node->get_kind())).first;
+
+        if (dims->second != 0)
+        {
+            names.emplace_back(key, node->get_name());
+            chunk->names.push_back(names.back());
+        }
+
+        info = &(node_info[address] = { vtable, key, dims->second, frame_count });
+    }
+}
+
+void recorder_t::record(gd::SceneTree* tree, double time)
+{
+    if (!file || !tree || !tree->get_current_scene())
+        return;
+
+    if (last_record >= 0.0 && time - last_record < 1.0 / rate)
+        return;
+
+    last_record = time;
+    begin_frame(time);
+
+    walked.clear();
+    new_ids.clear();
+
+    std::vector<gd::Node*> stack = { tree->get_current_scene() };
+    while (!stack.empty())
+    {
+        gd::Node* node = stack.back();
+        stack.pop_back();
+
+        node_info_t* info = find_info(node);
+        if (!info)
+            new_ids.emplace(reinterpret_cast<std::uintptr_t>(node), 0);
+
+        walked.push_back({ node, info });
+
+        for (gd::Node* child : node->get_children())
+        {
+            if (child)
+                stack.push_back(child);
+        }
+    }
+
+    // Keys of new nodes come from the ObjectDB, one pass for all of them
+    if (!new_ids.empty())
+        add_new_nodes();
+
+    for (const auto& [node, info] : walked)
+    {
+        info->last_seen = frame_count;
+
+        if (info->dims == recording::DIMS_3D)
+            add(info->key, reinterpret_cast<const float*>(&node->as<gd::Node3D>()->global_transform()), recording::DIMS_3D);
+        else if (info->dims == recording::DIMS_2D)
+            add(info->key, reinterpret_cast<const float*>(&node->as<gd::Node2D>()->position()), recording::DIMS_2D);
+    }
+
+    // Nodes that left the tree, their memory may hold anything by now
+    const std::uint32_t frame = frame_count;
+    if (frame % recording::CHUNK_FRAMES == 0)
+        std::erase_if(node_info, [frame](const auto& it) { return it.second.last_seen != frame; });
+
+    end_frame();
+}
+
+void recorder_t::encode(const chunk_t& chunk, std::vector<std::uint8_t>& out)
+{
+    out.clear();
+
+    const std::uint32_t frames = static_cast<std::uint32_t>(chunk.times.size());
+
+    recording::chunk_header_t header = {};
+    header.magic = recording::CHUNK_MAGIC;
+    header.first_frame = chunk.first_frame;
+    header.frame_count = frames;
+    header.node_count = static_cast<std::uint32_t>(chunk.nodes.size());
+    header.name_count = static_cast<std::uint32_t>(chunk.names.size());
+    header.start_time = frames ? chunk.times[0] : 0.0;
+
+    write_raw(out, header);
+
+    for (double time : chunk.times)
+        write_varint(out, static_cast<std::uint64_t>(std::max(0.0, (time - header.start_time) * 1e6 + 0.5))); // Rounded, times read back within half a microsecond
+
+    // The payload is built first so the node table can point into it
+    static thread_local std::vector<std::uint8_t> payload;
+    static thread_local std::vector<std::uint32_t> offsets;
+    payload.clear();
+    offsets.clear();
+
+    // Worst case is 5 bytes per value, write through a raw pointer instead of growing the vector byte by byte
+    payload.resize(chunk.values.size() * 5);
+    std::uint8_t* write = payload.data();
+
+    for (const node_t& node : chunk.nodes)
+    {
+        offsets.push_back(static_cast<std::uint32_t>(write - payload.data()));
+
+        for (std::uint32_t column = 0; column < node.dims; column++)
+        {
+            const float* value = chunk.values.data() + node.offset + column;
+            std::uint32_t previous = 0;
+
+            for (std::uint32_t frame = 0; frame < frames; frame++, value += chunk.stride)
+            {
+                std::uint32_t bits;
+                std::memcpy(&bits, value, sizeof(bits));
+
+                std::uint32_t delta = bits ^ previous;
+                previous = bits;
+
+                while (delta >= 0x80)
+                {
+                    *write++ = static_cast<std::uint8_t>(delta) | 0x80;
+                    delta >>= 7;
+                }
+                *write++ = static_cast<std::uint8_t>(delta);
+            }
+        }
+    }
+
+    payload.resize(write - payload.data());
+
+    for (std::size_t i = 0; i < chunk.nodes.size(); i++)
+    {
+        write_raw(out, chunk.nodes[i].key);
+        write_raw(out, chunk.nodes[i].dims);
+        write_raw(out, offsets[i]);
+    }
+
+    for (std::uint64_t presence : chunk.presence)
+        write_raw(out, presence);
+
+    for (const auto& [key, name] : chunk.names)
+        write_name(out, key, name);
+
+    out.insert(out.end(), payload.begin(), payload.end());
+
+    std::uint32_t body_size = static_cast<std::uint32_t>(out.size() - sizeof(header));
+    std::memcpy(out.data() + offsetof(recording::chunk_header_t, body_size), &body_size, sizeof(body_size));
+}
+
+void recorder_t::writer_loop()
+{
+    std::vector<std::uint8_t> out;
+
+    while (true)
+    {
+        std::unique_ptr<chunk_t> next;
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this]() { return stopping || !pending.empty(); });
+
+            if (pending.empty())
+                return;
+
+            next = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        encode(*next, out);
+
+        index.push_back({ next->first_frame, static_cast<std::uint64_t>(file_tell(file)) });
+        std::fwrite(out.data(), 1, out.size(), file);
+        bytes_written.fetch_add(out.size(), std::memory_order_relaxed);
+
+        std::lock_guard lock(mutex);
+        spare.push_back(std::move(next));
+    }
+}
+
+recording_t::~recording_t()
+{
+    close();
+}
+
+bool recording_t::open(const std::string& path)
+{
+    close();
+
+    file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    std::uint32_t header[2] = {};
+    if (std::fread(header, sizeof(header), 1, file) != 1 || header[0] != recording::FILE_MAGIC || header[1] != recording::VERSION)
+    {
+        close();
+        return false;
+    }
+
+    if (!load_index() && !scan_chunks())
+    {
+        close();
+        return false;
+    }
+
+    frame_count = 0;
+    if (!chunks.empty())
+    {
+        recording::chunk_header_t last = {};
+        file_seek(file, static_cast<std::int64_t>(chunks.back().offset), SEEK_SET);
+        if (std::fread(&last, sizeof(last), 1, file) == 1)
+            frame_count = last.first_frame + last.frame_count;
+    }
+
+    return true;
+}
+
+void recording_t::close()
+{
+    if (file)
+        std::fclose(file);
+
+    file = nullptr;
+    chunks.clear();
+    names.clear();
+    frame_count = 0;
+    cached = SIZE_MAX;
+}
+
+bool recording_t::load_index()
+{
+    struct
+    {
+        std::uint64_t offset;
+        std::uint32_t magic;
+    } trailer = {};
+
+    constexpr std::int64_t trailer_size = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+    if (file_seek(file, -trailer_size, SEEK_END) != 0)
+        return false;
+
+    std::int64_t trailer_offset = file_tell(file);
+    if (std::fread(&trailer.offset, sizeof(trailer.offset), 1, file) != 1 || std::fread(&trailer.magic, sizeof(trailer.magic), 1, file) != 1)
+        return false;
+
+    if (trailer.magic != recording::INDEX_MAGIC || static_cast<std::int64_t>(trailer.offset) >= trailer_offset)
+        return false;
+
+    std::vector<std::uint8_t> buffer(static_cast<std::size_t>(trailer_offset - static_cast<std::int64_t>(trailer.offset)));
+    file_seek(file, static_cast<std::int64_t>(trailer.offset), SEEK_SET);
+    if (std::fread(buffer.data(), 1, buffer.size(), file) != buffer.size())
+        return false;
+
+    const std::uint8_t* it = buffer.data();
+    const std::uint8_t* end = it + buffer.size();
+
+    std::uint32_t magic = 0, chunk_count = 0, name_count = 0;
+    if (!read_raw(it, end, magic) || magic != recording::INDEX_MAGIC || !read_raw(it, end, chunk_count))
+        return false;
+
+    chunks.resize(chunk_count);
+    for (chunk_ref_t& ref : chunks)
+    {
+        if (!read_raw(it, end, ref.first_frame) || !read_raw(it, end, ref.offset))
+            return false;
+    }
+
+    if (!read_raw(it, end, name_count))
+        return false;
+
+    for (std::uint32_t i = 0; i < name_count; i++)
+    {
+        std::uint64_t key;
+        std::string name;
+        if (!read_name(it, end, key, name))
+            return false;
+
+        names[key] = std::move(name);
+    }
+
+    return true;
+}
+
+bool recording_t::scan_chunks()
+{
+    chunks.clear();
+    names.clear();
+
+    std::int64_t offset = sizeof(std::uint32_t) * 2;
+
+    while (true)
+    {
+        recording::chunk_header_t header = {};
+        file_seek(file, offset, SEEK_SET);
+        if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != recording::CHUNK_MAGIC)
+            break;
+
+        chunks.push_back({ header.first_frame, static_cast<std::uint64_t>(offset) });
+
+        // Names are the only thing needed from the body
+        body.resize(header.body_size);
+        if (std::fread(body.data(), 1, body.size(), file) != body.size())
+        {
+            chunks.pop_back();
+            break;
+        }
+
+        const std::uint8_t* it = body.data();
+        const std::uint8_t* end = it + body.size();
+
+        for (std::uint32_t i = 0; i < header.frame_count; i++)
+            read_varint(it, end);
+
+        it += static_cast<std::size_t>(header.node_count) * (sizeof(std::uint64_t) + sizeof(std::uint8_t) + sizeof(std::uint32_t) + sizeof(std::uint64_t));
+
+        for (std::uint32_t i = 0; i < header.name_count && it < end; i++)
+        {
+            std::uint64_t key;
+            std::string name;
+            if (!read_name(it, end, key, name))
+                break;
+
+            names[key] = std::move(name);
+        }
+
+        offset += sizeof(header) + header.body_size;
+    }
+
+    return !chunks.empty();
+}
+
+bool recording_t::load_chunk(std::size_t index)
+{
+    if (cached == index)
+        return true;
+
+    cached = SIZE_MAX;
+
+    recording::chunk_header_t& header = cached_header;
+    file_seek(file, static_cast<std::int64_t>(chunks[index].offset), SEEK_SET);
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != recording::CHUNK_MAGIC || header.frame_count > recording::CHUNK_FRAMES)
+        return false;
+
+    body.resize(header.body_size);
+    if (std::fread(body.data(), 1, body.size(), file) != body.size())
+        return false;
+
+    const std::uint8_t* it = body.data();
+    const std::uint8_t* end = it + body.size();
+
+    cached_times.resize(header.frame_count);
+    for (double& time : cached_times)
+        time = header.start_time + static_cast<double>(read_varint(it, end)) * 1e-6;
+
+    cached_keys.resize(header.node_count);
+    cached_dims.resize(header.node_count);
+    cached_presence.resize(header.node_count);
+    cached_offsets.resize(header.node_count);
+
+    std::vector<std::uint32_t> payload_offsets(header.node_count);
+    std::size_t total = 0;
+
+    for (std::uint32_t i = 0; i < header.node_count; i++)
+    {
+        if (!read_raw(it, end, cached_keys[i]) || !read_raw(it, end, cached_dims[i]) || !read_raw(it, end, payload_offsets[i]))
+            return false;
+
+        cached_offsets[i] = static_cast<std::uint32_t>(total);
+        total += static_cast<std::size_t>(cached_dims[i]) * header.frame_count;
+    }
+
+    for (std::uint64_t& presence : cached_presence)
+    {
+        if (!read_raw(it, end, presence))
+            return false;
+    }
+
+    for (std::uint32_t i = 0; i < header.name_count; i++)
+    {
+        std::uint64_t key;
+        std::string name;
+        if (!read_name(it, end, key, name))
+            return false;
+    }
+
+    const std::uint8_t* payload = it;
+    cached_values.resize(total);
+
+    for (std::uint32_t i = 0; i < header.node_count; i++)
+    {
+        const std::uint8_t* column = payload + payload_offsets[i];
+        float* out = cached_values.data() + cached_offsets[i];
+
+        for (std::uint32_t c = 0; c < cached_dims[i]; c++)
+        {
+            std::uint32_t previous = 0;
+            for (std::uint32_t frame = 0; frame < header.frame_count; frame++)
+            {
+                previous ^= static_cast<std::uint32_t>(read_varint(column, end));
+                std::memcpy(out++, &previous, sizeof(float));
+            }
+        }
+    }
+
+    cached = index;
+    return true;
+}
+
+bool recording_t::read_frame(std::uint32_t frame, std::vector<node_state_t>& out, double* time)
+{
+    out.clear();
+
+    if (!file || frame >= frame_count)
+        return false;
+
+    auto it = std::upper_bound(chunks.begin(), chunks.end(), frame, [](std::uint32_t value, const chunk_ref_t& ref) { return value < ref.first_frame; });
+    if (it == chunks.begin())
+        return false;
+
+    std::size_t index = static_cast<std::size_t>(it - chunks.begin()) - 1;
+    if (!load_chunk(index))
+        return false;
+
+    std::uint32_t local = frame - cached_header.first_frame;
+    if (local >= cached_header.frame_count)
+        return false;
+
+    if (time)
+        *time = cached_times[local];
+
+    for (std::size_t i = 0; i < cached_keys.size(); i++)
+    {
+        if (!(cached_presence[i] & (1ull << local)))
+            continue;
+
+        node_state_t state = {};
+        state.key = cached_keys[i];
+        state.dims = cached_dims[i];
+
+        // Columns are frame_count floats each
+        const float* column = cached_values.data() + cached_offsets[i] + local;
+        for (std::uint32_t c = 0; c < state.dims && c < recording::DIMS_3D; c++)
+            state.values[c] = column[static_cast<std::size_t>(c) * cached_header.frame_count];
+
+        out.push_back(state);
+    }
+
+    return true;
+}
+
+const std::string* recording_t::get_name(std::uint64_t key) const
+{
+    auto it = names.find(key);
+    return it != names.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include "varint.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+namespace gd
+{
+	class Node;
+	class SceneTree;
+}
+
+/*
+ * Motion recording of every Node3D (global transform) and Node2D (position) of the current scene
+ *
+ * Frames are grouped in chunks of up to CHUNK_FRAMES, a chunk stores one column per node and per float
+ * Each column starts with a raw value, the following frames are XORed with the previous one and varint encoded,
+ * a node that doesn't move costs one byte per float per frame
+ *
+ * File layout:
+ *
+ * header   { u32 magic, u32 version }
+ * chunk... { chunk_header_t, body }
+ *          body = frame time deltas (varint, microseconds since start_time)
+ *                 node table (u64 key, u8 dims, u32 payload offset) * node_count
+ *                 presence (u64 bitmask of frames the node existed in) * node_count
+ *                 names introduced by this chunk (u64 key, u16 length, chars) * name_count
+ *                 payload
+ * index    { u32 magic, u32 chunk_count, (u32 first_frame, u64 offset) * chunk_count,
+ *            u32 name_count, (u64 key, u16 length, chars) * name_count }
+ * trailer  { u64 index offset, u32 magic }
+ *
+ * The index is written by close, a file without it (crash) is still readable by walking the chunks
+ * record keys nodes by instance id, so a node freed and another allocated at its address are two tracks
+ * (by address if the ObjectDB wasn't found)
+*/
+namespace recording
+{
+	constexpr std::uint32_t make_magic(const char (&tag)[5])
+	{
+		return std::uint32_t(tag[0]) | std::uint32_t(tag[1]) << 8 | std::uint32_t(tag[2]) << 16 | std::uint32_t(tag[3]) << 24;
+	}
+
+	constexpr std::uint32_t FILE_MAGIC = make_magic("GDRC");
+	constexpr std::uint32_t CHUNK_MAGIC = make_magic("GDCK");
+	constexpr std::uint32_t INDEX_MAGIC = make_magic("GDIX");
+	constexpr std::uint32_t VERSION = 1;
+
+	constexpr std::uint32_t CHUNK_FRAMES = 64; // Presence is a u64 bitmask
+	constexpr std::size_t CHUNK_VALUES = 1 << 24; // Raw floats buffered per chunk, large scenes get shorter chunks
+
+	constexpr std::uint8_t DIMS_2D = 2; // Vector2 position
+	constexpr std::uint8_t DIMS_3D = 12; // Transform3D
+
+#pragma pack(push, 1)
+	struct chunk_header_t {
+		std::uint32_t magic;
+		std::uint32_t first_frame;
+		std::uint32_t frame_count;
+		std::uint32_t node_count;
+		std::uint32_t name_count;
+		std::uint32_t body_size;
+		double start_time;
+	};
+#pragma pack(pop)
+}
+
+class recorder_t {
+public:
+	~recorder_t();
+
+	bool open(const std::string& path);
+	// Flushes the pending chunk, waits for the writer and appends the index
+	void close();
+
+	bool is_recording() const { return file != nullptr; }
+
+	// Low level capture, add every node between begin_frame and end_frame
+	// Adding nodes in the same order every frame skips the key lookup
+	void begin_frame(double time);
+	void add(std::uint64_t key, const float* values, std::uint8_t dims);
+	void end_frame();
+
+	// Walks the current scene and records it as one frame, calls closer than 1 / rate are skipped
+	void record(gd::SceneTree* tree, double time);
+
+	float rate = 60.f;
+
+	std::uint32_t get_frame_count() const { return frame_count; }
+	std::uint64_t get_bytes_written() const { return bytes_written.load(std::memory_order_relaxed); }
+
+private:
+	struct node_t {
+		std::uint64_t key;
+		std::uint8_t dims;
+		std::uint32_t offset; // Into a frame's values
+	};
+
+	struct chunk_t {
+		std::uint32_t first_frame = 0;
+		std::vector<double> times;
+		std::vector<node_t> nodes;
+		std::vector<std::uint64_t> presence;
+		std::vector<float> values; // Frame major, frame * stride + node.offset
+		std::uint32_t stride = 0;
+		std::vector<std::pair<std::uint64_t, std::string>> names;
+	};
+
+	void flush_chunk(std::unique_ptr<chunk_t> done);
+	void start_chunk();
+	void carry_nodes(const chunk_t& previous);
+	void writer_loop();
+	void encode(const chunk_t& chunk, std::vector<std::uint8_t>& out);
+
+private:
+	std::FILE* file = nullptr;
+
+	std::unique_ptr<chunk_t> chunk;
+	std::unordered_map<std::uint64_t, std::uint32_t> node_of_key; // Into chunk->nodes
+	std::uint32_t cursor = 0;
+	std::uint32_t frame_count = 0;
+	bool frame_open = false;
+	double last_record = -1.0;
+
+	// Every key named so far, the index repeats them so a reader never has to scan the chunks
+	std::vector<std::pair<std::uint64_t, std::string>> names;
+
+	// What record knows about the node at an address, checked against the vtable and the ObjectDB every frame
+	struct node_info_t {
+		const void* vtable;
+		std::uint64_t key;
+		std::uint8_t dims; // 0 for classes without a transform
+		std::uint32_t last_seen; // Frame, entries of nodes that left the tree are dropped once per chunk
+	};
+
+	// nullptr if the node is new, or another object took a freed node's place
+	node_info_t* find_info(gd::Node* node);
+	// Keys the new nodes of the frame with one pass over the ObjectDB and names them
+	void add_new_nodes();
+
+	std::unordered_map<std::uintptr_t, node_info_t> node_info;
+	std::unordered_map<const void*, std::uint8_t> dims_of_vtable;
+	std::vector<std::pair<gd::Node*, node_info_t*>> walked; // The frame's nodes in walk order, nullptr for new ones
+	std::unordered_map<std::uintptr_t, std::uint64_t> new_ids; // Address of a new node -> instance id
+
+	struct index_entry_t {
+		std::uint32_t first_frame;
+		std::uint64_t offset;
+	};
+	std::vector<index_entry_t> index;
+
+	// Raw chunks waiting for the writer, and encoded ones given back for reuse
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::unique_ptr<chunk_t>> pending;
+	std::vector<std::unique_ptr<chunk_t>> spare;
+	bool stopping = false;
+	std::thread writer;
+
+	std::atomic<std::uint64_t> bytes_written = 0;
+};
+
+/*
+ * Seekable reader, only the chunk holding the requested frame is decoded
+ * The last decoded chunk is kept so playing frames in order decodes each chunk once
+*/
+class recording_t {
+public:
+	struct node_state_t {
+		std::uint64_t key;
+		std::uint8_t dims;
+		float values[recording::DIMS_3D];
+	};
+
+	~recording_t();
+
+	bool open(const std::string& path);
+	void close();
+
+	std::uint32_t get_frame_count() const { return frame_count; }
+
+	// Nodes that existed in that frame
+	bool read_frame(std::uint32_t frame, std::vector<node_state_t>& out, double* time = nullptr);
+
+	const std::string* get_name(std::uint64_t key) const;
+
+private:
+	struct chunk_ref_t {
+		std::uint32_t first_frame;
+		std::uint64_t offset;
+	};
+
+	bool load_index();
+	bool scan_chunks();
+	bool load_chunk(std::size_t index);
+
+private:
+	std::FILE* file = nullptr;
+	std::vector<std::uint8_t> body;
+
+	std::vector<chunk_ref_t> chunks;
+	std::unordered_map<std::uint64_t, std::string> names;
+	std::uint32_t frame_count = 0;
+
+	// Decoded form of the cached chunk, column major per node
+	std::size_t cached = SIZE_MAX;
+	recording::chunk_header_t cached_header{};
+	std::vector<double> cached_times;
+	std::vector<std::uint64_t> cached_keys;
+	std::vector<std::uint8_t> cached_dims;
+	std::vector<std::uint64_t> cached_presence;
+	std::vector<std::uint32_t> cached_offsets; // Into cached_values, node columns are dims * frame_count floats
+	std::vector<float> cached_values;
+};
+
+inline std::unique_ptr<recorder_t> recorder = std::make_unique<recorder_t>();
@@ -0,0 +1,768 @@
+#include "remote.h"
+#include "varint.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+
+using socket_t = SOCKET;
+static constexpr int SEND_FLAGS = 0;
+
+static bool startup()
+{
+    static const bool started = []()
+    {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+
+    return started;
+}
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using socket_t = int;
+static constexpr socket_t INVALID_SOCKET = -1;
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL; // A viewer that went away is an error, not a SIGPIPE
+
+static bool startup()
+{
+    return true;
+}
+
+static int closesocket(socket_t socket)
+{
+    return ::close(socket);
+}
+#endif
+
+static constexpr std::uintptr_t NO_SOCKET = ~std::uintptr_t(0);
+static constexpr std::size_t HEADER_SIZE = 5; // u32 size, u8 type
+
+static socket_t as_socket(std::uintptr_t handle)
+{
+    return static_cast<socket_t>(handle);
+}
+
+static bool wait_readable(std::uintptr_t handle, int timeout_ms)
+{
+    socket_t socket = as_socket(handle);
+
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(socket, &set);
+
+    timeval timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    return select(static_cast<int>(socket) + 1, &set, nullptr, nullptr, &timeout) > 0;
+}
+
+static bool send_all(std::uintptr_t handle, const std::uint8_t* data, std::size_t size)
+{
+    while (size)
+    {
+        const int chunk = static_cast<int>(std::min<std::size_t>(size, 1 << 20));
+        const int sent = ::send(as_socket(handle), reinterpret_cast<const char*>(data), chunk, SEND_FLAGS);
+        if (sent <= 0)
+            return false;
+
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+
+    return true;
+}
+
+// Reads whatever is waiting (up to a bound), false once the peer closed the connection
+static bool receive_available(std::uintptr_t handle, std::vector<std::uint8_t>& incoming, std::uint64_t& bytes)
+{
+    std::uint8_t buffer[64 * 1024];
+
+    do
+    {
+        const int received = ::recv(as_socket(handle), reinterpret_cast<char*>(buffer), sizeof(buffer), 0);
+        if (received <= 0)
+            return false;
+
+        incoming.insert(incoming.end(), buffer, buffer + received);
+        bytes += static_cast<std::uint64_t>(received);
+    } while (incoming.size() < remote::MAX_MESSAGE && wait_readable(handle, 0));
+
+    return true;
+}
+
+static void set_no_delay(std::uintptr_t handle)
+{
+    int yes = 1;
+    setsockopt(as_socket(handle), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&yes), sizeof(yes));
+}
+
+static bool make_address(const std::string& host, std::uint16_t port, sockaddr_in& address)
+{
+    address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    return inet_pton(AF_INET, host.c_str(), &address.sin_addr) == 1;
+}
+
+template <typename T>
+static void write_raw(std::vector<std::uint8_t>& out, const T& value)
+{
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool read_raw(const std::uint8_t*& it, const std::uint8_t* end, T& value)
+{
+    if (static_cast<std::size_t>(end - it) < sizeof(T))
+        return false;
+
+    std::memcpy(&value, it, sizeof(T));
+    it += sizeof(T);
+    return true;
+}
+
+// Keys are node addresses, a list in tree order mostly steps between neighbouring allocations
+static void write_key(std::vector<std::uint8_t>& out, std::uint64_t key, std::uint64_t& previous)
+{
+    const std::uint64_t delta = key - previous;
+    write_varint(out, (delta << 1) ^ (0 - (delta >> 63)));
+    previous = key;
+}
+
+static std::uint64_t read_key(const std::uint8_t*& it, const std::uint8_t* end, std::uint64_t& previous)
+{
+    const std::uint64_t zigzag = read_varint(it, end);
+    previous += (zigzag >> 1) ^ (0 - (zigzag & 1));
+    return previous;
+}
+
+static void write_string(std::vector<std::uint8_t>& out, const std::string& value)
+{
+    write_varint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+static bool read_string(const std::uint8_t*& it, const std::uint8_t* end, std::string& value)
+{
+    const std::uint64_t length = read_varint(it, end);
+    if (length > static_cast<std::uint64_t>(end - it))
+        return false;
+
+    value.assign(reinterpret_cast<const char*>(it), static_cast<std::size_t>(length));
+    it += length;
+    return true;
+}
+
+static std::size_t begin_message(std::vector<std::uint8_t>& out, remote::type_t type)
+{
+    const std::size_t start = out.size();
+    write_raw(out, std::uint32_t(0));
+    out.push_back(type);
+    return start;
+}
+
+static void end_message(std::vector<std::uint8_t>& out, std::size_t start)
+{
+    const std::uint32_t size = static_cast<std::uint32_t>(out.size() - start - sizeof(std::uint32_t));
+    std::memcpy(out.data() + start, &size, sizeof(size));
+}
+
+bool remote::parse_address(const char* text, std::string& host, std::uint16_t& port)
+{
+    if (!text)
+        return false;
+
+    const char* colon = std::strrchr(text, ':');
+    host = colon ? std::string(text, colon) : "127.0.0.1";
+
+    const char* digits = colon ? colon + 1 : text;
+    if (!*digits)
+    {
+        port = DEFAULT_PORT;
+        return !host.empty();
+    }
+
+    char* end = nullptr;
+    const unsigned long value = std::strtoul(digits, &end, 10);
+    if (*end || !value || value > UINT16_MAX || host.empty())
+        return false;
+
+    port = static_cast<std::uint16_t>(value);
+    return true;
+}
+
+void remote_encoder_t::encode(const remote::scene_t& scene, std::uint32_t frame, bool keyframe, std::vector<std::uint8_t>& out)
+{
+    keyframe = keyframe || !baseline;
+    baseline = true;
+    generation++;
+
+    // A keyframe is a delta against nothing, every node comes out as new
+    if (keyframe)
+        sent.clear();
+
+    nodes.clear();
+    removed.clear();
+
+    std::uint64_t previous = 0;
+    std::uint32_t node_count = 0;
+
+    for (const remote::node_t& node : scene.nodes)
+    {
+        auto [it, inserted] = sent.try_emplace(node.key);
+        remote::node_t& last = it->second.node;
+        it->second.generation = generation;
+
+        std::uint8_t flags = 0;
+        if (inserted || last.parent != node.parent || last.dims != node.dims || last.name != node.name || last.class_name != node.class_name)
+            flags |= remote::STRUCTURE;
+
+        std::uint32_t mask = 0;
+        for (std::uint32_t i = 0; i < node.dims; i++)
+        {
+            if (std::memcmp(&last.values[i], &node.values[i], sizeof(float)) != 0)
+                mask |= 1u << i;
+        }
+
+        if (mask)
+            flags |= remote::VALUES;
+
+        if (!flags)
+            continue;
+
+        write_key(nodes, node.key, previous);
+        nodes.push_back(flags);
+        node_count++;
+
+        if (flags & remote::STRUCTURE)
+        {
+            write_varint(nodes, node.parent);
+            write_string(nodes, node.name);
+            write_string(nodes, node.class_name);
+            nodes.push_back(node.dims);
+
+            last.key = node.key;
+            last.parent = node.parent;
+            last.name = node.name;
+            last.class_name = node.class_name;
+            last.dims = node.dims;
+        }
+
+        if (flags & remote::VALUES)
+        {
+            write_varint(nodes, mask);
+
+            for (std::uint32_t i = 0; i < node.dims; i++)
+            {
+                if (!(mask & (1u << i)))
+                    continue;
+
+                std::uint32_t bits = 0, last_bits = 0;
+                std::memcpy(&bits, &node.values[i], sizeof(bits));
+                std::memcpy(&last_bits, &last.values[i], sizeof(last_bits));
+
+                write_varint(nodes, bits ^ last_bits);
+                last.values[i] = node.values[i];
+            }
+        }
+    }
+
+    std::uint32_t removed_count = 0;
+    std::uint64_t previous_removed = 0;
+
+    for (auto it = sent.begin(); it != sent.end();)
+    {
+        if (it->second.generation == generation)
+        {
+            ++it;
+            continue;
+        }
+
+        write_key(removed, it->first, previous_removed);
+        removed_count++;
+        it = sent.erase(it);
+    }
+
+    const std::size_t start = begin_message(out, keyframe ? remote::KEYFRAME : remote::DELTA);
+    write_varint(out, frame);
+    write_raw(out, scene.time);
+
+    if (!keyframe)
+    {
+        write_varint(out, removed_count);
+        out.insert(out.end(), removed.begin(), removed.end());
+    }
+
+    write_varint(out, node_count);
+    out.insert(out.end(), nodes.begin(), nodes.end());
+    end_message(out, start);
+}
+
+void remote_encoder_t::reset()
+{
+    sent.clear();
+    baseline = false;
+}
+
+bool remote_decoder_t::apply(std::uint8_t type, const std::uint8_t* data, std::size_t size)
+{
+    const std::uint8_t* it = data;
+    const std::uint8_t* end = data + size;
+
+    if (type == remote::HELLO)
+    {
+        std::uint32_t magic = 0, version = 0;
+        reset();
+        return read_raw(it, end, magic) && read_raw(it, end, version) && magic == remote::MAGIC && version == remote::VERSION;
+    }
+
+    if (type != remote::KEYFRAME && type != remote::DELTA)
+        return false;
+
+    if (type == remote::DELTA && !synced)
+        return false;
+
+    const std::uint32_t next_frame = static_cast<std::uint32_t>(read_varint(it, end));
+    double next_time = 0.0;
+    if (!read_raw(it, end, next_time))
+        return false;
+
+    // From here a malformed message leaves the mirror half updated, only a keyframe can fix it
+    synced = false;
+
+    if (type == remote::KEYFRAME)
+        nodes.clear();
+    else
+    {
+        std::uint64_t previous = 0;
+        const std::uint64_t removed_count = read_varint(it, end);
+        for (std::uint64_t i = 0; i < removed_count && it < end; i++)
+            nodes.erase(read_key(it, end, previous));
+    }
+
+    std::uint64_t previous = 0;
+    const std::uint64_t node_count = read_varint(it, end);
+
+    for (std::uint64_t i = 0; i < node_count; i++)
+    {
+        const std::uint64_t key = read_key(it, end, previous);
+
+        std::uint8_t flags = 0;
+        if (!read_raw(it, end, flags))
+            return false;
+
+        remote::node_t& node = nodes[key];
+        node.key = key;
+
+        if (flags & remote::STRUCTURE)
+        {
+            node.parent = read_varint(it, end);
+            if (!read_string(it, end, node.name) || !read_string(it, end, node.class_name) || !read_raw(it, end, node.dims) || node.dims > remote::MAX_DIMS)
+                return false;
+        }
+
+        if (flags & remote::VALUES)
+        {
+            const std::uint64_t mask = read_varint(it, end);
+            if (mask >> node.dims)
+                return false;
+
+            for (std::uint32_t j = 0; j < node.dims; j++)
+            {
+                if (!(mask & (1ull << j)))
+                    continue;
+
+                std::uint32_t bits = 0;
+                std::memcpy(&bits, &node.values[j], sizeof(bits));
+                bits ^= static_cast<std::uint32_t>(read_varint(it, end));
+                std::memcpy(&node.values[j], &bits, sizeof(bits));
+            }
+        }
+    }
+
+    if (it != end)
+        return false;
+
+    frame = next_frame;
+    time = next_time;
+    synced = true;
+    return true;
+}
+
+void remote_decoder_t::reset()
+{
+    nodes.clear();
+    frame = 0;
+    time = 0.0;
+    synced = false;
+}
+
+remote_server_t::~remote_server_t()
+{
+    stop();
+}
+
+bool remote_server_t::start(const std::string& host, std::uint16_t port)
+{
+    stop();
+
+    sockaddr_in address;
+    if (!startup() || !make_address(host, port, address))
+        return false;
+
+    socket_t socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket == INVALID_SOCKET)
+        return false;
+
+#ifndef _WIN32
+    // Restarting right after a viewer disconnected would otherwise wait for TIME_WAIT
+    int yes = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+#endif
+
+    if (bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(socket, 1) != 0)
+    {
+        closesocket(socket);
+        return false;
+    }
+
+    listener = static_cast<std::uintptr_t>(socket);
+
+    frame = 0;
+    last_keyframe = 0;
+    acked_frame = 0;
+    stats = {};
+    stopping = false;
+    network = std::thread(&remote_server_t::network_loop, this);
+
+    return true;
+}
+
+void remote_server_t::stop()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    cv.notify_all();
+
+    if (network.joinable())
+        network.join();
+
+    if (client != NO_SOCKET)
+        closesocket(as_socket(client));
+
+    if (listener != NO_SOCKET)
+        closesocket(as_socket(listener));
+
+    client = NO_SOCKET;
+    listener = NO_SOCKET;
+    connected = false;
+    outgoing.clear();
+    encoder.reset();
+}
+
+bool remote_server_t::is_ready() const
+{
+    std::lock_guard lock(mutex);
+    return connected.load(std::memory_order_relaxed) && frame - acked_frame.load(std::memory_order_acquire) < remote::WINDOW;
+}
+
+bool remote_server_t::publish(const remote::scene_t& scene)
+{
+    {
+        std::lock_guard lock(mutex);
+
+        if (!connected.load(std::memory_order_relaxed))
+            return false;
+
+        if (frame - acked_frame.load(std::memory_order_acquire) >= remote::WINDOW)
+        {
+            stats.dropped++;
+            return false;
+        }
+
+        frame++;
+
+        const bool keyframe = keyframe_requested.exchange(false) || frame - last_keyframe >= remote::KEYFRAME_INTERVAL;
+        if (keyframe)
+        {
+            last_keyframe = frame;
+            stats.keyframes++;
+        }
+
+        const std::size_t before = outgoing.size();
+        encoder.encode(scene, frame, keyframe, outgoing);
+
+        stats.frames++;
+        stats.bytes += outgoing.size() - before;
+    }
+
+    cv.notify_one();
+    return true;
+}
+
+remote_server_t::stats_t remote_server_t::get_stats() const
+{
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+void remote_server_t::network_loop()
+{
+    std::vector<std::uint8_t> sending;
+    std::vector<std::uint8_t> incoming;
+    std::uint64_t received = 0;
+
+    while (true)
+    {
+        {
+            std::lock_guard lock(mutex);
+            if (stopping)
+                break;
+        }
+
+        if (client == NO_SOCKET)
+        {
+            if (!wait_readable(listener, 100))
+                continue;
+
+            socket_t socket = accept(as_socket(listener), nullptr, nullptr);
+            if (socket == INVALID_SOCKET)
+                continue;
+
+            const std::uintptr_t handle = static_cast<std::uintptr_t>(socket);
+            set_no_delay(handle);
+
+            std::vector<std::uint8_t> hello;
+            const std::size_t start = begin_message(hello, remote::HELLO);
+            write_raw(hello, remote::MAGIC);
+            write_raw(hello, remote::VERSION);
+            end_message(hello, start);
+
+            if (!send_all(handle, hello.data(), hello.size()))
+            {
+                closesocket(socket);
+                continue;
+            }
+
+            // Whatever was queued for the previous viewer is useless to this one, it starts from a keyframe
+            std::lock_guard lock(mutex);
+            outgoing.clear();
+            acked_frame = frame;
+            keyframe_requested = true;
+            client = handle;
+            connected = true;
+            incoming.clear();
+            continue;
+        }
+
+        bool alive = true;
+        if (wait_readable(client, 0))
+            alive = receive_available(client, incoming, received);
+
+        std::size_t offset = 0;
+        while (alive && incoming.size() - offset >= HEADER_SIZE)
+        {
+            std::uint32_t size = 0;
+            std::memcpy(&size, incoming.data() + offset, sizeof(size));
+
+            if (!size || size > remote::MAX_MESSAGE)
+            {
+                alive = false;
+                break;
+            }
+
+            if (incoming.size() - offset - sizeof(size) < size)
+                break;
+
+            const std::uint8_t type = incoming[offset + sizeof(size)];
+            const std::uint8_t* it = incoming.data() + offset + HEADER_SIZE;
+            const std::uint8_t* end = incoming.data() + offset + sizeof(size) + size;
+
+            if (type == remote::ACK)
+            {
+                // Frames are numbered with wrap around, an older ack arriving late is ignored
+                const std::uint32_t value = static_cast<std::uint32_t>(read_varint(it, end));
+                if (static_cast<std::int32_t>(value - acked_frame.load(std::memory_order_relaxed)) > 0)
+                    acked_frame.store(value, std::memory_order_release);
+            }
+            else if (type == remote::RESYNC)
+                keyframe_requested = true;
+
+            offset += sizeof(size) + size;
+        }
+
+        incoming.erase(incoming.begin(), incoming.begin() + offset);
+
+        if (alive)
+        {
+            {
+                std::unique_lock lock(mutex);
+                cv.wait_for(lock, std::chrono::milliseconds(2), [&]() { return stopping || !outgoing.empty(); });
+
+                // Every message queued since the last send goes out at once
+                sending.clear();
+                sending.swap(outgoing);
+            }
+
+            if (!sending.empty())
+                alive = send_all(client, sending.data(), sending.size());
+        }
+
+        if (!alive)
+        {
+            std::lock_guard lock(mutex);
+            closesocket(as_socket(client));
+            client = NO_SOCKET;
+            connected = false;
+            outgoing.clear();
+        }
+    }
+}
+
+remote_client_t::~remote_client_t()
+{
+    close();
+}
+
+bool remote_client_t::connect(const std::string& host, std::uint16_t port)
+{
+    close();
+
+    sockaddr_in address;
+    if (!startup() || !make_address(host, port, address))
+        return false;
+
+    socket_t handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (handle == INVALID_SOCKET)
+        return false;
+
+    if (::connect(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        closesocket(handle);
+        return false;
+    }
+
+    socket = static_cast<std::uintptr_t>(handle);
+    set_no_delay(socket);
+
+    decoder.reset();
+    incoming.clear();
+    resync_sent = false;
+    stats = {};
+
+    return true;
+}
+
+void remote_client_t::close()
+{
+    if (socket != NO_SOCKET)
+        closesocket(as_socket(socket));
+
+    socket = NO_SOCKET;
+}
+
+bool remote_client_t::send_message(remote::type_t type, const std::vector<std::uint8_t>& payload)
+{
+    std::vector<std::uint8_t> message;
+    const std::size_t start = begin_message(message, type);
+    message.insert(message.end(), payload.begin(), payload.end());
+    end_message(message, start);
+
+    return send_all(socket, message.data(), message.size());
+}
+
+bool remote_client_t::poll(int timeout_ms)
+{
+    if (socket == NO_SOCKET)
+        return false;
+
+    if (!wait_readable(socket, timeout_ms))
+        return true;
+
+    if (!receive_available(socket, incoming, stats.bytes))
+    {
+        close();
+        return false;
+    }
+
+    stats.reads++;
+
+    bool framed = false;
+    std::uint32_t last_frame = 0;
+
+    std::size_t offset = 0;
+    while (incoming.size() - offset >= HEADER_SIZE)
+    {
+        std::uint32_t size = 0;
+        std::memcpy(&size, incoming.data() + offset, sizeof(size));
+
+        if (!size || size > remote::MAX_MESSAGE)
+        {
+            close();
+            return false;
+        }
+
+        if (incoming.size() - offset - sizeof(size) < size)
+            break;
+
+        const std::uint8_t type = incoming[offset + sizeof(size)];
+        const std::uint8_t* data = incoming.data() + offset + HEADER_SIZE;
+        const std::size_t length = size - 1;
+
+        const bool applied = decoder.apply(type, data, length);
+
+        if (type == remote::HELLO && !applied)
+        {
+            close();
+            return false;
+        }
+
+        if (type == remote::KEYFRAME || type == remote::DELTA)
+        {
+            // Acked even when it couldn't be applied, the server stalls on its window otherwise and the keyframe never comes
+            const std::uint8_t* it = data;
+            last_frame = static_cast<std::uint32_t>(read_varint(it, data + length));
+            framed = true;
+
+            if (type == remote::KEYFRAME)
+                stats.keyframes++;
+            else
+                stats.deltas++;
+
+            if (applied)
+                resync_sent = false;
+            else if (!resync_sent)
+                resync_sent = send_message(remote::RESYNC, {});
+        }
+
+        offset += sizeof(size) + size;
+    }
+
+    incoming.erase(incoming.begin(), incoming.begin() + offset);
+
+    if (framed)
+    {
+        std::vector<std::uint8_t> payload;
+        write_varint(payload, last_frame);
+        if (!send_message(remote::ACK, payload))
+        {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class work_pool_t;
+
+namespace gd
+{
+	class SceneTree;
+}
+
+/*
+ * Out of process viewer link, the injected side only captures the scene and streams it over loopback TCP
+ * to a viewer process that keeps a mirror of it (no window, device or ImGui in the game)
+ *
+ * Message  { u32 size, u8 type, payload }, size counts the type and the payload
+ * HELLO    server -> viewer { u32 magic, u32 version }
+ * KEYFRAME server -> viewer { varint frame, f64 time, varint node_count, node * node_count }, replaces the mirror
+ * DELTA    server -> viewer { varint frame, f64 time, varint removed_count, varint key * removed_count,
+ *                             varint node_count, node * node_count }, only new nodes and nodes that changed
+ * ACK      viewer -> server { varint frame }, the last frame applied
+ * RESYNC   viewer -> server { }, asks for a keyframe
+ *
+ * node     { varint key (zigzag delta from the previous key of the list), u8 flags,
+ *            STRUCTURE: varint parent, varint length, name, varint length, class, u8 dims
+ *            VALUES: varint mask of the floats that changed, varint (bits ^ previous bits) per float in the mask }
+ *
+ * A delta is against the last frame sent, not the last one captured: at most WINDOW frames can be in flight without
+ * an ACK, past that the game side skips the capture and the changes go out with the next delta (back-pressure)
+ * The network thread writes everything queued since its last send at once and the viewer acks once per read (batching)
+ * A keyframe goes out when a viewer connects, on RESYNC and every KEYFRAME_INTERVAL frames
+*/
+namespace remote
+{
+	constexpr std::uint32_t MAGIC = 'G' | 'D' << 8 | 'R' << 16 | 'M' << 24;
+	constexpr std::uint32_t VERSION = 1;
+	constexpr std::uint16_t DEFAULT_PORT = 7420;
+
+	constexpr std::uint32_t WINDOW = 8;
+	constexpr std::uint32_t KEYFRAME_INTERVAL = 600;
+	constexpr std::uint32_t MAX_MESSAGE = 64 << 20;
+	constexpr std::uint8_t MAX_DIMS = 12;
+
+	enum type_t : std::uint8_t {
+		HELLO = 1,
+		KEYFRAME,
+		DELTA,
+		ACK,
+		RESYNC
+	};
+
+	enum flags_t : std::uint8_t {
+		STRUCTURE = 1,
+		VALUES = 2
+	};
+
+	struct node_t {
+		std::uint64_t key = 0;
+		std::uint64_t parent = 0; // 0 for the scene's root
+		std::string name;
+		std::string class_name;
+		std::uint8_t dims = 0; // 2 for a Node2D position, 12 for a Node3D global transform
+		float values[MAX_DIMS] = {};
+	};
+
+	struct scene_t {
+		double time = 0.0;
+		std::vector<node_t> nodes; // Parents before their children
+	};
+
+	// "port" or "host:port" (GODOT_DUMPER_REMOTE), the host defaults to 127.0.0.1
+	bool parse_address(const char* text, std::string& host, std::uint16_t& port);
+
+	// Scenes smaller than this are walked on the calling thread, waking the pool would cost more than it saves
+	constexpr std::size_t PARALLEL_NODES = 20000;
+
+	// Walks the current scene into out (remote_capture.cpp, needs the SDK), preorder like a serial walk
+	// The walk is split across pool once the previous capture was PARALLEL_NODES or more, pool may be nullptr
+	bool capture(gd::SceneTree* tree, scene_t& out, work_pool_t* pool = nullptr);
+}
+
+class remote_encoder_t {
+public:
+	// Appends the message for scene to out, a keyframe if asked or if nothing was encoded since reset
+	void encode(const remote::scene_t& scene, std::uint32_t frame, bool keyframe, std::vector<std::uint8_t>& out);
+	void reset();
+
+private:
+	struct sent_t {
+		remote::node_t node;
+		std::uint32_t generation;
+	};
+
+	std::unordered_map<std::uint64_t, sent_t> sent;
+	std::uint32_t generation = 0;
+	bool baseline = false;
+
+	std::vector<std::uint8_t> removed;
+	std::vector<std::uint8_t> nodes;
+};
+
+class remote_decoder_t {
+public:
+	// One message's type and payload, false if it's malformed or a delta came without a keyframe before it
+	bool apply(std::uint8_t type, const std::uint8_t* data, std::size_t size);
+	void reset();
+
+	bool is_synced() const { return synced; }
+	std::uint32_t get_frame() const { return frame; }
+	double get_time() const { return time; }
+	const std::unordered_map<std::uint64_t, remote::node_t>& get_nodes() const { return nodes; }
+
+private:
+	std::unordered_map<std::uint64_t, remote::node_t> nodes;
+	std::uint32_t frame = 0;
+	double time = 0.0;
+	bool synced = false;
+};
+
+// Game side, one viewer at a time, publish is called from a single thread
+class remote_server_t {
+public:
+	struct stats_t {
+		std::uint64_t frames = 0;
+		std::uint64_t keyframes = 0;
+		std::uint64_t dropped = 0;
+		std::uint64_t bytes = 0;
+	};
+
+	~remote_server_t();
+
+	bool start(const std::string& host, std::uint16_t port);
+	void stop();
+
+	bool is_connected() const { return connected.load(std::memory_order_acquire); }
+	// A viewer is connected and less than WINDOW frames behind, capturing is pointless otherwise
+	bool is_ready() const;
+
+	// False if the frame was dropped (no viewer, or back-pressure)
+	bool publish(const remote::scene_t& scene);
+
+	stats_t get_stats() const;
+
+private:
+	void network_loop();
+
+private:
+	std::uintptr_t listener = ~std::uintptr_t(0);
+	std::uintptr_t client = ~std::uintptr_t(0);
+
+	remote_encoder_t encoder;
+	std::uint32_t frame = 0;
+	std::uint32_t last_keyframe = 0;
+
+	std::atomic<bool> connected = false;
+	std::atomic<bool> keyframe_requested = false;
+	std::atomic<std::uint32_t> acked_frame = 0;
+
+	mutable std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<std::uint8_t> outgoing; // Every message queued since the last send
+	stats_t stats;
+	bool stopping = false;
+	std::thread network;
+};
+
+// Viewer side, single threaded
+class remote_client_t {
+public:
+	struct stats_t {
+		std::uint64_t keyframes = 0;
+		std::uint64_t deltas = 0;
+		std::uint64_t bytes = 0;
+		std::uint64_t reads = 0;
+	};
+
+	~remote_client_t();
+
+	bool connect(const std::string& host, std::uint16_t port);
+	void close();
+
+	// Waits up to timeout_ms for data, applies every complete message and acks the last frame, false once disconnected
+	bool poll(int timeout_ms);
+
+	const remote_decoder_t& get_scene() const { return decoder; }
+	const stats_t& get_stats() const { return stats; }
+
+private:
+	bool send_message(remote::type_t type, const std::vector<std::uint8_t>& payload);
+
+private:
+	std::uintptr_t socket = ~std::uintptr_t(0);
+
+	remote_decoder_t decoder;
+	std::vector<std::uint8_t> incoming;
+	bool resync_sent = false;
+	stats_t stats;
+};
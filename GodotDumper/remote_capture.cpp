@@ -0,0 +1,62 @@
+#include "remote.h"
+#include "godot.h"
+#include "profiler.h"
+#include "tree_walk.h"
+#include <cstring>
+
+bool remote::capture(gd::SceneTree* tree, scene_t& out, work_pool_t* pool)
+{
+    PROFILE_SCOPE("remote::capture");
+
+    gd::Node* scene = tree ? tree->get_current_scene() : nullptr;
+    if (!scene)
+    {
+        out.nodes.clear();
+        return false;
+    }
+
+    struct class_t {
+        std::string name;
+        std::uint8_t dims;
+    };
+
+    // The class of a vtable never changes, only names are read every frame
+    // One cache per worker and the last one for the calling thread, the visitor never takes a lock
+    static std::vector<std::unordered_map<void*, class_t>> classes;
+    static tree_walker_t<node_t> walker;
+
+    work_pool_t* workers = pool && out.nodes.size() >= PARALLEL_NODES ? pool : nullptr;
+    const std::size_t caller = workers ? workers->get_worker_count() : 0;
+    if (classes.size() <= caller)
+        classes.resize(caller + 1);
+
+    walker.walk(scene, workers, out.nodes, [&](gd::Node* node, gd::Node* parent, std::uint32_t, node_t& entry)
+    {
+        const std::size_t worker = work_pool_t::get_worker_index();
+        std::unordered_map<void*, class_t>& cache = classes[worker == SIZE_MAX ? caller : worker];
+
+        auto it = cache.find(node->get_vtable());
+        if (it == cache.end())
+        {
+            std::string class_name = node->get_class_name();
+            const std::uint8_t dims = gd::Object::get_dims(gd::Object::get_kind(class_name));
+
+            it = cache.emplace(node->get_vtable(), class_t{ std::move(class_name), dims }).first;
+        }
+
+        entry.key = reinterpret_cast<std::uintptr_t>(node);
+        entry.parent = reinterpret_cast<std::uintptr_t>(parent);
+        entry.name = node->get_name();
+        entry.class_name = it->second.name;
+        entry.dims = it->second.dims;
+
+        if (entry.dims == 12)
+            std::memcpy(entry.values, &node->as<gd::Node3D>()->global_transform(), sizeof(float) * 12);
+        else if (entry.dims == 2)
+            std::memcpy(entry.values, &node->as<gd::Node2D>()->position(), sizeof(float) * 2);
+
+        return true;
+    });
+
+    return true;
+}
@@ -1,349 +1,514 @@
 #define IMGUI_DEFINE_MATH_OPERATORS
 #include "render.h"
 #include "godot.h"
-
-#include <dwmapi.h>
-#include <cstdio>
+#include "visuals.h"
+#include "objects.h"
+#include "properties.h"
+#include "sampler.h"
+#include "recorder.h"
+#include "pointerscan.h"
+#include "valuescan.h"
+#include "structdiff.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cfloat>
 #include <chrono>
-#include <thread>
+#include <cstdio>
+#include <format>
+
+render_t::render_t()
+{
+    detail = std::make_unique<detail_t>();
+}
+
+render_t::~render_t()
+{
+    destroy_imgui();
+    destroy_window();
+    destroy_device();
+}
+
+bool render_t::is_idle() const
+{
+    return !running && !visuals->enabled && ImGui::notifications.empty() && !recorder->is_recording() && !pointer_scan->is_running() && !value_scan->is_running() && !struct_capture->is_capturing();
+}
 
-extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+static gd::Node* current_node = nullptr;
+static gd::Node* last_scene = nullptr;
 
-LRESULT CALLBACK wnd_proc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+static void recursive_draw(gd::Node* node)
 {
-    if (ImGui_ImplWin32_WndProcHandler(hwnd, msg, wParam, lParam))
+    PROFILE_SCOPE("recursive_draw");
+
+    if (!node)
+        return;
+
+    std::string name = std::format("{} ({})##{}", node->get_name(), node->get_class_name(), (std::uintptr_t)node);
+
+    if (ImGui::TreeNode(name.c_str()))
     {
-        return true;
+        current_node = node;
+
+        LocalVector<gd::Node*>& children = node->get_children();
+        for (gd::Node* child : children)
+            recursive_draw(child);
+
+        ImGui::TreePop();
     }
+}
+
+static std::vector<sampler_t::sample_t> watch_history[sampler_t::MAX_WATCHES];
+static float watch_window = 5.f; // Seconds shown by the plots
 
-    switch (msg)
+// Pins the scalar components of a property
+static void watch_button(gd::Node* node, const char* name, const property_reader_t::plan_t::step_t& step)
+{
+    const std::uint32_t base = step.offset;
+    std::string label = std::format("{}.{}", node->get_name(), name);
+
+    auto button = [&](const char* text, const std::string& watch_name, std::uint32_t offset, sampler_t::kind_t kind)
     {
-    case WM_SYSCOMMAND:
-        if ((wParam & 0xfff0) == SC_KEYMENU)
+        ImGui::SameLine();
+        if (ImGui::SmallButton(std::format("{}##{}{}", text, name, offset).c_str()))
         {
-            return 0;
+            // The sampler looks the id up before every read, the node can be freed while it's watched
+            std::uint64_t instance_id = gd::ObjectDB::find_instance_id(node);
+            int index = instance_id ? sampler->watch(watch_name, instance_id, offset, kind) : -1;
+            if (index >= 0)
+                watch_history[index].clear();
         }
-        break;
+    };
 
-    case WM_SYSKEYDOWN:
-        if (wParam == VK_F4) {
-            DestroyWindow(hwnd);
-            return 0;
+    switch (step.field)
+    {
+    case property_reader_t::field_t::FLOAT:
+        button("Watch", label, base, sampler_t::kind_t::FLOAT);
+        break;
+    case property_reader_t::field_t::INT32:
+        button("Watch", label, base, sampler_t::kind_t::INT32);
+        break;
+    case property_reader_t::field_t::BOOL:
+        button("Watch", label, base, sampler_t::kind_t::BOOL);
+        break;
+    case property_reader_t::field_t::VECTOR2:
+        for (int i = 0; i < 2; i++)
+            button(i == 0 ? "x" : "y", label + (i == 0 ? ".x" : ".y"), base + i * static_cast<std::uint32_t>(sizeof(float)), sampler_t::kind_t::FLOAT);
+        break;
+    case property_reader_t::field_t::TRANSFORM3D:
+        // Only the origin, the basis is rarely useful as a curve
+        for (int i = 0; i < 3; i++)
+        {
+            const char* axis[] = { "x", "y", "z" };
+            button(axis[i], std::format("{}.origin.{}", label, axis[i]), base + static_cast<std::uint32_t>(offsetof(Transform3D, origin) + i * sizeof(float)), sampler_t::kind_t::FLOAT);
         }
         break;
-
-    case WM_DESTROY:
-        PostQuitMessage(0);
+    default:
         break;
-    case WM_CLOSE:
-        return 0;
     }
-
-    return DefWindowProcA(hwnd, msg, wParam, lParam);
-}
-
-render_t::render_t()
-{
-    detail = std::make_unique<detail_t>();
 }
 
-render_t::~render_t()
+static void render_watches()
 {
-    destroy_imgui();
-    destroy_window();
-    destroy_device();
-}
+    bool any = false;
+    for (std::size_t i = 0; i < sampler_t::MAX_WATCHES; i++)
+        any |= sampler->get_watch((int)i).active.load();
 
-bool render_t::create_window()
-{
-    detail->window_class.cbSize = sizeof(detail->window_class);
-    detail->window_class.style = CS_CLASSDC;
-    detail->window_class.lpszClassName = "T4";
-    detail->window_class.hInstance = GetModuleHandleA(0);
-    detail->window_class.lpfnWndProc = wnd_proc;
-
-    RegisterClassExA(&detail->window_class);
-
-    detail->window = CreateWindowExA(
-        WS_EX_TOPMOST | WS_EX_TRANSPARENT | WS_EX_LAYERED | WS_EX_TOOLWINDOW,
-        detail->window_class.lpszClassName,
-        "T4",
-        WS_POPUP,
-        0,
-        0,
-        GetSystemMetrics(SM_CXSCREEN),
-        GetSystemMetrics(SM_CYSCREEN),
-        0,
-        0,
-        detail->window_class.hInstance,
-        0
-    );
-
-    if (!detail->window)
-    {
-        return false;
-    }
+    if (!any)
+        return;
 
-    SetLayeredWindowAttributes(detail->window, RGB(0, 0, 0), BYTE(255), LWA_ALPHA);
+    ImGui::SetNextWindowSize({ 400, 300 }, ImGuiCond_FirstUseEver);
+    ImGui::Begin("Watches");
 
-    RECT client_area{};
-    RECT window_area{};
+    float rate = sampler->get_rate();
+    if (ImGui::SliderFloat("Rate (Hz)", &rate, 1.f, sampler_t::MAX_RATE, "%.0f", ImGuiSliderFlags_Logarithmic))
+        sampler->set_rate(rate);
 
-    GetClientRect(detail->window, &client_area);
-    GetWindowRect(detail->window, &window_area);
+    ImGui::SliderFloat("Window (s)", &watch_window, 0.1f, 30.f, "%.1f");
 
-    POINT diff{};
-    ClientToScreen(detail->window, &diff);
+    static std::vector<float> mins, maxs;
 
-    MARGINS margins
+    for (int i = 0; i < (int)sampler_t::MAX_WATCHES; i++)
     {
-        window_area.left + (diff.x - window_area.left),
-        window_area.top + (diff.y - window_area.top),
-        window_area.right,
-        window_area.bottom,
-    };
+        sampler_t::watch_t& watch = sampler->get_watch(i);
+        if (!watch.active.load())
+            continue;
 
-    DwmExtendFrameIntoClientArea(detail->window, &margins);
+        std::vector<sampler_t::sample_t>& history = watch_history[i];
+        sampler->drain(i, history);
 
-    ShowWindow(detail->window, SW_SHOW);
-    UpdateWindow(detail->window);
+        if (history.empty())
+            continue;
 
-    return true;
-}
+        // Keep a bit more than the window so resizing it doesn't start from an empty plot
+        const double t1 = history.back().time;
+        const double t0 = t1 - watch_window;
 
-bool render_t::create_device()
-{
-    DXGI_SWAP_CHAIN_DESC swap_chain_desc{};
+        auto first = std::lower_bound(history.begin(), history.end(), t1 - 30.0, [](const sampler_t::sample_t& sample, double time) { return sample.time < time; });
+        history.erase(history.begin(), first);
 
-    swap_chain_desc.BufferCount = 1;
+        ImGui::PushID(i);
+        ImGui::Text("%s: %.4f", watch.name.c_str(), history.back().value);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Remove"))
+            sampler->unwatch(i);
 
-    swap_chain_desc.BufferDesc.Width = 0;
-    swap_chain_desc.BufferDesc.Height = 0;
-    swap_chain_desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        if (watch.freed.load())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(freed)");
+        }
 
-    swap_chain_desc.OutputWindow = detail->window;
+        if (std::uint64_t dropped = watch.dropped.load())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%llu dropped)", (unsigned long long)dropped);
+        }
 
-    swap_chain_desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-    swap_chain_desc.Windowed = 1;
+        const ImVec2 size = { ImGui::GetContentRegionAvail().x, 80.f };
+        const ImVec2 pos = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(size);
 
-    swap_chain_desc.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+        const std::size_t bins = (std::size_t)std::max(size.x, 1.f);
+        mins.resize(bins);
+        maxs.resize(bins);
+        sampler_t::decimate(history.data(), history.size(), t0, t1, bins, mins.data(), maxs.data());
 
-    swap_chain_desc.SampleDesc.Count = 2;
-    swap_chain_desc.SampleDesc.Quality = 0;
+        float low = FLT_MAX, high = -FLT_MAX;
+        for (std::size_t b = 0; b < bins; b++)
+        {
+            if (mins[b] <= maxs[b])
+            {
+                low = std::min(low, mins[b]);
+                high = std::max(high, maxs[b]);
+            }
+        }
 
-    swap_chain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        if (high - low < 1e-6f)
+        {
+            low -= 0.5f;
+            high += 0.5f;
+        }
 
-    D3D_FEATURE_LEVEL feature_level;
-    D3D_FEATURE_LEVEL feature_level_list[2] = { D3D_FEATURE_LEVEL_11_0, D3D_FEATURE_LEVEL_10_0 };
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        draw_list->AddRectFilled(pos, { pos.x + size.x, pos.y + size.y }, ImGui::GetColorU32(ImGuiCol_FrameBg));
 
-    HRESULT result = D3D11CreateDeviceAndSwapChain(
-        nullptr,
-        D3D_DRIVER_TYPE_HARDWARE,
-        nullptr,
-        0,
-        feature_level_list,
-        2,
-        D3D11_SDK_VERSION,
-        &swap_chain_desc,
-        &detail->swap_chain,
-        &detail->device,
-        &feature_level,
-        &detail->device_context
-    );
+        auto to_y = [&](float value) { return pos.y + size.y - (value - low) / (high - low) * size.y; };
 
-    if (result == DXGI_ERROR_UNSUPPORTED)
-    {
-        result = D3D11CreateDeviceAndSwapChain(
-            nullptr,
-            D3D_DRIVER_TYPE_WARP,
-            nullptr,
-            0,
-            feature_level_list,
-            2,
-            D3D11_SDK_VERSION,
-            &swap_chain_desc,
-            &detail->swap_chain,
-            &detail->device,
-            &feature_level,
-            &detail->device_context
-        );
-    }
+        // One vertical min/max segment per pixel column, joined to the previous column
+        const ImU32 color = ImGui::GetColorU32(ImGuiCol_PlotLines);
+        float last_y = -1.f;
+        for (std::size_t b = 0; b < bins; b++)
+        {
+            if (mins[b] > maxs[b])
+                continue;
 
-    if (result != S_OK)
-    {
-        MessageBoxA(nullptr, "This software can not run on your computer.", "Critical Problem", MB_ICONERROR | MB_OK);
-    }
+            float x = pos.x + (float)b;
+            float y_min = to_y(mins[b]), y_max = to_y(maxs[b]);
 
-    ID3D11Texture2D* back_buffer{ nullptr };
-    detail->swap_chain->GetBuffer(0, IID_PPV_ARGS(&back_buffer));
+            if (last_y >= 0.f)
+                draw_list->AddLine({ x - 1.f, last_y }, { x, (y_min + y_max) * 0.5f }, color);
 
-    if (back_buffer)
-    {
-        detail->device->CreateRenderTargetView(back_buffer, nullptr, &detail->render_target_view);
-        back_buffer->Release();
+            draw_list->AddLine({ x, y_min }, { x, y_max + 1.f }, color);
+            last_y = (y_min + y_max) * 0.5f;
+        }
 
-        return true;
+        ImGui::PopID();
     }
 
-    return false;
+    ImGui::End();
 }
 
-bool render_t::create_imgui()
-{
-    ImGui::CreateContext();
-    ImGui::StyleColorsDark();
+static int selected_class = -1;
 
-    float main_scale = ImGui_ImplWin32_GetDpiScaleForMonitor(::MonitorFromPoint(POINT{ 0, 0 }, MONITOR_DEFAULTTOPRIMARY));
+static void render_objects()
+{
+    ImGui::SetNextWindowSize({ 400, 400 }, ImGuiCond_FirstUseEver);
 
-    ImGuiStyle& style = ImGui::GetStyle();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    io.IniFilename = nullptr;
+    ImGui::Begin("Objects");
+    if (ImGui::Button("Refresh"))
+        objects->refresh();
 
-    ImGui::StyleColorsDark();
-    style.ScaleAllSizes(main_scale);
-    style.FontScaleDpi = main_scale;
+    ImGui::SameLine();
+    if (gd::ObjectDB::get_slots())
+        ImGui::Text("%zu objects, %zu classes", objects->get_entries().size(), objects->get_classes().size());
+    else
+        ImGui::TextUnformatted("ObjectDB not found");
+    ImGui::Separator();
 
-    io.Fonts->AddFontDefault();
-    ImGui::MergeIconsWithLatestFont(10.f);
+    const std::vector<object_list_t::class_t>& classes = objects->get_classes();
+    std::string preview = selected_class >= 0 && selected_class < (int)classes.size() ? classes[selected_class].name : "All";
 
-    if (!ImGui_ImplWin32_Init(detail->window))
+    if (ImGui::BeginCombo("Class", preview.c_str()))
     {
-        return false;
+        if (ImGui::Selectable("All", selected_class == -1))
+            selected_class = -1;
+
+        for (std::size_t i = 0; i < classes.size(); i++)
+        {
+            std::string label = std::format("{} ({})##{}", classes[i].name, classes[i].count, i);
+            if (ImGui::Selectable(label.c_str(), selected_class == (int)i))
+                selected_class = (int)i;
+        }
+
+        ImGui::EndCombo();
     }
 
-    if (!detail->device || !detail->device_context)
+    // Filtering happens here so the clipper can skip the rows that aren't visible
+    static std::vector<std::uint32_t> rows;
+    rows.clear();
+
+    const std::vector<object_list_t::entry_t>& entries = objects->get_entries();
+    for (std::uint32_t i = 0; i < entries.size(); i++)
     {
-        return false;
+        if (selected_class == -1 || entries[i].class_index == (std::uint32_t)selected_class)
+            rows.push_back(i);
     }
 
-    if (!ImGui_ImplDX11_Init(detail->device, detail->device_context))
+    // The listing is only as fresh as the last refresh, an object freed since then (or whose slot now holds another
+    // object) isn't read
+    const auto is_alive = [](const object_list_t::entry_t& entry) { return gd::ObjectDB::get_instance(entry.instance_id) == entry.object; };
+
+    // With a single known class selected every visible row is read through the same plan
+    const property_reader_t::plan_t* plan = nullptr;
+    if (selected_class >= 0 && selected_class < (int)classes.size())
     {
-        return false;
+        for (std::uint32_t row : rows)
+        {
+            if (!is_alive(entries[row]))
+                continue;
+
+            plan = properties->get_plan(entries[row].object, false);
+            break;
+        }
     }
 
-    return true;
-}
+    const int columns = plan ? 1 + (int)plan->names.size() : 1;
 
-void render_t::destroy_device()
-{
-    if (detail->render_target_view) detail->render_target_view->Release();
-    if (detail->swap_chain) detail->swap_chain->Release();
-    if (detail->device_context) detail->device_context->Release();
-    if (detail->device) detail->device->Release();
-}
+    ImGui::BeginChild("##objects");
+    if (ImGui::BeginTable("##object_table", columns, ImGuiTableFlags_ScrollX | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+    {
+        ImGui::TableSetupColumn("Object");
+        for (int i = 1; i < columns; i++)
+            ImGui::TableSetupColumn(plan->names[i - 1]);
+        ImGui::TableHeadersRow();
+
+        static std::vector<gd::Object*> visible;
+        static std::vector<std::uint8_t> alive;
+        static std::vector<property_reader_t::value_t> values;
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)rows.size());
+        while (clipper.Step())
+        {
+            visible.clear();
+            alive.clear();
 
-void render_t::destroy_window()
-{
-    DestroyWindow(detail->window);
-    UnregisterClassA(detail->window_class.lpszClassName, detail->window_class.hInstance);
-}
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+            {
+                const object_list_t::entry_t& entry = entries[rows[row]];
+                alive.push_back(is_alive(entry));
 
-void render_t::destroy_imgui()
-{
-    ImGui_ImplDX11_Shutdown();
-    ImGui_ImplWin32_Shutdown();
-    ImGui::DestroyContext();
-}
+                if (alive.back())
+                    visible.push_back(entry.object);
+            }
 
-void render_t::start_render()
-{
-    MSG msg;
-    while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
-    {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
-    }
+            if (plan)
+                properties->read_many(visible.data(), visible.size(), plan, values);
 
-    ImGui_ImplDX11_NewFrame();
-    ImGui_ImplWin32_NewFrame();
-    ImGui::NewFrame();
+            std::size_t value_row = 0; // Into values, only the live rows were read
 
-    if (GetAsyncKeyState(VK_INSERT) & 1)
-    {
-        running = !running;
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+            {
+                const object_list_t::entry_t& entry = entries[rows[row]];
+                const object_list_t::class_t& entry_class = classes[entry.class_index];
+                const bool live = alive[row - clipper.DisplayStart];
 
-        if (running)
-        {
-            SetWindowLong(detail->window, GWL_EXSTYLE, WS_EX_TOOLWINDOW | WS_EX_TRANSPARENT);
-        }
-        else
-        {
-            SetWindowLong(detail->window, GWL_EXSTYLE, WS_EX_TOOLWINDOW | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_LAYERED);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+
+                // Freed rows stay in the table until the next refresh so the clipper's row count holds
+                if (!live)
+                {
+                    ImGui::TextDisabled("%s #%llx (freed)", entry_class.name.c_str(), static_cast<unsigned long long>(entry.instance_id));
+                    continue;
+                }
+
+                std::string label = std::format("{} #{:x}##{}", entry_class.name, entry.instance_id, (std::uintptr_t)entry.object);
+
+                // Only nodes have a properties window
+                if (ImGui::Selectable(label.c_str(), entry.object == current_node) && entry.object->is_node())
+                    current_node = entry.object->as<gd::Node>();
+
+                for (int i = 1; i < columns; i++)
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(property_reader_t::to_string(values[value_row * (columns - 1) + (i - 1)]).c_str());
+                }
+
+                value_row++;
+            }
         }
+
+        ImGui::EndTable();
     }
+    ImGui::EndChild();
+    ImGui::End();
 }
 
-void render_t::end_render()
+static int value_type = value_scanner_t::I32;
+static int value_compare = value_scanner_t::EXACT;
+static double value_low = 0.0;
+static double value_high = 0.0;
+
+static void render_value_scan()
 {
-    ImGui::RenderNotifications();
-    ImGui::Render();
+    static const char* TYPES[] = { "Int32", "Int64", "Float", "Double" };
+    static const char* COMPARES[] = { "Exact value", "Value between", "Unknown value", "Changed", "Unchanged", "Increased", "Decreased" };
 
-    float clear_color[4]{ 0, 0, 0, 0 };
-    detail->device_context->OMSetRenderTargets(1, &detail->render_target_view, nullptr);
-    detail->device_context->ClearRenderTargetView(detail->render_target_view, clear_color);
+    ImGui::SetNextWindowSize({ 400, 400 }, ImGuiCond_FirstUseEver);
 
-    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    ImGui::Begin("Value scan");
 
-    detail->swap_chain->Present(0, 0);
-}
+    if (value_scan->is_running())
+    {
+        ImGui::Text("Scanning memory...");
+        ImGui::End();
+        return;
+    }
 
-static gd::Node* current_node = nullptr;
-static gd::Node* last_scene = nullptr;
+    const value_scanner_t& scanner = value_scan->get_scanner();
 
-static void recursive_draw(gd::Node* node)
-{
-    if (!node)
-        return;
+    // The type is fixed once the first scan ran
+    ImGui::BeginDisabled(scanner.has_scan());
+    ImGui::Combo("Type", &value_type, TYPES, IM_ARRAYSIZE(TYPES));
+    ImGui::EndDisabled();
 
-    std::string name = std::format("{} ({})##{}", node->get_name(), node->get_class_name(), (std::uintptr_t)node);
+    ImGui::Combo("Scan", &value_compare, COMPARES, IM_ARRAYSIZE(COMPARES));
 
-    if (ImGui::TreeNode(name.c_str()))
-    {
-        current_node = node;
+    if (value_compare == value_scanner_t::EXACT || value_compare == value_scanner_t::RANGE)
+        ImGui::InputDouble(value_compare == value_scanner_t::RANGE ? "From" : "Value", &value_low);
 
-        LocalVector<gd::Node*> children = node->get_children();
-        for (gd::Node* child : children)
-            recursive_draw(child);
+    if (value_compare == value_scanner_t::RANGE)
+        ImGui::InputDouble("To", &value_high);
 
-        ImGui::TreePop();
+    value_scanner_t::query_t query;
+    query.compare = static_cast<value_scanner_t::compare_t>(value_compare);
+
+    if (value_type == value_scanner_t::F32 || value_type == value_scanner_t::F64)
+    {
+        query.low.f = value_low;
+        query.high.f = value_high;
+    }
+    else
+    {
+        query.low.i = static_cast<std::int64_t>(value_low);
+        query.high.i = static_cast<std::int64_t>(value_high);
     }
+
+    // Relative scans need a previous scan, unknown only works as a first one
+    const bool relative = value_compare >= value_scanner_t::CHANGED;
+
+    ImGui::BeginDisabled(relative);
+    if (ImGui::Button("First scan"))
+        value_scan->start(static_cast<value_scanner_t::type_t>(value_type), query, false);
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!scanner.has_scan() || value_compare == value_scanner_t::UNKNOWN);
+    if (ImGui::Button("Next scan"))
+        value_scan->start(scanner.get_type(), query, true);
+    ImGui::EndDisabled();
+
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+        value_scan->reset();
+
+    ImGui::TextUnformatted(value_scan->get_status().c_str());
+    ImGui::Separator();
+
+    for (const value_scanner_t::result_t& result : value_scan->get_results())
+        ImGui::Text("%016llX  %s", static_cast<unsigned long long>(result.address), value_scanner_t::to_string(scanner.get_type(), result.value).c_str());
+
+    if (scanner.get_count() > value_scan->get_results().size())
+        ImGui::TextDisabled("%zu more", scanner.get_count() - value_scan->get_results().size());
+
+    ImGui::End();
 }
 
 void render_t::render_menu()
 {
+    PROFILE_SCOPE("render_menu");
+
     ImGui::SetNextWindowSize({ 400, 400 }, ImGuiCond_Always);
 
     ImGui::Begin("Godot Explorer");
+    ImGui::Checkbox("Visuals", &visuals->enabled);
+    ImGui::SameLine();
+    ImGui::Checkbox("Class tags", &visuals->show_class);
+    ImGui::SameLine();
+
+    if (!recorder->is_recording())
+    {
+        if (ImGui::Button("Record"))
+        {
+            std::string path = std::format("recording_{}.gdrec", std::chrono::system_clock::now().time_since_epoch().count());
+            if (!recorder->open(path))
+                ImGui::InsertNotification({ ImGuiToastType_Error, 3000, "Couldn't create the recording file" });
+        }
+    }
+    else
+    {
+        if (ImGui::Button("Stop"))
+            recorder->close();
+
+        ImGui::SameLine();
+        ImGui::Text("%u frames, %.1f MB", recorder->get_frame_count(), recorder->get_bytes_written() / (1024.0 * 1024.0));
+    }
+
+    ImGui::Separator();
     recursive_draw(gd::SceneTree::get_singleton()->get_current_scene());
     ImGui::End();
 
+    render_objects();
+    render_watches();
+    render_value_scan();
+
+#ifdef ENABLE_PROFILER
+    profiler->draw();
+#endif
+
     if (gd::SceneTree::get_singleton()->get_current_scene() != last_scene)
         current_node = nullptr;
 
     if (current_node != nullptr)
     {
         std::string class_name = current_node->get_class_name();
+        const gd::Object::Kind kind = gd::Object::get_kind(class_name);
 
         ImGui::Begin("Node properties");
         ImGui::Text("Name: %s", current_node->get_name().c_str());
         ImGui::Text("Class: %s", class_name.c_str());
         ImGui::Separator();
 
-        // TODO: Fix gd::Object::inherits_from
-        if (class_name.contains("3D"))
+        if (kind == gd::Object::Kind::NODE_3D)
         {
-            ImGui::InputFloat("Position X", &current_node->as<gd::Node3D>()->local_transform.origin.x);
-            ImGui::InputFloat("Position Y", &current_node->as<gd::Node3D>()->local_transform.origin.y);
-            ImGui::InputFloat("Position Z", &current_node->as<gd::Node3D>()->local_transform.origin.z);
+            ImGui::InputFloat("Position X", &current_node->as<gd::Node3D>()->local_transform().origin.x);
+            ImGui::InputFloat("Position Y", &current_node->as<gd::Node3D>()->local_transform().origin.y);
+            ImGui::InputFloat("Position Z", &current_node->as<gd::Node3D>()->local_transform().origin.z);
+
+            // Follows the edits above before the engine's next frame
+            Vector3 global = current_node->as<gd::Node3D>()->compute_global_transform().origin;
+            ImGui::Text("Global: %.3f %.3f %.3f", global.x, global.y, global.z);
         }
-        else if (class_name.contains("2D"))
+        else if (kind == gd::Object::Kind::NODE_2D)
         {
-            ImGui::InputFloat("Position X", &current_node->as<gd::Node2D>()->position.x);
-            ImGui::InputFloat("Position Y", &current_node->as<gd::Node2D>()->position.y);
+            ImGui::InputFloat("Position X", &current_node->as<gd::Node2D>()->position().x);
+            ImGui::InputFloat("Position Y", &current_node->as<gd::Node2D>()->position().y);
         }
 
         if (class_name == "Camera3D")
-            ImGui::InputFloat("FOV ", &current_node->as<gd::Camera3D>()->fov);
+            ImGui::InputFloat("FOV ", &current_node->as<gd::Camera3D>()->fov());
 
         if (current_node == last_scene)
             ImGui::Text("Scene path: %s", current_node->get_scene_file_path().c_str());
@@ -355,14 +520,74 @@ void render_t::render_menu()
         if (current_node->get_owner() != nullptr)
             ImGui::Text("Owner: %s", current_node->get_owner()->get_name().c_str());
 
+        if (const property_reader_t::plan_t* plan = properties->get_plan(current_node, true))
+        {
+            static std::vector<property_reader_t::value_t> values;
+            properties->read(current_node, plan, values);
+
+            ImGui::Separator();
+            for (std::size_t i = 0; i < plan->names.size(); i++)
+            {
+                ImGui::Text("%s: %s", plan->names[i], property_reader_t::to_string(values[i]).c_str());
+
+                auto step = std::find_if(plan->steps.begin(), plan->steps.end(), [i](const property_reader_t::plan_t::step_t& it) { return it.property == i; });
+                watch_button(current_node, plan->names[i], *step);
+            }
+        }
+
         ImGui::Separator();
         ImGui::Text("Address: %p", current_node);
+
+        // Static chains to the node survive a restart, rescan once the same node is selected again to keep the stable ones
+        if (pointer_scan->is_running())
+            ImGui::Text("Scanning memory...");
+        else
+        {
+            if (ImGui::Button("Pointer scan"))
+                pointer_scan->start(reinterpret_cast<std::uint64_t>(current_node), false);
+
+            ImGui::SameLine();
+            if (ImGui::Button("Rescan"))
+                pointer_scan->start(reinterpret_cast<std::uint64_t>(current_node), true);
+
+            ImGui::TextUnformatted(pointer_scan->get_status().c_str());
+            for (const std::string& path : pointer_scan->get_preview())
+                ImGui::BulletText("%s", path.c_str());
+        }
+
+        // Offsets for a new engine version, the node has to move or rotate while the frames are captured
+        ImGui::Separator();
+        if (struct_capture->is_capturing())
+        {
+            ImGui::Text("Capturing %u/%u frames", struct_capture->get_frame_count(), struct_capture_t::FRAMES);
+            ImGui::SameLine();
+            if (ImGui::Button("Stop"))
+                struct_capture->stop();
+        }
+        else
+        {
+            if (ImGui::Button("Find offsets"))
+                struct_capture->start(current_node, current_node->get_class_name());
+
+            ImGui::TextUnformatted(struct_capture->get_status().c_str());
+            for (const struct_analyzer_t::proposal_t& proposal : struct_capture->get_proposals())
+            {
+                std::string offsets;
+                for (std::uint32_t offset : proposal.offsets)
+                    offsets += std::format(" 0x{:X}", offset);
+
+                ImGui::BulletText("%s (0x%X):%s", proposal.target->name, proposal.reference, offsets.c_str());
+            }
+        }
+
         ImGui::End();
     }
 }
 
 void render_t::render_visuals()
 {
+    PROFILE_SCOPE("render_visuals");
+
     if (gd::SceneTree::get_singleton()->get_current_scene() != nullptr)
     {
         if (gd::SceneTree::get_singleton()->get_current_scene() != last_scene)
@@ -372,5 +597,19 @@ void render_t::render_visuals()
         }
     }
 
+    visuals->draw(gd::SceneTree::get_singleton());
+
+    if (recorder->is_recording())
+        recorder->record(gd::SceneTree::get_singleton(), ImGui::GetTime());
+
+    // The node may be freed with its scene, the capture ends with the selection
+    if (struct_capture->is_capturing())
+    {
+        if (struct_capture->get_object() != current_node)
+            struct_capture->stop();
+        else
+            struct_capture->update(ImGui::GetTime());
+    }
+
     last_scene = gd::SceneTree::get_singleton()->get_current_scene();
 }
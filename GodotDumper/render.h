@@ -3,13 +3,23 @@
 #include <vector>
 #include <string>
 
+/*
+ * The backend is chosen at compile time, define RENDER_HEADLESS in the preprocessor
+ * definitions to drive ImGui without a window or a GPU (render_headless.cpp)
+ * instead of the Win32/D3D11 overlay (render_dx11.cpp)
+*/
+#ifndef RENDER_HEADLESS
 #include <d3d11.h>
+#endif
 
 #include <imgui/imgui.h>
+#ifndef RENDER_HEADLESS
 #include <imgui/imgui_impl_dx11.h>
 #include <imgui/imgui_impl_win32.h>
+#endif
 #include <imgui/imgui_notify.h>
 
+#ifndef RENDER_HEADLESS
 struct detail_t {
 	HWND window = nullptr;
 	WNDCLASSEX window_class = {};
@@ -18,6 +28,43 @@ struct detail_t {
 	ID3D11RenderTargetView* render_target_view = nullptr;
 	IDXGISwapChain* swap_chain = nullptr;
 };
+#else
+#include <chrono>
+
+struct input_event_t {
+	enum type_t {
+		MOUSE_MOVE,
+		MOUSE_BUTTON,
+		MOUSE_WHEEL,
+		KEY,
+		TEXT,
+		TOGGLE_MENU // Same as pressing Insert on the overlay
+	};
+
+	type_t type = MOUSE_MOVE;
+	float x = 0.f, y = 0.f;
+	int code = 0; // Mouse button, ImGuiKey or character
+	bool down = false;
+};
+
+struct frame_stats_t {
+	double cpu_ms = 0.0; // From start_render to the end of ImGui::Render
+	int vertices = 0;
+	int indices = 0;
+	int commands = 0;
+	int draw_lists = 0;
+};
+
+struct detail_t {
+	ImVec2 display_size = { 1920.f, 1080.f };
+	float delta_time = 1.f / 60.f;
+
+	std::vector<input_event_t> input; // Consumed by the next start_render
+	frame_stats_t last_frame;
+
+	std::chrono::steady_clock::time_point frame_start;
+};
+#endif
 
 class render_t {
 public:
@@ -26,6 +73,11 @@ public:
 
 	bool running = false;
 
+	// True if nothing would be drawn this frame, the loop can then be throttled
+	bool is_idle() const;
+	// Cheap check for pending input or a menu toggle, doesn't render anything
+	bool poll_input();
+
 	void start_render();
 	void render_menu();
 	void render_visuals();
@@ -35,8 +87,15 @@ public:
 	bool create_window();
 	bool create_imgui();
 
+#ifdef RENDER_HEADLESS
+	void push_input(const input_event_t& event);
+	const frame_stats_t& get_frame_stats() const;
+#endif
+
 	std::unique_ptr<detail_t> detail = std::make_unique<detail_t>();
 private:
+	bool toggle_requested = false;
+
 	void destroy_device();
 	void destroy_window();
 	void destroy_imgui();
@@ -0,0 +1,156 @@
+#ifdef RENDER_HEADLESS
+#include "render.h"
+#include "font_cache.h"
+#include "profiler.h"
+
+/*
+ * Null renderer: ImGui builds its draw lists as usual but nothing is uploaded or drawn
+ * Input comes from push_input, so the explorer UI can be driven and timed without a window
+*/
+
+bool render_t::create_window()
+{
+    return true;
+}
+
+bool render_t::create_device()
+{
+    return true;
+}
+
+bool render_t::create_imgui()
+{
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.BackendPlatformName = "headless";
+    io.BackendRendererName = "null";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures | ImGuiBackendFlags_RendererHasVtxOffset;
+    io.DisplaySize = detail->display_size;
+
+    // Glyphs baked by an earlier injection (or tools/fontcache) are copied instead of rasterized
+    font_cache->load(io.Fonts, "godot_dumper_fonts.bin");
+    font_cache_t::add_fonts(io.Fonts);
+
+    return true;
+}
+
+void render_t::destroy_device()
+{
+}
+
+void render_t::destroy_window()
+{
+}
+
+void render_t::destroy_imgui()
+{
+    if (ImGui::GetCurrentContext())
+        ImGui::DestroyContext();
+}
+
+void render_t::push_input(const input_event_t& event)
+{
+    detail->input.push_back(event);
+}
+
+const frame_stats_t& render_t::get_frame_stats() const
+{
+    return detail->last_frame;
+}
+
+bool render_t::poll_input()
+{
+    return !detail->input.empty();
+}
+
+void render_t::start_render()
+{
+    PROFILE_SCOPE("start_render");
+
+    detail->frame_start = std::chrono::steady_clock::now();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = detail->display_size;
+    io.DeltaTime = detail->delta_time;
+
+    for (const input_event_t& event : detail->input)
+    {
+        switch (event.type)
+        {
+        case input_event_t::MOUSE_MOVE:
+            io.AddMousePosEvent(event.x, event.y);
+            break;
+        case input_event_t::MOUSE_BUTTON:
+            io.AddMouseButtonEvent(event.code, event.down);
+            break;
+        case input_event_t::MOUSE_WHEEL:
+            io.AddMouseWheelEvent(event.x, event.y);
+            break;
+        case input_event_t::KEY:
+            io.AddKeyEvent(static_cast<ImGuiKey>(event.code), event.down);
+            break;
+        case input_event_t::TEXT:
+            io.AddInputCharacter(static_cast<unsigned int>(event.code));
+            break;
+        case input_event_t::TOGGLE_MENU:
+            toggle_requested = true;
+            break;
+        }
+    }
+
+    detail->input.clear();
+
+    ImGui::NewFrame();
+
+    if (toggle_requested)
+    {
+        toggle_requested = false;
+        running = !running;
+    }
+}
+
+void render_t::end_render()
+{
+    PROFILE_SCOPE("end_render");
+
+    ImGui::RenderNotifications();
+    ImGui::Render();
+
+    ImDrawData* draw_data = ImGui::GetDrawData();
+
+    // Acknowledge texture requests, otherwise the atlas would be rebuilt every frame
+    if (draw_data->Textures != nullptr)
+    {
+        for (ImTextureData* tex : *draw_data->Textures)
+        {
+            if (tex->Status == ImTextureStatus_WantCreate)
+            {
+                tex->SetTexID(static_cast<ImTextureID>(1));
+                tex->SetStatus(ImTextureStatus_OK);
+            }
+            else if (tex->Status == ImTextureStatus_WantUpdates)
+            {
+                tex->SetStatus(ImTextureStatus_OK);
+            }
+            else if (tex->Status == ImTextureStatus_WantDestroy && tex->UnusedFrames > 0)
+            {
+                tex->SetTexID(ImTextureID_Invalid);
+                tex->SetStatus(ImTextureStatus_Destroyed);
+            }
+        }
+    }
+
+    frame_stats_t& stats = detail->last_frame;
+    stats = {};
+    stats.cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - detail->frame_start).count();
+    stats.vertices = draw_data->TotalVtxCount;
+    stats.indices = draw_data->TotalIdxCount;
+    stats.draw_lists = draw_data->CmdListsCount;
+
+    for (ImDrawList* list : draw_data->CmdLists)
+        stats.commands += list->CmdBuffer.Size;
+}
+#endif
@@ -0,0 +1,225 @@
+#include "resolver.h"
+#include <algorithm>
+#include <unordered_map>
+
+/*
+ * Literals picked from Godot's source, they haven't changed from 4.3 to 4.5
+ *
+ * SceneTree::SceneTree starts with "if (singleton == nullptr) singleton = this;" and defines the collision debug settings
+ * ObjectDB::cleanup warns about leaked instances, the ObjectDB globals are among the ones it touches
+*/
+static const resolver_t::rule_t default_rules[] = {
+    { "SceneTree::singleton", "debug/shapes/collision/shape_color", resolver_t::GLOBAL_WRITE, 0 },
+    { "SceneTree::SceneTree", "debug/shapes/collision/shape_color", resolver_t::FUNCTION },
+    { "ObjectDB::cleanup", "ObjectDB instances leaked at exit (run with --verbose for details).", resolver_t::FUNCTION },
+};
+
+void string_matcher_t::add(std::string_view pattern, std::uint32_t id)
+{
+    if (pattern.empty())
+        return;
+
+    if (nodes.empty())
+    {
+        nodes.emplace_back();
+        std::fill(std::begin(nodes[0].next), std::end(nodes[0].next), -1);
+    }
+
+    std::int32_t state = 0;
+    for (char c : pattern)
+    {
+        const std::uint8_t byte = static_cast<std::uint8_t>(c);
+
+        if (nodes[state].next[byte] <= 0)
+        {
+            nodes[state].next[byte] = static_cast<std::int32_t>(nodes.size());
+            nodes.emplace_back();
+            std::fill(std::begin(nodes.back().next), std::end(nodes.back().next), -1);
+        }
+
+        state = nodes[state].next[byte];
+    }
+
+    nodes[state].outputs.push_back(static_cast<std::uint32_t>(patterns.size()));
+    patterns.push_back({ id, static_cast<std::uint32_t>(pattern.size()) });
+}
+
+void string_matcher_t::build()
+{
+    if (nodes.empty())
+        return;
+
+    // Breadth first so a node's fail target is complete before its children use it
+    std::vector<std::int32_t> queue;
+    queue.reserve(nodes.size());
+
+    for (std::int32_t& next : nodes[0].next)
+    {
+        if (next <= 0)
+        {
+            next = 0;
+            continue;
+        }
+
+        nodes[next].fail = 0;
+        queue.push_back(next);
+    }
+
+    for (std::size_t head = 0; head < queue.size(); head++)
+    {
+        const std::int32_t state = queue[head];
+        const std::int32_t fail = nodes[state].fail;
+
+        const std::vector<std::uint32_t>& inherited = nodes[fail].outputs;
+        nodes[state].outputs.insert(nodes[state].outputs.end(), inherited.begin(), inherited.end());
+
+        for (int byte = 0; byte < 256; byte++)
+        {
+            std::int32_t& next = nodes[state].next[byte];
+
+            if (next < 0)
+            {
+                next = nodes[fail].next[byte];
+                continue;
+            }
+
+            nodes[next].fail = nodes[fail].next[byte];
+            queue.push_back(next);
+        }
+    }
+}
+
+resolver_t::resolver_t() : rules(std::begin(default_rules), std::end(default_rules))
+{
+}
+
+std::uint32_t resolver_t::apply(const pe_image_t& image, const xref_index_t& xrefs, const rule_t& rule, const xref_index_t::xref_t& reference) const
+{
+    const pe_image_t::function_t* fragment = image.get_function(reference.site);
+    if (!fragment)
+        return 0;
+
+    const pe_image_t::function_t* root = image.get_root_function(fragment);
+
+    if (rule.action == FUNCTION)
+        return root->begin;
+
+    if (rule.action == CALL_AFTER)
+    {
+        std::uint32_t skip = rule.index;
+        for (const xref_index_t::xref_t& xref : xrefs.get_references_from(reference.site + reference.length, fragment->end))
+        {
+            if (xref.kind == xref_index_t::CALL && skip-- == 0)
+                return xref.target;
+        }
+
+        return 0;
+    }
+
+    // The prologue's part first, then the part holding the literal if the compiler split the function
+    const xref_index_t::kind_t kind = rule.action == GLOBAL_WRITE ? xref_index_t::WRITE : xref_index_t::READ;
+    const pe_image_t::function_t* parts[] = { root, fragment != root ? fragment : nullptr };
+
+    std::uint32_t skip = rule.index;
+    for (const pe_image_t::function_t* part : parts)
+    {
+        if (!part)
+            continue;
+
+        for (const xref_index_t::xref_t& xref : xrefs.get_references_from(part->begin, part->end))
+        {
+            if (xref.kind != kind)
+                continue;
+
+            // Constants in .rdata aren't globals
+            const pe_image_t::section_t* section = image.get_section(xref.target);
+            if (!section || !section->is_writable())
+                continue;
+
+            if (skip-- == 0)
+                return xref.target;
+        }
+    }
+
+    return 0;
+}
+
+bool resolver_t::resolve(const pe_image_t& image, const xref_index_t& xrefs)
+{
+    results.assign(rules.size(), result_t{});
+
+    // Matching the terminator too so only whole literals count
+    string_matcher_t matcher;
+    for (std::size_t i = 0; i < rules.size(); i++)
+    {
+        results[i].rule = &rules[i];
+        matcher.add(std::string_view(rules[i].anchor, std::strlen(rules[i].anchor) + 1), static_cast<std::uint32_t>(i));
+    }
+
+    matcher.build();
+
+    std::vector<std::vector<std::uint32_t>> literals(rules.size());
+
+    for (const pe_image_t::section_t& section : image.get_sections())
+    {
+        if (section.is_executable() || !image.is_valid(section.rva, section.size))
+            continue;
+
+        const std::uint8_t* data = image.data() + section.rva;
+
+        matcher.scan(data, section.size, [&](std::uint32_t rule, std::size_t offset)
+        {
+            if (offset == 0 || data[offset - 1] == 0)
+                literals[rule].push_back(section.rva + static_cast<std::uint32_t>(offset));
+        });
+    }
+
+    bool all = true;
+
+    for (std::size_t i = 0; i < rules.size(); i++)
+    {
+        std::unordered_map<std::uint32_t, std::uint32_t> votes;
+
+        for (std::uint32_t literal : literals[i])
+        {
+            for (const xref_index_t::xref_t& reference : xrefs.get_references_to(literal))
+            {
+                if (std::uint32_t rva = apply(image, xrefs, rules[i], reference))
+                {
+                    votes[rva]++;
+                    results[i].references++;
+                }
+            }
+        }
+
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> ranked(votes.begin(), votes.end());
+        std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b)
+        {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+
+        for (const auto& [rva, count] : ranked)
+            results[i].candidates.push_back(rva);
+
+        if (!ranked.empty())
+        {
+            results[i].rva = ranked[0].first;
+            results[i].votes = ranked[0].second;
+        }
+
+        all &= results[i].rva != 0;
+    }
+
+    return all;
+}
+
+std::uint32_t resolver_t::get(std::string_view name) const
+{
+    for (const result_t& result : results)
+    {
+        if (result.rule && name == result.rule->name)
+            return result.rva;
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "pe.h"
+#include "xref.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Aho-Corasick automaton, finds every occurrence of any number of byte strings in one pass
+ * The goto function is completed into a full table so a step is one load per input byte
+*/
+class string_matcher_t {
+public:
+	void add(std::string_view pattern, std::uint32_t id);
+	void build();
+
+	// on_match(id, offset of the first byte)
+	template <typename F>
+	void scan(const std::uint8_t* data, std::size_t size, F&& on_match) const
+	{
+		if (nodes.empty())
+			return;
+
+		std::int32_t state = 0;
+
+		for (std::size_t i = 0; i < size; i++)
+		{
+			state = nodes[state].next[data[i]];
+
+			if (!nodes[state].outputs.empty())
+			{
+				for (std::uint32_t pattern : nodes[state].outputs)
+					on_match(patterns[pattern].id, i + 1 - patterns[pattern].length);
+			}
+		}
+	}
+
+private:
+	struct node_t {
+		std::int32_t next[256];
+		std::int32_t fail = 0;
+		std::vector<std::uint32_t> outputs; // Into patterns, own and inherited through fail links
+	};
+
+	struct pattern_t {
+		std::uint32_t id;
+		std::uint32_t length;
+	};
+
+	std::vector<node_t> nodes;
+	std::vector<pattern_t> patterns;
+};
+
+/*
+ * String anchored resolver
+ *
+ * Godot's string literals (setting paths, error messages) survive compiler and version changes much better than byte patterns
+ * A rule names a literal and what to take from the function referencing it: the function itself, the n-th global it
+ * writes or reads, or the n-th function it calls after loading the literal
+ *
+ * All the rules resolve together, one Aho-Corasick pass over the data sections finds every literal, then the
+ * xref index gives their references, a literal referenced from several places resolves to the majority answer
+*/
+class resolver_t {
+public:
+	enum action_t : std::uint8_t {
+		FUNCTION, // Start of the function referencing the literal
+		GLOBAL_WRITE, // n-th global written by that function (singleton = this)
+		GLOBAL_READ, // n-th global read by that function
+		CALL_AFTER // n-th function called after the literal is loaded
+	};
+
+	struct rule_t {
+		const char* name;
+		const char* anchor; // Whole literal, not a substring
+		action_t action;
+		std::uint32_t index = 0;
+	};
+
+	struct result_t {
+		const rule_t* rule = nullptr;
+		std::uint32_t rva = 0; // 0 if not found
+		std::uint32_t votes = 0; // References agreeing on rva
+		std::uint32_t references = 0; // References of the literal that led somewhere
+		std::vector<std::uint32_t> candidates; // Every RVA a reference led to, most votes first
+	};
+
+	std::vector<rule_t> rules;
+
+public:
+	resolver_t();
+
+	bool resolve(const pe_image_t& image, const xref_index_t& xrefs);
+
+	const std::vector<result_t>& get_results() const { return results; }
+
+	// RVA found for the rule with that name, 0 if it didn't resolve
+	std::uint32_t get(std::string_view name) const;
+
+private:
+	std::uint32_t apply(const pe_image_t& image, const xref_index_t& xrefs, const rule_t& rule, const xref_index_t::xref_t& reference) const;
+
+private:
+	std::vector<result_t> results;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Lock-free single producer / single consumer ring buffer with a fixed capacity
+ *
+ * Producer and consumer indices live on their own cache lines, each side also keeps a cached copy
+ * of the other side's index so the shared line is only read when the ring looks full (or empty)
+ * Nothing is allocated after construction
+*/
+template <typename T, std::size_t Capacity>
+class spsc_ring_t {
+	static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	static constexpr std::size_t capacity = Capacity;
+
+	// Producer only, false if the ring is full
+	bool push(const T& value)
+	{
+		T* slot = begin_push();
+		if (!slot)
+			return false;
+
+		*slot = value;
+		end_push();
+		return true;
+	}
+
+	// Producer only, the next free slot to be filled in place (nullptr if the ring is full), published by end_push
+	// Saves building a large T on the stack and copying it over, which also stalls when it was written piecewise
+	T* begin_push()
+	{
+		const std::size_t head = producer.index.load(std::memory_order_relaxed);
+
+		if (head - producer.cached_other == Capacity)
+		{
+			producer.cached_other = consumer.index.load(std::memory_order_acquire);
+			if (head - producer.cached_other == Capacity)
+				return nullptr;
+		}
+
+		return &buffer[head & (Capacity - 1)];
+	}
+
+	void end_push()
+	{
+		producer.index.store(producer.index.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer only, returns how many values were written to out
+	std::size_t pop(T* out, std::size_t max_count)
+	{
+		const std::size_t tail = consumer.index.load(std::memory_order_relaxed);
+
+		if (consumer.cached_other == tail)
+		{
+			consumer.cached_other = producer.index.load(std::memory_order_acquire);
+			if (consumer.cached_other == tail)
+				return 0;
+		}
+
+		std::size_t count = consumer.cached_other - tail;
+		if (count > max_count)
+			count = max_count;
+
+		for (std::size_t i = 0; i < count; i++)
+			out[i] = buffer[(tail + i) & (Capacity - 1)];
+
+		consumer.index.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	// Approximate when called while the other side is running
+	std::size_t size() const
+	{
+		return producer.index.load(std::memory_order_acquire) - consumer.index.load(std::memory_order_acquire);
+	}
+
+private:
+	struct alignas(64) side_t {
+		std::atomic<std::size_t> index = 0;
+		std::size_t cached_other = 0;
+	};
+
+	side_t producer;
+	side_t consumer;
+
+	alignas(64) T buffer[Capacity];
+};
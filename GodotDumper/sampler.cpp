@@ -0,0 +1,254 @@
+#include "sampler.h"
+#include "godot.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <xmmintrin.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+sampler_t::sampler_t()
+{
+    watches = std::make_unique<watch_t[]>(MAX_WATCHES);
+
+#ifdef _WIN32
+    stop_event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+    // Windows 10 1803 and later, the plain timer is only as precise as the scheduler tick
+    timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer)
+        timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+#endif
+}
+
+sampler_t::~sampler_t()
+{
+    stop();
+
+#ifdef _WIN32
+    if (timer)
+        CloseHandle(timer);
+    if (stop_event)
+        CloseHandle(stop_event);
+#endif
+}
+
+int sampler_t::watch(const std::string& name, std::uint64_t instance_id, std::uint32_t offset, kind_t kind)
+{
+    for (std::size_t i = 0; i < MAX_WATCHES; i++)
+    {
+        watch_t& entry = watches[i];
+        if (entry.active.load(std::memory_order_acquire))
+            continue;
+
+        // A pass that started before unwatch may still be reading this slot
+        if (entry.released_pass != 0 && passes.load(std::memory_order_acquire) < entry.released_pass + 1)
+            continue;
+
+        std::vector<sample_t> discard;
+        drain(static_cast<int>(i), discard);
+
+        entry.name = name;
+        entry.instance_id = instance_id;
+        entry.offset = offset;
+        entry.kind = kind;
+        entry.dropped.store(0, std::memory_order_relaxed);
+        entry.freed.store(false, std::memory_order_relaxed);
+        entry.active.store(true, std::memory_order_release);
+
+        if (threaded && !running.exchange(true, std::memory_order_acq_rel))
+        {
+#ifdef _WIN32
+            ResetEvent(stop_event);
+#endif
+            thread = std::thread(&sampler_t::run, this);
+        }
+
+        return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
+void sampler_t::unwatch(int index)
+{
+    watches[index].active.store(false, std::memory_order_release);
+    watches[index].released_pass = passes.load(std::memory_order_acquire) + 1;
+
+    for (std::size_t i = 0; i < MAX_WATCHES; i++)
+    {
+        if (watches[i].active.load(std::memory_order_acquire))
+            return;
+    }
+
+    // Nothing left to sample
+    stop();
+}
+
+void sampler_t::stop()
+{
+    if (!running.exchange(false, std::memory_order_acq_rel))
+        return;
+
+#ifdef _WIN32
+    SetEvent(stop_event);
+#else
+    {
+        // The thread checks running under the lock before it sleeps, the notification can't fall in between
+        std::lock_guard guard(wake_mutex);
+    }
+    wake.notify_all();
+#endif
+
+    if (thread.joinable())
+        thread.join();
+
+    // No pass can be reading a slot anymore
+    for (std::size_t i = 0; i < MAX_WATCHES; i++)
+        watches[i].released_pass = 0;
+}
+
+void sampler_t::set_rate(float hz)
+{
+    rate.store(std::clamp(hz, 1.f, MAX_RATE), std::memory_order_relaxed);
+}
+
+float sampler_t::get_rate() const
+{
+    return rate.load(std::memory_order_relaxed);
+}
+
+void sampler_t::sample_once(double time)
+{
+    for (std::size_t i = 0; i < MAX_WATCHES; i++)
+    {
+        watch_t& entry = watches[i];
+        if (!entry.active.load(std::memory_order_acquire) || entry.freed.load(std::memory_order_relaxed))
+            continue;
+
+        // Instance ids aren't reused, once the lookup fails the object is gone for good
+        gd::Object* object = gd::ObjectDB::get_instance(entry.instance_id);
+        if (!object)
+        {
+            entry.freed.store(true, std::memory_order_relaxed);
+            continue;
+        }
+
+        const std::uint8_t* address = reinterpret_cast<const std::uint8_t*>(object) + entry.offset;
+
+        float value = 0.f;
+        switch (entry.kind)
+        {
+        case kind_t::FLOAT:
+            value = *reinterpret_cast<const volatile float*>(address);
+            break;
+        case kind_t::INT32:
+            value = static_cast<float>(*reinterpret_cast<const volatile std::int32_t*>(address));
+            break;
+        case kind_t::BOOL:
+            value = *reinterpret_cast<const volatile bool*>(address) ? 1.f : 0.f;
+            break;
+        }
+
+        if (!entry.ring.push({ time, value }))
+            entry.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    passes.fetch_add(1, std::memory_order_release);
+}
+
+std::size_t sampler_t::drain(int index, std::vector<sample_t>& out)
+{
+    watch_t& entry = watches[index];
+
+    std::size_t offset = out.size();
+    out.resize(offset + entry.ring.size());
+
+    std::size_t count = entry.ring.pop(out.data() + offset, out.size() - offset);
+    out.resize(offset + count);
+
+    return count;
+}
+
+void sampler_t::run()
+{
+    using clock = std::chrono::steady_clock;
+
+    const clock::time_point start = clock::now();
+    clock::time_point next = start;
+
+    for (;;)
+    {
+        next += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate.load(std::memory_order_relaxed)));
+
+        // Fell behind (debugger, suspended game), don't try to catch up with a burst of samples
+        clock::time_point now = clock::now();
+        if (now - next > std::chrono::milliseconds(100))
+            next = now;
+
+        if (!wait_until(next))
+            break;
+
+        sample_once(std::chrono::duration<double>(clock::now() - start).count());
+    }
+}
+
+bool sampler_t::wait_until(std::chrono::steady_clock::time_point next)
+{
+    if (next - std::chrono::steady_clock::now() < SPIN_WAIT)
+    {
+        while (std::chrono::steady_clock::now() < next)
+        {
+            if (!running.load(std::memory_order_acquire))
+                return false;
+
+            _mm_pause();
+        }
+
+        return running.load(std::memory_order_acquire);
+    }
+
+#ifdef _WIN32
+    const std::int64_t remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(next - std::chrono::steady_clock::now()).count();
+
+    // Relative due time in 100ns units
+    LARGE_INTEGER due;
+    due.QuadPart = -std::max<std::int64_t>(remaining / 100, 1);
+
+    if (!timer || !SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE))
+        return WaitForSingleObject(stop_event, static_cast<DWORD>(std::max<std::int64_t>(remaining / 1000000, 1))) == WAIT_TIMEOUT;
+
+    HANDLE handles[] = { stop_event, timer };
+    return WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1;
+#else
+    std::unique_lock lock(wake_mutex);
+    return !wake.wait_until(lock, next, [this]() { return !running.load(std::memory_order_acquire); });
+#endif
+}
+
+void sampler_t::decimate(const sample_t* samples, std::size_t count, double t0, double t1, std::size_t bins, float* mins, float* maxs)
+{
+    std::fill(mins, mins + bins, std::numeric_limits<float>::max());
+    std::fill(maxs, maxs + bins, std::numeric_limits<float>::lowest());
+
+    if (bins == 0 || t1 <= t0)
+        return;
+
+    const double scale = static_cast<double>(bins) / (t1 - t0);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (samples[i].time < t0 || samples[i].time > t1)
+            continue;
+
+        std::size_t bin = std::min(static_cast<std::size_t>((samples[i].time - t0) * scale), bins - 1);
+        mins[bin] = std::min(mins[bin], samples[i].value);
+        maxs[bin] = std::max(maxs[bin], samples[i].value);
+    }
+}
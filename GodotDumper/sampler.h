@@ -0,0 +1,115 @@
+#pragma once
+#include "ring.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Watches: pinned fields read by a background thread at up to 10 kHz
+ *
+ * Every watch owns a preallocated SPSC ring, the sampler thread is the producer and the UI drains it once per frame
+ * The sample path only does the ObjectDB lookup, the raw read and a ring push, there's no lock and no allocation
+ *
+ * A watch is an instance id and an offset, never a raw address: the object is looked up again before every read,
+ * once it's freed the watch stops sampling instead of reading freed memory
+ * The thread sleeps on a timer between samples, and only runs while there's an active watch
+ * Timers don't wake it more precisely than about 0.5ms, waits shorter than SPIN_WAIT spin instead, which is what
+ * rates above 2 kHz cost: a core for as long as they're selected
+*/
+class sampler_t {
+public:
+	static constexpr std::size_t MAX_WATCHES = 16;
+	static constexpr std::size_t RING_SIZE = 1 << 14;
+	static constexpr float MAX_RATE = 10000.f;
+	static constexpr std::chrono::microseconds SPIN_WAIT{ 500 }; // Shortest wait a high resolution timer is trusted with
+
+	enum class kind_t {
+		FLOAT,
+		INT32,
+		BOOL
+	};
+
+	struct sample_t {
+		double time; // Seconds since the sampler started
+		float value;
+	};
+
+	struct watch_t {
+		std::string name;
+		std::uint64_t instance_id = 0;
+		std::uint32_t offset = 0; // From the object
+		kind_t kind = kind_t::FLOAT;
+
+		std::atomic<bool> active = false;
+		std::atomic<bool> freed = false; // The object is gone, the history stays but nothing is sampled anymore
+		std::uint64_t released_pass = 0;
+		std::atomic<std::uint64_t> dropped = 0; // Samples lost because the UI didn't drain the ring in time
+
+		spsc_ring_t<sample_t, RING_SIZE> ring;
+	};
+
+public:
+	// False leaves sampling to whoever calls sample_once (benchmarks), watch doesn't start the thread
+	bool threaded = true;
+
+public:
+	sampler_t();
+	~sampler_t();
+
+	// Returns the watch index or -1 if every slot is taken, starts the thread if it isn't running
+	int watch(const std::string& name, std::uint64_t instance_id, std::uint32_t offset, kind_t kind);
+	// Stops the thread with the last active watch
+	void unwatch(int index);
+
+	// Samples per second, up to MAX_RATE
+	void set_rate(float hz);
+	float get_rate() const;
+
+	// Reads every active watch once, called by the thread (and by benchmarks)
+	void sample_once(double time);
+
+	// UI side, moves pending samples of a watch into out
+	std::size_t drain(int index, std::vector<sample_t>& out);
+
+	watch_t& get_watch(int index) { return watches[index]; }
+
+	/*
+	 * Reduces samples in [t0, t1] to one min/max pair per bin, so a plot of any length costs one line per pixel column
+	 * A sample at t1 goes to the last bin, the newest sample is plotted
+	 * Empty bins get min > max
+	*/
+	static void decimate(const sample_t* samples, std::size_t count, double t0, double t1, std::size_t bins, float* mins, float* maxs);
+
+private:
+	void run();
+	void stop();
+
+	// Sleeps until next, false once stop asked the thread to exit
+	bool wait_until(std::chrono::steady_clock::time_point next);
+
+private:
+	std::unique_ptr<watch_t[]> watches;
+
+	// Completed sample_once calls, a slot is only reused once the sampler can't be reading it anymore
+	std::atomic<std::uint64_t> passes = 0;
+
+	std::atomic<float> rate = 1000.f;
+	std::atomic<bool> running = false;
+	std::thread thread;
+
+	// stop wakes the thread from its sleep, the Windows wait also needs a timer (condition variables wake on the scheduler tick)
+#ifdef _WIN32
+	void* stop_event = nullptr;
+	void* timer = nullptr;
+#else
+	std::mutex wake_mutex;
+	std::condition_variable wake;
+#endif
+};
+
+inline std::unique_ptr<sampler_t> sampler = std::make_unique<sampler_t>();
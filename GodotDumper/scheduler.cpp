@@ -0,0 +1,70 @@
+#include "scheduler.h"
+#include <algorithm>
+#include <thread>
+
+frame_scheduler_t::frame_scheduler_t(clock_fn clock, sleep_fn sleep) : clock(clock), sleep(sleep)
+{
+    if (!this->clock)
+    {
+        this->clock = []() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+        };
+    }
+
+    if (!this->sleep)
+    {
+        this->sleep = [](std::chrono::nanoseconds duration) {
+            std::this_thread::sleep_for(duration);
+        };
+    }
+
+    last_frame = this->clock();
+}
+
+void frame_scheduler_t::set_idle(bool idle)
+{
+    idle_requested = idle;
+}
+
+void frame_scheduler_t::wake()
+{
+    woken.store(true, std::memory_order_release);
+}
+
+bool frame_scheduler_t::is_idle() const
+{
+    return idle_requested && clock() - last_interaction >= wake_grace;
+}
+
+std::chrono::nanoseconds frame_scheduler_t::get_period() const
+{
+    float rate = std::max(is_idle() ? idle_rate : target_rate, 0.1f);
+    return std::chrono::nanoseconds(static_cast<std::int64_t>(1e9f / rate));
+}
+
+bool frame_scheduler_t::wait()
+{
+    bool interrupted = false;
+
+    while (true)
+    {
+        std::chrono::nanoseconds now = clock();
+
+        if (woken.exchange(false, std::memory_order_acq_rel) || (interaction && interaction()))
+        {
+            // Leaving idle shortens the period, so a throttled loop renders right away
+            last_interaction = now;
+            interrupted = true;
+        }
+
+        std::chrono::nanoseconds remaining = last_frame + get_period() - now;
+        if (remaining <= std::chrono::nanoseconds::zero())
+            break;
+
+        sleep(std::min(remaining, poll_interval));
+    }
+
+    // Pace from the actual frame start so a late frame doesn't cause a burst of catch-up frames
+    last_frame = clock();
+    return interrupted;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+/*
+ * Paces the overlay loop
+ *
+ * While something is on screen frames are spaced at target_rate, otherwise the loop
+ * drops to idle_rate and keeps polling for input every poll_interval without rendering
+ * The clock, sleep and input poll are injectable so the pacing can be driven by a fake clock
+*/
+class frame_scheduler_t {
+public:
+	using clock_fn = std::function<std::chrono::nanoseconds()>;
+	using sleep_fn = std::function<void(std::chrono::nanoseconds)>;
+	using poll_fn = std::function<bool()>;
+
+	frame_scheduler_t(clock_fn clock = nullptr, sleep_fn sleep = nullptr);
+
+	float target_rate = 144.f;
+	float idle_rate = 4.f;
+
+	std::chrono::nanoseconds poll_interval = std::chrono::milliseconds(10);
+	std::chrono::nanoseconds wake_grace = std::chrono::milliseconds(500); // Stay at full rate this long after an interaction
+
+	poll_fn interaction = nullptr;
+
+	// Call once per frame, idle means nothing is visible and the menu is closed
+	void set_idle(bool idle);
+
+	// Thread safe, makes the pending wait return immediately
+	void wake();
+
+	// Blocks until the next frame is due, returns true if it was cut short by an interaction
+	bool wait();
+
+	bool is_idle() const;
+	std::chrono::nanoseconds get_period() const;
+
+private:
+	clock_fn clock;
+	sleep_fn sleep;
+
+	bool idle_requested = false;
+	std::atomic<bool> woken = false;
+
+	std::chrono::nanoseconds last_frame{ 0 };
+	std::chrono::nanoseconds last_interaction{ 0 };
+};
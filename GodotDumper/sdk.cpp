@@ -1,3 +1,5 @@
+#include "compiler.h"
+SDK_FP_CONTRACT_OFF
 #include "sdk.h"
 #include <cmath>
 #define PI 3.14159265358979323846
@@ -26,12 +28,12 @@ void Projection::set_perspective(float fovy_degrees, float aspect, float z_near,
 	float radians = DEG2RAD(fovy_degrees / 2.f);
 	
 	deltaz = z_far - z_near;
-	sine = std::sinf(radians);
+	sine = std::sin(radians);
 	
 	if (deltaz == 0 || sine == 0 || aspect == 0)
 		return;
 	
-	cotangent = std::cosf(radians) / sine;
+	cotangent = std::cos(radians) / sine;
 	for (int i = 0; i < 4; i++)
 	{
 		for (int j = 0; j < 4; j++)
@@ -46,9 +48,9 @@ void Projection::set_perspective(float fovy_degrees, float aspect, float z_near,
 	matrix[3][3] = 0.f;
 }
 
-float Vector3::mag()
+float Vector3::mag() const
 {
-    return std::sqrtf(x * x + y * y + z * z);
+    return std::sqrt(x * x + y * y + z * z);
 }
 
 void Vector3::normalize()
@@ -81,8 +83,8 @@ Vector3 Vector3::cross(const Vector3& width) const
 {
 	return Vector3{
 		(y * width.z) - (z * width.y),
-		(z * width.x) - (x * width.y),
-		(x * width.y) - (y * width.y)
+		(z * width.x) - (x * width.z),
+		(x * width.y) - (y * width.x)
 	};
 }
 
@@ -173,5 +175,5 @@ float Vector2::distance(const Vector2& other) const
 	float dx = x - other.x;
 	float dy = y - other.y;
 
-	return std::sqrtf(dx * dx + dy * dy);
+	return std::sqrt(dx * dx + dy * dy);
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include "compiler.h"
 #include <cstdint>
 
 #define CLASS_NO_CONSTRUCTOR(CLASS) \
@@ -115,36 +116,23 @@ public:
 class Vector3
 {
 public:
-    float x, y, z;
-
-public:
-    constexpr const float& operator[](int index) const
+    union
     {
-        switch (index)
+        struct
         {
-        case 0:
-            return x;
-        case 1:
-            return y;
-        case 2:
-            return z;
-        default:
-            return 0.f;
-        }
-    }
+            float x, y, z;
+        };
 
-    constexpr float& operator[](int index)
-    {
-        switch (index)
-        {
-        case 0:
-            return x;
-        case 1:
-            return y;
-        case 2:
-            return z;
-        }
-    }
+        float coord[3];
+    };
+
+public:
+    Vector3() = default;
+    constexpr Vector3(float p_x, float p_y, float p_z) : x(p_x), y(p_y), z(p_z) { }
+
+public:
+    constexpr const float& operator[](int index) const { return coord[index]; }
+    constexpr float& operator[](int index) { return coord[index]; }
 
 public:
     constexpr Vector3& operator+=(const Vector3& v);
@@ -164,7 +152,7 @@ public:
     constexpr Vector3 operator-() const;
 
 public:
-    float mag();
+    float mag() const;
     void normalize();
     Vector3 normalized() const;
 
@@ -262,40 +250,19 @@ constexpr Vector3 Vector3::operator-() const
 class Vector4
 {
 public:
-    float x, y, z, w;
-
-public:
-    constexpr const float& operator[](int index) const
+    union
     {
-        switch (index)
+        struct
         {
-        case 0:
-            return x;
-        case 1:
-            return y;
-        case 2:
-            return z;
-        case 3:
-            return w;
-        default:
-            return 0.f;
-        }
-    }
+            float x, y, z, w;
+        };
 
-    constexpr float& operator[](int index)
-    {
-        switch (index)
-        {
-        case 0:
-            return x;
-        case 1:
-            return y;
-        case 2:
-            return z;
-        case 3:
-            return w;
-        }
-    }
+        float coord[4];
+    };
+
+public:
+    constexpr const float& operator[](int index) const { return coord[index]; }
+    constexpr float& operator[](int index) { return coord[index]; }
 };
 
 class Plane
@@ -326,6 +293,11 @@ public:
 
     Vector3 xform_inv(const Vector3& p_vector) const;
 
+    __forceinline Vector3 xform(const Vector3& p_vector) const
+    {
+        return Vector3(rows[0].dot(p_vector), rows[1].dot(p_vector), rows[2].dot(p_vector));
+    }
+
     Basis looking_at(const Vector3& target, const Vector3& up, bool use_model_front);
 
 public:
@@ -344,6 +316,20 @@ public:
 public:
     constexpr const Vector3& operator[](int row) const { return rows[row]; }
     constexpr Vector3& operator[](int row) { return rows[row]; }
+
+    __forceinline Basis operator*(const Basis& p_matrix) const
+    {
+        Basis result;
+        for (int i = 0; i < 3; i++)
+        {
+            result.rows[i] = Vector3(
+                rows[i].x * p_matrix.rows[0].x + rows[i].y * p_matrix.rows[1].x + rows[i].z * p_matrix.rows[2].x,
+                rows[i].x * p_matrix.rows[0].y + rows[i].y * p_matrix.rows[1].y + rows[i].z * p_matrix.rows[2].y,
+                rows[i].x * p_matrix.rows[0].z + rows[i].y * p_matrix.rows[1].z + rows[i].z * p_matrix.rows[2].z);
+        }
+
+        return result;
+    }
 };
 
 class Transform3D
@@ -353,6 +339,11 @@ public:
     Vector3 origin;
 
 public:
+    __forceinline Vector3 xform(const Vector3& p_vector) const
+    {
+        return basis.xform(p_vector) + origin;
+    }
+
     __forceinline Vector3 xform_inv(const Vector3& p_vector) const
     {
         Vector3 v = p_vector - origin;
@@ -363,6 +354,15 @@ public:
             (basis.rows[0][2] * v.x) + (basis.rows[1][2] * v.y) + (basis.rows[2][2] * v.z));
     }
 
+    __forceinline Transform3D operator*(const Transform3D& p_transform) const
+    {
+        Transform3D result;
+        result.basis = basis * p_transform.basis;
+        result.origin = xform(p_transform.origin);
+
+        return result;
+    }
+
 public:
     void orthonormalize();
     Transform3D orthonormalized();
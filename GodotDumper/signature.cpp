@@ -0,0 +1,333 @@
+#include "signature.h"
+#include "x86.h"
+#include <algorithm>
+
+bool signature_generator_t::build(const pe_image_t& image)
+{
+    this->image = &image;
+
+    ranges.clear();
+    for (const pe_image_t::section_t& section : image.get_sections())
+    {
+        if (!section.is_executable() || !image.is_valid(section.rva, section.size))
+            continue;
+
+        ranges.push_back({ section.rva, section.rva + section.size });
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const range_t& a, const range_t& b) { return a.begin < b.begin; });
+
+    if (ranges.empty())
+        return false;
+
+    const std::uint8_t* data = image.data();
+
+    // Counting sort of every position by the bucket of its 4 bytes, counted first so positions is allocated once
+    bucket_starts.assign((std::size_t(1) << BUCKET_BITS) + 1, 0);
+
+    for (const range_t& range : ranges)
+    {
+        for (std::uint32_t rva = range.begin; rva + 4 <= range.end; rva++)
+        {
+            std::uint32_t gram;
+            std::memcpy(&gram, data + rva, sizeof(gram));
+            bucket_starts[bucket_of(gram) + 1]++;
+        }
+    }
+
+    for (std::size_t i = 1; i < bucket_starts.size(); i++)
+        bucket_starts[i] += bucket_starts[i - 1];
+
+    positions.resize(bucket_starts.back());
+
+    std::vector<std::uint32_t> cursor(bucket_starts.begin(), bucket_starts.end() - 1);
+
+    for (const range_t& range : ranges)
+    {
+        for (std::uint32_t rva = range.begin; rva + 4 <= range.end; rva++)
+        {
+            std::uint32_t gram;
+            std::memcpy(&gram, data + rva, sizeof(gram));
+            positions[cursor[bucket_of(gram)]++] = rva;
+        }
+    }
+
+    return true;
+}
+
+const signature_generator_t::range_t* signature_generator_t::get_range(std::uint32_t rva) const
+{
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), rva, [](std::uint32_t value, const range_t& range) { return value < range.begin; });
+    if (it == ranges.begin())
+        return nullptr;
+
+    --it;
+    return rva < it->end ? &*it : nullptr;
+}
+
+std::size_t signature_generator_t::count_matches(const std::uint8_t* bytes, const std::uint8_t* mask, std::size_t length, std::size_t limit) const
+{
+    if (!image || !length)
+        return 0;
+
+    // Rarest run of 4 known bytes, a pattern without one is treated as never unique
+    std::size_t best_offset = SIZE_MAX;
+    std::uint32_t best_size = UINT32_MAX;
+    std::uint32_t best_bucket = 0;
+
+    for (std::size_t i = 0; i + 4 <= length; i++)
+    {
+        if (!mask[i] || !mask[i + 1] || !mask[i + 2] || !mask[i + 3])
+            continue;
+
+        std::uint32_t gram;
+        std::memcpy(&gram, bytes + i, sizeof(gram));
+
+        const std::uint32_t bucket = bucket_of(gram);
+        const std::uint32_t size = bucket_starts[bucket + 1] - bucket_starts[bucket];
+
+        if (size < best_size)
+        {
+            best_size = size;
+            best_offset = i;
+            best_bucket = bucket;
+        }
+    }
+
+    if (best_offset == SIZE_MAX)
+        return limit;
+
+    const std::uint8_t* data = image->data();
+    std::size_t count = 0;
+
+    for (std::uint32_t i = bucket_starts[best_bucket]; i < bucket_starts[best_bucket + 1]; i++)
+    {
+        const std::uint32_t position = positions[i];
+        if (position < best_offset)
+            continue;
+
+        const std::uint32_t start = static_cast<std::uint32_t>(position - best_offset);
+        const range_t* range = get_range(start);
+        if (!range || range->end - start < length)
+            continue;
+
+        const std::uint8_t* candidate = data + start;
+
+        std::size_t j = 0;
+        while (j < length && (!mask[j] || candidate[j] == bytes[j]))
+            j++;
+
+        if (j == length && ++count >= limit)
+            break;
+    }
+
+    return count;
+}
+
+std::size_t signature_generator_t::collect(std::uint32_t rva, std::vector<std::uint8_t>& bytes, std::vector<std::uint8_t>& mask) const
+{
+    bytes.clear();
+    mask.clear();
+
+    const range_t* range = get_range(rva);
+    if (!range)
+        return 0;
+
+    std::uint32_t end = static_cast<std::uint32_t>(std::min<std::uint64_t>(range->end, std::uint64_t(rva) + max_length));
+
+    // Past the end of the function is whatever the linker put next, it moves between builds
+    if (const pe_image_t::function_t* function = image->get_function(rva))
+        end = std::min(end, function->end);
+
+    const std::uint8_t* data = image->data();
+    std::uint32_t current = rva;
+
+    while (current < end)
+    {
+        x86::instruction_t instruction;
+        std::size_t length = x86::decode(data + current, range->end - current, instruction);
+        if (!length)
+            break;
+
+        const std::size_t first = bytes.size();
+        bytes.insert(bytes.end(), data + current, data + current + length);
+        mask.insert(mask.end(), length, 1);
+
+        if (instruction.rip_relative)
+            std::fill_n(mask.begin() + first + instruction.disp_offset, instruction.disp_size, 0);
+
+        // imm8 are shift counts, small constants and flags, they rarely change
+        if (instruction.imm_size && (instruction.relative || instruction.imm_size > 1))
+            std::fill_n(mask.begin() + first + instruction.imm_offset, instruction.imm_size, 0);
+
+        for (std::size_t i = 0; i < length; i++)
+        {
+            if (image->is_relocated(current + static_cast<std::uint32_t>(i), 1))
+                mask[first + i] = 0;
+        }
+
+        current += static_cast<std::uint32_t>(length);
+    }
+
+    // The last instruction may run past end, only keep what's inside
+    const std::size_t kept = std::min<std::size_t>(bytes.size(), end - rva);
+    bytes.resize(kept);
+    mask.resize(kept);
+
+    return kept;
+}
+
+bool signature_generator_t::generate(std::uint32_t rva, signature_t& out) const
+{
+    std::vector<std::uint8_t> bytes, mask;
+
+    const std::size_t length = collect(rva, bytes, mask);
+    if (!length || count_matches(bytes.data(), mask.data(), length) != 1)
+        return false;
+
+    // A longer prefix never matches more, so the shortest unique one is a binary search
+    std::size_t low = 1, high = length;
+    while (low < high)
+    {
+        const std::size_t middle = (low + high) / 2;
+
+        if (count_matches(bytes.data(), mask.data(), middle) == 1)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    std::size_t shortest = low;
+    while (shortest > 1 && !mask[shortest - 1])
+        shortest--;
+
+    out.pattern = to_string(bytes.data(), mask.data(), shortest);
+    out.rva = rva;
+    out.length = static_cast<std::uint32_t>(shortest);
+    out.rva_offset = 0;
+    out.rip_offset = 0;
+
+    return true;
+}
+
+std::vector<std::uint32_t> signature_generator_t::find_references(std::uint32_t target) const
+{
+    std::vector<std::uint32_t> sites;
+    if (!image)
+        return sites;
+
+    if (xrefs)
+    {
+        for (const xref_index_t::xref_t& xref : xrefs->get_references_to(target))
+            sites.push_back(xref.site);
+
+        return sites;
+    }
+
+    const std::uint8_t* data = image->data();
+
+    for (const range_t& range : ranges)
+    {
+        for (std::uint32_t rva = range.begin; rva + 4 <= range.end; rva++)
+        {
+            std::int32_t displacement;
+            std::memcpy(&displacement, data + rva, sizeof(displacement));
+
+            // Relative to the end of the instruction, which is the displacement plus an immediate of up to 4 bytes
+            const std::int64_t distance = static_cast<std::int64_t>(target) - (static_cast<std::int64_t>(rva) + 4 + displacement);
+            if (distance != 0 && distance != 1 && distance != 2 && distance != 4)
+                continue;
+
+            // Walking the function from its start finds the real instruction, prefixes included
+            if (const pe_image_t::function_t* function = image->get_function(rva))
+            {
+                std::uint32_t start = function->begin;
+                x86::instruction_t instruction;
+
+                while (start < rva && x86::decode(data + start, range.end - start, instruction))
+                {
+                    if (start + instruction.length > rva)
+                        break;
+
+                    start += instruction.length;
+                }
+
+                if (start < rva && rva - start == (instruction.rip_relative ? instruction.disp_offset : instruction.imm_offset) &&
+                    (instruction.rip_relative || (instruction.relative && instruction.imm_size == 4)) && instruction.target(start, data + start) == target)
+                {
+                    sites.push_back(start);
+                    continue;
+                }
+            }
+
+            // Otherwise try every possible instruction start before the displacement
+            for (std::uint32_t back = 1; back < x86::MAX_LENGTH && back <= rva - range.begin; back++)
+            {
+                const std::uint32_t start = rva - back;
+
+                x86::instruction_t instruction;
+                if (!x86::decode(data + start, range.end - start, instruction))
+                    continue;
+
+                const bool rip_operand = instruction.rip_relative && instruction.disp_offset == back;
+                const bool branch = instruction.relative && instruction.imm_size == 4 && instruction.imm_offset == back;
+
+                if ((rip_operand || branch) && instruction.target(start, data + start) == target)
+                {
+                    sites.push_back(start);
+                    break;
+                }
+            }
+        }
+    }
+
+    return sites;
+}
+
+bool signature_generator_t::generate_reference(std::uint32_t target, signature_t& out) const
+{
+    bool found = false;
+
+    for (std::uint32_t site : find_references(target))
+    {
+        signature_t signature;
+        if (!generate(site, signature) || (found && signature.length >= out.length))
+            continue;
+
+        x86::instruction_t instruction;
+        x86::decode(image->data() + site, image->size() - site, instruction);
+
+        signature.rva_offset = instruction.rip_relative ? instruction.disp_offset : instruction.imm_offset;
+        signature.rip_offset = instruction.length;
+
+        out = signature;
+        found = true;
+    }
+
+    return found;
+}
+
+std::string signature_generator_t::to_string(const std::uint8_t* bytes, const std::uint8_t* mask, std::size_t length)
+{
+    static constexpr char digits[] = "0123456789ABCDEF";
+
+    std::string pattern;
+    pattern.reserve(length * 3);
+
+    for (std::size_t i = 0; i < length; i++)
+    {
+        if (i)
+            pattern += ' ';
+
+        if (!mask[i])
+        {
+            pattern += '?';
+            continue;
+        }
+
+        pattern += digits[bytes[i] >> 4];
+        pattern += digits[bytes[i] & 0xF];
+    }
+
+    return pattern;
+}
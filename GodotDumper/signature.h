@@ -0,0 +1,79 @@
+#pragma once
+#include "pe.h"
+#include "xref.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Shortest unique signature generator
+ *
+ * Instructions from the target are appended with the bytes that change between builds wildcarded
+ * (rip relative displacements, branch displacements, immediates wider than a byte and relocated slots),
+ * then the shortest prefix that only matches once in the executable sections is kept
+ *
+ * Uniqueness is answered by an index of every 4 byte sequence of the executable sections (hashed into buckets),
+ * a query only verifies the positions of the rarest fully known 4 bytes of the pattern
+ * The patterns use the same format as the layout table ("48 8B 05 ? ? ? ?")
+*/
+class signature_generator_t {
+public:
+	struct signature_t {
+		std::string pattern;
+		std::uint32_t rva = 0; // Where the pattern starts
+		std::uint32_t length = 0; // In bytes, wildcards included
+
+		// Only for generate_reference, same meaning as the layout's *_rva_offset / *_rip_offset
+		std::uint32_t rva_offset = 0;
+		std::uint32_t rip_offset = 0;
+	};
+
+	std::size_t max_length = 64;
+
+public:
+	// The image must outlive the generator
+	bool build(const pe_image_t& image);
+
+	// Optional, find_references becomes a lookup instead of a scan of the executable sections
+	void set_xrefs(const xref_index_t* index) { xrefs = index; }
+
+	// Signature starting at rva (a function or any instruction)
+	bool generate(std::uint32_t rva, signature_t& out) const;
+
+	// Shortest signature of any instruction referencing target (a global or a function), to resolve with resolve_rel_addr
+	bool generate_reference(std::uint32_t target, signature_t& out) const;
+
+	// Instructions that reference target through a rip relative operand or a call / jmp rel32
+	std::vector<std::uint32_t> find_references(std::uint32_t target) const;
+
+	// Matches of bytes in the executable sections, mask[i] = 0 is a wildcard, stops counting at limit
+	std::size_t count_matches(const std::uint8_t* bytes, const std::uint8_t* mask, std::size_t length, std::size_t limit = 2) const;
+
+	static std::string to_string(const std::uint8_t* bytes, const std::uint8_t* mask, std::size_t length);
+
+private:
+	static constexpr int BUCKET_BITS = 22;
+
+	static std::uint32_t bucket_of(std::uint32_t gram)
+	{
+		return (gram * 0x9E3779B1u) >> (32 - BUCKET_BITS);
+	}
+
+	struct range_t {
+		std::uint32_t begin;
+		std::uint32_t end;
+	};
+
+	const range_t* get_range(std::uint32_t rva) const;
+
+	// Masked bytes of the instructions starting at rva, up to max_length or the end of the function
+	std::size_t collect(std::uint32_t rva, std::vector<std::uint8_t>& bytes, std::vector<std::uint8_t>& mask) const;
+
+private:
+	const pe_image_t* image = nullptr;
+	const xref_index_t* xrefs = nullptr;
+	std::vector<range_t> ranges; // Executable sections
+
+	std::vector<std::uint32_t> bucket_starts; // Into positions, one more than the bucket count
+	std::vector<std::uint32_t> positions; // RVAs grouped by bucket
+};
@@ -0,0 +1,347 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct pending_region_t {
+    std::uint64_t base;
+    std::uint64_t size;
+    std::uint32_t flags;
+};
+
+// Queues a region, or only its parts inside the requested ranges
+static void add_pending(std::vector<pending_region_t>& pending, std::uint64_t& total, std::uint64_t base, std::uint64_t size, std::uint32_t flags, std::span<const memory_snapshot_t::range_t> only)
+{
+    if (only.empty())
+    {
+        pending.push_back({ base, size, flags });
+        total += size;
+        return;
+    }
+
+    auto it = std::upper_bound(only.begin(), only.end(), base, [](std::uint64_t value, const memory_snapshot_t::range_t& range) { return value < range.base; });
+    if (it != only.begin())
+        --it;
+
+    for (; it != only.end() && it->base < base + size; ++it)
+    {
+        const std::uint64_t start = std::max<std::uint64_t>(base, it->base);
+        const std::uint64_t end = std::min<std::uint64_t>(base + size, it->base + it->size);
+
+        if (start < end)
+        {
+            pending.push_back({ start, end - start, flags });
+            total += end - start;
+        }
+    }
+}
+
+void memory_snapshot_t::clear()
+{
+    modules.clear();
+    regions.clear();
+    storage.clear();
+}
+
+#ifdef _WIN32
+bool memory_snapshot_t::capture(std::uint32_t pid, std::span<const range_t> only)
+{
+    clear();
+
+    HANDLE process = pid ? OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid) : GetCurrentProcess();
+    if (!process)
+        return false;
+
+    // The first module is the executable
+    HMODULE handles[1024];
+    DWORD needed = 0;
+    if (EnumProcessModulesEx(process, handles, sizeof(handles), &needed, LIST_MODULES_64BIT))
+    {
+        for (DWORD i = 0; i < std::min<DWORD>(needed / sizeof(HMODULE), 1024); i++)
+        {
+            char name[MAX_PATH];
+            MODULEINFO info;
+            if (!GetModuleBaseNameA(process, handles[i], name, sizeof(name)) || !GetModuleInformation(process, handles[i], &info, sizeof(info)))
+                continue;
+
+            modules.push_back({ name, reinterpret_cast<std::uint64_t>(info.lpBaseOfDll), info.SizeOfImage });
+        }
+    }
+
+    // Listed before anything is copied, the storage allocated below must not end up in its own snapshot
+    static constexpr DWORD WRITABLE = PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+    static constexpr DWORD EXECUTABLE = PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+    std::vector<pending_region_t> pending;
+    std::uint64_t total = 0;
+
+    MEMORY_BASIC_INFORMATION info;
+    for (std::uint64_t address = 0; VirtualQueryEx(process, reinterpret_cast<LPCVOID>(address), &info, sizeof(info)) == sizeof(info); address = reinterpret_cast<std::uint64_t>(info.BaseAddress) + info.RegionSize)
+    {
+        if (info.State != MEM_COMMIT || (info.Protect & (PAGE_GUARD | PAGE_NOACCESS)) || !(info.Protect & WRITABLE))
+            continue;
+
+        std::uint32_t flags = 0;
+        if (info.Type == MEM_IMAGE)
+            flags |= REGION_IMAGE;
+
+        if (info.Protect & EXECUTABLE)
+            flags |= REGION_EXECUTABLE;
+
+        add_pending(pending, total, reinterpret_cast<std::uint64_t>(info.BaseAddress), info.RegionSize, flags, only);
+    }
+
+    storage.reserve(total);
+
+    for (const pending_region_t& region : pending)
+    {
+        const std::size_t offset = storage.size();
+        storage.resize(offset + region.size);
+
+        // Regions can be freed or protected between the query and the copy
+        SIZE_T read = 0;
+        if (!ReadProcessMemory(process, reinterpret_cast<LPCVOID>(region.base), storage.data() + offset, region.size, &read) || read != region.size)
+        {
+            storage.resize(offset);
+            continue;
+        }
+
+        regions.push_back({ region.base, region.size, region.flags, offset });
+    }
+
+    if (pid)
+        CloseHandle(process);
+
+    finish();
+    return !regions.empty();
+}
+#else
+bool memory_snapshot_t::capture(std::uint32_t pid, std::span<const range_t> only)
+{
+    clear();
+
+    const std::string proc = pid ? "/proc/" + std::to_string(pid) : "/proc/self";
+
+    std::FILE* maps = std::fopen((proc + "/maps").c_str(), "r");
+    if (!maps)
+        return false;
+
+    std::vector<pending_region_t> pending;
+    std::uint64_t total = 0;
+
+    // Mappings of one file make up a module, the anonymous mapping right after its last one is its .bss
+    std::size_t last_module = SIZE_MAX;
+    std::uint64_t last_end = 0;
+
+    char line[4096];
+    while (std::fgets(line, sizeof(line), maps))
+    {
+        unsigned long long start = 0, end = 0;
+        char perms[8] = {};
+        char path[4096] = {};
+        if (std::sscanf(line, "%llx-%llx %7s %*s %*s %*s %4095[^\n]", &start, &end, perms, path) < 3)
+            continue;
+
+        std::size_t module = SIZE_MAX;
+
+        if (path[0] == '/')
+        {
+            std::string_view name = path;
+            name = name.substr(name.rfind('/') + 1);
+
+            for (std::size_t i = 0; i < modules.size() && module == SIZE_MAX; i++)
+            {
+                if (modules[i].name == name)
+                    module = i;
+            }
+
+            if (module == SIZE_MAX)
+            {
+                module = modules.size();
+                modules.push_back({ std::string(name), start, 0 });
+            }
+        }
+        else if (path[0] == 0 && start == last_end)
+            module = last_module;
+
+        if (module != SIZE_MAX)
+            modules[module].size = std::max<std::uint64_t>(modules[module].size, end - modules[module].base);
+
+        last_module = module;
+        last_end = end;
+
+        if (perms[0] != 'r' || perms[1] != 'w' || std::strncmp(path, "/dev/", 5) == 0)
+            continue;
+
+        std::uint32_t flags = 0;
+        if (module != SIZE_MAX)
+            flags |= REGION_IMAGE;
+
+        if (perms[2] == 'x')
+            flags |= REGION_EXECUTABLE;
+
+        add_pending(pending, total, start, end - start, flags, only);
+    }
+
+    std::fclose(maps);
+
+    const int memory = open((proc + "/mem").c_str(), O_RDONLY);
+    if (memory < 0)
+        return false;
+
+    storage.reserve(total);
+
+    for (const pending_region_t& region : pending)
+    {
+        const std::size_t offset = storage.size();
+        storage.resize(offset + region.size);
+
+        if (pread(memory, storage.data() + offset, region.size, static_cast<off_t>(region.base)) != static_cast<ssize_t>(region.size))
+        {
+            storage.resize(offset);
+            continue;
+        }
+
+        regions.push_back({ region.base, region.size, region.flags, offset });
+    }
+
+    close(memory);
+
+    finish();
+    return !regions.empty();
+}
+#endif
+
+void memory_snapshot_t::finish()
+{
+    std::sort(regions.begin(), regions.end(), [](const region_t& a, const region_t& b) { return a.base < b.base; });
+}
+
+bool memory_snapshot_t::save(const std::string& path) const
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = true;
+    auto write = [&](const void* data, std::size_t size) { ok &= std::fwrite(data, 1, size, file) == size; };
+
+    const std::uint32_t header[4] = { FILE_MAGIC, VERSION, static_cast<std::uint32_t>(modules.size()), static_cast<std::uint32_t>(regions.size()) };
+    write(header, sizeof(header));
+
+    for (const module_t& module : modules)
+    {
+        const std::uint16_t length = static_cast<std::uint16_t>(std::min<std::size_t>(module.name.size(), UINT16_MAX));
+        write(&module.base, sizeof(module.base));
+        write(&module.size, sizeof(module.size));
+        write(&length, sizeof(length));
+        write(module.name.data(), length);
+    }
+
+    for (const region_t& region : regions)
+    {
+        write(&region.base, sizeof(region.base));
+        write(&region.size, sizeof(region.size));
+        write(&region.flags, sizeof(region.flags));
+    }
+
+    for (const region_t& region : regions)
+        write(get_data(region), region.size);
+
+    std::fclose(file);
+    return ok;
+}
+
+bool memory_snapshot_t::load(const std::string& path)
+{
+    clear();
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    auto read = [&](void* data, std::size_t size) { return std::fread(data, 1, size, file) == size; };
+
+    std::uint32_t header[4];
+    bool ok = read(header, sizeof(header)) && header[0] == FILE_MAGIC && header[1] == VERSION;
+
+    for (std::uint32_t i = 0; ok && i < header[2]; i++)
+    {
+        module_t module;
+        std::uint16_t length = 0;
+        ok = read(&module.base, sizeof(module.base)) && read(&module.size, sizeof(module.size)) && read(&length, sizeof(length));
+
+        module.name.resize(length);
+        ok = ok && read(module.name.data(), length);
+
+        modules.push_back(std::move(module));
+    }
+
+    std::size_t total = 0;
+    for (std::uint32_t i = 0; ok && i < header[3]; i++)
+    {
+        region_t region;
+        ok = read(&region.base, sizeof(region.base)) && read(&region.size, sizeof(region.size)) && read(&region.flags, sizeof(region.flags));
+
+        region.offset = total;
+        total += region.size;
+
+        regions.push_back(region);
+    }
+
+    if (ok)
+    {
+        storage.resize(total);
+        ok = read(storage.data(), total);
+    }
+
+    std::fclose(file);
+
+    if (!ok)
+    {
+        clear();
+        return false;
+    }
+
+    finish();
+    return true;
+}
+
+const memory_snapshot_t::module_t* memory_snapshot_t::get_module(std::string_view name) const
+{
+    for (const module_t& module : modules)
+    {
+        if (module.name == name)
+            return &module;
+    }
+
+    return nullptr;
+}
+
+const memory_snapshot_t::module_t* memory_snapshot_t::get_module(std::uint64_t address) const
+{
+    for (const module_t& module : modules)
+    {
+        if (module.contains(address))
+            return &module;
+    }
+
+    return nullptr;
+}
+
+const memory_snapshot_t::region_t* memory_snapshot_t::get_region(std::uint64_t address) const
+{
+    auto it = std::upper_bound(regions.begin(), regions.end(), address, [](std::uint64_t value, const region_t& region) { return value < region.base; });
+    if (it == regions.begin())
+        return nullptr;
+
+    --it;
+    return it->contains(address) ? &*it : nullptr;
+}
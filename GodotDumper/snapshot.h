@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Copy of a process' writable memory, what pointer scans run against
+ *
+ * Only writable regions are kept: runtime pointers live in the heap, stacks and the modules' .data/.bss,
+ * read-only memory only holds pointers the linker put there (vtables, relocated tables)
+ * Modules are kept by name and address so a static address can be written as module + rva and found again
+ * in a later run where the module moved
+ *
+ * File layout:
+ *
+ * header  { u32 magic, u32 version, u32 module_count, u32 region_count }
+ * modules { u64 base, u64 size, u16 name length, chars } * module_count
+ * regions { u64 base, u64 size, u32 flags } * region_count
+ * data    region bytes back to back in region order
+ *
+ * The same file can be written from Windows and read on any OS
+*/
+class memory_snapshot_t {
+public:
+	static constexpr std::uint32_t FILE_MAGIC = 'G' | 'D' << 8 | 'S' << 16 | 'N' << 24;
+	static constexpr std::uint32_t VERSION = 1;
+
+	enum region_flags_t : std::uint32_t {
+		REGION_IMAGE = 1 << 0, // Part of a module's image (its .data/.bss)
+		REGION_EXECUTABLE = 1 << 1,
+	};
+
+	struct module_t {
+		std::string name; // File name without the directory
+		std::uint64_t base = 0;
+		std::uint64_t size = 0;
+
+		bool contains(std::uint64_t address) const { return address - base < size; }
+	};
+
+	struct range_t {
+		std::uint64_t base = 0;
+		std::uint64_t size = 0;
+	};
+
+	struct region_t {
+		std::uint64_t base = 0;
+		std::uint64_t size = 0;
+		std::uint32_t flags = 0;
+		std::size_t offset = 0; // Into the snapshot's storage
+
+		bool contains(std::uint64_t address) const { return address - base < size; }
+	};
+
+public:
+	// Copies the writable memory of a process, 0 is the calling process
+	// Windows: VirtualQueryEx/ReadProcessMemory, Linux: /proc/<pid>/maps and /proc/<pid>/mem
+	// only (sorted, not overlapping) limits the copy to those ranges, for scans that only look at a few places again
+	bool capture(std::uint32_t pid = 0, std::span<const range_t> only = {});
+
+	bool load(const std::string& path);
+	bool save(const std::string& path) const;
+
+	void clear();
+
+	const std::vector<module_t>& get_modules() const { return modules; }
+	const std::vector<region_t>& get_regions() const { return regions; }
+
+	const module_t* get_module(std::string_view name) const;
+	const module_t* get_module(std::uint64_t address) const;
+
+	// Regions are sorted and don't overlap
+	const region_t* get_region(std::uint64_t address) const;
+
+	const std::uint8_t* get_data(const region_t& region) const { return storage.data() + region.offset; }
+	std::size_t get_size() const { return storage.size(); }
+
+	// Reads from the copy, false if the address wasn't captured
+	template <typename T>
+	bool read(std::uint64_t address, T& out) const
+	{
+		const region_t* region = get_region(address);
+		if (!region || address - region->base > region->size - sizeof(T))
+			return false;
+
+		std::memcpy(&out, get_data(*region) + (address - region->base), sizeof(T));
+		return true;
+	}
+
+private:
+	void finish();
+
+private:
+	std::vector<module_t> modules;
+	std::vector<region_t> regions;
+	std::vector<std::uint8_t> storage;
+};
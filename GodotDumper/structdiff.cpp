@@ -0,0 +1,577 @@
+#include "structdiff.h"
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifndef STRUCT_DIFF_SCALAR
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+// Float bit patterns of 1e-6 and 1e7, positive floats order like integers
+static constexpr std::int32_t FLOAT_MIN = 0x358637BD;
+static constexpr std::int32_t FLOAT_MAX = 0x4B189680;
+
+static constexpr std::int32_t COUNTER_STEP = 1024;
+
+void struct_series_t::reset(std::uint32_t new_size)
+{
+    size = new_size;
+    stride = (new_size + 15) & ~15u;
+    data.clear();
+    times.clear();
+}
+
+void struct_series_t::add(const void* frame, double time)
+{
+    const std::size_t offset = data.size();
+    data.resize(offset + stride);
+    std::memcpy(data.data() + offset, frame, size);
+
+    times.push_back(time);
+}
+
+bool struct_series_t::save(const std::string& path) const
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = true;
+    auto write = [&](const void* value, std::size_t length) { ok &= std::fwrite(value, 1, length, file) == length; };
+    auto write_string = [&](const std::string& text)
+    {
+        const std::uint16_t length = static_cast<std::uint16_t>(std::min<std::size_t>(text.size(), UINT16_MAX));
+        write(&length, sizeof(length));
+        write(text.data(), length);
+    };
+
+    const std::uint32_t header[2] = { FILE_MAGIC, VERSION };
+    const std::uint32_t frame_count = get_frame_count();
+    write(header, sizeof(header));
+    write(&address, sizeof(address));
+    write(&size, sizeof(size));
+    write(&frame_count, sizeof(frame_count));
+    write_string(class_name);
+
+    const std::uint16_t reference_count = static_cast<std::uint16_t>(references.size());
+    write(&reference_count, sizeof(reference_count));
+    for (const reference_t& reference : references)
+    {
+        write_string(reference.name);
+        write(&reference.offset, sizeof(reference.offset));
+    }
+
+    for (std::uint32_t frame = 0; frame < frame_count; frame++)
+    {
+        write(&times[frame], sizeof(double));
+        write(get_frame(frame), size);
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+bool struct_series_t::load(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    auto read = [&](void* value, std::size_t length) { return std::fread(value, 1, length, file) == length; };
+    auto read_string = [&](std::string& text)
+    {
+        std::uint16_t length = 0;
+        if (!read(&length, sizeof(length)))
+            return false;
+
+        text.resize(length);
+        return read(text.data(), length);
+    };
+
+    std::uint32_t header[2];
+    std::uint32_t frame_size = 0, frame_count = 0;
+    bool ok = read(header, sizeof(header)) && header[0] == FILE_MAGIC && header[1] == VERSION;
+    ok = ok && read(&address, sizeof(address)) && read(&frame_size, sizeof(frame_size)) && read(&frame_count, sizeof(frame_count)) && read_string(class_name);
+
+    std::uint16_t reference_count = 0;
+    ok = ok && read(&reference_count, sizeof(reference_count));
+
+    references.clear();
+    for (std::uint16_t i = 0; ok && i < reference_count; i++)
+    {
+        reference_t reference;
+        ok = read_string(reference.name) && read(&reference.offset, sizeof(reference.offset));
+        references.push_back(std::move(reference));
+    }
+
+    reset(frame_size);
+
+    std::vector<std::uint8_t> frame(frame_size);
+    for (std::uint32_t i = 0; ok && i < frame_count; i++)
+    {
+        double time = 0.0;
+        ok = read(&time, sizeof(time)) && read(frame.data(), frame_size);
+
+        if (ok)
+            add(frame.data(), time);
+    }
+
+    std::fclose(file);
+
+    if (!ok)
+        reset(0);
+
+    return ok;
+}
+
+namespace
+{
+    // One entry per slot, the not_* masks are non zero once a frame disproved the kind
+    struct accumulators_t {
+        std::vector<std::uint32_t> changes;
+        std::vector<std::uint32_t> fingerprint;
+        std::vector<std::uint32_t> any; // OR of every value
+        std::vector<std::uint32_t> not_float;
+        std::vector<std::uint32_t> not_bool;
+        std::vector<std::uint32_t> not_counter;
+        std::vector<std::uint32_t> not_pointer; // On the low slot of each 8 byte pair
+
+        explicit accumulators_t(std::size_t slots)
+            : changes(slots), fingerprint(slots), any(slots), not_float(slots), not_bool(slots), not_counter(slots), not_pointer(slots)
+        {
+        }
+    };
+}
+
+// Spreads frame numbers over the 32 bits, XORed together they tell which frames a slot changed in
+static std::uint32_t mix(std::uint32_t frame)
+{
+    std::uint32_t x = frame * 0x9E3779B1u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    return x ^ (x >> 13);
+}
+
+/*
+ * 8 aligned and in user space above 4GB: 64 bit Windows and Linux put heaps and images up there, where a pair of
+ * 32 bit values (an int and a bool, a float and a zero) would need a denormal or a tiny integer in the high half
+*/
+[[maybe_unused]] static bool is_pointer(std::uint64_t value)
+{
+    return value >= 0x100000000 && value < 0x800000000000 && !(value & 7);
+}
+
+#ifndef STRUCT_DIFF_SCALAR
+static void accumulate(const std::uint8_t* current, const std::uint8_t* previous, std::uint32_t frame_mix, std::size_t chunks, accumulators_t& out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i seven = _mm_set1_epi32(7);
+    const __m128i abs_mask = _mm_set1_epi32(0x7FFFFFFF);
+    const __m128i float_min = _mm_set1_epi32(FLOAT_MIN - 1);
+    const __m128i float_max = _mm_set1_epi32(FLOAT_MAX + 1);
+    const __m128i step = _mm_set1_epi32(COUNTER_STEP);
+    const __m128i fingerprint = _mm_set1_epi32(static_cast<int>(frame_mix));
+
+    auto load = [](const std::uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); };
+    auto store = [](std::uint32_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); };
+
+    for (std::size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        const std::size_t slot = chunk * 4;
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + chunk * 16));
+
+        store(&out.any[slot], _mm_or_si128(load(&out.any[slot]), v));
+
+        const __m128i magnitude = _mm_and_si128(v, abs_mask);
+        const __m128i is_float = _mm_or_si128(_mm_cmpeq_epi32(magnitude, zero), _mm_and_si128(_mm_cmpgt_epi32(magnitude, float_min), _mm_cmpgt_epi32(float_max, magnitude)));
+        store(&out.not_float[slot], _mm_or_si128(load(&out.not_float[slot]), _mm_xor_si128(is_float, ones)));
+
+        const __m128i is_bool = _mm_or_si128(_mm_cmpeq_epi32(v, zero), _mm_cmpeq_epi32(v, one));
+        store(&out.not_bool[slot], _mm_or_si128(load(&out.not_bool[slot]), _mm_xor_si128(is_bool, ones)));
+
+        // Low lanes of the swapped vector hold the high halves, see is_pointer
+        const __m128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        const __m128i canonical = _mm_cmpeq_epi32(_mm_srli_epi32(swapped, 15), zero);
+        const __m128i aligned = _mm_cmpeq_epi32(_mm_and_si128(v, seven), zero);
+        const __m128i is_pointer = _mm_andnot_si128(_mm_cmpeq_epi32(swapped, zero), _mm_and_si128(canonical, aligned));
+        store(&out.not_pointer[slot], _mm_or_si128(load(&out.not_pointer[slot]), _mm_xor_si128(is_pointer, ones)));
+
+        if (!previous)
+            continue;
+
+        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + chunk * 16));
+        const __m128i changed = _mm_xor_si128(_mm_cmpeq_epi32(v, p), ones);
+
+        // changed lanes are -1
+        store(&out.changes[slot], _mm_sub_epi32(load(&out.changes[slot]), changed));
+        store(&out.fingerprint[slot], _mm_xor_si128(load(&out.fingerprint[slot]), _mm_and_si128(changed, fingerprint)));
+
+        const __m128i delta = _mm_sub_epi32(v, p);
+        const __m128i bad_step = _mm_or_si128(_mm_cmpgt_epi32(zero, delta), _mm_cmpgt_epi32(delta, step));
+        store(&out.not_counter[slot], _mm_or_si128(load(&out.not_counter[slot]), bad_step));
+    }
+}
+#else
+static void accumulate(const std::uint8_t* current, const std::uint8_t* previous, std::uint32_t frame_mix, std::size_t chunks, accumulators_t& out)
+{
+    for (std::size_t slot = 0; slot < chunks * 4; slot++)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, current + slot * 4, sizeof(v));
+
+        out.any[slot] |= v;
+
+        const std::int32_t magnitude = static_cast<std::int32_t>(v & 0x7FFFFFFF);
+        if (magnitude != 0 && (magnitude < FLOAT_MIN || magnitude > FLOAT_MAX))
+            out.not_float[slot] = ~0u;
+
+        if (v > 1)
+            out.not_bool[slot] = ~0u;
+
+        if (!(slot & 1))
+        {
+            std::uint64_t pointer;
+            std::memcpy(&pointer, current + slot * 4, sizeof(pointer));
+
+            if (!is_pointer(pointer))
+                out.not_pointer[slot] = ~0u;
+        }
+
+        if (!previous)
+            continue;
+
+        std::uint32_t p;
+        std::memcpy(&p, previous + slot * 4, sizeof(p));
+
+        if (v != p)
+        {
+            out.changes[slot]++;
+            out.fingerprint[slot] ^= frame_mix;
+        }
+
+        const std::int32_t delta = static_cast<std::int32_t>(v - p);
+        if (delta < 0 || delta > COUNTER_STEP)
+            out.not_counter[slot] = ~0u;
+    }
+}
+#endif
+
+void struct_analyzer_t::analyze(const struct_series_t& series)
+{
+    PROFILE_SCOPE("struct_analyzer_t::analyze");
+
+    slots.clear();
+    fields.clear();
+
+    const std::uint32_t frames = series.get_frame_count();
+    const std::size_t chunks = series.get_stride() / 16;
+    if (frames == 0 || chunks == 0)
+        return;
+
+    accumulators_t acc(chunks * 4);
+
+    for (std::uint32_t frame = 0; frame < frames; frame++)
+        accumulate(series.get_frame(frame), frame ? series.get_frame(frame - 1) : nullptr, mix(frame), chunks, acc);
+
+    const std::size_t count = series.get_size() / 4;
+    slots.resize(count);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        slot_t& slot = slots[i];
+        slot.offset = static_cast<std::uint32_t>(i * 4);
+        slot.changes = acc.changes[i];
+        slot.fingerprint = acc.fingerprint[i];
+
+        if (!(i & 1) && i + 1 < count && !acc.not_pointer[i])
+            slot.kind = POINTER;
+        else if (i & 1 && slots[i - 1].kind == POINTER)
+            slot.kind = POINTER;
+        else if (!acc.any[i])
+            slot.kind = ZERO;
+        else if (!acc.not_bool[i])
+            slot.kind = BOOL;
+        else if (slot.changes && !acc.not_counter[i])
+            slot.kind = COUNTER;
+        else if (!acc.not_float[i])
+            slot.kind = FLOAT;
+        else
+            slot.kind = INTEGER;
+    }
+
+    // Pointers are one field each, other neighbours merge when they have the same kind and changed in the same frames
+    for (std::size_t i = 0; i < count;)
+    {
+        field_t field = { slots[i].offset, 4, slots[i].kind, slots[i].changes };
+        std::size_t next = i + 1;
+
+        if (field.kind == POINTER)
+        {
+            field.size = 8;
+            field.changes = std::max<std::uint32_t>(slots[i].changes, slots[i + 1].changes);
+            next = i + 2;
+        }
+        else
+        {
+            while (next < count && slots[next].kind == field.kind && slots[next].changes == field.changes && slots[next].fingerprint == slots[i].fingerprint)
+            {
+                field.size += 4;
+                next++;
+            }
+        }
+
+        fields.push_back(field);
+        i = next;
+    }
+}
+
+std::vector<struct_analyzer_t::proposal_t> struct_analyzer_t::propose(const struct_series_t& series) const
+{
+    struct window_t {
+        std::uint32_t offset;
+        std::uint32_t valued; // Slots that aren't always zero
+        std::uint32_t changed;
+        std::uint32_t distance;
+    };
+
+    const std::span<const target_t> targets = get_targets();
+
+    std::vector<proposal_t> proposals(targets.size());
+    std::vector<std::vector<window_t>> windows(targets.size());
+
+    for (std::size_t t = 0; t < targets.size(); t++)
+    {
+        const target_t& target = targets[t];
+        proposals[t] = { &target, UINT32_MAX, {} };
+
+        for (const struct_series_t::reference_t& reference : series.references)
+        {
+            if (reference.name == target.name)
+                proposals[t].reference = reference.offset;
+        }
+
+        const std::size_t length = target.size / 4;
+
+        for (std::size_t start = 0; start + length <= slots.size(); start++)
+        {
+            if (target.kind == POINTER && (start & 1))
+                continue;
+
+            std::uint32_t valued = 0;
+            std::uint32_t changed = 0;
+            bool match = true;
+
+            for (std::size_t i = start; i < start + length && match; i++)
+            {
+                const slot_t& slot = slots[i];
+                match = slot.kind == target.kind || (target.kind == FLOAT && slot.kind == ZERO);
+                valued += slot.kind != ZERO;
+                changed += slot.changes != 0;
+            }
+
+            if (match && valued && (!target.moves || changed))
+                windows[t].push_back({ slots[start].offset, valued, changed, 0 });
+        }
+    }
+
+    auto rank = [&](bool known, std::int64_t shift)
+    {
+        for (std::size_t t = 0; t < targets.size(); t++)
+        {
+            const std::int64_t expected = proposals[t].reference == UINT32_MAX ? -1 : proposals[t].reference + shift;
+
+            for (window_t& window : windows[t])
+                window.distance = expected < 0 ? 0 : static_cast<std::uint32_t>(std::abs(static_cast<std::int64_t>(window.offset) - expected));
+
+            // Before a shift is known a window shifted into the zero padding next to the real field would win, it has fewer values
+            std::sort(windows[t].begin(), windows[t].end(), [known](const window_t& a, const window_t& b)
+            {
+                if (!known && a.valued != b.valued)
+                    return a.valued > b.valued;
+
+                if (a.distance != b.distance)
+                    return a.distance < b.distance;
+
+                if (a.valued != b.valued)
+                    return a.valued > b.valued;
+
+                if (a.changed != b.changed)
+                    return a.changed > b.changed;
+
+                return a.offset < b.offset;
+            });
+        }
+    };
+
+    rank(false, 0);
+
+    // Fields mostly move together between versions (a member added to a base class), the most common shift
+    // of the best windows ranks every target again so ambiguous ones (two transforms side by side) follow the others
+    std::vector<std::int64_t> shifts;
+    for (std::size_t t = 0; t < targets.size(); t++)
+    {
+        if (proposals[t].reference != UINT32_MAX && !windows[t].empty())
+            shifts.push_back(static_cast<std::int64_t>(windows[t].front().offset) - proposals[t].reference);
+    }
+
+    std::sort(shifts.begin(), shifts.end());
+
+    std::int64_t shift = 0;
+    std::size_t best = 0;
+    for (std::size_t i = 0; i < shifts.size();)
+    {
+        std::size_t next = i;
+        while (next < shifts.size() && shifts[next] == shifts[i])
+            next++;
+
+        if (next - i > best)
+        {
+            best = next - i;
+            shift = shifts[i];
+        }
+
+        i = next;
+    }
+
+    if (best)
+        rank(true, shift);
+
+    std::vector<proposal_t> out;
+
+    for (std::size_t t = 0; t < targets.size(); t++)
+    {
+        proposal_t& proposal = proposals[t];
+
+        for (const window_t& window : windows[t])
+        {
+            if (proposal.offsets.size() >= MAX_CANDIDATES)
+                break;
+
+            bool overlaps = false;
+            for (std::uint32_t offset : proposal.offsets)
+                overlaps |= window.offset < offset + targets[t].size && offset < window.offset + targets[t].size;
+
+            if (!overlaps)
+                proposal.offsets.push_back(window.offset);
+        }
+
+        if (!proposal.offsets.empty())
+            out.push_back(std::move(proposal));
+    }
+
+    return out;
+}
+
+const char* struct_analyzer_t::to_string(kind_t kind)
+{
+    switch (kind)
+    {
+    case ZERO: return "zero";
+    case POINTER: return "pointer";
+    case FLOAT: return "float";
+    case BOOL: return "bool";
+    case COUNTER: return "counter";
+    default: return "int";
+    }
+}
+
+std::span<const struct_analyzer_t::target_t> struct_analyzer_t::get_targets()
+{
+    static const target_t targets[] = {
+        { "node_parent", &gd::layout_t::node_parent, POINTER, 8, false },
+        { "node_owner", &gd::layout_t::node_owner, POINTER, 8, false },
+        { "node_tree", &gd::layout_t::node_tree, POINTER, 8, false },
+        { "node2d_position", &gd::layout_t::node2d_position, FLOAT, 8, true },
+        { "node3d_global_transform", &gd::layout_t::node3d_global_transform, FLOAT, 48, true },
+        { "node3d_local_transform", &gd::layout_t::node3d_local_transform, FLOAT, 48, true },
+        { "camera3d_fov", &gd::layout_t::camera3d_fov, FLOAT, 4, false },
+        { "camera3d_near", &gd::layout_t::camera3d_near, FLOAT, 4, false },
+        { "camera3d_far", &gd::layout_t::camera3d_far, FLOAT, 4, false },
+    };
+
+    return targets;
+}
+
+void struct_analyzer_t::set_references(struct_series_t& series, const gd::layout_t& layout)
+{
+    series.references.clear();
+
+    for (const target_t& target : get_targets())
+        series.references.push_back({ target.name, layout.*target.member });
+}
+
+bool struct_capture_t::start(const void* target, const std::string& class_name)
+{
+    if (object)
+        return false;
+
+#ifdef _WIN32
+    if (IsBadReadPtr(target, OBJECT_SIZE))
+    {
+        status = "The object isn't readable";
+        return false;
+    }
+#endif
+
+    series.reset(OBJECT_SIZE);
+    series.class_name = class_name;
+    series.address = reinterpret_cast<std::uint64_t>(target);
+
+    if (gd::layout)
+        struct_analyzer_t::set_references(series, *gd::layout);
+    else
+        series.references.clear();
+
+    object = target;
+    proposals.clear();
+    status = "Capturing, move or edit the object";
+    return true;
+}
+
+void struct_capture_t::stop()
+{
+    if (object)
+        finish();
+}
+
+void struct_capture_t::update(double time)
+{
+    if (!object)
+        return;
+
+    series.add(object, time);
+
+    if (series.get_frame_count() >= FRAMES)
+        finish();
+}
+
+void struct_capture_t::finish()
+{
+    object = nullptr;
+
+    analyzer.analyze(series);
+    proposals = analyzer.propose(series);
+
+    std::size_t changing = 0;
+    for (const struct_analyzer_t::slot_t& slot : analyzer.get_slots())
+        changing += slot.changes != 0;
+
+    char path[128];
+    std::snprintf(path, sizeof(path), "struct_%s_%lld.gdss", series.class_name.c_str(), static_cast<long long>(std::chrono::system_clock::now().time_since_epoch().count()));
+
+    const bool saved = series.save(path);
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%u frames, %zu fields, %zu slots changed, %s%s", series.get_frame_count(), analyzer.get_fields().size(), changing,
+        saved ? "saved to " : "couldn't save the series", saved ? path : "");
+
+    status = line;
+}
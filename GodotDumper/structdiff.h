@@ -0,0 +1,167 @@
+#pragma once
+#include "layout.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/*
+ * Structure offset finder, proposes layout_t offsets for a new engine version from how an object's bytes change
+ *
+ * A series is the first size bytes of one object copied once per frame while the user moves, rotates or edits it
+ * (or the same range read out of several memory snapshots), the analyzer then looks at every 4 byte slot:
+ * - how often it changed and in which frames (a fingerprint, slots written together share it)
+ * - whether every value looks like a float, a bool, a growing counter, or with its neighbour a user space pointer
+ * Neighbouring slots of the same kind changed in the same frames are merged into fields (a moved Vector3 is one
+ * 12 byte float field), and windows of slots are matched with the shapes of the layout_t offsets they could be
+ *
+ * Define STRUCT_DIFF_SCALAR in the preprocessor definitions to replace the SSE2 kernels with the scalar ones
+ *
+ * File layout:
+ *
+ * header     { u32 magic, u32 version, u64 address, u32 size, u32 frame_count, u16 name length, chars }
+ * references { u16 count, (u16 name length, chars, u32 offset) * count }
+ * frames     { f64 time, bytes[size] } * frame_count
+ *
+ * References are the offsets of the layout the game ran with, the proposals are ranked by their distance to them
+*/
+class struct_series_t {
+public:
+	static constexpr std::uint32_t FILE_MAGIC = 'G' | 'D' << 8 | 'S' << 16 | 'S' << 24;
+	static constexpr std::uint32_t VERSION = 1;
+
+	struct reference_t {
+		std::string name; // layout_t member
+		std::uint32_t offset;
+	};
+
+	std::string class_name;
+	std::uint64_t address = 0;
+	std::vector<reference_t> references;
+
+public:
+	// Frames are padded to 16 bytes with zeros
+	void reset(std::uint32_t size);
+	void add(const void* data, double time);
+
+	std::uint32_t get_size() const { return size; }
+	std::uint32_t get_frame_count() const { return static_cast<std::uint32_t>(times.size()); }
+	const std::uint8_t* get_frame(std::uint32_t frame) const { return data.data() + static_cast<std::size_t>(frame) * stride; }
+	std::uint32_t get_stride() const { return stride; }
+	double get_time(std::uint32_t frame) const { return times[frame]; }
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+
+private:
+	std::uint32_t size = 0;
+	std::uint32_t stride = 0;
+
+	std::vector<std::uint8_t> data;
+	std::vector<double> times;
+};
+
+class struct_analyzer_t {
+public:
+	enum kind_t : std::uint8_t {
+		ZERO, // Zero in every frame
+		POINTER, // 8 aligned slot pair, a user space address in every frame
+		FLOAT, // Finite with a sane exponent in every frame, or zero
+		BOOL, // 0 or 1
+		COUNTER, // Integer that only grows, by small steps
+		INTEGER // Anything else
+	};
+
+	struct slot_t {
+		std::uint32_t offset;
+		kind_t kind;
+		std::uint32_t changes; // Frames that differ from the previous one
+		std::uint32_t fingerprint; // Of the frames it changed in, equal for slots written together
+	};
+
+	struct field_t {
+		std::uint32_t offset;
+		std::uint32_t size;
+		kind_t kind;
+		std::uint32_t changes;
+	};
+
+	// A layout_t offset the series could tell
+	struct target_t {
+		const char* name;
+		std::uint32_t gd::layout_t::* member;
+		kind_t kind;
+		std::uint32_t size;
+		bool moves; // Only a window with a slot that changed over the series matches
+	};
+
+	struct proposal_t {
+		const target_t* target;
+		std::uint32_t reference; // UINT32_MAX without one
+		std::vector<std::uint32_t> offsets; // Best first, windows don't overlap
+	};
+
+	static constexpr std::size_t MAX_CANDIDATES = 4;
+
+public:
+	void analyze(const struct_series_t& series);
+
+	/*
+	 * Proposals for every target with a match, a match is a window of target size slots of the target's kind
+	 * (zeros count as floats), the windows with the most non zero slots first
+	 * With reference offsets in the series, the most common shift between them and the best windows is taken as
+	 * the version's shift and the windows closest to reference + shift come first
+	*/
+	std::vector<proposal_t> propose(const struct_series_t& series) const;
+
+	const std::vector<slot_t>& get_slots() const { return slots; }
+	const std::vector<field_t>& get_fields() const { return fields; }
+
+	static const char* to_string(kind_t kind);
+	static std::span<const target_t> get_targets();
+
+	// The offsets of layout in the series, for proposals on a later version
+	static void set_references(struct_series_t& series, const gd::layout_t& layout);
+
+private:
+	std::vector<slot_t> slots;
+	std::vector<field_t> fields;
+};
+
+/*
+ * In-process capture of the selected node, one copy per overlay frame for FRAMES frames
+ * The series is saved to struct_<class>_<time>.gdss for the offline tool before it's analyzed
+*/
+class struct_capture_t {
+public:
+	static constexpr std::uint32_t OBJECT_SIZE = 0x1000;
+	static constexpr std::uint32_t FRAMES = 600;
+
+public:
+	bool start(const void* object, const std::string& class_name);
+	void stop();
+
+	// Called every overlay frame, copies the object and analyzes the series once it's full
+	void update(double time);
+
+	bool is_capturing() const { return object != nullptr; }
+	const void* get_object() const { return object; }
+	std::uint32_t get_frame_count() const { return series.get_frame_count(); }
+
+	const struct_analyzer_t& get_analyzer() const { return analyzer; }
+	const std::vector<struct_analyzer_t::proposal_t>& get_proposals() const { return proposals; }
+	const std::string& get_status() const { return status; }
+
+private:
+	void finish();
+
+private:
+	const void* object = nullptr;
+	struct_series_t series;
+	struct_analyzer_t analyzer;
+	std::vector<struct_analyzer_t::proposal_t> proposals;
+	std::string status = "No capture yet";
+};
+
+inline std::unique_ptr<struct_capture_t> struct_capture = std::make_unique<struct_capture_t>();
@@ -0,0 +1,203 @@
+#pragma once
+#include "godot.h"
+#include "profiler.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <xmmintrin.h>
+
+/*
+ * Parallel preorder walk of a scene tree on the work stealing pool
+ *
+ * A task walks its subtree depth first with its own stack, the serial walk's order, and every SPLIT_INTERVAL nodes
+ * checks whether the pool is short of work: if so the bottom of its stack (the subtree it would walk last, the one
+ * closest to the root and usually the largest) becomes a new task for another worker to steal
+ *
+ * Every task fills its own segment, a subtree split off a segment comes after everything still left in it, so
+ * in preorder a segment's records are followed by its splits' in reverse order of splitting
+ * The merge gives every segment its offset in that order and swaps them into place as pool tasks
+ *
+ * Records are never destroyed between walks, a visitor overwrites the one left at that slot by an earlier walk and
+ * the merge swaps instead of moving, so the strings a record holds keep their buffers from frame to frame
+ *
+ * The walk is otherwise a chain of dependent misses (node -> children_cache -> child), a child's children_cache
+ * header is prefetched when it's pushed and the child array of the next node to pop before the current one is visited
+*/
+template <typename T>
+class tree_walker_t {
+public:
+	static constexpr std::uint32_t SPLIT_INTERVAL = 32; // Nodes walked between two looks at the pool
+
+	bool prefetch = true;
+
+	// visit(gd::Node* node, gd::Node* parent, std::uint32_t depth, T& record) -> bool, false skips the children
+	// It runs concurrently on the pool's workers and fills one record per node, out ends up with them in serial preorder
+	// The record may hold an earlier walk's values, the visitor overwrites every field
+	// Without a pool the walk runs on the calling thread, with one it has to be called from outside the pool
+	template <typename F>
+	void walk(gd::Node* root, work_pool_t* pool, std::vector<T>& out, F&& visit);
+
+	// Tasks the last walk was split into
+	std::size_t get_segment_count() const { return used; }
+
+private:
+	struct entry_t {
+		gd::Node* node;
+		gd::Node* parent;
+		std::uint32_t depth;
+	};
+
+	struct segment_t {
+		std::vector<T> records; // The first count are this walk's, the rest are kept for the next walks to overwrite
+		std::size_t count = 0;
+		std::vector<segment_t*> splits; // In the order they were split off
+		std::size_t offset = 0;
+
+		T& next()
+		{
+			if (count == records.size())
+				records.emplace_back();
+
+			return records[count++];
+		}
+	};
+
+	// Segments are kept across walks, their buffers and records are already grown and faulted in
+	segment_t* take_segment();
+
+private:
+	std::mutex lock;
+	std::vector<std::unique_ptr<segment_t>> segments;
+	std::size_t used = 0; // Taken by the current walk
+};
+
+template <typename T>
+inline typename tree_walker_t<T>::segment_t* tree_walker_t<T>::take_segment()
+{
+    std::lock_guard guard(lock);
+
+    if (used == segments.size())
+        segments.push_back(std::make_unique<segment_t>());
+
+    segment_t* segment = segments[used++].get();
+    segment->count = 0;
+    segment->splits.clear();
+    return segment;
+}
+
+template <typename T>
+template <typename F>
+inline void tree_walker_t<T>::walk(gd::Node* root, work_pool_t* pool, std::vector<T>& out, F&& visit)
+{
+    PROFILE_SCOPE("tree_walker_t::walk");
+
+    used = 0;
+    if (!root)
+    {
+        out.clear();
+        return;
+    }
+
+    const std::uint32_t children_offset = gd::layout->node_children_cache;
+    const bool prefetching = prefetch;
+
+    std::function<void(segment_t&, entry_t)> run = [&](segment_t& self, entry_t start)
+    {
+        // Entries below base were split off, only the back is ever popped
+        std::vector<entry_t> stack = { start };
+        std::size_t base = 0;
+
+        while (stack.size() > base)
+        {
+            // Only every SPLIT_INTERVAL nodes, the pool's counters are shared by every worker
+            if (pool && stack.size() - base > 1 && pool->wants_work())
+            {
+                segment_t* split = take_segment();
+                self.splits.push_back(split);
+
+                const entry_t bottom = stack[base++];
+                pool->submit([&run, split, bottom]() { run(*split, bottom); });
+            }
+
+            for (std::uint32_t n = 0; n < SPLIT_INTERVAL && stack.size() > base; n++)
+            {
+                const entry_t entry = stack.back();
+                stack.pop_back();
+
+                if (prefetching && stack.size() > base)
+                    _mm_prefetch(reinterpret_cast<const char*>(stack.back().node->get_children().ptr()), _MM_HINT_T0);
+
+                if (!visit(entry.node, entry.parent, entry.depth, self.next()))
+                    continue;
+
+                // Reversed so the children come out in their order
+                LocalVector<gd::Node*>& children = entry.node->get_children();
+                for (std::uint32_t i = children.size(); i-- > 0;)
+                {
+                    gd::Node* child = children[i];
+                    if (!child)
+                        continue;
+
+                    // The header straddles two lines in some layouts (count in one, the pointer in the next)
+                    if (prefetching)
+                    {
+                        _mm_prefetch(reinterpret_cast<const char*>(child) + children_offset, _MM_HINT_T0);
+                        _mm_prefetch(reinterpret_cast<const char*>(child) + children_offset + sizeof(std::uint64_t), _MM_HINT_T0);
+                    }
+
+                    stack.push_back({ child, entry.node, entry.depth + 1 });
+                }
+            }
+        }
+    };
+
+    // The first segment is always at offset 0, it fills out's own records and never moves
+    segment_t& first = *take_segment();
+    first.records.swap(out);
+
+    if (pool)
+    {
+        pool->submit([&]() { run(first, { root, nullptr, 0 }); });
+        pool->wait();
+    }
+    else
+    {
+        run(first, { root, nullptr, 0 });
+    }
+
+    out.swap(first.records);
+    std::size_t total = first.count;
+
+    if (used == 1)
+    {
+        out.resize(total); // Only destroys records when the tree shrank
+        return;
+    }
+
+    // Offsets in preorder, a segment's splits are pushed in order so the last one split off is placed first
+    std::vector<segment_t*> order;
+    std::vector<segment_t*> pending(first.splits.begin(), first.splits.end());
+
+    while (!pending.empty())
+    {
+        segment_t* current = pending.back();
+        pending.pop_back();
+
+        current->offset = total;
+        total += current->count;
+        order.push_back(current);
+
+        pending.insert(pending.end(), current->splits.begin(), current->splits.end());
+    }
+
+    out.resize(total);
+
+    for (segment_t* current : order)
+        pool->submit([&out, current]() { std::swap_ranges(current->records.begin(), current->records.begin() + current->count, out.begin() + current->offset); });
+
+    pool->wait();
+}
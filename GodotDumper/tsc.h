@@ -0,0 +1,62 @@
+#pragma once
+#include "compiler.h"
+#include <chrono>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+/*
+ * Cheap timestamps for hot paths: record raw TSC ticks, convert them later
+ *
+ * to_ns maps ticks onto the steady clock, the ratio is refined by every calibrate call
+ * (the profiler and the logger call it from their consumer side, never from the recording side)
+*/
+class tsc_clock_t {
+public:
+	tsc_clock_t()
+	{
+		ticks_origin = ticks();
+		ns_origin = now();
+	}
+
+	static __forceinline std::int64_t ticks()
+	{
+		return static_cast<std::int64_t>(__rdtsc());
+	}
+
+	// Steady clock, nanoseconds
+	static std::int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void calibrate()
+	{
+		std::int64_t elapsed_ticks = ticks() - ticks_origin;
+		std::int64_t elapsed_ns = now() - ns_origin;
+
+		// Too early for a usable ratio, keep the previous one
+		if (elapsed_ns > 1000000 && elapsed_ticks > 0)
+			ns_per_tick = static_cast<double>(elapsed_ns) / static_cast<double>(elapsed_ticks);
+	}
+
+	std::int64_t to_ns(std::int64_t tick) const
+	{
+		return ns_origin + static_cast<std::int64_t>((tick - ticks_origin) * ns_per_tick);
+	}
+
+	// Nanoseconds since this clock was created
+	std::int64_t since_start(std::int64_t tick) const
+	{
+		return to_ns(tick) - ns_origin;
+	}
+
+private:
+	std::int64_t ticks_origin = 0;
+	std::int64_t ns_origin = 0;
+	double ns_per_tick = 1.0;
+};
@@ -0,0 +1,731 @@
+#include "valuescan.h"
+#include "profiler.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#ifndef VALUE_SCAN_SCALAR
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using compare_t = value_scanner_t::compare_t;
+using value_t = value_scanner_t::value_t;
+
+// 64 slots per bitmap word, candidates is null on first scans (everything is a candidate), out may be candidates
+using kernel_t = void (*)(const std::uint8_t* current, const std::uint8_t* previous, const std::uint64_t* candidates, std::uint64_t* out, std::size_t words, value_t low, value_t high);
+
+static constexpr std::size_t CHUNK_WORDS = 1 << 14; // 1M slots per task
+
+template <typename T>
+static T from_value(value_t value)
+{
+    if constexpr (std::is_floating_point_v<T>)
+        return static_cast<T>(value.f);
+    else
+        return static_cast<T>(value.i);
+}
+
+template <typename T>
+static T load(const std::uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename T, compare_t C>
+static bool matches(T current, T previous, T low, T high)
+{
+    // Floats compare equal by their bits for (un)changed, a NaN that stays NaN is unchanged
+    if constexpr (C == value_scanner_t::EXACT)
+        return current == low;
+    else if constexpr (C == value_scanner_t::RANGE)
+        return current >= low && current <= high;
+    else if constexpr (C == value_scanner_t::UNKNOWN)
+        return true;
+    else if constexpr (C == value_scanner_t::CHANGED)
+        return std::memcmp(&current, &previous, sizeof(T)) != 0;
+    else if constexpr (C == value_scanner_t::UNCHANGED)
+        return std::memcmp(&current, &previous, sizeof(T)) == 0;
+    else if constexpr (C == value_scanner_t::INCREASED)
+        return current > previous;
+    else
+        return current < previous;
+}
+
+template <typename T>
+static bool matches(compare_t compare, T current, T previous, T low, T high)
+{
+    switch (compare)
+    {
+    case value_scanner_t::EXACT: return matches<T, value_scanner_t::EXACT>(current, previous, low, high);
+    case value_scanner_t::RANGE: return matches<T, value_scanner_t::RANGE>(current, previous, low, high);
+    case value_scanner_t::UNKNOWN: return true;
+    case value_scanner_t::CHANGED: return matches<T, value_scanner_t::CHANGED>(current, previous, low, high);
+    case value_scanner_t::UNCHANGED: return matches<T, value_scanner_t::UNCHANGED>(current, previous, low, high);
+    case value_scanner_t::INCREASED: return matches<T, value_scanner_t::INCREASED>(current, previous, low, high);
+    default: return matches<T, value_scanner_t::DECREASED>(current, previous, low, high);
+    }
+}
+
+// Only tests the candidate bits, cheap on sparse words
+template <typename T, compare_t C>
+static void compare_scalar(const std::uint8_t* current, const std::uint8_t* previous, const std::uint64_t* candidates, std::uint64_t* out, std::size_t words, value_t low_value, value_t high_value)
+{
+    const T low = from_value<T>(low_value);
+    const T high = from_value<T>(high_value);
+
+    for (std::size_t word = 0; word < words; word++)
+    {
+        const std::uint64_t mask = candidates ? candidates[word] : ~0ull;
+        std::uint64_t bits = 0;
+
+        for (std::uint64_t it = mask; it; it &= it - 1)
+        {
+            const std::size_t slot = word * 64 + std::countr_zero(it);
+            const T before = previous ? load<T>(previous + slot * sizeof(T)) : T{};
+
+            if (matches<T, C>(load<T>(current + slot * sizeof(T)), before, low, high))
+                bits |= it & (~it + 1);
+        }
+
+        out[word] = bits;
+    }
+}
+
+#ifndef VALUE_SCAN_SCALAR
+/*
+ * One struct per type with the 256 bit compares, every compare returns one bit per lane like movemask
+ * Integers compare signed, floats ordered (a NaN never matches a value or a range)
+*/
+struct avx2_i32 {
+    using type_t = std::int32_t;
+    using vector_t = __m256i;
+    static constexpr std::uint32_t ALL = 0xFF;
+
+    AVX2_TARGET static vector_t load(const std::uint8_t* data) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)); }
+    AVX2_TARGET static vector_t set(type_t value) { return _mm256_set1_epi32(value); }
+    AVX2_TARGET static std::uint32_t mask(__m256i m) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+    AVX2_TARGET static std::uint32_t equal(vector_t a, vector_t b) { return mask(_mm256_cmpeq_epi32(a, b)); }
+    AVX2_TARGET static std::uint32_t same(vector_t a, vector_t b) { return equal(a, b); }
+    AVX2_TARGET static std::uint32_t greater(vector_t a, vector_t b) { return mask(_mm256_cmpgt_epi32(a, b)); }
+    AVX2_TARGET static std::uint32_t in_range(vector_t x, vector_t low, vector_t high) { return ALL & ~mask(_mm256_or_si256(_mm256_cmpgt_epi32(low, x), _mm256_cmpgt_epi32(x, high))); }
+};
+
+struct avx2_i64 {
+    using type_t = std::int64_t;
+    using vector_t = __m256i;
+    static constexpr std::uint32_t ALL = 0xF;
+
+    AVX2_TARGET static vector_t load(const std::uint8_t* data) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)); }
+    AVX2_TARGET static vector_t set(type_t value) { return _mm256_set1_epi64x(value); }
+    AVX2_TARGET static std::uint32_t mask(__m256i m) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(m))); }
+    AVX2_TARGET static std::uint32_t equal(vector_t a, vector_t b) { return mask(_mm256_cmpeq_epi64(a, b)); }
+    AVX2_TARGET static std::uint32_t same(vector_t a, vector_t b) { return equal(a, b); }
+    AVX2_TARGET static std::uint32_t greater(vector_t a, vector_t b) { return mask(_mm256_cmpgt_epi64(a, b)); }
+    AVX2_TARGET static std::uint32_t in_range(vector_t x, vector_t low, vector_t high) { return ALL & ~mask(_mm256_or_si256(_mm256_cmpgt_epi64(low, x), _mm256_cmpgt_epi64(x, high))); }
+};
+
+struct avx2_f32 {
+    using type_t = float;
+    using vector_t = __m256;
+    static constexpr std::uint32_t ALL = 0xFF;
+
+    AVX2_TARGET static vector_t load(const std::uint8_t* data) { return _mm256_loadu_ps(reinterpret_cast<const float*>(data)); }
+    AVX2_TARGET static vector_t set(type_t value) { return _mm256_set1_ps(value); }
+    AVX2_TARGET static std::uint32_t equal(vector_t a, vector_t b) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))); }
+    AVX2_TARGET static std::uint32_t same(vector_t a, vector_t b) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_castps_si256(a), _mm256_castps_si256(b))))); }
+    AVX2_TARGET static std::uint32_t greater(vector_t a, vector_t b) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ))); }
+    AVX2_TARGET static std::uint32_t in_range(vector_t x, vector_t low, vector_t high) { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, low, _CMP_GE_OQ), _mm256_cmp_ps(x, high, _CMP_LE_OQ)))); }
+};
+
+struct avx2_f64 {
+    using type_t = double;
+    using vector_t = __m256d;
+    static constexpr std::uint32_t ALL = 0xF;
+
+    AVX2_TARGET static vector_t load(const std::uint8_t* data) { return _mm256_loadu_pd(reinterpret_cast<const double*>(data)); }
+    AVX2_TARGET static vector_t set(type_t value) { return _mm256_set1_pd(value); }
+    AVX2_TARGET static std::uint32_t equal(vector_t a, vector_t b) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+    AVX2_TARGET static std::uint32_t same(vector_t a, vector_t b) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_castpd_si256(a), _mm256_castpd_si256(b))))); }
+    AVX2_TARGET static std::uint32_t greater(vector_t a, vector_t b) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ))); }
+    AVX2_TARGET static std::uint32_t in_range(vector_t x, vector_t low, vector_t high) { return static_cast<std::uint32_t>(_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, low, _CMP_GE_OQ), _mm256_cmp_pd(x, high, _CMP_LE_OQ)))); }
+};
+
+template <typename O, compare_t C>
+AVX2_TARGET static void compare_avx2(const std::uint8_t* current, const std::uint8_t* previous, const std::uint64_t* candidates, std::uint64_t* out, std::size_t words, value_t low_value, value_t high_value)
+{
+    using T = typename O::type_t;
+
+    static constexpr std::size_t LANES = 32 / sizeof(T);
+    static constexpr std::size_t VECTORS = 64 / LANES;
+    static constexpr bool RELATIVE = C >= value_scanner_t::CHANGED;
+
+    const typename O::vector_t low = O::set(from_value<T>(low_value));
+    const typename O::vector_t high = O::set(from_value<T>(high_value));
+
+    for (std::size_t word = 0; word < words; word++)
+    {
+        const std::uint64_t mask = candidates ? candidates[word] : ~0ull;
+        if (!mask)
+        {
+            out[word] = 0;
+            continue;
+        }
+
+        const std::uint8_t* now = current + word * 64 * sizeof(T);
+        const std::uint8_t* before = RELATIVE ? previous + word * 64 * sizeof(T) : nullptr;
+
+        std::uint64_t bits = 0;
+
+        for (std::size_t i = 0; i < VECTORS; i++)
+        {
+            const typename O::vector_t x = O::load(now + i * 32);
+            std::uint32_t match;
+
+            if constexpr (C == value_scanner_t::EXACT)
+                match = O::equal(x, low);
+            else if constexpr (C == value_scanner_t::RANGE)
+                match = O::in_range(x, low, high);
+            else if constexpr (C == value_scanner_t::UNKNOWN)
+                match = O::ALL;
+            else if constexpr (C == value_scanner_t::CHANGED)
+                match = O::ALL & ~O::same(x, O::load(before + i * 32));
+            else if constexpr (C == value_scanner_t::UNCHANGED)
+                match = O::same(x, O::load(before + i * 32));
+            else if constexpr (C == value_scanner_t::INCREASED)
+                match = O::greater(x, O::load(before + i * 32));
+            else
+                match = O::greater(O::load(before + i * 32), x);
+
+            bits |= static_cast<std::uint64_t>(match) << (i * LANES);
+        }
+
+        out[word] = bits & mask;
+    }
+}
+
+static bool detect_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // The OS has to save the ymm registers too
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#else
+struct avx2_i32 {};
+struct avx2_i64 {};
+struct avx2_f32 {};
+struct avx2_f64 {};
+#endif
+
+bool value_scanner_t::is_vectorized()
+{
+#ifdef VALUE_SCAN_SCALAR
+    return false;
+#else
+    static const bool avx2 = detect_avx2();
+    return avx2;
+#endif
+}
+
+template <typename T, typename O>
+static kernel_t select_kernel(compare_t compare)
+{
+#ifndef VALUE_SCAN_SCALAR
+    if (value_scanner_t::is_vectorized())
+    {
+        switch (compare)
+        {
+        case value_scanner_t::EXACT: return &compare_avx2<O, value_scanner_t::EXACT>;
+        case value_scanner_t::RANGE: return &compare_avx2<O, value_scanner_t::RANGE>;
+        case value_scanner_t::UNKNOWN: return &compare_avx2<O, value_scanner_t::UNKNOWN>;
+        case value_scanner_t::CHANGED: return &compare_avx2<O, value_scanner_t::CHANGED>;
+        case value_scanner_t::UNCHANGED: return &compare_avx2<O, value_scanner_t::UNCHANGED>;
+        case value_scanner_t::INCREASED: return &compare_avx2<O, value_scanner_t::INCREASED>;
+        default: return &compare_avx2<O, value_scanner_t::DECREASED>;
+        }
+    }
+#endif
+
+    switch (compare)
+    {
+    case value_scanner_t::EXACT: return &compare_scalar<T, value_scanner_t::EXACT>;
+    case value_scanner_t::RANGE: return &compare_scalar<T, value_scanner_t::RANGE>;
+    case value_scanner_t::UNKNOWN: return &compare_scalar<T, value_scanner_t::UNKNOWN>;
+    case value_scanner_t::CHANGED: return &compare_scalar<T, value_scanner_t::CHANGED>;
+    case value_scanner_t::UNCHANGED: return &compare_scalar<T, value_scanner_t::UNCHANGED>;
+    case value_scanner_t::INCREASED: return &compare_scalar<T, value_scanner_t::INCREASED>;
+    default: return &compare_scalar<T, value_scanner_t::DECREASED>;
+    }
+}
+
+static kernel_t select_kernel(value_scanner_t::type_t type, compare_t compare)
+{
+    switch (type)
+    {
+    case value_scanner_t::I32: return select_kernel<std::int32_t, avx2_i32>(compare);
+    case value_scanner_t::I64: return select_kernel<std::int64_t, avx2_i64>(compare);
+    case value_scanner_t::F32: return select_kernel<float, avx2_f32>(compare);
+    default: return select_kernel<double, avx2_f64>(compare);
+    }
+}
+
+std::size_t value_scanner_t::get_size(type_t type)
+{
+    return type == I32 || type == F32 ? 4 : 8;
+}
+
+std::string value_scanner_t::to_string(type_t type, value_t value)
+{
+    char text[32];
+
+    if (type == F32 || type == F64)
+        std::snprintf(text, sizeof(text), "%g", value.f);
+    else
+        std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(value.i));
+
+    return text;
+}
+
+static value_t to_value(value_scanner_t::type_t type, const std::uint8_t* data)
+{
+    value_t value = { 0 };
+
+    switch (type)
+    {
+    case value_scanner_t::I32: value.i = load<std::int32_t>(data); break;
+    case value_scanner_t::I64: value.i = load<std::int64_t>(data); break;
+    case value_scanner_t::F32: value.f = load<float>(data); break;
+    case value_scanner_t::F64: value.f = load<double>(data); break;
+    }
+
+    return value;
+}
+
+void value_scanner_t::reset()
+{
+    regions.clear();
+    previous.clear();
+    count = 0;
+    scanned = false;
+}
+
+bool value_scanner_t::first_scan(memory_snapshot_t&& snapshot, type_t scan_type, const query_t& query, work_pool_t& pool)
+{
+    if (query.compare != EXACT && query.compare != RANGE && query.compare != UNKNOWN)
+        return false;
+
+    reset();
+    type = scan_type;
+
+    // Whole words only, regions are pages so nothing is lost
+    const std::size_t size = get_size(type);
+    for (const memory_snapshot_t::region_t& source : snapshot.get_regions())
+    {
+        region_t region;
+        region.base = source.base;
+        region.slots = (source.size / size) & ~63ull;
+
+        if (region.slots)
+        {
+            region.bitmap.resize(region.slots / 64);
+            regions.push_back(std::move(region));
+        }
+    }
+
+    return scan(std::move(snapshot), query, pool);
+}
+
+bool value_scanner_t::next_scan(memory_snapshot_t&& snapshot, const query_t& query, work_pool_t& pool)
+{
+    if (!scanned || query.compare == UNKNOWN)
+        return false;
+
+    return scan(std::move(snapshot), query, pool);
+}
+
+template <typename T>
+void value_scanner_t::scan_runs(region_t& region, const std::uint8_t* current, std::uint64_t available, const query_t& query) const
+{
+    const T low = from_value<T>(query.low);
+    const T high = from_value<T>(query.high);
+    const std::uint32_t first = region.runs.front().start;
+
+    std::vector<run_t> runs;
+    std::vector<std::uint8_t> values;
+    std::size_t kept = 0;
+
+    const std::uint8_t* before = region.values.data();
+
+    for (const run_t& run : region.runs)
+    {
+        for (std::uint32_t slot = run.start; slot < run.start + run.count; slot++, before += sizeof(T))
+        {
+            // Memory that was freed or shrank since the last scan
+            if (slot - first >= available)
+                break;
+
+            const std::uint8_t* now = current + (slot - first) * sizeof(T);
+            if (!matches<T>(query.compare, load<T>(now), load<T>(before), low, high))
+                continue;
+
+            if (!runs.empty() && runs.back().start + runs.back().count == slot)
+                runs.back().count++;
+            else
+                runs.push_back({ slot, 1 });
+
+            values.insert(values.end(), now, now + sizeof(T));
+            kept++;
+        }
+    }
+
+    region.runs = std::move(runs);
+    region.values = std::move(values);
+    region.count = kept;
+}
+
+void value_scanner_t::compact(region_t& region, const std::uint8_t* current) const
+{
+    if (region.bitmap.empty() || region.count == 0)
+        return;
+
+    const std::size_t size = get_size(type);
+
+    std::size_t run_count = 0;
+    std::uint64_t carry = 0; // Last bit of the previous word
+    for (std::uint64_t word : region.bitmap)
+    {
+        // Runs start where a set bit follows a clear one
+        run_count += std::popcount(word & ~((word << 1) | carry));
+        carry = word >> 63;
+    }
+
+    const std::size_t bitmap_cost = region.bitmap.size() * sizeof(std::uint64_t) + region.slots * size;
+    const std::size_t runs_cost = run_count * sizeof(run_t) + region.count * size;
+
+    // Packing copies the values, not worth it for a few percent (an unknown first scan would copy everything)
+    if (runs_cost * 2 >= bitmap_cost)
+        return;
+
+    region.runs.reserve(run_count);
+    region.values.reserve(region.count * size);
+
+    for (std::size_t word = 0; word < region.bitmap.size(); word++)
+    {
+        for (std::uint64_t it = region.bitmap[word]; it; it &= it - 1)
+        {
+            const std::uint32_t slot = static_cast<std::uint32_t>(word * 64 + std::countr_zero(it));
+
+            if (!region.runs.empty() && region.runs.back().start + region.runs.back().count == slot)
+                region.runs.back().count++;
+            else
+                region.runs.push_back({ slot, 1 });
+
+            const std::uint8_t* value = current + slot * size;
+            region.values.insert(region.values.end(), value, value + size);
+        }
+    }
+
+    std::vector<std::uint64_t>().swap(region.bitmap);
+}
+
+bool value_scanner_t::scan(memory_snapshot_t&& snapshot, const query_t& query, work_pool_t& pool)
+{
+    PROFILE_SCOPE("value_scanner_t::scan");
+
+    const std::size_t size = get_size(type);
+    const kernel_t kernel = select_kernel(type, query.compare);
+    const bool first = !scanned;
+
+    struct job_t {
+        region_t* region;
+        const std::uint8_t* current;
+        const std::uint8_t* previous;
+        std::uint64_t available; // Runs only
+        std::size_t begin; // Bitmap words
+        std::size_t end;
+        std::size_t count;
+    };
+
+    std::vector<job_t> jobs;
+    std::vector<const std::uint8_t*> current(regions.size(), nullptr);
+
+    for (std::size_t i = 0; i < regions.size(); i++)
+    {
+        region_t& region = regions[i];
+        region.count = 0;
+
+        const bool runs = region.bitmap.empty();
+        const std::uint64_t start = region.base + (runs ? region.runs.front().start * size : 0);
+
+        // The region may have been freed, shrunk or captured in pieces since, whatever is left is compared
+        const memory_snapshot_t::region_t* source = snapshot.get_region(start);
+        if (!source)
+        {
+            region.bitmap.clear();
+            region.runs.clear();
+            continue;
+        }
+
+        const std::uint8_t* data = snapshot.get_data(*source) + (start - source->base);
+        const std::uint64_t available = (source->base + source->size - start) / size;
+
+        if (runs)
+        {
+            jobs.push_back({ &region, data, nullptr, available, 0, 0, 0 });
+            continue;
+        }
+
+        current[i] = data;
+
+        if (available < region.slots)
+        {
+            region.slots = available & ~63ull;
+            region.bitmap.resize(region.slots / 64);
+        }
+
+        const std::uint8_t* before = nullptr;
+        if (!first)
+        {
+            const memory_snapshot_t::region_t* last = previous.get_region(region.base);
+            before = last ? previous.get_data(*last) + (region.base - last->base) : nullptr;
+
+            if (!before)
+            {
+                region.bitmap.clear();
+                continue;
+            }
+        }
+
+        for (std::size_t begin = 0; begin < region.bitmap.size(); begin += CHUNK_WORDS)
+            jobs.push_back({ &region, data, before, 0, begin, std::min<std::size_t>(begin + CHUNK_WORDS, region.bitmap.size()), 0 });
+    }
+
+    for (job_t& job : jobs)
+    {
+        pool.submit([&, kernel]()
+        {
+            region_t& region = *job.region;
+
+            if (region.bitmap.empty())
+            {
+                switch (type)
+                {
+                case I32: scan_runs<std::int32_t>(region, job.current, job.available, query); break;
+                case I64: scan_runs<std::int64_t>(region, job.current, job.available, query); break;
+                case F32: scan_runs<float>(region, job.current, job.available, query); break;
+                case F64: scan_runs<double>(region, job.current, job.available, query); break;
+                }
+
+                job.count = region.count;
+                return;
+            }
+
+            const std::size_t offset = job.begin * 64 * size;
+            std::uint64_t* bits = region.bitmap.data() + job.begin;
+
+            kernel(job.current + offset, job.previous ? job.previous + offset : nullptr, first ? nullptr : bits, bits, job.end - job.begin, query.low, query.high);
+
+            for (std::size_t word = 0; word < job.end - job.begin; word++)
+                job.count += std::popcount(bits[word]);
+        });
+    }
+
+    pool.wait();
+
+    for (const job_t& job : jobs)
+    {
+        if (!job.region->bitmap.empty())
+            job.region->count += job.count;
+    }
+
+    // Sparse bitmaps become runs, their values have to be packed from this snapshot before it's dropped
+    for (std::size_t i = 0; i < regions.size(); i++)
+    {
+        if (current[i] && regions[i].count)
+            pool.submit([this, &current, i]() { compact(regions[i], current[i]); });
+    }
+
+    pool.wait();
+
+    std::erase_if(regions, [](const region_t& region) { return region.count == 0; });
+
+    count = 0;
+    bool dense = false;
+
+    for (const region_t& region : regions)
+    {
+        count += region.count;
+        dense |= !region.bitmap.empty();
+    }
+
+    if (dense)
+        previous = std::move(snapshot);
+    else
+        previous.clear();
+
+    scanned = true;
+    return count != 0;
+}
+
+std::vector<memory_snapshot_t::range_t> value_scanner_t::get_ranges() const
+{
+    const std::size_t size = get_size(type);
+
+    std::vector<memory_snapshot_t::range_t> ranges;
+    for (const region_t& region : regions)
+    {
+        if (!region.bitmap.empty())
+            ranges.push_back({ region.base, region.slots * size });
+        else if (!region.runs.empty())
+        {
+            const std::uint64_t first = region.runs.front().start;
+            const std::uint64_t last = region.runs.back().start + region.runs.back().count;
+            ranges.push_back({ region.base + first * size, (last - first) * size });
+        }
+    }
+
+    return ranges;
+}
+
+std::size_t value_scanner_t::get_memory_usage() const
+{
+    std::size_t usage = 0;
+    for (const region_t& region : regions)
+        usage += region.bitmap.capacity() * sizeof(std::uint64_t) + region.runs.capacity() * sizeof(run_t) + region.values.capacity();
+
+    return usage;
+}
+
+std::vector<value_scanner_t::result_t> value_scanner_t::get_results(std::size_t max) const
+{
+    const std::size_t size = get_size(type);
+
+    std::vector<result_t> results;
+
+    for (const region_t& region : regions)
+    {
+        if (results.size() >= max)
+            break;
+
+        if (region.bitmap.empty())
+        {
+            const std::uint8_t* value = region.values.data();
+
+            for (const run_t& run : region.runs)
+            {
+                for (std::uint32_t slot = run.start; slot < run.start + run.count && results.size() < max; slot++, value += size)
+                    results.push_back({ region.base + slot * size, to_value(type, value) });
+            }
+
+            continue;
+        }
+
+        const memory_snapshot_t::region_t* source = previous.get_region(region.base);
+        if (!source)
+            continue;
+
+        const std::uint8_t* data = previous.get_data(*source) + (region.base - source->base);
+
+        for (std::size_t word = 0; word < region.bitmap.size() && results.size() < max; word++)
+        {
+            for (std::uint64_t it = region.bitmap[word]; it && results.size() < max; it &= it - 1)
+            {
+                const std::uint64_t slot = word * 64 + std::countr_zero(it);
+                results.push_back({ region.base + slot * size, to_value(type, data + slot * size) });
+            }
+        }
+    }
+
+    return results;
+}
+
+value_scan_job_t::~value_scan_job_t()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+bool value_scan_job_t::start(value_scanner_t::type_t type, const value_scanner_t::query_t& query, bool next)
+{
+    if (is_running())
+        return false;
+
+    if (thread.joinable())
+        thread.join();
+
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&value_scan_job_t::run, this, type, query, next);
+    return true;
+}
+
+void value_scan_job_t::reset()
+{
+    if (is_running())
+        return;
+
+    scanner.reset();
+    results.clear();
+    status = "No scan yet";
+}
+
+void value_scan_job_t::run(value_scanner_t::type_t type, value_scanner_t::query_t query, bool next)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // The previous snapshot is still alive, a next scan only copies where candidates are left so it doesn't copy that too
+    if (!next)
+        scanner.reset();
+
+    std::vector<memory_snapshot_t::range_t> ranges = scanner.get_ranges();
+
+    memory_snapshot_t snapshot;
+    work_pool_t pool;
+
+    char line[128];
+
+    if (next && !scanner.has_scan())
+        status = "Run a first scan before a next scan";
+    else if (next && scanner.get_count() == 0)
+        status = "No candidates left, start a new scan";
+    else if (!snapshot.capture(0, ranges))
+        status = "Couldn't capture the process' memory";
+    else
+    {
+        if (next)
+            scanner.next_scan(std::move(snapshot), query, pool);
+        else
+            scanner.first_scan(std::move(snapshot), type, query, pool);
+
+        std::snprintf(line, sizeof(line), "%zu candidates, %.1f MB of candidate sets (%.2f s%s)", scanner.get_count(), scanner.get_memory_usage() / (1024.0 * 1024.0),
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), value_scanner_t::is_vectorized() ? ", AVX2" : "");
+
+        status = line;
+    }
+
+    results = scanner.get_results(SHOWN_RESULTS);
+    running.store(false, std::memory_order_release);
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include "snapshot.h"
+#include "work_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Value scanner, finds where a gameplay value (health, ammo, a position) lives by narrowing candidates over scans
+ *
+ * A first scan looks for an exact value, a range or takes every address (unknown initial value), next scans compare
+ * each candidate with its value in the previous scan (changed, unchanged, increased, decreased) or with a value again
+ * Values are aligned to their size, like Cheat Engine's fast scan
+ *
+ * Candidates are kept per region in one of two forms:
+ * - bitmap, one bit per slot, the previous values are the previous snapshot itself (no copy)
+ * - runs of consecutive candidates with their values packed, once a region is sparse enough for it to be smaller
+ * Once every region is in runs the previous snapshot is released
+ *
+ * Compares run 64 slots per bitmap word with AVX2 kernels when the CPU has them (SSE2 only machines get the scalar
+ * ones), define VALUE_SCAN_SCALAR in the preprocessor definitions to always use the scalar kernels
+ * Bitmap words without candidates are skipped, narrowing a mostly empty region costs little more than reading its bitmap
+*/
+class value_scanner_t {
+public:
+	enum type_t : std::uint8_t {
+		I32,
+		I64,
+		F32,
+		F64
+	};
+
+	enum compare_t : std::uint8_t {
+		EXACT, // low
+		RANGE, // [low, high]
+		UNKNOWN, // First scan only, every slot
+		CHANGED, // Next scans only, against the previous scan
+		UNCHANGED,
+		INCREASED,
+		DECREASED
+	};
+
+	union value_t {
+		std::int64_t i; // I32, I64
+		double f; // F32, F64
+	};
+
+	struct query_t {
+		compare_t compare = EXACT;
+		value_t low = { 0 };
+		value_t high = { 0 };
+	};
+
+	struct result_t {
+		std::uint64_t address;
+		value_t value; // In the last scan
+	};
+
+public:
+	// Snapshots are moved in, the scanner keeps the last one while its values are needed
+	bool first_scan(memory_snapshot_t&& snapshot, type_t type, const query_t& query, work_pool_t& pool);
+	bool next_scan(memory_snapshot_t&& snapshot, const query_t& query, work_pool_t& pool);
+
+	void reset();
+
+	bool has_scan() const { return scanned; }
+	type_t get_type() const { return type; }
+	std::size_t get_count() const { return count; }
+
+	// Address ranges still holding candidates, what the next scan has to capture
+	std::vector<memory_snapshot_t::range_t> get_ranges() const;
+
+	// Bytes held by the candidate sets and packed values, the snapshot not included
+	std::size_t get_memory_usage() const;
+
+	// First max results in address order
+	std::vector<result_t> get_results(std::size_t max) const;
+
+	static std::size_t get_size(type_t type);
+	static std::string to_string(type_t type, value_t value);
+
+	// True when the AVX2 kernels are used
+	static bool is_vectorized();
+
+private:
+	struct run_t {
+		std::uint32_t start; // Slot
+		std::uint32_t count;
+	};
+
+	struct region_t {
+		std::uint64_t base = 0;
+		std::uint64_t slots = 0;
+		std::size_t count = 0;
+
+		std::vector<std::uint64_t> bitmap; // Empty once the region uses runs
+		std::vector<run_t> runs;
+		std::vector<std::uint8_t> values; // Packed values of the runs, in run order
+	};
+
+	bool scan(memory_snapshot_t&& snapshot, const query_t& query, work_pool_t& pool);
+
+	// current points at the first run's first slot, available is how many slots the new snapshot has from there
+	template <typename T>
+	void scan_runs(region_t& region, const std::uint8_t* current, std::uint64_t available, const query_t& query) const;
+	void compact(region_t& region, const std::uint8_t* current) const;
+
+private:
+	type_t type = I32;
+	bool scanned = false;
+	std::size_t count = 0;
+
+	std::vector<region_t> regions;
+	memory_snapshot_t previous;
+};
+
+/*
+ * In-process value scans, capturing and scanning run on their own thread so the overlay keeps drawing
+*/
+class value_scan_job_t {
+public:
+	static constexpr std::size_t SHOWN_RESULTS = 100;
+
+public:
+	~value_scan_job_t();
+
+	// First scan when next is false
+	bool start(value_scanner_t::type_t type, const value_scanner_t::query_t& query, bool next);
+	void reset();
+
+	bool is_running() const { return running.load(std::memory_order_acquire); }
+
+	// Only valid while not running
+	const value_scanner_t& get_scanner() const { return scanner; }
+	const std::vector<value_scanner_t::result_t>& get_results() const { return results; }
+	const std::string& get_status() const { return status; }
+
+private:
+	void run(value_scanner_t::type_t type, value_scanner_t::query_t query, bool next);
+
+private:
+	value_scanner_t scanner;
+	std::vector<value_scanner_t::result_t> results;
+	std::string status = "No scan yet";
+
+	std::atomic<bool> running = false;
+	std::thread thread;
+};
+
+inline std::unique_ptr<value_scan_job_t> value_scan = std::make_unique<value_scan_job_t>();
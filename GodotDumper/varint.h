@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// LEB128, 7 bits per byte with the high bit set on every byte but the last
+inline void write_varint(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<std::uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+
+	out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline std::uint64_t read_varint(const std::uint8_t*& it, const std::uint8_t* end)
+{
+	std::uint64_t value = 0;
+	for (std::uint32_t shift = 0; it < end && shift < 64; shift += 7)
+	{
+		std::uint8_t byte = *it++;
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+		if (!(byte & 0x80))
+			break;
+	}
+
+	return value;
+}
@@ -0,0 +1,348 @@
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include "visuals.h"
+#include "godot.h"
+#include "profiler.h"
+#include "math_batch.h"
+
+#include <imgui/imgui_internal.h>
+
+static constexpr ImU32 COLOR_3D = IM_COL32(255, 255, 255, 220);
+static constexpr ImU32 COLOR_2D = IM_COL32(90, 200, 255, 220);
+static constexpr ImU32 COLOR_CLASS = IM_COL32(180, 180, 180, 200);
+
+static constexpr int CACHE_MAX_LABELS = 32768;
+static constexpr int CACHE_MAX_AGE = 600; // Frames a label can stay unused before it's evicted
+
+void visuals_t::collect(gd::SceneTree* tree, std::vector<item_t>& out, camera_t& camera, ImVec2 screen_size)
+{
+    PROFILE_SCOPE("visuals::collect");
+
+    out.clear();
+    camera.valid = false;
+
+    if (!tree)
+        return;
+
+    gd::Window* root = tree->get_root();
+    gd::Camera3D* cam = root ? root->get_camera_3d() : nullptr;
+
+    if (cam && cam->mode() == gd::Camera3D::PROJECTION_PERSPECTIVE)
+    {
+        camera.transform = cam->get_camera_transform();
+        camera.projection.set_perspective(cam->fov(), screen_size.x / screen_size.y, cam->_near(), cam->_far(), cam->keep_aspect() == gd::Camera3D::KEEP_WIDTH);
+        camera.z_near = cam->_near();
+        camera.valid = true;
+    }
+
+    struct entry_t
+    {
+        gd::Node* node;
+        Vector2 offset; // Sum of the parent Node2D positions (rotation and scale are ignored)
+        std::int32_t parent_3d; // Hierarchy index of Node3D::get_parent_3d, -1 for none
+    };
+
+    parents_3d.clear();
+    locals_3d.clear();
+    items_3d.clear();
+
+    std::vector<entry_t> stack;
+    if (tree->get_current_scene())
+        stack.push_back({ tree->get_current_scene(), { 0.f, 0.f }, -1 });
+
+    while (!stack.empty() && out.size() < max_items)
+    {
+        entry_t entry = stack.back();
+        stack.pop_back();
+
+        Vector2 offset = entry.offset;
+        std::int32_t parent_3d = -1;
+        std::string class_name = entry.node->get_class_name();
+        const gd::Object::Kind kind = gd::Object::get_kind(class_name);
+
+        if (show_3d && kind == gd::Object::Kind::NODE_3D)
+        {
+            gd::Node3D* node = entry.node->as<gd::Node3D>();
+
+            // Depth first, a parent always gets its index before its children
+            parent_3d = static_cast<std::int32_t>(parents_3d.size());
+            parents_3d.push_back(node->is_top_level() ? -1 : entry.parent_3d);
+            locals_3d.push_back(node->local_transform());
+            items_3d.push_back(static_cast<std::uint32_t>(out.size()));
+
+            out.push_back({ Vector3(), true, entry.node->get_name(), std::move(class_name) });
+        }
+        else if (kind == gd::Object::Kind::NODE_2D)
+        {
+            Vector2 position = entry.node->as<gd::Node2D>()->position();
+            offset = { offset.x + position.x, offset.y + position.y };
+
+            if (show_2d)
+                out.push_back({ Vector3(offset.x, offset.y, 0.f), false, entry.node->get_name(), std::move(class_name) });
+        }
+
+        for (gd::Node* child : entry.node->get_children())
+        {
+            if (child)
+                stack.push_back({ child, offset, parent_3d });
+        }
+    }
+
+    if (parents_3d.empty() || !hierarchy.build(parents_3d))
+        return;
+
+    for (std::size_t i = 0; i < locals_3d.size(); i++)
+        hierarchy.set_local(i, locals_3d[i]);
+
+    hierarchy.update();
+
+    for (std::size_t i = 0; i < items_3d.size(); i++)
+        out[items_3d[i]].position = hierarchy.get_global(i).origin;
+}
+
+void visuals_t::validate_cache(ImFont* font, float font_size)
+{
+    ImTextureData* tex = ImGui::GetIO().Fonts->TexData;
+    int tex_id = tex ? tex->UniqueID : 0;
+    int tex_width = tex ? tex->Width : 0;
+    int tex_height = tex ? tex->Height : 0;
+
+    // Glyph UVs move when the atlas is rebuilt or grows
+    if (font != cache_font || font_size != cache_font_size || tex_id != cache_tex_id || tex_width != cache_tex_width || tex_height != cache_tex_height)
+    {
+        labels.clear();
+
+        cache_font = font;
+        cache_font_size = font_size;
+        cache_tex_id = tex_id;
+        cache_tex_width = tex_width;
+        cache_tex_height = tex_height;
+    }
+
+    if (labels.size() > CACHE_MAX_LABELS)
+        std::erase_if(labels, [this](const auto& it) { return frame - it.second.last_used > CACHE_MAX_AGE; });
+}
+
+const visuals_t::label_t& visuals_t::get_label(const std::string& text, ImFont* font, float font_size)
+{
+    auto it = labels.find(text);
+    if (it != labels.end())
+    {
+        it->second.last_used = frame;
+        return it->second;
+    }
+
+    label_t& label = labels[text];
+    label.last_used = frame;
+
+    ImFontBaked* baked = font->GetFontBaked(font_size);
+    const float scale = font_size / baked->Size;
+
+    float x = 0.f;
+    const char* s = text.c_str();
+    const char* end = s + text.size();
+
+    while (s < end)
+    {
+        unsigned int c = static_cast<unsigned char>(*s);
+        if (c < 0x80)
+            s++;
+        else
+            s += ImTextCharFromUtf8(&c, s, end);
+
+        const ImFontGlyph* glyph = baked->FindGlyph(static_cast<ImWchar>(c));
+        if (!glyph)
+            continue;
+
+        if (glyph->Visible)
+        {
+            label.quads.push_back({
+                ImVec2(x + glyph->X0 * scale, glyph->Y0 * scale),
+                ImVec2(x + glyph->X1 * scale, glyph->Y1 * scale),
+                ImVec2(glyph->U0, glyph->V0),
+                ImVec2(glyph->U1, glyph->V1) });
+        }
+
+        x += glyph->AdvanceX * scale;
+    }
+
+    label.size = ImVec2(x, font_size);
+    return label;
+}
+
+void visuals_t::build(ImDrawList* draw_list, const std::vector<item_t>& in, const camera_t& camera, ImVec2 screen_size)
+{
+    PROFILE_SCOPE("visuals::build");
+
+    ImFont* font = ImGui::GetFont();
+    float font_size = ImGui::GetFontSize();
+
+    frame++;
+    validate_cache(font, font_size);
+
+    projected.clear();
+
+    // Batch transform every 3D position into camera space first
+    world.clear();
+    world_index.clear();
+
+    for (std::uint32_t i = 0; i < in.size(); i++)
+    {
+        if (!in[i].is_3d)
+        {
+            projected.push_back({ ImVec2(in[i].position.x, in[i].position.y), box_size, i });
+            continue;
+        }
+
+        if (camera.valid)
+        {
+            world.push_back(in[i].position);
+            world_index.push_back(i);
+        }
+    }
+
+    view.resize(world.size());
+    batch::xform_inv(camera.transform, world.data(), view.data(), world.size());
+
+    const Vector4* m = camera.projection.matrix;
+    for (std::size_t i = 0; i < view.size(); i++)
+    {
+        const Vector3& v = view[i];
+
+        // The camera looks down -Z
+        float depth = -v.z;
+        if (depth < camera.z_near)
+            continue;
+
+        float x = m[0].x * v.x + m[1].x * v.y + m[2].x * v.z + m[3].x;
+        float y = m[0].y * v.x + m[1].y * v.y + m[2].y * v.z + m[3].y;
+        float w = m[0].w * v.x + m[1].w * v.y + m[2].w * v.z + m[3].w;
+
+        if (w == 0.f)
+            continue;
+
+        x /= w;
+        y /= w;
+
+        if (x < -1.1f || x > 1.1f || y < -1.1f || y > 1.1f)
+            continue;
+
+        float half = box_size * m[1].y / depth * 0.5f * screen_size.y;
+
+        projected.push_back({ ImVec2((x * 0.5f + 0.5f) * screen_size.x, (-y * 0.5f + 0.5f) * screen_size.y), half, world_index[i] });
+    }
+
+    // Resolve the labels and grow the buffers once for the whole frame
+    name_labels.resize(projected.size());
+    class_labels.assign(projected.size(), nullptr);
+
+    int vtx_total = 0;
+    int idx_total = 0;
+
+    for (std::size_t i = 0; i < projected.size(); i++)
+    {
+        const item_t& item = in[projected[i].item];
+
+        name_labels[i] = &get_label(item.name, font, font_size);
+        int quads = 4 + static_cast<int>(name_labels[i]->quads.size());
+
+        if (show_class)
+        {
+            class_labels[i] = &get_label(item.class_name, font, font_size);
+            quads += static_cast<int>(class_labels[i]->quads.size());
+        }
+
+        vtx_total += quads * 4;
+        idx_total += quads * 6;
+    }
+
+    draw_list->VtxBuffer.reserve(draw_list->VtxBuffer.Size + vtx_total);
+    draw_list->IdxBuffer.reserve(draw_list->IdxBuffer.Size + idx_total);
+
+    auto emit_label = [draw_list](const label_t* label, ImVec2 origin, ImU32 color) {
+        for (const glyph_quad_t& quad : label->quads)
+            draw_list->PrimRectUV(origin + quad.a, origin + quad.b, quad.uv_a, quad.uv_b, color);
+    };
+
+    const bool large_meshes = sizeof(ImDrawIdx) != 2 || (draw_list->Flags & ImDrawListFlags_AllowVtxOffset);
+
+    for (std::size_t i = 0; i < projected.size(); i++)
+    {
+        const projected_t& p = projected[i];
+        const item_t& item = in[p.item];
+        const label_t* name = name_labels[i];
+        const label_t* class_name = class_labels[i];
+
+        int quads = 4 + static_cast<int>(name->quads.size()) + (class_name ? static_cast<int>(class_name->quads.size()) : 0);
+
+        // One reservation per item, PrimReserve moves to a new VtxOffset before 16-bit indices overflow
+        if (!large_meshes && draw_list->_VtxCurrentIdx + quads * 4 >= (1 << 16))
+            break;
+
+        draw_list->PrimReserve(quads * 6, quads * 4);
+
+        ImU32 color = item.is_3d ? COLOR_3D : COLOR_2D;
+        ImVec2 min(p.screen.x - p.half_size, p.screen.y - p.half_size);
+        ImVec2 max(p.screen.x + p.half_size, p.screen.y + p.half_size);
+
+        draw_list->PrimRect(min, ImVec2(max.x, min.y + 1.f), color);
+        draw_list->PrimRect(ImVec2(min.x, max.y - 1.f), max, color);
+        draw_list->PrimRect(ImVec2(min.x, min.y + 1.f), ImVec2(min.x + 1.f, max.y - 1.f), color);
+        draw_list->PrimRect(ImVec2(max.x - 1.f, min.y + 1.f), ImVec2(max.x, max.y - 1.f), color);
+
+        emit_label(name, ImVec2(IM_TRUNC(p.screen.x - name->size.x * 0.5f), IM_TRUNC(min.y - name->size.y - 2.f)), color);
+
+        if (class_name)
+            emit_label(class_name, ImVec2(IM_TRUNC(p.screen.x - class_name->size.x * 0.5f), IM_TRUNC(max.y + 2.f)), COLOR_CLASS);
+    }
+}
+
+void visuals_t::capture(gd::SceneTree* tree)
+{
+    camera_t back_camera;
+    ImVec2 screen_size;
+
+    {
+        std::lock_guard lock(capture_mutex);
+        if (!capture_requested)
+            return;
+
+        screen_size = capture_screen_size;
+    }
+
+    collect(tree, capture_back, back_camera, screen_size);
+
+    std::lock_guard lock(capture_mutex);
+    std::swap(captured, capture_back);
+    captured_camera = back_camera;
+    capture_fresh = true;
+    capture_requested = false;
+}
+
+void visuals_t::draw(gd::SceneTree* tree)
+{
+    if (!enabled)
+        return;
+
+    const ImVec2 screen_size = ImGui::GetIO().DisplaySize;
+
+    if (on_frame_hook)
+    {
+        // Until the game's next frame the previous capture is drawn again
+        std::lock_guard lock(capture_mutex);
+        if (capture_fresh)
+        {
+            std::swap(items, captured);
+            camera = captured_camera;
+            capture_fresh = false;
+        }
+
+        capture_requested = true;
+        capture_screen_size = screen_size;
+    }
+    else
+    {
+        collect(tree, items, camera, screen_size);
+    }
+
+    build(ImGui::GetBackgroundDrawList(), items, camera, screen_size);
+}
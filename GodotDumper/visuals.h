@@ -0,0 +1,120 @@
+#pragma once
+#include "sdk.h"
+#include "hierarchy.h"
+#include <imgui/imgui.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace gd
+{
+	class Node;
+	class SceneTree;
+}
+
+/*
+ * World-space overlays (boxes, names and class tags) for every Node3D/Node2D of the current scene
+ *
+ * A frame is split in collect (memory reads) and build (cull, batch projection, geometry)
+ * 3D positions come from the local transform chain through TransformHierarchy, so edits show before the engine's next frame
+ * build writes straight into one ImDrawList: the vertex/index buffers are grown once per frame
+ * and glyph quads come from a per-string cache, so labels never go through ImGui's text layout again
+*/
+class visuals_t {
+public:
+	struct item_t {
+		Vector3 position; // World position for 3D nodes, canvas position for 2D ones
+		bool is_3d = true;
+		std::string name;
+		std::string class_name;
+	};
+
+	struct camera_t {
+		Transform3D transform;
+		Projection projection{};
+		float z_near = 0.05f;
+		bool valid = false;
+	};
+
+	bool enabled = false;
+	bool show_3d = true;
+	bool show_2d = true;
+	bool show_class = true;
+
+	float box_size = 0.5f; // World units for 3D boxes, pixels for 2D ones
+	std::size_t max_items = 20000;
+
+	// Set once capture runs on the game's thread (frame_hook), draw then builds from the last capture instead of collecting
+	bool on_frame_hook = false;
+
+	void collect(gd::SceneTree* tree, std::vector<item_t>& out, camera_t& camera, ImVec2 screen_size);
+	void build(ImDrawList* draw_list, const std::vector<item_t>& in, const camera_t& camera, ImVec2 screen_size);
+
+	// collect between two game frames, only when draw has taken the previous capture so the game pays for one per overlay frame
+	void capture(gd::SceneTree* tree);
+
+	// collect (or the last capture) + build into the background draw list
+	void draw(gd::SceneTree* tree);
+
+private:
+	struct glyph_quad_t {
+		ImVec2 a, b; // Corners relative to the label's origin
+		ImVec2 uv_a, uv_b;
+	};
+
+	struct projected_t {
+		ImVec2 screen;
+		float half_size;
+		std::uint32_t item;
+	};
+
+	struct label_t {
+		std::vector<glyph_quad_t> quads;
+		ImVec2 size;
+		int last_used = 0;
+	};
+
+	const label_t& get_label(const std::string& text, ImFont* font, float font_size);
+	void validate_cache(ImFont* font, float font_size);
+
+private:
+	std::unordered_map<std::string, label_t> labels;
+
+	// The cached UVs are only valid for this atlas state
+	int cache_tex_id = 0;
+	int cache_tex_width = 0;
+	int cache_tex_height = 0;
+	float cache_font_size = 0.f;
+	ImFont* cache_font = nullptr;
+
+	int frame = 0;
+
+	// 3D globals of a collect pass, evaluated from the local transforms in one batch
+	TransformHierarchy hierarchy;
+	std::vector<std::int32_t> parents_3d;
+	std::vector<Transform3D> locals_3d;
+	std::vector<std::uint32_t> items_3d; // Hierarchy index -> collected item
+
+	// Handed from capture to draw, the game's thread only touches the back buffer and collect's scratch while on_frame_hook
+	std::mutex capture_mutex;
+	std::vector<item_t> captured;
+	std::vector<item_t> capture_back;
+	camera_t captured_camera;
+	bool capture_fresh = false;
+	bool capture_requested = false;
+	ImVec2 capture_screen_size{ 0.f, 0.f };
+
+	// Per frame buffers, kept so build doesn't allocate once they've grown
+	std::vector<item_t> items;
+	camera_t camera;
+	std::vector<projected_t> projected;
+	std::vector<Vector3> world;
+	std::vector<Vector3> view;
+	std::vector<std::uint32_t> world_index;
+	std::vector<const label_t*> name_labels;
+	std::vector<const label_t*> class_labels;
+};
+
+inline std::unique_ptr<visuals_t> visuals = std::make_unique<visuals_t>();
@@ -0,0 +1,162 @@
+#include "vtables.h"
+#include "analysis.h"
+#include "profiler.h"
+#include "x86.h"
+#include <algorithm>
+
+vtable_table_t::~vtable_table_t()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+void vtable_table_t::start(const void* module, std::size_t class_name_index)
+{
+    if (thread.joinable() || ready)
+        return;
+
+    thread = std::thread([this, module, class_name_index]()
+    {
+        if (analysis->get(module))
+            scan(analysis->get_image(), analysis->get_xrefs(), class_name_index);
+    });
+}
+
+static bool is_identifier(const pe_image_t& image, std::uint32_t rva, std::string& out)
+{
+    static constexpr std::size_t MAX_NAME = 64;
+
+    out.clear();
+
+    for (std::size_t i = 0; i < MAX_NAME; i++)
+    {
+        std::uint8_t c;
+        if (!image.read(rva + static_cast<std::uint32_t>(i), c))
+            return false;
+
+        if (c == 0)
+            return !out.empty();
+
+        const bool letter = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+        if (!letter && !(i && c >= '0' && c <= '9'))
+            return false;
+
+        out += static_cast<char>(c);
+    }
+
+    return false;
+}
+
+std::string vtable_table_t::find_class_literal(const pe_image_t& image, const xref_index_t& xrefs, std::uint32_t function) const
+{
+    // Incremental linking and identical code folding leave jmp thunks in vtables
+    for (int hops = 0; hops < 4; hops++)
+    {
+        x86::instruction_t instruction;
+        if (!image.is_valid(function, 1) || !x86::decode(image.data() + function, image.size() - function, instruction) || !instruction.is_jump())
+            break;
+
+        function = static_cast<std::uint32_t>(instruction.target(function, image.data() + function));
+    }
+
+    const pe_image_t::function_t* range = image.get_function(function);
+    const std::uint32_t end = range ? range->end : function + 256;
+
+    std::string name;
+
+    for (const xref_index_t::xref_t& xref : xrefs.get_references_from(function, end))
+    {
+        if (xref.kind != xref_index_t::ADDRESS)
+            continue;
+
+        const pe_image_t::section_t* section = image.get_section(xref.target);
+        if (!section || section->is_executable() || section->is_writable())
+            continue;
+
+        if (is_identifier(image, xref.target, name))
+            return name;
+    }
+
+    return {};
+}
+
+bool vtable_table_t::scan(const pe_image_t& image, const xref_index_t& xrefs, std::size_t class_name_index)
+{
+    PROFILE_SCOPE("vtable_table_t::scan");
+
+    const std::uint64_t pointer_base = image.get_pointer_base();
+
+    auto code_rva = [&](std::uint32_t slot, std::uint32_t& out) -> bool
+    {
+        std::uint64_t pointer;
+        if (!image.read(slot, pointer) || pointer < pointer_base || pointer - pointer_base >= image.size())
+            return false;
+
+        out = static_cast<std::uint32_t>(pointer - pointer_base);
+
+        const pe_image_t::section_t* section = image.get_section(out);
+        return section && section->is_executable();
+    };
+
+    // Every address a lea loads from read-only data, vtables among them
+    std::vector<std::uint32_t> candidates;
+    for (const xref_index_t::xref_t& xref : xrefs.get_references_from(0, UINT32_MAX))
+    {
+        if (xref.kind == xref_index_t::ADDRESS && (xref.target & 7) == 0)
+            candidates.push_back(xref.target);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    // Several vtables share an inherited get_class
+    std::unordered_map<std::uint32_t, std::uint32_t> name_of_function;
+    std::unordered_map<std::string, std::uint32_t> index_of_name;
+
+    const pe_image_t::section_t* section = nullptr;
+
+    for (std::uint32_t candidate : candidates)
+    {
+        if (!section || !section->contains(candidate))
+            section = image.get_section(candidate);
+
+        if (!section || section->is_executable() || section->is_writable())
+            continue;
+
+        std::uint32_t function = 0;
+        bool is_vtable = true;
+
+        for (std::size_t i = 0; i < MIN_ENTRIES && is_vtable; i++)
+        {
+            std::uint32_t entry;
+            is_vtable = code_rva(candidate + static_cast<std::uint32_t>(i * sizeof(std::uint64_t)), entry);
+
+            if (i == class_name_index)
+                function = entry;
+        }
+
+        if (!is_vtable || (class_name_index >= MIN_ENTRIES && !code_rva(candidate + static_cast<std::uint32_t>(class_name_index * sizeof(std::uint64_t)), function)))
+            continue;
+
+        vtable_count++;
+
+        auto named = name_of_function.find(function);
+        if (named == name_of_function.end())
+        {
+            std::string name = find_class_literal(image, xrefs, function);
+            if (name.empty())
+                continue;
+
+            auto [it, inserted] = index_of_name.emplace(name, static_cast<std::uint32_t>(names.size()));
+            if (inserted)
+                names.push_back(std::move(name));
+
+            named = name_of_function.emplace(function, it->second).first;
+        }
+
+        class_of_vtable.emplace(static_cast<std::uintptr_t>(pointer_base + candidate), named->second);
+    }
+
+    ready.store(true, std::memory_order_release);
+    return !class_of_vtable.empty();
+}
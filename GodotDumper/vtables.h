@@ -0,0 +1,65 @@
+#pragma once
+#include "pe.h"
+#include "xref.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Vtable to class name table, built once from the image instead of asking live objects
+ *
+ * Vtables are the read-only arrays of code pointers whose address a constructor loads (lea reg, [rip + vtable])
+ * The class name comes from the vtable's get_class: its body loads the class name literal (return String("Node3D")),
+ * the first identifier literal it references is taken, nothing is ever called
+ *
+ * After that classifying an object is one pointer read and a hash lookup,
+ * vtables the scan couldn't name (get_class not overridden, inlined differently) still go through the virtual call
+*/
+class vtable_table_t {
+public:
+	static constexpr std::size_t MIN_ENTRIES = 11; // get_class has to be in the vtable
+
+	~vtable_table_t();
+
+	// Scans the module on its own thread, find returns nullptr until it's done
+	void start(const void* module, std::size_t class_name_index);
+
+	// Portable part, the image may come from disk (tools) or the running game
+	bool scan(const pe_image_t& image, const xref_index_t& xrefs, std::size_t class_name_index);
+
+	const std::string* find(const void* vtable) const
+	{
+		if (!ready.load(std::memory_order_acquire))
+			return nullptr;
+
+		auto it = class_of_vtable.find(reinterpret_cast<std::uintptr_t>(vtable));
+		return it != class_of_vtable.end() ? &names[it->second] : nullptr;
+	}
+
+	bool is_ready() const { return ready.load(std::memory_order_acquire); }
+
+	// Vtables found, and how many of them got a name
+	std::size_t get_vtable_count() const { return vtable_count; }
+	std::size_t get_named_count() const { return class_of_vtable.size(); }
+
+	const std::unordered_map<std::uintptr_t, std::uint32_t>& get_table() const { return class_of_vtable; }
+	const std::vector<std::string>& get_names() const { return names; }
+
+private:
+	// Class name literal loaded by the function at rva, empty if there's none
+	std::string find_class_literal(const pe_image_t& image, const xref_index_t& xrefs, std::uint32_t function) const;
+
+private:
+	std::vector<std::string> names;
+	std::unordered_map<std::uintptr_t, std::uint32_t> class_of_vtable; // Absolute vtable address -> into names
+	std::size_t vtable_count = 0;
+
+	std::atomic<bool> ready = false;
+	std::thread thread;
+};
+
+inline std::unique_ptr<vtable_table_t> vtables = std::make_unique<vtable_table_t>();
@@ -0,0 +1,130 @@
+#include "work_pool.h"
+#include <algorithm>
+
+static thread_local const work_pool_t* current_pool = nullptr;
+static thread_local std::size_t current_index = SIZE_MAX;
+
+work_pool_t::work_pool_t(std::size_t threads)
+{
+    if (threads == 0)
+        threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+    for (std::size_t i = 0; i < threads; i++)
+        workers.push_back(std::make_unique<worker_t>());
+
+    for (std::size_t i = 0; i < threads; i++)
+        workers[i]->thread = std::thread(&work_pool_t::run, this, i);
+}
+
+work_pool_t::~work_pool_t()
+{
+    wait();
+
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (std::unique_ptr<worker_t>& worker : workers)
+        worker->thread.join();
+}
+
+std::size_t work_pool_t::get_worker_index()
+{
+    return current_index;
+}
+
+void work_pool_t::submit(task_t task)
+{
+    const std::size_t index = current_pool == this ? current_index : next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+    // A worker going to sleep counts itself under sleep_lock before checking queued, one of the two sides sees the other
+    pending.fetch_add(1);
+    queued.fetch_add(1);
+
+    {
+        std::lock_guard<std::mutex> guard(workers[index]->lock);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+
+    if (sleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        wake.notify_one();
+    }
+}
+
+void work_pool_t::wait()
+{
+    std::unique_lock<std::mutex> guard(sleep_lock);
+    done.wait(guard, [this]() { return pending.load() == 0; });
+}
+
+bool work_pool_t::pop(std::size_t index, task_t& task)
+{
+    worker_t& worker = *workers[index];
+    std::lock_guard<std::mutex> guard(worker.lock);
+
+    if (worker.tasks.empty())
+        return false;
+
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool work_pool_t::steal(std::size_t index, task_t& task)
+{
+    for (std::size_t i = 1; i < workers.size(); i++)
+    {
+        worker_t& victim = *workers[(index + i) % workers.size()];
+
+        std::unique_lock<std::mutex> guard(victim.lock, std::try_to_lock);
+        if (!guard.owns_lock() || victim.tasks.empty())
+            continue;
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+void work_pool_t::run(std::size_t index)
+{
+    current_pool = this;
+    current_index = index;
+
+    while (true)
+    {
+        task_t task;
+
+        if (pop(index, task) || steal(index, task))
+        {
+            queued.fetch_sub(1);
+            task();
+            task = nullptr;
+
+            if (pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> guard(sleep_lock);
+                done.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleep_lock);
+
+        // try_lock misses in steal can leave work behind, only sleep when nothing is queued anywhere
+        sleeping.fetch_add(1);
+        wake.wait(guard, [this]() { return stopping || queued.load() > 0; });
+        sleeping.fetch_sub(1);
+
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
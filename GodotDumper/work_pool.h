@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Work stealing thread pool for recursive jobs (pointer scans, tree traversals)
+ *
+ * Every worker owns a deque, tasks submitted from a worker go to the back of its own deque and are popped back first
+ * (depth first, the working set stays in cache), an idle worker steals from the front of the others' (the oldest,
+ * usually largest, pieces of work) and sleeps when there's nothing left anywhere
+ *
+ * Tasks may submit more tasks, wait returns once all of them finished, it's meant to be called from outside the pool
+*/
+class work_pool_t {
+public:
+	using task_t = std::function<void()>;
+
+	// 0 threads = one per hardware thread
+	explicit work_pool_t(std::size_t threads = 0);
+	~work_pool_t();
+
+	work_pool_t(const work_pool_t&) = delete;
+	work_pool_t& operator=(const work_pool_t&) = delete;
+
+	void submit(task_t task);
+
+	// Blocks until every task, including the ones submitted by tasks, returned
+	void wait();
+
+	// True while some worker could use more work, a recursive task should split instead of going deeper itself
+	bool wants_work() const { return queued.load(std::memory_order_relaxed) < workers.size(); }
+
+	std::size_t get_worker_count() const { return workers.size(); }
+
+	// Index of the calling worker in [0, get_worker_count()), for per worker buffers, SIZE_MAX outside the pool
+	static std::size_t get_worker_index();
+
+private:
+	struct worker_t {
+		std::mutex lock;
+		std::deque<task_t> tasks;
+		std::thread thread;
+	};
+
+	void run(std::size_t index);
+	bool pop(std::size_t index, task_t& task);
+	bool steal(std::size_t index, task_t& task);
+
+private:
+	std::vector<std::unique_ptr<worker_t>> workers;
+
+	std::atomic<std::size_t> pending = 0; // Submitted and not finished
+	std::atomic<std::size_t> queued = 0; // Sitting in a deque
+	std::atomic<std::size_t> sleeping = 0;
+	std::atomic<std::size_t> next_worker = 0; // Round robin for tasks submitted from outside
+
+	std::mutex sleep_lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+	bool stopping = false;
+};
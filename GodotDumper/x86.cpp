@@ -0,0 +1,374 @@
+#include "x86.h"
+#include <array>
+#include <cstring>
+
+namespace
+{
+    enum flag_t : std::uint8_t {
+        MODRM = 1 << 0,
+        IMM8 = 1 << 1,
+        IMMZ = 1 << 2, // 16 or 32 bits depending on the operand size
+        IMM16 = 1 << 3,
+        REL8 = 1 << 4,
+        REL32 = 1 << 5,
+        INVALID = 1 << 6,
+        SPECIAL = 1 << 7 // Operands depend on more than the opcode, see decode
+    };
+
+    constexpr std::uint8_t primary_flags(std::uint8_t op)
+    {
+        // ALU block: add, or, adc, sbb, and, sub, xor, cmp
+        if (op < 0x40)
+        {
+            switch (op & 7)
+            {
+            case 0: case 1: case 2: case 3: return MODRM;
+            case 4: return IMM8;
+            case 5: return IMMZ;
+            default: return op == 0x0F ? SPECIAL : INVALID; // push/pop segment, daa, das... (prefixes never get here)
+            }
+        }
+
+        if (op >= 0x50 && op <= 0x5F)
+            return 0;
+        if (op >= 0x70 && op <= 0x7F)
+            return REL8;
+        if (op >= 0x84 && op <= 0x8F)
+            return MODRM;
+        if (op >= 0x90 && op <= 0x9F)
+            return op == 0x9A ? INVALID : 0;
+        if (op >= 0xA0 && op <= 0xA3)
+            return SPECIAL; // moffs
+        if (op >= 0xB0 && op <= 0xB7)
+            return IMM8;
+        if (op >= 0xB8 && op <= 0xBF)
+            return SPECIAL; // imm64 with REX.W
+        if (op >= 0xD0 && op <= 0xD3)
+            return MODRM;
+        if (op >= 0xD8 && op <= 0xDF)
+            return MODRM; // x87
+
+        switch (op)
+        {
+        case 0x60: case 0x61: case 0x82: case 0xCE: case 0xD4: case 0xD5: case 0xD6: case 0xEA:
+            return INVALID;
+        case 0x63: return MODRM;
+        case 0x68: return IMMZ;
+        case 0x69: return MODRM | IMMZ;
+        case 0x6A: return IMM8;
+        case 0x6B: return MODRM | IMM8;
+        case 0x80: return MODRM | IMM8;
+        case 0x81: return MODRM | IMMZ;
+        case 0x83: return MODRM | IMM8;
+        case 0xA8: return IMM8;
+        case 0xA9: return IMMZ;
+        case 0xC0: case 0xC1: return MODRM | IMM8;
+        case 0xC2: return IMM16;
+        case 0xC6: return MODRM | IMM8;
+        case 0xC7: return MODRM | IMMZ;
+        case 0xC8: return SPECIAL; // enter imm16, imm8
+        case 0xCA: return IMM16;
+        case 0xCD: return IMM8;
+        case 0xE0: case 0xE1: case 0xE2: case 0xE3: return REL8;
+        case 0xE4: case 0xE5: case 0xE6: case 0xE7: return IMM8;
+        case 0xE8: case 0xE9: return REL32;
+        case 0xEB: return REL8;
+        case 0xF6: case 0xF7: return SPECIAL; // test has an immediate, not/neg/mul/div don't
+        case 0xFE: case 0xFF: return MODRM;
+        default: return 0;
+        }
+    }
+
+    constexpr std::uint8_t map_0f_flags(std::uint8_t op)
+    {
+        if (op <= 0x03)
+            return MODRM;
+        if (op >= 0x10 && op <= 0x17)
+            return MODRM;
+        if (op >= 0x18 && op <= 0x1F)
+            return MODRM; // hint nops, endbr64
+        if (op >= 0x20 && op <= 0x23)
+            return MODRM;
+        if (op >= 0x24 && op <= 0x27)
+            return INVALID;
+        if (op >= 0x28 && op <= 0x2F)
+            return MODRM;
+        if (op >= 0x30 && op <= 0x37)
+            return 0;
+        if (op >= 0x40 && op <= 0x4F)
+            return MODRM; // cmovcc
+        if (op >= 0x70 && op <= 0x73)
+            return MODRM | IMM8;
+        if (op == 0x77)
+            return 0; // emms
+        if (op >= 0x50 && op <= 0x7F)
+            return MODRM;
+        if (op >= 0x80 && op <= 0x8F)
+            return REL32; // jcc
+        if (op >= 0x90 && op <= 0x9F)
+            return MODRM; // setcc
+        if (op >= 0xC8 && op <= 0xCF)
+            return 0; // bswap
+        if (op >= 0xD0)
+            return MODRM;
+
+        switch (op)
+        {
+        case 0x05: case 0x06: case 0x07: case 0x08: case 0x09: case 0x0B: case 0x0E:
+            return 0;
+        case 0x0D: return MODRM;
+        case 0x0F: return MODRM | IMM8; // 3DNow!
+        case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xA9: case 0xAA:
+            return 0;
+        case 0xA4: case 0xAC: case 0xBA: case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+            return MODRM | IMM8;
+        case 0xA3: case 0xA5: case 0xAB: case 0xAD: case 0xAE: case 0xAF:
+            return MODRM;
+        case 0xA6: case 0xA7:
+            return INVALID;
+        default:
+            return (op >= 0xB0 && op <= 0xC7) ? MODRM : INVALID;
+        }
+    }
+
+    template <std::uint8_t(*Flags)(std::uint8_t)>
+    constexpr std::array<std::uint8_t, 256> make_table()
+    {
+        std::array<std::uint8_t, 256> table{};
+        for (int i = 0; i < 256; i++)
+            table[i] = Flags(static_cast<std::uint8_t>(i));
+        return table;
+    }
+
+    constexpr std::array<std::uint8_t, 256> primary_table = make_table<primary_flags>();
+    constexpr std::array<std::uint8_t, 256> map_0f_table = make_table<map_0f_flags>();
+
+    // VEX / EVEX instructions always have a ModRM (but vzeroupper / vzeroall), these also take an imm8
+    constexpr bool vex_has_imm8(x86::map_t map, std::uint8_t op)
+    {
+        if (map == x86::MAP_0F3A)
+            return true;
+        if (map == x86::MAP_0F)
+            return (op >= 0x70 && op <= 0x73) || op == 0xC2 || op == 0xC4 || op == 0xC5 || op == 0xC6;
+        return false;
+    }
+}
+
+std::uint64_t x86::instruction_t::target(std::uint64_t address, const std::uint8_t* code) const
+{
+    std::int64_t offset = 0;
+
+    if (rip_relative)
+    {
+        std::int32_t disp;
+        std::memcpy(&disp, code + disp_offset, sizeof(disp));
+        offset = disp;
+    }
+    else if (relative && imm_size == 1)
+    {
+        offset = static_cast<std::int8_t>(code[imm_offset]);
+    }
+    else if (relative)
+    {
+        std::int32_t rel;
+        std::memcpy(&rel, code + imm_offset, sizeof(rel));
+        offset = rel;
+    }
+    else
+    {
+        return 0;
+    }
+
+    return address + length + offset;
+}
+
+std::size_t x86::decode(const std::uint8_t* code, std::size_t size, instruction_t& out)
+{
+    out = instruction_t{};
+
+    const std::size_t limit = size < MAX_LENGTH ? size : MAX_LENGTH;
+    std::size_t i = 0;
+
+    // Legacy prefixes, any order, then an optional REX right before the opcode
+    for (; i < limit; i++)
+    {
+        std::uint8_t byte = code[i];
+
+        if (byte == 0x66)
+            out.operand_size = true;
+        else if (byte == 0x67)
+            out.address_size = true;
+        else if (byte == 0xF2 || byte == 0xF3)
+            out.rep = true;
+        else if (byte != 0xF0 && byte != 0x2E && byte != 0x36 && byte != 0x3E && byte != 0x26 && byte != 0x64 && byte != 0x65)
+            break;
+    }
+
+    if (i < limit && (code[i] & 0xF0) == 0x40)
+        out.rex = code[i++];
+
+    out.prefix_count = static_cast<std::uint8_t>(i);
+
+    if (i >= limit)
+        return 0;
+
+    std::uint8_t flags = 0;
+    std::uint8_t op = code[i];
+
+    if (op == 0xC4 || op == 0xC5 || op == 0x62)
+    {
+        // VEX (2 / 3 bytes) or EVEX (4 bytes), C4 / C5 / 62 aren't les / lds / bound in 64-bit mode
+        std::size_t payload = op == 0xC5 ? 1 : op == 0xC4 ? 2 : 3;
+        if (i + payload + 1 >= limit)
+            return 0;
+
+        std::uint8_t selector = op == 0xC5 ? 1 : code[i + 1] & (op == 0x62 ? 7 : 0x1F);
+
+        out.vex = true;
+        out.map = selector == 1 ? MAP_0F : selector == 2 ? MAP_0F38 : selector == 3 ? MAP_0F3A : MAP_OTHER;
+
+        if (op == 0xC4 && (code[i + 2] & 0x80))
+            out.rex = 0x48; // VEX.W, only matters for B8-BF which VEX doesn't have
+
+        i += payload + 1;
+        out.opcode_offset = static_cast<std::uint8_t>(i);
+        out.opcode = code[i++];
+
+        flags = MODRM;
+        if (out.map == MAP_0F && out.opcode == 0x77)
+            flags = 0;
+        if (vex_has_imm8(out.map, out.opcode))
+            flags |= IMM8;
+    }
+    else if (op == 0x0F)
+    {
+        if (i + 1 >= limit)
+            return 0;
+
+        std::uint8_t next = code[i + 1];
+
+        if (next == 0x38 || next == 0x3A)
+        {
+            if (i + 2 >= limit)
+                return 0;
+
+            out.map = next == 0x38 ? MAP_0F38 : MAP_0F3A;
+            out.opcode_offset = static_cast<std::uint8_t>(i + 2);
+            out.opcode = code[i + 2];
+            i += 3;
+
+            flags = next == 0x38 ? MODRM : MODRM | IMM8;
+        }
+        else
+        {
+            out.map = MAP_0F;
+            out.opcode_offset = static_cast<std::uint8_t>(i + 1);
+            out.opcode = next;
+            i += 2;
+
+            flags = map_0f_table[next];
+        }
+    }
+    else
+    {
+        out.opcode_offset = static_cast<std::uint8_t>(i);
+        out.opcode = op;
+        i++;
+
+        flags = primary_table[op];
+    }
+
+    if (flags & INVALID)
+        return 0;
+
+    std::size_t imm_size = 0;
+
+    if (flags & SPECIAL)
+    {
+        switch (out.opcode)
+        {
+        case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+            imm_size = out.address_size ? 4 : 8; // mov al/eax, [moffs]
+            break;
+        case 0xC8:
+            imm_size = 3;
+            break;
+        case 0xF6: case 0xF7:
+            flags = MODRM;
+            break;
+        default: // B8-BF
+            imm_size = (out.rex & 8) ? 8 : out.operand_size ? 2 : 4;
+            break;
+        }
+    }
+
+    if (flags & MODRM)
+    {
+        if (i >= limit)
+            return 0;
+
+        out.has_modrm = true;
+        out.modrm_offset = static_cast<std::uint8_t>(i);
+        out.modrm = code[i++];
+
+        const std::uint8_t mod = out.mod();
+        const std::uint8_t rm = out.rm();
+
+        if (mod != 3)
+        {
+            std::uint8_t disp_size = mod == 1 ? 1 : mod == 2 ? 4 : 0;
+
+            if (rm == 4)
+            {
+                if (i >= limit)
+                    return 0;
+
+                // SIB without a base register
+                if (mod == 0 && (code[i] & 7) == 5)
+                    disp_size = 4;
+
+                i++;
+            }
+            else if (mod == 0 && rm == 5)
+            {
+                disp_size = 4;
+                out.rip_relative = true;
+            }
+
+            if (disp_size)
+            {
+                out.disp_offset = static_cast<std::uint8_t>(i);
+                out.disp_size = disp_size;
+                i += disp_size;
+            }
+        }
+
+        // test r/m, imm
+        if (out.map == MAP_PRIMARY && (out.opcode == 0xF6 || out.opcode == 0xF7) && out.reg() < 2)
+            imm_size = out.opcode == 0xF6 ? 1 : out.operand_size ? 2 : 4;
+    }
+
+    if (flags & IMM8)
+        imm_size = 1;
+    else if (flags & IMMZ)
+        imm_size = out.operand_size && !(out.rex & 8) ? 2 : 4;
+    else if (flags & IMM16)
+        imm_size = 2;
+    else if (flags & REL8)
+        imm_size = 1, out.relative = true;
+    else if (flags & REL32)
+        imm_size = 4, out.relative = true;
+
+    if (imm_size)
+    {
+        out.imm_offset = static_cast<std::uint8_t>(i);
+        out.imm_size = static_cast<std::uint8_t>(imm_size);
+        i += imm_size;
+    }
+
+    if (i > limit)
+        return 0;
+
+    out.length = static_cast<std::uint8_t>(i);
+    return i;
+}
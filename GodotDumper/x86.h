@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * x86-64 instruction length decoder
+ *
+ * Only finds where each part of an instruction is (prefixes, opcode, ModRM, displacement, immediate),
+ * it doesn't name instructions, enough to walk code, wildcard operands and relocate instructions
+ * Legacy, REX, VEX and EVEX encodings are handled, 64-bit mode only
+*/
+namespace x86
+{
+	constexpr std::size_t MAX_LENGTH = 15;
+
+	enum map_t : std::uint8_t {
+		MAP_PRIMARY, // One byte opcodes
+		MAP_0F,
+		MAP_0F38,
+		MAP_0F3A,
+		MAP_OTHER // EVEX/APX maps, decoded like 0F38
+	};
+
+	struct instruction_t {
+		std::uint8_t length = 0;
+
+		std::uint8_t prefix_count = 0; // Legacy prefixes and REX
+		std::uint8_t rex = 0;
+		bool operand_size = false; // 0x66
+		bool address_size = false; // 0x67
+		bool rep = false; // 0xF2 / 0xF3
+		bool vex = false; // VEX or EVEX
+
+		map_t map = MAP_PRIMARY;
+		std::uint8_t opcode_offset = 0;
+		std::uint8_t opcode = 0;
+
+		bool has_modrm = false;
+		std::uint8_t modrm_offset = 0;
+		std::uint8_t modrm = 0;
+
+		std::uint8_t disp_offset = 0;
+		std::uint8_t disp_size = 0;
+
+		std::uint8_t imm_offset = 0;
+		std::uint8_t imm_size = 0;
+
+		bool rip_relative = false; // disp32 is relative to the next instruction
+		bool relative = false; // The immediate is a branch displacement (jmp, call, jcc, loop)
+
+		std::uint8_t mod() const { return modrm >> 6; }
+		std::uint8_t reg() const { return (modrm >> 3) & 7; }
+		std::uint8_t rm() const { return modrm & 7; }
+
+		// call rel32
+		bool is_call() const { return map == MAP_PRIMARY && opcode == 0xE8; }
+		// jmp rel8 / rel32
+		bool is_jump() const { return map == MAP_PRIMARY && (opcode == 0xE9 || opcode == 0xEB); }
+		bool is_conditional_jump() const { return relative && !is_call() && !is_jump(); }
+		bool is_return() const { return map == MAP_PRIMARY && (opcode == 0xC3 || opcode == 0xC2); }
+
+		// Address a rip relative operand or a branch points to, address is where the instruction lives
+		std::uint64_t target(std::uint64_t address, const std::uint8_t* code) const;
+	};
+
+	// Decodes the instruction at code, returns its length or 0 if it's invalid or doesn't fit in size
+	std::size_t decode(const std::uint8_t* code, std::size_t size, instruction_t& out);
+}
@@ -0,0 +1,133 @@
+#include "xref.h"
+#include "x86.h"
+#include <algorithm>
+
+void xref_index_t::decode_range(const pe_image_t& image, std::uint32_t begin, std::uint32_t end)
+{
+    const std::uint8_t* data = image.data();
+    const std::uint32_t image_size = static_cast<std::uint32_t>(image.size());
+
+    x86::instruction_t instruction;
+    std::uint32_t rva = begin;
+
+    while (rva < end)
+    {
+        const std::size_t length = x86::decode(data + rva, end - rva, instruction);
+
+        // Jump tables and padding inside a function, resync on the next byte
+        if (!length)
+        {
+            rva++;
+            continue;
+        }
+
+        instruction_count++;
+
+        const bool branch = instruction.relative && instruction.imm_size == 4;
+        if (instruction.rip_relative || branch)
+        {
+            const std::uint64_t target = instruction.target(rva, data + rva);
+
+            if (target < image_size)
+            {
+                xref_t xref;
+                xref.site = rva;
+                xref.target = static_cast<std::uint32_t>(target);
+                xref.length = static_cast<std::uint8_t>(length);
+                xref.operand_offset = branch ? instruction.imm_offset : instruction.disp_offset;
+
+                if (branch)
+                    xref.kind = instruction.is_call() ? CALL : instruction.is_jump() ? JUMP : BRANCH;
+                else if (instruction.map != x86::MAP_PRIMARY)
+                    xref.kind = READ;
+                else if (instruction.opcode == 0x8D)
+                    xref.kind = ADDRESS;
+                else if (instruction.opcode == 0x88 || instruction.opcode == 0x89 || instruction.opcode == 0xC6 || instruction.opcode == 0xC7)
+                    xref.kind = WRITE;
+                else if (instruction.opcode == 0xFF && instruction.reg() == 2)
+                    xref.kind = CALL_INDIRECT;
+                else if (instruction.opcode == 0xFF && instruction.reg() == 4)
+                    xref.kind = JUMP_INDIRECT;
+                else
+                    xref.kind = READ;
+
+                by_site.push_back(xref);
+            }
+        }
+
+        rva += static_cast<std::uint32_t>(length);
+    }
+}
+
+bool xref_index_t::build(const pe_image_t& image)
+{
+    by_site.clear();
+    by_target.clear();
+    instruction_count = 0;
+
+    const std::vector<pe_image_t::function_t>& functions = image.get_functions();
+
+    for (const pe_image_t::section_t& section : image.get_sections())
+    {
+        if (!section.is_executable() || !image.is_valid(section.rva, section.size))
+            continue;
+
+        const std::uint32_t section_end = section.rva + section.size;
+
+        if (functions.empty())
+        {
+            decode_range(image, section.rva, section_end);
+            continue;
+        }
+
+        auto it = std::lower_bound(functions.begin(), functions.end(), section.rva, [](const pe_image_t::function_t& function, std::uint32_t value) { return function.begin < value; });
+
+        // Functions split in several .pdata entries (cold parts, chained unwind info) may overlap
+        std::uint32_t decoded = section.rva;
+        for (; it != functions.end() && it->begin < section_end; ++it)
+        {
+            const std::uint32_t begin = std::max(it->begin, decoded);
+            const std::uint32_t end = std::min(it->end, section_end);
+
+            if (begin < end)
+            {
+                decode_range(image, begin, end);
+                decoded = end;
+            }
+        }
+    }
+
+    if (by_site.empty())
+        return false;
+
+    if (!std::is_sorted(by_site.begin(), by_site.end(), [](const xref_t& a, const xref_t& b) { return a.site < b.site; }))
+        std::sort(by_site.begin(), by_site.end(), [](const xref_t& a, const xref_t& b) { return a.site < b.site; });
+
+    by_target = by_site;
+    std::stable_sort(by_target.begin(), by_target.end(), [](const xref_t& a, const xref_t& b) { return a.target < b.target; });
+
+    by_site.shrink_to_fit();
+    return true;
+}
+
+std::span<const xref_index_t::xref_t> xref_index_t::get_references_to(std::uint32_t target) const
+{
+    auto begin = std::lower_bound(by_target.begin(), by_target.end(), target, [](const xref_t& xref, std::uint32_t value) { return xref.target < value; });
+    auto end = std::upper_bound(begin, by_target.end(), target, [](std::uint32_t value, const xref_t& xref) { return value < xref.target; });
+
+    return { begin, end };
+}
+
+std::span<const xref_index_t::xref_t> xref_index_t::get_references_from(std::uint32_t begin, std::uint32_t end) const
+{
+    auto first = std::lower_bound(by_site.begin(), by_site.end(), begin, [](const xref_t& xref, std::uint32_t value) { return xref.site < value; });
+    auto last = std::lower_bound(first, by_site.end(), end, [](const xref_t& xref, std::uint32_t value) { return xref.site < value; });
+
+    return { first, last };
+}
+
+const xref_index_t::xref_t* xref_index_t::get_reference_at(std::uint32_t site) const
+{
+    std::span<const xref_t> found = get_references_from(site, site + 1);
+    return found.empty() ? nullptr : &found.front();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "pe.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+ * Cross-reference index of the executable sections
+ *
+ * One pass decodes every instruction (function by function when the image has .pdata, so data between functions
+ * can't desync the decoder) and keeps the ones with a rip relative operand or a rel32 call / jmp / jcc
+ * The references are then kept twice, sorted by site and sorted by target, so both directions are a binary search
+ *
+ * All addresses are RVAs, targets outside the image (bad decodes) are dropped
+*/
+class xref_index_t {
+public:
+	enum kind_t : std::uint8_t {
+		READ, // Any other rip relative memory operand
+		WRITE, // mov [rip + x], ...
+		ADDRESS, // lea reg, [rip + x]
+		CALL, // call rel32, target is the function
+		CALL_INDIRECT, // call [rip + x], target is the pointer (import slots)
+		JUMP, // jmp rel32
+		JUMP_INDIRECT, // jmp [rip + x]
+		BRANCH // jcc rel32
+	};
+
+	struct xref_t {
+		std::uint32_t site; // Start of the instruction
+		std::uint32_t target;
+		kind_t kind;
+		std::uint8_t operand_offset; // Of the disp32 / rel32, same as the layout's *_rva_offset
+		std::uint8_t length; // Same as the layout's *_rip_offset
+	};
+
+public:
+	bool build(const pe_image_t& image);
+
+	// Every reference to target (readers of a global, callers of a function), by site
+	std::span<const xref_t> get_references_to(std::uint32_t target) const;
+
+	// References made by the instructions in [begin, end), by site
+	std::span<const xref_t> get_references_from(std::uint32_t begin, std::uint32_t end) const;
+
+	// The reference made by the instruction at site, if any
+	const xref_t* get_reference_at(std::uint32_t site) const;
+
+	std::size_t size() const { return by_site.size(); }
+	std::size_t get_instruction_count() const { return instruction_count; }
+
+private:
+	void decode_range(const pe_image_t& image, std::uint32_t begin, std::uint32_t end);
+
+private:
+	std::vector<xref_t> by_site;
+	std::vector<xref_t> by_target;
+	std::size_t instruction_count = 0;
+};
@@ -0,0 +1,428 @@
+// Test of the containers.h views against Vector, HashMap, List and RBMap laid out like Godot's in synthetic memory (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -I../GodotDumper containertest.cpp -o containertest
+//   (cl /std:c++20 /O2 /EHsc with the same file on Windows)
+//
+// Usage:
+//   containertest
+//
+// Every container is written field by field at Godot 4's offsets into an arena mapped at a fake address, the views
+// only reach it through the arena's memory source, which refuses anything outside it
+// Each view is checked on a filled container (iteration, order, lookup), an empty one, a null one, and a corrupted
+// one: sizes that are negative or don't fit, pointers leaving the arena, lists that loop back on themselves
+
+#include "containers.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    int failed = 0;
+
+    void check(bool passed, const char* what)
+    {
+        if (passed)
+            return;
+
+        std::printf("FAILED: %s\n", what);
+        failed++;
+    }
+
+    // The views' iterators are forward only and have no traits, std::vector's range constructor can't take them
+    template <typename View>
+    std::vector<std::int32_t> collect(const View& view)
+    {
+        std::vector<std::int32_t> out;
+        for (std::int32_t value : view)
+            out.push_back(value);
+
+        return out;
+    }
+
+    // The game's memory, far from anything the process has mapped so a view skipping translate would crash
+    class arena_t {
+    public:
+        static constexpr std::uintptr_t BASE = 0x7A0000000000;
+
+        arena_t(std::size_t capacity) : bytes(capacity, 0) {}
+
+        std::uintptr_t alloc(std::size_t size)
+        {
+            used = (used + 15) & ~std::size_t(15);
+
+            const std::uintptr_t address = BASE + used;
+            used += size;
+
+            if (used > bytes.size())
+            {
+                std::printf("arena too small\n");
+                std::exit(1);
+            }
+
+            return address;
+        }
+
+        template <typename T>
+        void write(std::uintptr_t address, T value)
+        {
+            std::memcpy(bytes.data() + (address - BASE), &value, sizeof(T));
+        }
+
+        const void* translate(std::uintptr_t address, std::size_t size) const
+        {
+            if (address < BASE || address - BASE > bytes.size() || size > bytes.size() - (address - BASE))
+                return nullptr;
+
+            return bytes.data() + (address - BASE);
+        }
+
+    private:
+        std::vector<std::uint8_t> bytes;
+        std::size_t used = 0;
+    };
+
+    // Memory source handed to the views, copied into every view and iterator
+    struct arena_source_t {
+        const arena_t* arena = nullptr;
+
+        const void* translate(std::uintptr_t address, std::size_t size) const
+        {
+            return arena->translate(address, size);
+        }
+    };
+
+    constexpr std::uintptr_t OUTSIDE = 0x10; // Never readable through the arena
+
+    /*
+     * Vector<T> { VectorWriteProxy (8 bytes); T* _ptr; }, CowData's refcount and size sit right before _ptr
+    */
+    std::uintptr_t write_vector(arena_t& arena, const std::vector<std::uint64_t>& values, std::int64_t size)
+    {
+        const std::uintptr_t header = arena.alloc(16 + values.size() * sizeof(std::uint64_t));
+        const std::uintptr_t data = header + 16;
+
+        arena.write<std::uint64_t>(header, 1); // refcount
+        arena.write<std::int64_t>(header + 8, size);
+
+        for (std::size_t i = 0; i < values.size(); i++)
+            arena.write(data + i * sizeof(std::uint64_t), values[i]);
+
+        const std::uintptr_t vector = arena.alloc(16);
+        arena.write<std::uintptr_t>(vector + 8, data);
+        return vector;
+    }
+
+    void test_vector(arena_t& arena, arena_source_t source)
+    {
+        using view_t = VectorView<std::uint64_t, arena_source_t>;
+
+        const std::vector<std::uint64_t> values = { 3, 1, 4, 1, 5, 9, 2, 6 };
+        const view_t view = view_t::from_vector(write_vector(arena, values, values.size()), source);
+
+        check(view.size() == values.size() && !view.empty(), "Vector size");
+        check(std::vector<std::uint64_t>(view.begin(), view.end()) == values, "Vector iteration");
+        check(view[5] == 9, "Vector indexing");
+
+        check(view_t::from_vector(write_vector(arena, {}, 0), source).empty(), "empty Vector");
+
+        const std::uintptr_t null_vector = arena.alloc(16);
+        check(view_t::from_vector(null_vector, source).empty() && view_t(0, source).empty(), "null Vector");
+        check(view_t::from_vector(OUTSIDE, source).empty(), "Vector at an unreadable address");
+
+        check(view_t::from_vector(write_vector(arena, values, -4), source).empty(), "Vector with a negative size");
+        check(view_t::from_vector(write_vector(arena, values, 1 << 24), source).empty(), "Vector running past readable memory");
+
+        // size * sizeof(T) wraps to 0 bytes, which any source would happily translate
+        check(view_t::from_vector(write_vector(arena, values, std::int64_t(1) << 61), source).empty(), "Vector whose byte size overflows");
+    }
+
+    /*
+     * HashMap<K, V> { Allocator (8 bytes); elements; hashes; head_element; tail_element; uint32_t capacity_index; uint32_t num_elements; }
+     * HashMapElement { next; prev; KeyValue<K, V> data; }
+    */
+    struct hash_map_t {
+        std::uintptr_t address;
+        std::vector<std::uintptr_t> elements;
+    };
+
+    hash_map_t write_hash_map(arena_t& arena, const std::vector<std::pair<std::uint32_t, float>>& pairs)
+    {
+        hash_map_t map = { arena.alloc(48), {} };
+
+        for (const auto& [key, value] : pairs)
+        {
+            const std::uintptr_t element = arena.alloc(24);
+            arena.write(element + 16, key);
+            arena.write(element + 20, value);
+
+            if (!map.elements.empty())
+            {
+                arena.write(map.elements.back(), element);
+                arena.write(element + 8, map.elements.back());
+            }
+
+            map.elements.push_back(element);
+        }
+
+        arena.write<std::uintptr_t>(map.address + 24, map.elements.empty() ? 0 : map.elements.front());
+        arena.write<std::uintptr_t>(map.address + 32, map.elements.empty() ? 0 : map.elements.back());
+        arena.write<std::uint32_t>(map.address + 40, 2);
+        arena.write<std::uint32_t>(map.address + 44, static_cast<std::uint32_t>(pairs.size()));
+        return map;
+    }
+
+    void test_hash_map(arena_t& arena, arena_source_t source)
+    {
+        using view_t = HashMapView<std::uint32_t, float, arena_source_t>;
+
+        // Insertion order, which is what the engine iterates in, not key order
+        const std::vector<std::pair<std::uint32_t, float>> pairs = { { 40, 0.5f }, { 7, 1.5f }, { 19, 2.5f }, { 3, 3.5f }, { 28, 4.5f } };
+        const hash_map_t map = write_hash_map(arena, pairs);
+        const view_t view(map.address, source);
+
+        std::vector<std::pair<std::uint32_t, float>> seen;
+        for (const KeyValue<std::uint32_t, float>& pair : view)
+            seen.emplace_back(pair.key, pair.value);
+
+        check(view.size() == pairs.size() && seen == pairs, "HashMap iteration in insertion order");
+
+        const KeyValue<std::uint32_t, float>* found = view.find_if([](const KeyValue<std::uint32_t, float>& pair) { return pair.key == 19; });
+        check(found && found->value == 2.5f, "HashMap lookup");
+        check(!view.find_if([](const KeyValue<std::uint32_t, float>& pair) { return pair.key == 8; }), "HashMap lookup of a missing key");
+
+        const view_t empty(write_hash_map(arena, {}).address, source);
+        check(empty.empty() && empty.begin() == empty.end(), "empty HashMap");
+
+        const view_t null_map(0, source), unreadable(OUTSIDE, source);
+        check(null_map.empty() && null_map.begin() == null_map.end() && unreadable.empty() && unreadable.begin() == unreadable.end(), "null HashMap");
+
+        std::size_t count = 0;
+
+        // The last element points back at the first
+        const hash_map_t cyclic = write_hash_map(arena, pairs);
+        arena.write(cyclic.elements.back(), cyclic.elements.front());
+        for (auto it = view_t(cyclic.address, source).begin(); it != view_t(cyclic.address, source).end() && count < 100; ++it)
+            count++;
+        check(count == pairs.size(), "cyclic HashMap stops after num_elements");
+
+        // The third element's next leaves readable memory
+        const hash_map_t broken = write_hash_map(arena, pairs);
+        arena.write<std::uintptr_t>(broken.elements[2], OUTSIDE);
+        count = 0;
+        for (const KeyValue<std::uint32_t, float>& pair : view_t(broken.address, source))
+            count += pair.key != 0;
+        check(count == 3, "HashMap stops at an unreadable element");
+    }
+
+    /*
+     * List<T> { _Data* _data; }, _Data { first; last; int size_cache; }
+     * Element { T value; next_ptr; prev_ptr; _Data* data; }
+    */
+    struct list_t {
+        std::uintptr_t address;
+        std::uintptr_t data;
+        std::vector<std::uintptr_t> elements;
+    };
+
+    list_t write_list(arena_t& arena, const std::vector<std::int32_t>& values)
+    {
+        list_t list = { arena.alloc(8), arena.alloc(24), {} };
+        arena.write(list.address, list.data);
+
+        for (std::int32_t value : values)
+        {
+            const std::uintptr_t element = arena.alloc(32);
+            arena.write(element, value);
+            arena.write(element + 24, list.data);
+
+            if (!list.elements.empty())
+            {
+                arena.write(list.elements.back() + 8, element);
+                arena.write(element + 16, list.elements.back());
+            }
+
+            list.elements.push_back(element);
+        }
+
+        arena.write<std::uintptr_t>(list.data, list.elements.empty() ? 0 : list.elements.front());
+        arena.write<std::uintptr_t>(list.data + 8, list.elements.empty() ? 0 : list.elements.back());
+        arena.write<std::int32_t>(list.data + 16, static_cast<std::int32_t>(values.size()));
+        return list;
+    }
+
+    void test_list(arena_t& arena, arena_source_t source)
+    {
+        using view_t = ListView<std::int32_t, arena_source_t>;
+
+        const std::vector<std::int32_t> values = { -2, 10, 33, 7 };
+        const view_t view(write_list(arena, values).address, source);
+
+        check(view.size() == values.size() && collect(view) == values, "List iteration");
+
+        const view_t empty(write_list(arena, {}).address, source);
+        check(empty.empty() && empty.begin() == empty.end(), "empty List");
+
+        // A List whose _data was never allocated
+        const std::uintptr_t no_data = arena.alloc(8);
+        const view_t null_list(0, source), null_data(no_data, source), unreadable(OUTSIDE, source);
+        check(null_list.empty() && null_data.empty() && null_data.begin() == null_data.end() && unreadable.empty(), "null List");
+
+        const list_t negative = write_list(arena, values);
+        arena.write<std::int32_t>(negative.data + 16, -1);
+        check(view_t(negative.address, source).begin() == view_t(negative.address, source).end(), "List with a negative size");
+
+        const list_t cyclic = write_list(arena, values);
+        arena.write(cyclic.elements.back() + 8, cyclic.elements.front());
+        std::size_t count = 0;
+        for (auto it = view_t(cyclic.address, source).begin(); it != view_t(cyclic.address, source).end() && count < 100; ++it)
+            count++;
+        check(count == values.size(), "cyclic List stops after size_cache");
+
+        // size_cache below the real length bounds the walk too
+        const list_t shorter = write_list(arena, values);
+        arena.write<std::int32_t>(shorter.data + 16, 2);
+        const view_t shorter_view(shorter.address, source);
+        check(collect(shorter_view) == std::vector<std::int32_t>{ -2, 10 }, "List stops after size_cache");
+    }
+
+    /*
+     * RBMap<K, V> { _Data { _root; _nil; int size_cache; } }, _root is a sentinel whose left is the real root
+     * Element { int color; right; left; parent; _next; _prev; KeyValue<K, V> _data; }
+    */
+    constexpr std::size_t RB_ELEMENT_SIZE = 56;
+
+    struct rb_map_t {
+        std::uintptr_t address;
+        std::vector<std::uintptr_t> elements; // In key order
+    };
+
+    // Keys sorted, the tree is built balanced with the middle key at the top of every range
+    rb_map_t write_rb_map(arena_t& arena, const std::vector<std::int32_t>& keys)
+    {
+        rb_map_t map = { arena.alloc(24), {} };
+
+        const std::uintptr_t root = arena.alloc(RB_ELEMENT_SIZE);
+        const std::uintptr_t nil = arena.alloc(RB_ELEMENT_SIZE);
+
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            const std::uintptr_t element = arena.alloc(RB_ELEMENT_SIZE);
+            arena.write(element + 48, keys[i]);
+            arena.write<std::int32_t>(element + 52, keys[i] * 100);
+            map.elements.push_back(element);
+        }
+
+        const auto build = [&](auto& self, std::size_t begin, std::size_t end, std::uintptr_t parent) -> std::uintptr_t
+        {
+            if (begin == end)
+                return nil;
+
+            const std::size_t middle = (begin + end) / 2;
+            const std::uintptr_t element = map.elements[middle];
+
+            arena.write<std::uintptr_t>(element + 24, parent);
+            arena.write<std::uintptr_t>(element + 16, self(self, begin, middle, element));
+            arena.write<std::uintptr_t>(element + 8, self(self, middle + 1, end, element));
+            return element;
+        };
+
+        arena.write<std::uintptr_t>(root + 16, build(build, 0, keys.size(), root));
+        arena.write<std::uintptr_t>(root + 8, nil);
+
+        // Threaded in order, the ends point at nothing
+        for (std::size_t i = 0; i < map.elements.size(); i++)
+        {
+            arena.write<std::uintptr_t>(map.elements[i] + 32, i + 1 < map.elements.size() ? map.elements[i + 1] : 0);
+            arena.write<std::uintptr_t>(map.elements[i] + 40, i > 0 ? map.elements[i - 1] : 0);
+        }
+
+        arena.write(map.address, root);
+        arena.write(map.address + 8, nil);
+        arena.write<std::int32_t>(map.address + 16, static_cast<std::int32_t>(keys.size()));
+        return map;
+    }
+
+    void test_rb_map(arena_t& arena, arena_source_t source)
+    {
+        using view_t = RBMapView<std::int32_t, std::int32_t, arena_source_t>;
+
+        std::vector<std::int32_t> keys;
+        for (std::int32_t i = 0; i < 100; i++)
+            keys.push_back(i * 3 - 50);
+
+        const rb_map_t map = write_rb_map(arena, keys);
+        const view_t view(map.address, source);
+
+        std::vector<std::int32_t> seen;
+        bool values_match = true;
+        for (const KeyValue<std::int32_t, std::int32_t>& pair : view)
+        {
+            seen.push_back(pair.key);
+            values_match &= pair.value == pair.key * 100;
+        }
+
+        check(view.size() == keys.size() && seen == keys && values_match, "RBMap iteration in key order");
+
+        bool all_found = true, none_extra = true;
+        for (std::int32_t key : keys)
+        {
+            const KeyValue<std::int32_t, std::int32_t>* found = view.find(key);
+            all_found &= found && found->key == key && found->value == key * 100;
+
+            // Keys in between, and past both ends
+            none_extra &= !view.find(key + 1) && !view.find(key - 1);
+        }
+
+        check(all_found, "RBMap find of every key");
+        check(none_extra, "RBMap find of missing keys");
+
+        const view_t empty(write_rb_map(arena, {}).address, source);
+        check(empty.empty() && empty.begin() == empty.end() && !empty.find(0), "empty RBMap");
+
+        const view_t null_map(0, source), unreadable(OUTSIDE, source);
+        check(null_map.empty() && null_map.begin() == null_map.end() && !null_map.find(0) && unreadable.begin() == unreadable.end(), "null RBMap");
+
+        // The largest element threads back to the smallest
+        const rb_map_t cyclic = write_rb_map(arena, keys);
+        arena.write(cyclic.elements.back() + 32, cyclic.elements.front());
+        std::size_t count = 0;
+        for (auto it = view_t(cyclic.address, source).begin(); it != view_t(cyclic.address, source).end() && count < 1000; ++it)
+            count++;
+        check(count == keys.size(), "cyclic RBMap stops after size_cache");
+
+        // A child pointing at its own parent, the descent gives up after size_cache steps
+        const rb_map_t looped = write_rb_map(arena, { 1, 2, 3 });
+        arena.write(looped.elements[0] + 16, looped.elements[1]);
+        const view_t looped_view(looped.address, source);
+        check(looped_view.begin() == looped_view.end() && !looped_view.find(0), "RBMap with a loop in its left spine");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 1)
+    {
+        std::fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    arena_t arena(1 << 20);
+    const arena_source_t source = { &arena };
+
+    test_vector(arena, source);
+    test_hash_map(arena, source);
+    test_list(arena, source);
+    test_rb_map(arena, source);
+
+    if (failed)
+    {
+        std::printf("%d checks failed\n", failed);
+        return 1;
+    }
+
+    std::printf("every check passed\n");
+    return 0;
+}
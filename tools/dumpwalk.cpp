@@ -0,0 +1,125 @@
+// Offline scene tree walker, runs the gd:: readers against a minidump of the game (any OS, x64)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper dumpwalk.cpp ../GodotDumper/minidump.cpp ../GodotDumper/memory.cpp ../GodotDumper/godot.cpp ../GodotDumper/hierarchy.cpp ../GodotDumper/layout.cpp ../GodotDumper/analysis.cpp ../GodotDumper/resolver.cpp ../GodotDumper/vtables.cpp ../GodotDumper/pe.cpp ../GodotDumper/x86.cpp ../GodotDumper/xref.cpp ../GodotDumper/sdk.cpp -o dumpwalk
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   dumpwalk <dump>                      modules, memory and what the SDK resolves (layout, SceneTree)
+//   dumpwalk <dump> --tree [depth]       every node below the root, 8 levels by default
+//   dumpwalk <dump> --find <pattern>...  addresses of IDA style patterns in the executable
+//
+// The dump needs the game's memory (MiniDumpWithFullMemory, or a Task Manager dump), the regions are mapped
+// at their original addresses so the process can't have anything of its own there
+
+#include "analysis.h"
+#include "godot.h"
+#include "minidump.h"
+#include "vtables.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print_tree(gd::Node* node, int depth, int max_depth)
+{
+    // Garbage pointers of a torn write would fault here instead of in the game
+    if (!mem->is_readable(node, gd::layout->node_tree + sizeof(void*)))
+    {
+        std::printf("%*s<unreadable %p>\n", depth * 2, "", static_cast<void*>(node));
+        return;
+    }
+
+    std::printf("%*s%s (%s) %p\n", depth * 2, "", node->get_name().c_str(), node->get_class_name().c_str(), static_cast<void*>(node));
+
+    LocalVector<gd::Node*>& children = node->get_children();
+    if (depth + 1 >= max_depth || !mem->is_readable(children.ptr(), children.size() * sizeof(gd::Node*)))
+        return;
+
+    for (gd::Node* child : children)
+    {
+        if (child)
+            print_tree(child, depth + 1, max_depth);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <dump> [--tree [depth]] [--find <pattern>...]\n", argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    minidump_t dump;
+    if (!dump.open(argv[1]))
+    {
+        std::fprintf(stderr, "[-] Couldn't read the minidump %s\n", argv[1]);
+        return 1;
+    }
+
+    std::fprintf(stderr, "[+] %zu modules, %zu regions, %.1f MB of memory indexed in %.3f s\n", dump.get_modules().size(), dump.get_regions().size(),
+        dump.get_memory_size() / (1024.0 * 1024.0), seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+
+    if (!dump.attach())
+    {
+        std::fprintf(stderr, "[-] The executable's image isn't in the dump or its address is taken\n");
+        return 1;
+    }
+
+    std::fprintf(stderr, "[+] %s at %p, %.1f of %.1f MB mapped in %.3f s\n", dump.get_modules().front().name.c_str(), mem->get_base_address(),
+        dump.get_mapped_size() / (1024.0 * 1024.0), dump.get_memory_size() / (1024.0 * 1024.0), seconds_since(start));
+
+    if (argc > 2 && std::strcmp(argv[2], "--find") == 0)
+    {
+        for (int i = 3; i < argc; i++)
+            std::printf("%s: %p\n", argv[i], static_cast<void*>(mem->find_pattern(argv[i])));
+
+        return 0;
+    }
+
+    if (!gd::detect_layout())
+    {
+        std::fprintf(stderr, "[-] Unknown engine version\n");
+        return 1;
+    }
+
+    std::fprintf(stderr, "[+] Godot %d.%d layout\n", gd::layout->major, gd::layout->minor);
+
+    // On the calling thread, the tree needs the names before it prints
+    start = std::chrono::steady_clock::now();
+    if (analysis->get(mem->get_base_address()))
+        vtables->scan(analysis->get_image(), analysis->get_xrefs(), gd::Object::CLASS_NAME_INDEX);
+
+    std::fprintf(stderr, "[+] %zu vtables, %zu named in %.2f s\n", vtables->get_vtable_count(), vtables->get_named_count(), seconds_since(start));
+
+    gd::SceneTree* tree = gd::SceneTree::get_singleton();
+    if (!tree || !mem->is_readable(tree, gd::layout->scene_tree_current_scene + sizeof(void*)))
+    {
+        std::fprintf(stderr, "[-] No SceneTree in the dump\n");
+        return 1;
+    }
+
+    gd::Window* root = tree->get_root();
+    gd::Node* scene = tree->get_current_scene();
+    std::printf("SceneTree %p, root %p, current scene %p", static_cast<void*>(tree), static_cast<void*>(root), static_cast<void*>(scene));
+
+    if (scene && mem->is_readable(scene, gd::layout->node_scene_file_path + sizeof(void*)))
+        std::printf(" (%s)", scene->get_scene_file_path().c_str());
+
+    std::printf("\n");
+
+    if (argc > 2 && std::strcmp(argv[2], "--tree") == 0 && root)
+        print_tree(root, 0, argc > 3 ? std::atoi(argv[3]) : 8);
+
+    return 0;
+}
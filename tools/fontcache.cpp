@@ -0,0 +1,153 @@
+// Font cache builder for the overlay, bakes the explorer's glyphs without a window or a GPU (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -I../GodotDumper -I../GodotDumper/external fontcache.cpp ../GodotDumper/font_cache.cpp ../GodotDumper/external/imgui/imgui.cpp ../GodotDumper/external/imgui/imgui_draw.cpp ../GodotDumper/external/imgui/imgui_widgets.cpp ../GodotDumper/external/imgui/imgui_tables.cpp -o fontcache
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   fontcache [path] [scale...]            bakes ASCII and the icons at every DPI scale (1 by default) into path
+//   fontcache --measure [path] [scale]     font setup and first frame, stb_truetype alone and from the cache
+//
+// path defaults to godot_dumper_fonts.bin, the overlay reads it from the game's working directory (next to the log)
+// and adds whatever it rasterizes itself, building it ahead only saves the first injection the work
+
+#include "font_cache.h"
+#include <imgui/imgui.h>
+#include <imgui/imgui_internal.h>
+#include <imgui/font_awesome_5.h>
+#include <imgui/fa_solid_900.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static ImGuiIO& create_context()
+{
+    ImGui::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = { 1920.f, 1080.f };
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+    return io;
+}
+
+// One frame of text with the toasts' icons, then the texture requests are accepted like the headless backend does
+static void first_frame(float scale)
+{
+    ImGui::GetStyle().FontScaleDpi = scale;
+    ImGui::GetIO().DeltaTime = 1.f / 60.f;
+
+    ImGui::NewFrame();
+    ImGui::Begin("Explorer");
+    ImGui::Text("Scene tree 0123456789 ()[]{}<>:;,.!?'\"+-*/=_@#$%%&|\\~^`");
+    ImGui::Text("ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnopqrstuvwxyz");
+    ImGui::Text("%s %s %s %s", ICON_FA_CHECK_CIRCLE, ICON_FA_EXCLAMATION_TRIANGLE, ICON_FA_TIMES_CIRCLE, ICON_FA_INFO_CIRCLE);
+    ImGui::End();
+    ImGui::Render();
+
+    for (ImTextureData* texture : ImGui::GetPlatformIO().Textures)
+    {
+        if (texture->Status == ImTextureStatus_WantCreate || texture->Status == ImTextureStatus_WantUpdates)
+        {
+            texture->SetTexID(static_cast<ImTextureID>(1));
+            texture->SetStatus(ImTextureStatus_OK);
+        }
+    }
+}
+
+static int build(const std::string& path, const std::vector<float>& scales)
+{
+    create_context();
+
+    const bool existed = font_cache->load(ImGui::GetIO().Fonts, path);
+    font_cache_t::add_fonts(ImGui::GetIO().Fonts);
+
+    for (float scale : scales)
+        font_cache_t::preload(ImGui::GetIO().Fonts, scale);
+
+    const bool saved = font_cache->save();
+    std::fprintf(stderr, "[%c] %zu glyphs (%llu new) %s %s\n", saved ? '+' : '-', font_cache->get_glyph_count(), static_cast<unsigned long long>(font_cache->get_misses()),
+        saved ? "written to" : "couldn't be written to", path.c_str());
+
+    if (existed)
+        std::fprintf(stderr, "[+] %llu glyphs were already cached\n", static_cast<unsigned long long>(font_cache->get_hits()));
+
+    ImGui::DestroyContext();
+    return saved ? 0 : 1;
+}
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+static int measure(const std::string& path, float scale)
+{
+    constexpr int RUNS = 25;
+    std::vector<double> before, after;
+
+    for (int i = 0; i < RUNS; i++)
+    {
+        // What create_imgui did before the cache: the default font and all of Font Awesome through stb_truetype
+        auto start = std::chrono::steady_clock::now();
+        ImGuiIO& io = create_context();
+        io.Fonts->AddFontDefault();
+
+        static const ImWchar all_icons[] = { ICON_MIN_FA, ICON_MAX_FA, 0 };
+        ImFontConfig config;
+        config.MergeMode = true;
+        config.PixelSnapH = true;
+        config.FontDataOwnedByAtlas = false;
+        io.Fonts->AddFontFromMemoryTTF(const_cast<unsigned char*>(fa_solid_900), sizeof(fa_solid_900), 10.f, &config, all_icons);
+
+        first_frame(scale);
+        before.push_back(ms_since(start));
+        ImGui::DestroyContext();
+
+        start = std::chrono::steady_clock::now();
+        create_context();
+        if (!font_cache->load(ImGui::GetIO().Fonts, path))
+        {
+            std::fprintf(stderr, "[-] Couldn't read %s, build it first\n", path.c_str());
+            ImGui::DestroyContext();
+            return 1;
+        }
+
+        font_cache_t::add_fonts(ImGui::GetIO().Fonts);
+        first_frame(scale);
+        after.push_back(ms_since(start));
+        ImGui::DestroyContext();
+    }
+
+    std::printf("scale %.2f, median of %d: stb_truetype %.3f ms, cached %.3f ms (%llu hits, %llu misses in the last run)\n", scale, RUNS, median(before), median(after),
+        static_cast<unsigned long long>(font_cache->get_hits()), static_cast<unsigned long long>(font_cache->get_misses()));
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--measure") == 0)
+        return measure(argc > 2 ? argv[2] : "godot_dumper_fonts.bin", argc > 3 ? static_cast<float>(std::atof(argv[3])) : 1.f);
+
+    std::string path = argc > 1 ? argv[1] : "godot_dumper_fonts.bin";
+
+    std::vector<float> scales;
+    for (int i = 2; i < argc; i++)
+        scales.push_back(static_cast<float>(std::atof(argv[i])));
+
+    if (scales.empty())
+        scales.push_back(1.f);
+
+    return build(path, scales);
+}
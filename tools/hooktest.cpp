@@ -0,0 +1,335 @@
+// Test of the inline hooks: instruction relocation, live hooks, and patching code another thread is running (x86-64, any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper hooktest.cpp ../GodotDumper/hook.cpp ../GodotDumper/x86.cpp -o hooktest
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   hooktest [--seconds n]
+//
+// relocate is checked on byte buffers moved 1 GB and more away: every rip relative operand and branch of the copy has to
+// reach what the original reached, and the cases it has to refuse (out of rel32 reach, a branch back into the stolen
+// bytes, a function shorter than the patch) have to return 0
+// The live hooks run on machine code written at startup (rip relative load, jcc rel8, call rel32, jrcxz) in the Windows
+// x64 convention on every OS, then a compiled function and an unaligned one are hooked and unhooked for --seconds
+// (2 by default) each while another thread keeps calling them and checks every result
+
+#include "hook.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// The machine code below takes its arguments in ecx and edx
+#ifdef _WIN32
+#define MS_ABI
+#else
+#define MS_ABI __attribute__((ms_abi))
+#endif
+
+#ifdef _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+    using unary_t = int (MS_ABI*)(int);
+    using wide_t = int (MS_ABI*)(std::int64_t);
+    using binary_t = int (MS_ABI*)(int, int);
+    using none_t = int (MS_ABI*)();
+
+    int failed = 0;
+
+    void check(bool passed, const char* what)
+    {
+        if (passed)
+            return;
+
+        std::printf("FAILED: %s\n", what);
+        failed++;
+    }
+
+    // Every rip relative operand and branch target of the relocated copy is the original's, and it ends where it should
+    void check_relocation(const char* name, const std::uint8_t* code, std::size_t available, std::uint64_t source, std::uint64_t destination)
+    {
+        std::vector<std::uint8_t> out;
+        const std::size_t taken = hook::relocate(code, available, hook::JMP_SIZE, source, destination, out);
+
+        std::vector<std::uint64_t> expected, relocated;
+
+        for (std::size_t offset = 0; offset < taken;)
+        {
+            x86::instruction_t instruction;
+            const std::size_t length = x86::decode(code + offset, available - offset, instruction);
+            if (!length)
+                break;
+
+            if (instruction.rip_relative || instruction.relative)
+                expected.push_back(instruction.target(source + offset, code + offset));
+
+            offset += length;
+        }
+
+        // The jmp back to the rest of the function
+        expected.push_back(source + taken);
+
+        for (std::size_t offset = 0; offset < out.size();)
+        {
+            x86::instruction_t instruction;
+            const std::size_t length = x86::decode(out.data() + offset, out.size() - offset, instruction);
+            if (!length)
+            {
+                relocated.clear();
+                break;
+            }
+
+            // A widened loop / jrcxz also branches over its own jmp, inside the copy
+            const std::uint64_t target = instruction.target(destination + offset, out.data() + offset);
+            if ((instruction.rip_relative || instruction.relative) && !(target > destination && target <= destination + out.size()))
+                relocated.push_back(target);
+
+            offset += length;
+        }
+
+        char what[128];
+        std::snprintf(what, sizeof(what), "relocate %s keeps its targets", name);
+        check(taken >= hook::JMP_SIZE && expected == relocated, what);
+    }
+
+    void test_relocation()
+    {
+        const std::uint8_t rip_load[] = { 0x48, 0x8B, 0x05, 0x10, 0x00, 0x00, 0x00, 0xC3 }; // mov rax, [rip + 0x10]; ret
+        check_relocation("mov rax, [rip]", rip_load, sizeof(rip_load), 0x140001000, 0x100000000);
+
+        const std::uint8_t rip_immediate[] = { 0x80, 0x3D, 0x00, 0x01, 0x00, 0x00, 0x05 }; // cmp byte [rip + 0x100], 5
+        check_relocation("cmp byte [rip], imm8", rip_immediate, sizeof(rip_immediate), 0x140001000, 0x100000000);
+
+        const std::uint8_t jcc_rel8[] = { 0x85, 0xFF, 0x74, 0x20, 0x90, 0x90, 0x90 }; // test edi, edi; jz +0x20; nops
+        check_relocation("jz rel8", jcc_rel8, sizeof(jcc_rel8), 0x140001000, 0x180000000);
+
+        const std::uint8_t jcc_rel32[] = { 0x0F, 0x84, 0x00, 0x02, 0x00, 0x00 }; // jz +0x200
+        check_relocation("jz rel32", jcc_rel32, sizeof(jcc_rel32), 0x140001000, 0x150000000);
+
+        const std::uint8_t call[] = { 0xE8, 0x00, 0x10, 0x00, 0x00, 0x90 }; // call +0x1000
+        check_relocation("call rel32", call, sizeof(call), 0x140001000, 0x110000000);
+
+        const std::uint8_t loop[] = { 0x90, 0x90, 0x90, 0xE2, 0x40, 0x90 }; // nops; loop +0x40
+        check_relocation("loop rel8", loop, sizeof(loop), 0x140001000, 0x120000000);
+
+        const std::uint8_t jrcxz[] = { 0xE3, 0x40, 0x90, 0x90, 0x90, 0x90 }; // jrcxz +0x40; nops
+        check_relocation("jrcxz", jrcxz, sizeof(jrcxz), 0x140001000, 0x120000000);
+
+        const std::uint8_t thunk[] = { 0xE9, 0x00, 0x10, 0x00, 0x00 }; // A jmp covering the whole patch
+        check_relocation("jmp thunk", thunk, sizeof(thunk), 0x140001000, 0x140100000);
+
+        std::vector<std::uint8_t> out;
+
+        check(hook::relocate(rip_load, sizeof(rip_load), hook::JMP_SIZE, 0x140001000, 0x7F0000000000, out) == 0, "relocate refuses a rip operand out of rel32 reach");
+
+        const std::uint8_t back[] = { 0x31, 0xC0, 0xFF, 0xC0, 0x39, 0xF8, 0x7C, 0xFA, 0xC3 }; // xor eax, eax; inc eax; cmp eax, edi; jl -6; ret
+        check(hook::relocate(back, sizeof(back), hook::JMP_SIZE, 0x140001000, 0x140100000, out) == 0, "relocate refuses a branch back into the stolen bytes");
+
+        const std::uint8_t short_function[] = { 0xC3, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+        check(hook::relocate(short_function, sizeof(short_function), hook::JMP_SIZE, 0x140001000, 0x140100000, out) == 0, "relocate refuses a function shorter than the patch");
+    }
+
+    // Small functions as machine code, each followed by int3 padding like the compiler leaves between functions
+    struct functions_t {
+        unary_t rip_load; // value + x, value read through [rip]
+        unary_t jcc; // x == 0 ? 2 : 1, jz rel8 in the stolen bytes
+        unary_t call; // helper() + x, call rel32 in the stolen bytes
+        wide_t jrcxz; // x == 0 ? 7 : 1
+        none_t short_function; // Only a ret, too short to patch
+        unary_t back; // Counts up to x, its loop branches back into the first 5 bytes
+        binary_t odd; // x * 3 + y, at 6 mod 16 so the patch crosses a qword and goes through the jmp-to-self
+    };
+
+    functions_t write_functions(std::uint8_t* code, std::size_t size)
+    {
+        std::memset(code, 0xCC, size);
+
+        constexpr std::size_t VALUE = 0x200; // int read by rip_load
+        std::size_t at = 0;
+
+        const auto put = [&](std::initializer_list<std::uint8_t> bytes, std::size_t offset = 0)
+        {
+            at = ((at + 15) & ~std::size_t(15)) + offset;
+            std::uint8_t* start = code + at;
+            std::memcpy(start, bytes.begin(), bytes.size());
+            at += bytes.size();
+            return start;
+        };
+
+        const auto set_rel32 = [](std::uint8_t* instruction, std::size_t offset, std::size_t length, const std::uint8_t* target)
+        {
+            const std::int32_t rel = static_cast<std::int32_t>(target - (instruction + length));
+            std::memcpy(instruction + offset, &rel, sizeof(rel));
+        };
+
+        const std::int32_t value = 5;
+        std::memcpy(code + VALUE, &value, sizeof(value));
+
+        functions_t functions{};
+
+        std::uint8_t* rip_load = put({ 0x8B, 0x05, 0, 0, 0, 0, 0x01, 0xC8, 0xC3 }); // mov eax, [rip + value]; add eax, ecx; ret
+        set_rel32(rip_load, 2, 6, code + VALUE);
+        functions.rip_load = reinterpret_cast<unary_t>(rip_load);
+
+        // test ecx, ecx; jz +6; mov eax, 1; ret; mov eax, 2; ret
+        functions.jcc = reinterpret_cast<unary_t>(put({ 0x85, 0xC9, 0x74, 0x06, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3, 0xB8, 0x02, 0x00, 0x00, 0x00, 0xC3 }));
+
+        std::uint8_t* helper = put({ 0xB8, 0x64, 0x00, 0x00, 0x00, 0xC3 }); // mov eax, 100; ret
+
+        // sub rsp, 0x28; call helper; add rsp, 0x28; add eax, ecx; ret
+        std::uint8_t* call = put({ 0x48, 0x83, 0xEC, 0x28, 0xE8, 0, 0, 0, 0, 0x48, 0x83, 0xC4, 0x28, 0x01, 0xC8, 0xC3 });
+        set_rel32(call + 4, 1, 5, helper);
+        functions.call = reinterpret_cast<unary_t>(call);
+
+        // jrcxz +6; mov eax, 1; ret; mov eax, 7; ret
+        functions.jrcxz = reinterpret_cast<wide_t>(put({ 0xE3, 0x06, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3, 0xB8, 0x07, 0x00, 0x00, 0x00, 0xC3 }));
+
+        functions.short_function = reinterpret_cast<none_t>(put({ 0xC3 }));
+
+        // xor eax, eax; inc eax; cmp eax, ecx; jl -6; ret
+        functions.back = reinterpret_cast<unary_t>(put({ 0x31, 0xC0, 0xFF, 0xC0, 0x39, 0xC8, 0x7C, 0xFA, 0xC3 }));
+
+        // lea eax, [rcx + rcx * 2]; add eax, edx; ret
+        functions.odd = reinterpret_cast<binary_t>(put({ 0x8D, 0x04, 0x49, 0x01, 0xD0, 0xC3 }, 6));
+
+        return functions;
+    }
+
+    inline_hook_t rip_load_hook, jcc_hook, call_hook, jrcxz_hook, odd_hook, add_hook;
+
+    int MS_ABI rip_load_detour(int x) { return rip_load_hook.get_original<unary_t>()(x) * 10; }
+    int MS_ABI jcc_detour(int x) { return jcc_hook.get_original<unary_t>()(x) * 10; }
+    int MS_ABI call_detour(int x) { return call_hook.get_original<unary_t>()(x) * 10; }
+    int MS_ABI jrcxz_detour(std::int64_t x) { return jrcxz_hook.get_original<wide_t>()(x) * 10; }
+    int MS_ABI odd_detour(int x, int y) { return odd_hook.get_original<binary_t>()(x, y) + 1000; }
+    int MS_ABI no_detour() { return 0; }
+
+    void test_hooks(const functions_t& functions)
+    {
+        check(rip_load_hook.install(reinterpret_cast<void*>(functions.rip_load), reinterpret_cast<void*>(&rip_load_detour)), "hook a rip relative load");
+        check(functions.rip_load(1) == 60, "rip relative load through the trampoline");
+
+        check(jcc_hook.install(reinterpret_cast<void*>(functions.jcc), reinterpret_cast<void*>(&jcc_detour)), "hook a jcc rel8");
+        check(functions.jcc(0) == 20 && functions.jcc(3) == 10, "jcc rel8 through the trampoline, both ways");
+
+        check(call_hook.install(reinterpret_cast<void*>(functions.call), reinterpret_cast<void*>(&call_detour)), "hook a call rel32");
+        check(functions.call(1) == 1010, "call rel32 through the trampoline");
+
+        check(jrcxz_hook.install(reinterpret_cast<void*>(functions.jrcxz), reinterpret_cast<void*>(&jrcxz_detour)), "hook a jrcxz");
+        check(functions.jrcxz(0) == 70 && functions.jrcxz(5) == 10, "jrcxz through the trampoline, both ways");
+
+        inline_hook_t short_hook, back_hook;
+        check(!short_hook.install(reinterpret_cast<void*>(functions.short_function), reinterpret_cast<void*>(&no_detour)), "refuse a function shorter than the patch");
+        check(!back_hook.install(reinterpret_cast<void*>(functions.back), reinterpret_cast<void*>(&no_detour)), "refuse a loop back into the stolen bytes");
+        check(functions.back(3) == 3, "a refused hook leaves the function untouched");
+
+        check(rip_load_hook.remove() && jcc_hook.remove() && call_hook.remove() && jrcxz_hook.remove(), "remove every hook");
+        check(functions.rip_load(1) == 6 && functions.jcc(0) == 2 && functions.call(1) == 101 && functions.jrcxz(0) == 7, "original code once removed");
+    }
+
+    // Hooks and unhooks target for seconds while another thread calls it, every call must return one of the two results
+    template <typename F>
+    void test_concurrent(const char* name, inline_hook_t& hook, void* target, void* detour, F&& call, int plain, int hooked, double seconds)
+    {
+        std::atomic<bool> stop = false;
+        std::atomic<std::uint64_t> calls = 0, wrong = 0;
+
+        std::thread caller([&]()
+        {
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                const int result = call();
+                if (result != plain && result != hooked)
+                    wrong++;
+
+                calls++;
+            }
+        });
+
+        const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+        std::uint64_t cycles = 0;
+        bool patched = true;
+
+        while (std::chrono::steady_clock::now() < until && patched)
+        {
+            patched = hook.install(target, detour) && hook.remove();
+            cycles++;
+        }
+
+        stop = true;
+        caller.join();
+
+        std::printf("%-12s %8llu install/remove cycles, %10llu calls, %llu wrong\n", name, static_cast<unsigned long long>(cycles),
+            static_cast<unsigned long long>(calls.load()), static_cast<unsigned long long>(wrong.load()));
+
+        char what[128];
+        std::snprintf(what, sizeof(what), "%s patched while another thread calls it", name);
+        check(patched && wrong == 0 && calls > 0, what);
+    }
+}
+
+extern "C" NOINLINE int add(int a, int b)
+{
+    return a * 3 + b;
+}
+
+namespace
+{
+    int (*volatile add_function)(int, int) = &add; // Keeps the calls real
+
+    int add_detour(int a, int b)
+    {
+        return add_hook.get_original<int (*)(int, int)>()(a, b) + 1000;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 2.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = std::atof(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--seconds n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    test_relocation();
+
+    constexpr std::size_t CODE_SIZE = 0x1000;
+    std::uint8_t* code = hook::allocate_near(reinterpret_cast<const void*>(&add), CODE_SIZE);
+    if (!code)
+    {
+        std::printf("no executable memory\n");
+        return 1;
+    }
+
+    const functions_t functions = write_functions(code, CODE_SIZE);
+    test_hooks(functions);
+
+    check(add_function(2, 1) == 7, "compiled function before the hook");
+    test_concurrent("compiled", add_hook, reinterpret_cast<void*>(&add), reinterpret_cast<void*>(&add_detour), []() { return add_function(2, 1); }, 7, 1007, seconds);
+    test_concurrent("unaligned", odd_hook, reinterpret_cast<void*>(functions.odd), reinterpret_cast<void*>(&odd_detour), [&]() { return functions.odd(2, 1); }, 7, 1007, seconds);
+
+    if (failed)
+    {
+        std::printf("%d checks failed\n", failed);
+        return 1;
+    }
+
+    std::printf("every check passed\n");
+    return 0;
+}
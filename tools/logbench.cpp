@@ -0,0 +1,163 @@
+// Hot path cost of the asynchronous logger, against the synchronous console write it replaced (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper logbench.cpp ../GodotDumper/logger.cpp -o logbench
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   logbench [--calls n] [--runs n] [--limit ns] [--file path]
+//
+// Calls are timed in bursts of half a ring, the next burst waits for the writer thread to drain the ring so a
+// call never takes the dropped path, the formatting and the file writes happen outside the timed part
+// The synchronous baseline formats the same line and flushes it to the same file, like std::cout << std::endl did
+// Fails if a logger call takes more than --limit (50 ns by default) per call, or if a record was dropped
+
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    constexpr std::size_t BURST = decltype(logger_t::thread_buffer_t::ring)::capacity / 2;
+
+    double now_ns()
+    {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // ns per call of the best run, each run makes calls log calls in bursts
+    template <typename F>
+    double time_logger(std::size_t calls, int runs, F&& call)
+    {
+        logger_t::thread_buffer_t& buffer = logger->get_thread_buffer();
+        double best = 1e18;
+
+        for (int run = 0; run < runs; run++)
+        {
+            double elapsed = 0.0;
+
+            for (std::size_t done = 0; done < calls; done += BURST)
+            {
+                while (buffer.ring.size() != 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+                const std::size_t count = std::min(BURST, calls - done);
+                const double start = now_ns();
+
+                for (std::size_t i = 0; i < count; i++)
+                    call(i);
+
+                elapsed += now_ns() - start;
+            }
+
+            best = std::min(best, elapsed / static_cast<double>(calls));
+        }
+
+        return best;
+    }
+
+    template <typename F>
+    double time_sync(std::size_t calls, int runs, F&& call)
+    {
+        double best = 1e18;
+
+        for (int run = 0; run < runs; run++)
+        {
+            const double start = now_ns();
+            for (std::size_t i = 0; i < calls; i++)
+                call(i);
+
+            best = std::min(best, (now_ns() - start) / static_cast<double>(calls));
+        }
+
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t calls = 100000;
+    int runs = 5;
+    double limit = 50.0;
+    std::string path = "logbench.log";
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--calls") && i + 1 < argc)
+            calls = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--limit") && i + 1 < argc)
+            limit = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--file") && i + 1 < argc)
+            path = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--calls n] [--runs n] [--limit ns] [--file path]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::remove(path.c_str());
+    if (!logger->start(path, nullptr))
+    {
+        std::fprintf(stderr, "couldn't open %s\n", path.c_str());
+        return 1;
+    }
+
+    const std::string scene = "res://levels/forest_01.tscn";
+    const void* node = &scene;
+
+    struct result_t {
+        const char* name;
+        double ns;
+    };
+
+    const result_t results[] = {
+        { "no arguments", time_logger(calls, runs, [](std::size_t) { LOG_INFO("Frame hook installed"); }) },
+        { "int, hex pointer", time_logger(calls, runs, [&](std::size_t i) { LOG_INFO("Node {} at {:x}", i, node); }) },
+        { "3 args, string", time_logger(calls, runs, [&](std::size_t i) { LOG_WARNING("Scene {} has {} nodes, {} ms", scene, i, 1.5); }) },
+    };
+
+    logger->stop();
+
+    const std::uint64_t dropped = logger->get_thread_buffer().dropped.load();
+
+    // What dllmain did before: format on the calling thread and flush every line
+    std::FILE* file = std::fopen(path.c_str(), "a");
+    const double sync = file ? time_sync(std::min<std::size_t>(calls, 20000), 1, [&](std::size_t i)
+    {
+        char line[256];
+        int length = std::snprintf(line, sizeof(line), "[!] Scene %s has %zu nodes, %g ms\n", scene.c_str(), i, 1.5);
+        std::fwrite(line, 1, length, file);
+        std::fflush(file);
+    }) : 0.0;
+
+    if (file)
+        std::fclose(file);
+
+    std::remove(path.c_str());
+
+    bool within = true;
+    for (const result_t& result : results)
+    {
+        std::printf("LOG_INFO, %-17s %7.1f ns\n", result.name, result.ns);
+        within &= result.ns <= limit;
+    }
+
+    std::printf("snprintf + fflush         %7.1f ns\n", sync);
+    std::printf("%llu records dropped\n", static_cast<unsigned long long>(dropped));
+
+    if (!within || dropped)
+    {
+        std::printf("over the %.0f ns limit or dropping records\n", limit);
+        return 1;
+    }
+
+    std::printf("every call under %.0f ns\n", limit);
+    return 0;
+}
@@ -0,0 +1,464 @@
+// Reference test and microbenchmark for the batch math (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -march=native -ffp-contract=off -I../GodotDumper mathtest.cpp ../GodotDumper/math_batch.cpp ../GodotDumper/sdk.cpp ../GodotDumper/hierarchy.cpp -o mathtest
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows, add -DSDK_MATH_SCALAR / /DSDK_MATH_SCALAR for the scalar build)
+//
+// Usage:
+//   mathtest [--count n] [--runs n] [--no-bench]
+//
+// Every batch kernel, the Vector3A / Transform3DA register types and TransformHierarchy are compared bit for bit
+// against the scalar sdk.h math, and the scalar math against Godot's formulas copied from core/math
+// Then the batch kernels are timed against a loop of their scalar counterparts
+// -march=native is there on purpose: with fma available a contracted build fails the comparison
+
+#include "compiler.h"
+SDK_FP_CONTRACT_OFF
+#include "hierarchy.h"
+#include "math_batch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Godot 4's own formulas (vector3.h, basis.cpp, transform_3d.h), written out against the sdk.h types
+    namespace godot
+    {
+        Vector3 normalized(Vector3 v)
+        {
+            const float lengthsq = v.x * v.x + v.y * v.y + v.z * v.z;
+            if (lengthsq == 0)
+                return Vector3(0.f, 0.f, 0.f);
+
+            const float length = std::sqrt(lengthsq);
+            return Vector3(v.x / length, v.y / length, v.z / length);
+        }
+
+        float dot(const Vector3& a, const Vector3& b)
+        {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        Vector3 cross(const Vector3& a, const Vector3& b)
+        {
+            return Vector3((a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x));
+        }
+
+        Vector3 xform(const Transform3D& t, const Vector3& v)
+        {
+            return Vector3(dot(t.basis.rows[0], v) + t.origin.x, dot(t.basis.rows[1], v) + t.origin.y, dot(t.basis.rows[2], v) + t.origin.z);
+        }
+
+        Vector3 xform_inv(const Transform3D& t, const Vector3& p)
+        {
+            const Vector3 v = p - t.origin;
+            const Basis& b = t.basis;
+
+            return Vector3(
+                (b.rows[0][0] * v.x) + (b.rows[1][0] * v.y) + (b.rows[2][0] * v.z),
+                (b.rows[0][1] * v.x) + (b.rows[1][1] * v.y) + (b.rows[2][1] * v.z),
+                (b.rows[0][2] * v.x) + (b.rows[1][2] * v.y) + (b.rows[2][2] * v.z));
+        }
+
+        Basis orthonormalized(Basis b)
+        {
+            Vector3 x = b.get_column(0);
+            Vector3 y = b.get_column(1);
+            Vector3 z = b.get_column(2);
+
+            x = normalized(x);
+            y = normalized(y - x * dot(x, y));
+            z = normalized(z - x * dot(x, z) - y * dot(y, z));
+
+            b.set_column(0, x);
+            b.set_column(1, y);
+            b.set_column(2, z);
+            return b;
+        }
+
+        Basis looking_at(const Vector3& target, const Vector3& up, bool use_model_front)
+        {
+            Vector3 v_z = normalized(target);
+            if (!use_model_front)
+                v_z = -v_z;
+
+            const Vector3 v_x = normalized(cross(up, v_z));
+            const Vector3 v_y = cross(v_z, v_x);
+
+            Basis b;
+            b.set_column(0, v_x);
+            b.set_column(1, v_y);
+            b.set_column(2, v_z);
+            return b;
+        }
+
+        Transform3D multiply(const Transform3D& a, const Transform3D& b)
+        {
+            Transform3D r;
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                    r.basis.rows[i][j] = a.basis.rows[i][0] * b.basis.rows[0][j] + a.basis.rows[i][1] * b.basis.rows[1][j] + a.basis.rows[i][2] * b.basis.rows[2][j];
+            }
+
+            r.origin = xform(a, b.origin);
+            return r;
+        }
+    }
+
+    std::mt19937 random(1234);
+
+    float random_float(float range)
+    {
+        return std::uniform_real_distribution<float>(-range, range)(random);
+    }
+
+    // Mostly ordinary values, with zero vectors, tiny and huge components mixed in so the edge cases get compared too
+    Vector3 random_vector()
+    {
+        switch (random() % 16)
+        {
+        case 0:
+            return Vector3(0.f, 0.f, 0.f);
+        case 1:
+            return Vector3(random_float(1e-20f), random_float(1e-20f), random_float(1e-20f));
+        case 2:
+            return Vector3(random_float(1e15f), random_float(1e15f), random_float(1e15f));
+        default:
+            return Vector3(random_float(100.f), random_float(100.f), random_float(100.f));
+        }
+    }
+
+    Transform3D random_transform()
+    {
+        Transform3D t;
+        for (Vector3& row : t.basis.rows)
+            row = Vector3(random_float(2.f), random_float(2.f), random_float(2.f));
+
+        t.origin = Vector3(random_float(1000.f), random_float(1000.f), random_float(1000.f));
+        return t;
+    }
+
+    std::size_t total_differ = 0;
+
+    struct check_t {
+        const char* name;
+        std::size_t compared = 0;
+        std::size_t differ = 0;
+
+        template <typename T>
+        void compare(const T& a, const T& b)
+        {
+            compared++;
+            if (std::memcmp(&a, &b, sizeof(T)) != 0)
+                differ++;
+        }
+
+        void report()
+        {
+            std::printf("  %-36s %8zu compared, %zu differ\n", name, compared, differ);
+            total_differ += differ;
+        }
+    };
+
+    void test_scalar_against_godot(std::size_t count)
+    {
+        std::printf("sdk.h against Godot's formulas\n");
+
+        check_t vectors = { "Vector3 dot / cross / normalized" };
+        check_t transforms = { "Transform3D xform / xform_inv / *" };
+        check_t bases = { "Basis orthonormalize / looking_at" };
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const Vector3 a = random_vector(), b = random_vector();
+            const Transform3D t = random_transform(), u = random_transform();
+
+            vectors.compare(a.dot(b), godot::dot(a, b));
+            vectors.compare(a.cross(b), godot::cross(a, b));
+            vectors.compare(a.normalized(), godot::normalized(a));
+
+            transforms.compare(t.xform(a), godot::xform(t, a));
+            transforms.compare(t.xform_inv(a), godot::xform_inv(t, a));
+            transforms.compare(t * u, godot::multiply(t, u));
+
+            bases.compare(t.basis.orthonormalized(), godot::orthonormalized(t.basis));
+
+            Basis look;
+            bases.compare(look.looking_at(a, b, i & 1), godot::looking_at(a, b, i & 1));
+        }
+
+        vectors.report();
+        transforms.report();
+        bases.report();
+    }
+
+    void test_batch(std::size_t count)
+    {
+        std::printf("batch kernels against sdk.h\n");
+
+        // Not a multiple of 4 so the scalar tail runs too
+        const std::size_t n = count | 3;
+
+        std::vector<Vector3> in(n), out(n), targets(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            in[i] = random_vector();
+            targets[i] = random_vector();
+        }
+
+        const Transform3D t = random_transform();
+
+        {
+            check_t check = { "batch::xform" };
+            batch::xform(t, in.data(), out.data(), n);
+            for (std::size_t i = 0; i < n; i++)
+                check.compare(out[i], t.xform(in[i]));
+            check.report();
+        }
+
+        {
+            check_t check = { "batch::xform_inv" };
+            batch::xform_inv(t, in.data(), out.data(), n);
+            for (std::size_t i = 0; i < n; i++)
+                check.compare(out[i], t.xform_inv(in[i]));
+            check.report();
+        }
+
+        {
+            check_t check = { "batch::orthonormalize" };
+            std::vector<Basis> bases(n);
+            for (Basis& basis : bases)
+                basis = random_transform().basis;
+
+            std::vector<Basis> expected = bases;
+            for (Basis& basis : expected)
+                basis.orthonormalize();
+
+            batch::orthonormalize(bases.data(), n);
+            for (std::size_t i = 0; i < n; i++)
+                check.compare(bases[i], expected[i]);
+            check.report();
+        }
+
+        for (bool front : { false, true })
+        {
+            check_t check = { front ? "batch::look_at, model front" : "batch::look_at" };
+            const Vector3 up = random_vector();
+
+            std::vector<Transform3D> looks(n);
+            batch::look_at(in.data(), targets.data(), looks.data(), n, up, front);
+
+            for (std::size_t i = 0; i < n; i++)
+            {
+                Transform3D expected;
+                expected.set_look_at(in[i], targets[i], up, front);
+                check.compare(looks[i], expected);
+            }
+            check.report();
+        }
+    }
+
+    void test_register_types(std::size_t count)
+    {
+        std::printf("Vector3A / Transform3DA against sdk.h\n");
+
+        check_t vectors = { "Vector3A + - * dot cross" };
+        check_t transforms = { "Transform3DA xform / xform_inv / *" };
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const Vector3 a = random_vector(), b = random_vector();
+            const float s = random_float(10.f);
+            const Vector3A va(a), vb(b);
+
+            vectors.compare((va + vb).get(), a + b);
+            vectors.compare((va - vb).get(), a - b);
+            vectors.compare((va * s).get(), a * s);
+            vectors.compare(va.dot(vb), a.dot(b));
+            vectors.compare(va.cross(vb).get(), a.cross(b));
+
+            const Transform3D t = random_transform(), u = random_transform();
+            const Transform3DA ta(t), ua(u);
+
+            transforms.compare(ta.xform(va).get(), t.xform(a));
+            transforms.compare(ta.xform_inv(va).get(), t.xform_inv(a));
+            transforms.compare((ta * ua).get(), t * u);
+        }
+
+        vectors.report();
+        transforms.report();
+    }
+
+    void test_hierarchy(std::size_t count)
+    {
+        std::printf("TransformHierarchy against a scalar walk\n");
+
+        std::vector<std::int32_t> parents(count);
+        std::vector<Transform3D> locals(count), globals(count);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            parents[i] = i == 0 || random() % 8 == 0 ? -1 : static_cast<std::int32_t>(random() % i);
+            locals[i] = random_transform();
+        }
+
+        TransformHierarchy hierarchy;
+        hierarchy.build(parents);
+        for (std::size_t i = 0; i < count; i++)
+            hierarchy.set_local(i, locals[i]);
+
+        // Edits one node after the first update, only its subtree is recomputed the second time
+        for (int pass = 0; pass < 2; pass++)
+        {
+            check_t check = { pass == 0 ? "TransformHierarchy::update" : "TransformHierarchy::update, one edit" };
+
+            if (pass == 1)
+            {
+                const std::size_t edited = random() % count;
+                locals[edited] = random_transform();
+                hierarchy.set_local(edited, locals[edited]);
+            }
+
+            hierarchy.update();
+
+            for (std::size_t i = 0; i < count; i++)
+            {
+                globals[i] = parents[i] < 0 ? locals[i] : globals[parents[i]] * locals[i];
+                check.compare(hierarchy.get_global(i), globals[i]);
+            }
+            check.report();
+        }
+    }
+
+    template <typename F>
+    double best_of(int runs, F&& run)
+    {
+        double best = 1e9;
+        for (int i = 0; i < runs; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        return best;
+    }
+
+    // Keeps the scalar loops from being optimized out
+    volatile float sink;
+
+    void bench(std::size_t count, int runs)
+    {
+        std::printf("\nbenchmark, %zu elements, best of %d\n", count, runs);
+
+        std::vector<Vector3> in(count), out(count), targets(count);
+        std::vector<Basis> bases(count), work(count);
+        std::vector<Transform3D> looks(count);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            in[i] = Vector3(random_float(100.f), random_float(100.f), random_float(100.f));
+            targets[i] = Vector3(random_float(100.f), random_float(100.f), random_float(100.f));
+            bases[i] = random_transform().basis;
+        }
+
+        const Transform3D t = random_transform();
+
+        const auto row = [](const char* name, double scalar, double batched)
+        {
+            std::printf("  %-16s scalar %8.3f ms  batch %8.3f ms  x%.2f\n", name, scalar, batched, scalar / batched);
+        };
+
+        row("xform",
+            best_of(runs, [&]() { for (std::size_t i = 0; i < count; i++) out[i] = t.xform(in[i]); sink = out[count / 2].x; }),
+            best_of(runs, [&]() { batch::xform(t, in.data(), out.data(), count); sink = out[count / 2].x; }));
+
+        row("xform_inv",
+            best_of(runs, [&]() { for (std::size_t i = 0; i < count; i++) out[i] = t.xform_inv(in[i]); sink = out[count / 2].x; }),
+            best_of(runs, [&]() { batch::xform_inv(t, in.data(), out.data(), count); sink = out[count / 2].x; }));
+
+        row("orthonormalize",
+            best_of(runs, [&]() { work = bases; for (Basis& basis : work) basis.orthonormalize(); sink = work[count / 2].rows[0].x; }),
+            best_of(runs, [&]() { work = bases; batch::orthonormalize(work.data(), count); sink = work[count / 2].rows[0].x; }));
+
+        row("look_at",
+            best_of(runs, [&]() { for (std::size_t i = 0; i < count; i++) looks[i].set_look_at(in[i], targets[i]); sink = looks[count / 2].basis.rows[0].x; }),
+            best_of(runs, [&]() { batch::look_at(in.data(), targets.data(), looks.data(), count); sink = looks[count / 2].basis.rows[0].x; }));
+
+        // A chain of products, the scalar and register types one parent at a time
+        const std::size_t chain = std::min<std::size_t>(count, 64);
+        std::vector<Transform3D> links(chain);
+        for (Transform3D& link : links)
+            link = random_transform();
+
+        const std::size_t repeats = std::max<std::size_t>(1, count / chain);
+        row("Transform3D *",
+            best_of(runs, [&]()
+            {
+                for (std::size_t r = 0; r < repeats; r++)
+                {
+                    Transform3D global = links[0];
+                    for (std::size_t i = 1; i < chain; i++)
+                        global = links[i] * global;
+                    sink = global.origin.x;
+                }
+            }),
+            best_of(runs, [&]()
+            {
+                for (std::size_t r = 0; r < repeats; r++)
+                {
+                    Transform3DA global(links[0]);
+                    for (std::size_t i = 1; i < chain; i++)
+                        global = Transform3DA(links[i]) * global;
+                    sink = global.get().origin.x;
+                }
+            }));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t count = 100000;
+    int runs = 5;
+    bool benchmark = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--count") && i + 1 < argc)
+            count = std::max<std::size_t>(4, std::strtoull(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--no-bench"))
+            benchmark = false;
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--count n] [--runs n] [--no-bench]\n", argv[0]);
+            return 1;
+        }
+    }
+
+#ifdef SDK_MATH_SCALAR
+    std::printf("scalar build (SDK_MATH_SCALAR)\n");
+#else
+    std::printf("SSE build\n");
+#endif
+
+    test_scalar_against_godot(count);
+    test_batch(count);
+    test_register_types(count);
+    test_hierarchy(std::min<std::size_t>(count, 10000));
+
+    std::printf(total_differ == 0 ? "every result is bit-identical\n" : "MISMATCH\n");
+
+    if (benchmark)
+        bench(count * 10, runs);
+
+    return total_differ == 0 ? 0 : 1;
+}
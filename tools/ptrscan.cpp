@@ -0,0 +1,161 @@
+// Offline pointer path scanner, runs against memory snapshots (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper ptrscan.cpp ../GodotDumper/snapshot.cpp ../GodotDumper/pointerscan.cpp ../GodotDumper/work_pool.cpp -o ptrscan
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   ptrscan capture <pid> <snapshot>                       copies the writable memory of a running process
+//   ptrscan scan <snapshot> <target> <paths> [options]     paths from static addresses to target
+//       --level <n>      dereferences, 5 by default
+//       --offset <n>     largest offset after a dereference (hex), 1000 by default
+//       --max <n>        stops after n paths, 1000000 by default
+//       --all-modules    chains may start in any module, not only the executable
+//       --threads <n>    worker threads, one per hardware thread by default (rescan takes it too)
+//   ptrscan rescan <snapshot> <target> <paths>             keeps the paths that still lead to target, in place
+//   ptrscan list <paths> [count]                           prints the first count paths (20 by default)
+//
+// Targets are hex addresses, snapshots written by the in-game scan (Windows) can be read here as well
+
+#include "pointerscan.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool load_snapshot(memory_snapshot_t& snapshot, const char* path)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (!snapshot.load(path))
+    {
+        std::fprintf(stderr, "[-] Couldn't read the snapshot %s\n", path);
+        return false;
+    }
+
+    std::fprintf(stderr, "[+] %zu regions, %.1f MB, %zu modules loaded in %.2f s\n", snapshot.get_regions().size(), snapshot.get_size() / (1024.0 * 1024.0), snapshot.get_modules().size(), seconds_since(start));
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: %s capture <pid> <snapshot> | scan <snapshot> <target> <paths> [--level n] [--offset n] [--max n] [--all-modules] [--threads n] | rescan <snapshot> <target> <paths> [--threads n] | list <paths> [count]\n", argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (std::strcmp(argv[1], "capture") == 0 && argc >= 4)
+    {
+        memory_snapshot_t snapshot;
+        if (!snapshot.capture(static_cast<std::uint32_t>(std::strtoul(argv[2], nullptr, 10))) || !snapshot.save(argv[3]))
+        {
+            std::fprintf(stderr, "[-] Couldn't capture process %s\n", argv[2]);
+            return 1;
+        }
+
+        std::fprintf(stderr, "[+] %zu regions, %.1f MB captured in %.2f s\n", snapshot.get_regions().size(), snapshot.get_size() / (1024.0 * 1024.0), seconds_since(start));
+        return 0;
+    }
+
+    if (std::strcmp(argv[1], "list") == 0)
+    {
+        pointer_path_set_t paths;
+        if (!paths.load(argv[2]))
+        {
+            std::fprintf(stderr, "[-] Couldn't read %s\n", argv[2]);
+            return 1;
+        }
+
+        std::size_t count = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 20;
+
+        std::fprintf(stderr, "[+] %zu paths, %zu bytes\n", paths.size(), paths.get_compressed_size());
+        paths.for_each([&](const pointer_path_t& path)
+        {
+            if (count && count--)
+                std::printf("%s\n", paths.to_string(path).c_str());
+        });
+
+        return 0;
+    }
+
+    if (argc < 5)
+    {
+        std::fprintf(stderr, "[-] %s needs <snapshot> <target> <paths>\n", argv[1]);
+        return 1;
+    }
+
+    memory_snapshot_t snapshot;
+    if (!load_snapshot(snapshot, argv[2]))
+        return 1;
+
+    const std::uint64_t target = std::strtoull(argv[3], nullptr, 16);
+
+    std::size_t threads = 0;
+    for (int i = 5; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0)
+            threads = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+
+    work_pool_t pool(threads);
+
+    if (std::strcmp(argv[1], "rescan") == 0)
+    {
+        pointer_path_set_t paths;
+        if (!paths.load(argv[4]))
+        {
+            std::fprintf(stderr, "[-] Couldn't read %s\n", argv[4]);
+            return 1;
+        }
+
+        start = std::chrono::steady_clock::now();
+
+        const std::size_t before = paths.size();
+        paths.rescan(snapshot, target, pool);
+
+        std::fprintf(stderr, "[+] %zu of %zu paths still lead to %llX (%.3f s)\n", paths.size(), before, static_cast<unsigned long long>(target), seconds_since(start));
+        return paths.save(argv[4]) ? 0 : 1;
+    }
+
+    if (std::strcmp(argv[1], "scan") != 0)
+    {
+        std::fprintf(stderr, "[-] Unknown command %s\n", argv[1]);
+        return 1;
+    }
+
+    pointer_scanner_t::options_t options;
+    for (int i = 5; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+            options.max_level = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--offset") == 0 && i + 1 < argc)
+            options.max_offset = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 16));
+        else if (std::strcmp(argv[i], "--max") == 0 && i + 1 < argc)
+            options.max_results = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--all-modules") == 0)
+            options.all_modules = true;
+    }
+
+    start = std::chrono::steady_clock::now();
+
+    pointer_map_t map;
+    map.build(snapshot, pool);
+
+    std::fprintf(stderr, "[+] %zu pointers mapped on %zu threads in %.2f s\n", map.size(), pool.get_worker_count(), seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+
+    pointer_path_set_t paths;
+    pointer_scanner_t::scan(snapshot, map, target, options, pool, paths);
+
+    std::fprintf(stderr, "[+] %zu paths (%zu bytes compressed) in %.2f s\n", paths.size(), paths.get_compressed_size(), seconds_since(start));
+    return paths.save(argv[4]) ? 0 : 1;
+}
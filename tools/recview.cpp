@@ -0,0 +1,320 @@
+// Reader for the overlay's motion recordings (.gdrec), and a write/read round trip test of the format (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper recview.cpp ../GodotDumper/recorder.cpp ../GodotDumper/memory.cpp ../GodotDumper/godot.cpp ../GodotDumper/hierarchy.cpp ../GodotDumper/layout.cpp ../GodotDumper/analysis.cpp ../GodotDumper/resolver.cpp ../GodotDumper/vtables.cpp ../GodotDumper/pe.cpp ../GodotDumper/x86.cpp ../GodotDumper/xref.cpp ../GodotDumper/sdk.cpp -o recview
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   recview <file>                   frames, duration, nodes and the size per frame
+//   recview <file> --frame n         every node present in frame n
+//   recview <file> --track <name>    position of every node with that name, frame by frame
+//   recview --test [frames] [nodes]  records a synthetic scene with recorder_t and checks every frame read back
+//
+// --test moves a few nodes every frame, spawns and frees others (also in the middle of a chunk) and keeps a copy of
+// what it recorded, then reads the file in order and in random order and compares every value bit for bit
+
+#include "recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <set>
+
+namespace
+{
+    // The translation of a node's state, the origin of a Transform3D or a Node2D position
+    void print_position(const recording_t::node_state_t& state)
+    {
+        if (state.dims == recording::DIMS_3D)
+            std::printf("%10.3f %10.3f %10.3f", state.values[9], state.values[10], state.values[11]);
+        else
+            std::printf("%10.3f %10.3f", state.values[0], state.values[1]);
+    }
+
+    const char* name_of(const recording_t& recording, std::uint64_t key)
+    {
+        const std::string* name = recording.get_name(key);
+        return name ? name->c_str() : "?";
+    }
+
+    int summary(recording_t& recording, const char* path)
+    {
+        std::vector<recording_t::node_state_t> states;
+        std::set<std::uint64_t> keys;
+        std::size_t states_total = 0, states_3d = 0;
+        double first = 0.0, last = 0.0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::uint32_t frame = 0; frame < recording.get_frame_count(); frame++)
+        {
+            double time = 0.0;
+            if (!recording.read_frame(frame, states, &time))
+            {
+                std::printf("frame %u is unreadable\n", frame);
+                return 1;
+            }
+
+            if (frame == 0)
+                first = time;
+            last = time;
+
+            for (const recording_t::node_state_t& state : states)
+            {
+                keys.insert(state.key);
+                states_3d += state.dims == recording::DIMS_3D;
+            }
+
+            states_total += states.size();
+        }
+
+        const double decode = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::FILE* file = std::fopen(path, "rb");
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fclose(file);
+
+        const std::uint32_t frames = recording.get_frame_count();
+        std::size_t named = 0;
+        for (std::uint64_t key : keys)
+            named += recording.get_name(key) != nullptr;
+
+        std::printf("%u frames, %.2f s\n", frames, last - first);
+        std::printf("%zu nodes (%zu named), %.1f per frame, %.1f%% of them Node3D\n", keys.size(), named,
+            frames ? static_cast<double>(states_total) / frames : 0.0, states_total ? 100.0 * states_3d / states_total : 0.0);
+        std::printf("%ld bytes, %.1f per frame, %.2f per node and frame\n", size,
+            frames ? static_cast<double>(size) / frames : 0.0, states_total ? static_cast<double>(size) / states_total : 0.0);
+        std::printf("decoded every frame in %.2f ms\n", decode);
+        return 0;
+    }
+
+    int print_frame(recording_t& recording, std::uint32_t frame)
+    {
+        std::vector<recording_t::node_state_t> states;
+        double time = 0.0;
+
+        if (!recording.read_frame(frame, states, &time))
+        {
+            std::printf("no frame %u (%u frames)\n", frame, recording.get_frame_count());
+            return 1;
+        }
+
+        std::printf("frame %u, %.3f s, %zu nodes\n", frame, time, states.size());
+        for (const recording_t::node_state_t& state : states)
+        {
+            std::printf("%016" PRIx64 " %-24s ", state.key, name_of(recording, state.key));
+            print_position(state);
+            std::printf("\n");
+        }
+
+        return 0;
+    }
+
+    int print_track(recording_t& recording, const char* name)
+    {
+        std::vector<recording_t::node_state_t> states;
+        std::size_t found = 0;
+
+        for (std::uint32_t frame = 0; frame < recording.get_frame_count(); frame++)
+        {
+            double time = 0.0;
+            recording.read_frame(frame, states, &time);
+
+            for (const recording_t::node_state_t& state : states)
+            {
+                const std::string* node_name = recording.get_name(state.key);
+                if (!node_name || *node_name != name)
+                    continue;
+
+                std::printf("%6u %9.3f %016" PRIx64 " ", frame, time, state.key);
+                print_position(state);
+                std::printf("\n");
+                found++;
+            }
+        }
+
+        if (!found)
+            std::printf("no node named %s\n", name);
+
+        return found ? 0 : 1;
+    }
+
+    struct expected_t {
+        double time;
+        std::map<std::uint64_t, recording_t::node_state_t> nodes;
+    };
+
+    bool compare(const expected_t& expected, const std::vector<recording_t::node_state_t>& states, double time)
+    {
+        if (std::abs(time - expected.time) > 0.5e-6 || states.size() != expected.nodes.size())
+            return false;
+
+        for (const recording_t::node_state_t& state : states)
+        {
+            auto it = expected.nodes.find(state.key);
+            if (it == expected.nodes.end() || it->second.dims != state.dims)
+                return false;
+
+            if (std::memcmp(it->second.values, state.values, state.dims * sizeof(float)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    int test(std::uint32_t frames, std::size_t node_count, const char* path)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> step(-0.1f, 0.1f);
+
+        struct node_t {
+            std::uint64_t key;
+            recording_t::node_state_t state;
+            bool moving;
+        };
+
+        std::uint64_t next_key = 1;
+        const auto spawn = [&]()
+        {
+            node_t node = {};
+            node.key = next_key++;
+            node.state.key = node.key;
+            node.state.dims = random() % 4 == 0 ? recording::DIMS_2D : recording::DIMS_3D;
+            node.moving = random() % 8 == 0;
+
+            for (std::uint32_t i = 0; i < node.state.dims; i++)
+                node.state.values[i] = static_cast<float>(random() % 1000) * 0.25f;
+
+            return node;
+        };
+
+        std::vector<node_t> scene;
+        for (std::size_t i = 0; i < node_count; i++)
+            scene.push_back(spawn());
+
+        recorder_t writer;
+        if (!writer.open(path))
+        {
+            std::printf("couldn't create %s\n", path);
+            return 1;
+        }
+
+        std::vector<expected_t> expected(frames);
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::uint32_t frame = 0; frame < frames; frame++)
+        {
+            // A few nodes freed and spawned every 5th frame, which also lands in the middle of chunks
+            if (frame % 5 == 4)
+            {
+                for (int i = 0; i < 3 && !scene.empty(); i++)
+                    scene.erase(scene.begin() + random() % scene.size());
+
+                for (int i = 0; i < 3; i++)
+                    scene.insert(scene.begin() + random() % (scene.size() + 1), spawn());
+            }
+
+            expected[frame].time = frame / 60.0;
+            writer.begin_frame(expected[frame].time);
+
+            for (node_t& node : scene)
+            {
+                if (node.moving)
+                {
+                    for (std::uint32_t i = 0; i < node.state.dims; i++)
+                        node.state.values[i] += step(random);
+                }
+
+                writer.add(node.key, node.state.values, node.state.dims);
+                expected[frame].nodes[node.key] = node.state;
+            }
+
+            writer.end_frame();
+        }
+
+        writer.close();
+        const double write = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        recording_t reader;
+        if (!reader.open(path) || reader.get_frame_count() != frames)
+        {
+            std::printf("couldn't read %s back\n", path);
+            return 1;
+        }
+
+        std::vector<recording_t::node_state_t> states;
+        std::size_t differ = 0;
+
+        auto read = [&](std::uint32_t frame)
+        {
+            double time = 0.0;
+            if (!reader.read_frame(frame, states, &time) || !compare(expected[frame], states, time))
+                differ++;
+        };
+
+        const auto in_order = std::chrono::steady_clock::now();
+        for (std::uint32_t frame = 0; frame < frames; frame++)
+            read(frame);
+        const double sequential = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - in_order).count();
+
+        std::vector<std::uint32_t> order(frames);
+        for (std::uint32_t i = 0; i < frames; i++)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), random);
+
+        const auto shuffled = std::chrono::steady_clock::now();
+        for (std::uint32_t frame : order)
+            read(frame);
+        const double seeking = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shuffled).count();
+
+        std::printf("%u frames of about %zu nodes, %llu nodes in total\n", frames, node_count, static_cast<unsigned long long>(next_key - 1));
+        std::printf("recorded in %.1f ms, %.1f bytes per node and frame\n", write, static_cast<double>(writer.get_bytes_written()) / (static_cast<double>(frames) * node_count));
+        std::printf("read in order %.1f ms, in random order %.1f ms\n", sequential, seeking);
+
+        std::remove(path);
+
+        if (differ)
+        {
+            std::printf("%zu of %u frames read back differ\n", differ, frames * 2);
+            return 1;
+        }
+
+        std::printf("every frame reads back bit for bit\n");
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && !std::strcmp(argv[1], "--test"))
+    {
+        const std::uint32_t frames = argc >= 3 ? static_cast<std::uint32_t>(std::max(1, std::atoi(argv[2]))) : 1000;
+        const std::size_t nodes = argc >= 4 ? static_cast<std::size_t>(std::max(1, std::atoi(argv[3]))) : 2000;
+        return test(frames, nodes, "recview_test.gdrec");
+    }
+
+    if (argc != 2 && !(argc == 4 && (!std::strcmp(argv[2], "--frame") || !std::strcmp(argv[2], "--track"))))
+    {
+        std::fprintf(stderr, "usage: %s <file> [--frame n | --track name]\n       %s --test [frames] [nodes]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    recording_t recording;
+    if (!recording.open(argv[1]))
+    {
+        std::printf("%s isn't a recording\n", argv[1]);
+        return 1;
+    }
+
+    if (argc == 2)
+        return summary(recording, argv[1]);
+
+    if (!std::strcmp(argv[2], "--frame"))
+        return print_frame(recording, static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 10)));
+
+    return print_track(recording, argv[3]);
+}
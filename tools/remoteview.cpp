@@ -0,0 +1,338 @@
+// Out of process viewer for GODOT_DUMPER_REMOTE, and a stand-in producer to run it without the game (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper remoteview.cpp ../GodotDumper/remote.cpp -o remoteview
+//   (cl /std:c++20 /O2 /EHsc remoteview.cpp ..\GodotDumper\remote.cpp ws2_32.lib on Windows)
+//
+// Usage:
+//   remoteview [[host:]port] [--tree] [--slow ms]   mirrors the scene, prints the rate once a second (the tree with --tree)
+//                                                   --slow sleeps after every read to watch the back-pressure
+//   remoteview serve [[host:]port] [nodes] [rate]   synthetic scene streamed like the game does, 2000 nodes at 60 Hz
+//   remoteview bench [nodes] [frames]               encodes and decodes the synthetic scene in process, sizes and times
+//
+// The game streams when GODOT_DUMPER_REMOTE=[host:]port is set before it's started, 127.0.0.1:7420 by default
+
+#include "remote.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Stand-in for remote::capture, a tree of Node, Node2D and Node3D where a few percent of the nodes move
+ * every frame and one leaf is replaced every couple of seconds, keys look like heap addresses
+*/
+class synthetic_scene_t {
+public:
+    explicit synthetic_scene_t(std::size_t count)
+    {
+        scene.nodes.reserve(count);
+        add(0);
+
+        while (scene.nodes.size() < count)
+            add(scene.nodes[random() % scene.nodes.size()].key);
+
+        sort();
+    }
+
+    void step(double time)
+    {
+        scene.time = time;
+
+        for (remote::node_t& node : scene.nodes)
+        {
+            if (!node.dims || random() % 100 >= 5)
+                continue;
+
+            // Origin for a Node3D (last 3 floats), position for a Node2D
+            const std::uint32_t first = node.dims == 12 ? 9 : 0;
+            node.values[first] += 0.05f * std::sin(static_cast<float>(time));
+            node.values[first + 1] += 0.01f;
+
+            if (node.dims == 12)
+                node.values[0] = std::cos(static_cast<float>(time));
+        }
+
+        if (++frames % 120 == 0)
+        {
+            // Some leaf goes away and a new node appears elsewhere
+            std::unordered_map<std::uint64_t, bool> parents;
+            for (const remote::node_t& node : scene.nodes)
+                parents[node.parent] = true;
+
+            for (std::size_t i = scene.nodes.size(); i-- > 1;)
+            {
+                if (!parents.contains(scene.nodes[i].key))
+                {
+                    scene.nodes.erase(scene.nodes.begin() + i);
+                    break;
+                }
+            }
+
+            add(scene.nodes[random() % scene.nodes.size()].key);
+            sort();
+        }
+    }
+
+    remote::scene_t scene;
+
+private:
+    void add(std::uint64_t parent)
+    {
+        static const std::pair<const char*, std::uint8_t> classes[] = { { "Node", 0 }, { "Node3D", 12 }, { "MeshInstance3D", 12 }, { "Sprite2D", 2 }, { "CollisionShape3D", 12 } };
+
+        remote::node_t node;
+        node.key = 0x1D000000000ull + next++ * 0x3A0;
+        node.parent = parent;
+        const auto& [class_name, dims] = classes[random() % 5];
+        node.class_name = class_name;
+        node.name = node.class_name + "_" + std::to_string(next);
+        node.dims = dims;
+
+        for (std::uint32_t i = 0; i < node.dims; i++)
+            node.values[i] = node.dims == 12 && i < 9 ? (i % 4 == 0 ? 1.f : 0.f) : static_cast<float>(random() % 1000) * 0.1f;
+
+        scene.nodes.push_back(std::move(node));
+    }
+
+    // Parents before their children, like a walk of the tree
+    void sort()
+    {
+        std::unordered_map<std::uint64_t, std::vector<std::size_t>> children;
+        for (std::size_t i = 1; i < scene.nodes.size(); i++)
+            children[scene.nodes[i].parent].push_back(i);
+
+        std::vector<remote::node_t> sorted;
+        sorted.reserve(scene.nodes.size());
+
+        std::vector<std::size_t> stack = { 0 };
+        while (!stack.empty())
+        {
+            const std::size_t index = stack.back();
+            stack.pop_back();
+
+            sorted.push_back(scene.nodes[index]);
+
+            auto it = children.find(scene.nodes[index].key);
+            if (it != children.end())
+                stack.insert(stack.end(), it->second.rbegin(), it->second.rend());
+        }
+
+        scene.nodes = std::move(sorted);
+    }
+
+    std::mt19937_64 random{ 42 };
+    std::uint64_t next = 1;
+    std::uint64_t frames = 0;
+};
+
+static void print_tree(const remote_decoder_t& decoder)
+{
+    std::unordered_map<std::uint64_t, std::vector<const remote::node_t*>> children;
+    for (const auto& [key, node] : decoder.get_nodes())
+        children[node.parent].push_back(&node);
+
+    for (auto& [key, list] : children)
+        std::sort(list.begin(), list.end(), [](const remote::node_t* a, const remote::node_t* b) { return a->key < b->key; });
+
+    std::vector<std::pair<const remote::node_t*, int>> stack;
+    for (auto it = children[0].rbegin(); it != children[0].rend(); ++it)
+        stack.emplace_back(*it, 0);
+
+    while (!stack.empty())
+    {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+
+        std::printf("%*s%s (%s) %llX", depth * 2, "", node->name.c_str(), node->class_name.c_str(), static_cast<unsigned long long>(node->key));
+        if (node->dims == 12)
+            std::printf(" at %.2f %.2f %.2f", node->values[9], node->values[10], node->values[11]);
+        else if (node->dims == 2)
+            std::printf(" at %.2f %.2f", node->values[0], node->values[1]);
+
+        std::printf("\n");
+
+        auto it = children.find(node->key);
+        if (it == children.end())
+            continue;
+
+        for (auto child = it->second.rbegin(); child != it->second.rend(); ++child)
+            stack.emplace_back(*child, depth + 1);
+    }
+}
+
+static int serve(const std::string& host, std::uint16_t port, std::size_t count, double rate)
+{
+    remote_server_t server;
+    if (!server.start(host, port))
+    {
+        std::fprintf(stderr, "[-] Couldn't listen on %s:%u\n", host.c_str(), port);
+        return 1;
+    }
+
+    std::fprintf(stderr, "[+] %zu nodes at %.0f Hz on %s:%u\n", count, rate, host.c_str(), port);
+
+    synthetic_scene_t synthetic(count);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto period = std::chrono::duration<double>(1.0 / rate);
+    auto next = start;
+    auto report = start;
+
+    remote_server_t::stats_t last = {};
+
+    while (true)
+    {
+        synthetic.step(seconds_since(start));
+        server.publish(synthetic.scene);
+
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        std::this_thread::sleep_until(next);
+
+        if (seconds_since(report) < 1.0)
+            continue;
+
+        const remote_server_t::stats_t stats = server.get_stats();
+        const std::uint64_t frames = stats.frames - last.frames;
+
+        std::fprintf(stderr, "%s %llu frames (%llu keyframes), %llu dropped, %.1f KB/s, %.0f B/frame\n", server.is_connected() ? "[viewer]" : "[      ]",
+            static_cast<unsigned long long>(frames), static_cast<unsigned long long>(stats.keyframes - last.keyframes), static_cast<unsigned long long>(stats.dropped - last.dropped),
+            (stats.bytes - last.bytes) / 1024.0 / seconds_since(report), frames ? static_cast<double>(stats.bytes - last.bytes) / frames : 0.0);
+
+        last = stats;
+        report = std::chrono::steady_clock::now();
+    }
+}
+
+static int bench(std::size_t count, std::uint32_t frames)
+{
+    synthetic_scene_t synthetic(count);
+
+    remote_encoder_t encoder;
+    remote_decoder_t decoder;
+    std::vector<std::uint8_t> message;
+
+    double encode_time = 0.0, decode_time = 0.0;
+    std::uint64_t keyframe_bytes = 0, delta_bytes = 0;
+
+    for (std::uint32_t frame = 1; frame <= frames; frame++)
+    {
+        synthetic.step(frame / 60.0);
+        message.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        encoder.encode(synthetic.scene, frame, frame == 1, message);
+        encode_time += seconds_since(start);
+
+        (frame == 1 ? keyframe_bytes : delta_bytes) += message.size();
+
+        start = std::chrono::steady_clock::now();
+        if (!decoder.apply(message[4], message.data() + 5, message.size() - 5))
+        {
+            std::fprintf(stderr, "[-] Frame %u didn't decode\n", frame);
+            return 1;
+        }
+
+        decode_time += seconds_since(start);
+    }
+
+    // The mirror has to match the last frame exactly
+    bool same = decoder.get_nodes().size() == synthetic.scene.nodes.size();
+    for (const remote::node_t& node : synthetic.scene.nodes)
+    {
+        auto it = decoder.get_nodes().find(node.key);
+        same = same && it != decoder.get_nodes().end() && it->second.parent == node.parent && it->second.name == node.name
+            && it->second.dims == node.dims && std::memcmp(it->second.values, node.values, sizeof(node.values)) == 0;
+    }
+
+    std::printf("%zu nodes, %u frames: keyframe %llu B, delta %.0f B average (%.1f%%), encode %.3f ms, decode %.3f ms per frame, mirror %s\n", count, frames,
+        static_cast<unsigned long long>(keyframe_bytes), static_cast<double>(delta_bytes) / (frames - 1), 100.0 * delta_bytes / (frames - 1) / keyframe_bytes,
+        encode_time * 1000.0 / frames, decode_time * 1000.0 / frames, same ? "matches" : "DIFFERS");
+
+    return same ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    std::string host = "127.0.0.1";
+    std::uint16_t port = remote::DEFAULT_PORT;
+
+    if (argc > 1 && std::strcmp(argv[1], "bench") == 0)
+        return bench(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000, argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 600);
+
+    if (argc > 1 && std::strcmp(argv[1], "serve") == 0)
+    {
+        if (argc > 2 && !remote::parse_address(argv[2], host, port))
+        {
+            std::fprintf(stderr, "[-] Bad address %s\n", argv[2]);
+            return 1;
+        }
+
+        return serve(host, port, argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2000, argc > 4 ? std::atof(argv[4]) : 60.0);
+    }
+
+    bool tree = false;
+    int slow = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--tree") == 0)
+            tree = true;
+        else if (std::strcmp(argv[i], "--slow") == 0 && i + 1 < argc)
+            slow = std::atoi(argv[++i]);
+        else if (!remote::parse_address(argv[i], host, port))
+        {
+            std::fprintf(stderr, "usage: %s [[host:]port] [--tree] [--slow ms] | serve [[host:]port] [nodes] [rate] | bench [nodes] [frames]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    remote_client_t client;
+    while (!client.connect(host, port))
+    {
+        std::fprintf(stderr, "[ ] Waiting for %s:%u\n", host.c_str(), port);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    std::fprintf(stderr, "[+] Connected to %s:%u\n", host.c_str(), port);
+
+    auto report = std::chrono::steady_clock::now();
+    remote_client_t::stats_t last = {};
+
+    while (client.poll(100))
+    {
+        if (slow)
+            std::this_thread::sleep_for(std::chrono::milliseconds(slow));
+
+        if (tree && client.get_scene().is_synced())
+        {
+            print_tree(client.get_scene());
+            return 0;
+        }
+
+        if (seconds_since(report) < 1.0)
+            continue;
+
+        const remote_client_t::stats_t& stats = client.get_stats();
+        std::fprintf(stderr, "[+] frame %u at %.2f s, %zu nodes, %llu deltas, %llu keyframes in %llu reads, %.1f KB/s\n", client.get_scene().get_frame(),
+            client.get_scene().get_time(), client.get_scene().get_nodes().size(), static_cast<unsigned long long>(stats.deltas - last.deltas),
+            static_cast<unsigned long long>(stats.keyframes - last.keyframes), static_cast<unsigned long long>(stats.reads - last.reads),
+            (stats.bytes - last.bytes) / 1024.0 / seconds_since(report));
+
+        last = stats;
+        report = std::chrono::steady_clock::now();
+    }
+
+    std::fprintf(stderr, "[-] Disconnected\n");
+    return 0;
+}
@@ -0,0 +1,343 @@
+// Benchmark of the watch sampler's sample path, with a heap allocation count, and of the rate its thread holds (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper samplebench.cpp ../GodotDumper/sampler.cpp ../GodotDumper/memory.cpp ../GodotDumper/godot.cpp ../GodotDumper/hierarchy.cpp ../GodotDumper/layout.cpp ../GodotDumper/analysis.cpp ../GodotDumper/resolver.cpp ../GodotDumper/vtables.cpp ../GodotDumper/pe.cpp ../GodotDumper/x86.cpp ../GodotDumper/xref.cpp ../GodotDumper/sdk.cpp -o samplebench
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   samplebench [--passes n] [--rate hz] [--seconds s]
+//
+// The watched objects sit in an ObjectDB reached the way the DLL reaches it: the layout's patterns in a fake image
+// point at the slot array globals, every object's vtable lies inside the image
+// sample_once is timed with 1, 4 and 16 watches over --passes passes (1000000 by default), rings are drained between
+// timed batches, every operator new made while sampling is counted and any fails the run
+// Then the sampler's own thread runs one watch at --rate (5000 Hz by default) for --seconds (1 by default) and the
+// samples it produced give the rate it held and the spacing between them
+// Also checks that a freed object stops its watch and that decimate plots the newest sample
+
+#include "sampler.h"
+#include "godot.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    std::atomic<std::size_t> allocations = 0;
+    std::atomic<bool> counting = false;
+
+    int failed = 0;
+
+    void check(bool passed, const char* what)
+    {
+        if (passed)
+            return;
+
+        std::printf("FAILED: %s\n", what);
+        failed++;
+    }
+
+    // Headers, the two ObjectDB sites in .text, the globals they point at and one vtable
+    class image_t {
+    public:
+        static constexpr std::uint32_t TEXT = 0x1000;
+        static constexpr std::uint32_t VTABLE = 0x2000;
+        static constexpr std::uint32_t SLOTS_GLOBAL = 0x3000;
+        static constexpr std::uint32_t SLOT_MAX_GLOBAL = 0x3008;
+        static constexpr std::uint32_t SIZE = 0x4000;
+
+        image_t() : bytes(SIZE, 0)
+        {
+            put<std::uint16_t>(0, 0x5A4D); // MZ
+            put<std::uint32_t>(0x3C, 0x40);
+            put<std::uint32_t>(0x40, 0x4550); // PE\0\0
+            put<std::uint32_t>(0x40 + 0x50, SIZE); // SizeOfImage
+
+            add_site(gd::layout->object_slots_pattern, gd::layout->object_slots_rva_offset, gd::layout->object_slots_rip_offset, SLOTS_GLOBAL);
+            add_site(gd::layout->slot_max_pattern, gd::layout->slot_max_rva_offset, gd::layout->slot_max_rip_offset, SLOT_MAX_GLOBAL);
+        }
+
+        std::uint8_t* base() { return bytes.data(); }
+        void* vtable() { return bytes.data() + VTABLE; }
+
+        template <typename T>
+        void put(std::uint32_t rva, T value)
+        {
+            std::memcpy(bytes.data() + rva, &value, sizeof(value));
+        }
+
+    private:
+        void add_site(const char* pattern, std::uint32_t rva_offset, std::uint32_t rip_offset, std::uint32_t target)
+        {
+            const std::uint32_t site = text_end;
+
+            for (const char* it = pattern; *it;)
+            {
+                if (*it == ' ')
+                    it++;
+                else if (*it == '?')
+                {
+                    bytes[text_end++] = 0;
+                    it += it[1] == '?' ? 2 : 1;
+                }
+                else
+                {
+                    char* end = nullptr;
+                    bytes[text_end++] = static_cast<std::uint8_t>(std::strtoul(it, &end, 16));
+                    it = end;
+                }
+            }
+
+            put<std::int32_t>(site + rva_offset, static_cast<std::int32_t>(target - (site + rip_offset)));
+            text_end += 16;
+        }
+
+    private:
+        std::vector<std::uint8_t> bytes;
+        std::uint32_t text_end = TEXT;
+    };
+
+    // Fields a watch reads, after the vtable pointer
+    struct object_t {
+        void* vtable;
+        float value;
+        std::int32_t counter;
+        bool flag;
+    };
+
+    constexpr std::uint32_t SLOT_MAX = 64;
+
+    double ns_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // sample_once with count watches, ns per pass
+    double bench_passes(sampler_t& bench, const std::vector<std::uint64_t>& ids, std::size_t count, std::size_t passes)
+    {
+        constexpr std::uint32_t FIELDS[] = { offsetof(object_t, value), offsetof(object_t, counter), offsetof(object_t, flag) };
+        constexpr sampler_t::kind_t KINDS[] = { sampler_t::kind_t::FLOAT, sampler_t::kind_t::INT32, sampler_t::kind_t::BOOL };
+
+        std::vector<int> watches;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            watches.push_back(bench.watch("field", ids[i % ids.size()], FIELDS[i % 3], KINDS[i % 3]));
+            if (watches.back() < 0)
+            {
+                std::printf("no free watch slot\n");
+                std::exit(1);
+            }
+        }
+
+        // Reserved up front, a drain into it never allocates either
+        std::vector<sampler_t::sample_t> drained;
+        drained.reserve(sampler_t::RING_SIZE);
+
+        constexpr std::size_t BATCH = sampler_t::RING_SIZE / 2;
+        double total = 0.0;
+        std::size_t lost = 0;
+
+        for (std::size_t done = 0; done < passes; done += BATCH)
+        {
+            const std::size_t batch = std::min(BATCH, passes - done);
+
+            counting = true;
+            const auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < batch; i++)
+                bench.sample_once(static_cast<double>(done + i));
+            total += ns_since(start);
+            counting = false;
+
+            for (int index : watches)
+            {
+                drained.clear();
+                lost += batch - bench.drain(index, drained);
+            }
+        }
+
+        for (int index : watches)
+            bench.unwatch(index);
+
+        // Past the pass that may have been running during unwatch, the released slots can be reused by the next round
+        bench.sample_once(0.0);
+        bench.sample_once(0.0);
+
+        check(lost == 0, "every sample reaches its ring");
+        return total / passes;
+    }
+
+    void test_freed(sampler_t& bench, gd::ObjectDB::ObjectSlot* slots, std::uint64_t id)
+    {
+        const int index = bench.watch("freed", id, offsetof(object_t, value), sampler_t::kind_t::FLOAT);
+
+        const std::uint32_t slot = static_cast<std::uint32_t>(id & ((1ull << gd::ObjectDB::SLOT_MAX_COUNT_BITS) - 1));
+        const std::uint64_t validator = slots[slot].validator;
+
+        bench.sample_once(1.0);
+        slots[slot].validator = validator + 1; // Freed and the slot reused
+        bench.sample_once(2.0);
+
+        std::vector<sampler_t::sample_t> drained;
+        bench.drain(index, drained);
+
+        check(drained.size() == 1 && bench.get_watch(index).freed.load(), "a freed object stops its watch");
+
+        slots[slot].validator = validator;
+        bench.unwatch(index);
+        bench.sample_once(0.0);
+        bench.sample_once(0.0);
+    }
+
+    void test_decimate()
+    {
+        sampler_t::sample_t samples[11];
+        for (int i = 0; i <= 10; i++)
+            samples[i] = { i * 0.1, static_cast<float>(i) };
+
+        float mins[10], maxs[10];
+        sampler_t::decimate(samples, 11, 0.0, samples[10].time, 10, mins, maxs);
+
+        check(maxs[9] == 10.f && mins[0] == 0.f, "decimate plots the samples at both ends of the window");
+    }
+
+    // The sampler's thread on one watch, rate held and spacing between samples
+    void bench_thread(std::uint64_t id, float rate, double seconds)
+    {
+        sampler_t threaded;
+        threaded.set_rate(rate);
+
+        const int index = threaded.watch("thread", id, offsetof(object_t, value), sampler_t::kind_t::FLOAT);
+
+        std::vector<sampler_t::sample_t> samples;
+        samples.reserve(static_cast<std::size_t>(rate * seconds * 2) + sampler_t::RING_SIZE);
+
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            threaded.drain(index, samples);
+        }
+
+        threaded.unwatch(index);
+        threaded.drain(index, samples);
+
+        if (samples.size() < 2)
+        {
+            std::printf("thread at %.0f Hz: %zu samples\n", rate, samples.size());
+            check(false, "the sampler thread samples");
+            return;
+        }
+
+        std::vector<double> gaps;
+        for (std::size_t i = 1; i < samples.size(); i++)
+            gaps.push_back((samples[i].time - samples[i - 1].time) * 1e6);
+
+        std::sort(gaps.begin(), gaps.end());
+
+        const double span = samples.back().time - samples.front().time;
+        std::printf("thread at %.0f Hz: %zu samples in %.2f s, %.0f Hz held, spacing median %.1f us, p99 %.1f us, max %.1f us, %llu dropped\n",
+            rate, samples.size(), span, (samples.size() - 1) / span, gaps[gaps.size() / 2], gaps[gaps.size() * 99 / 100], gaps.back(),
+            static_cast<unsigned long long>(threaded.get_watch(index).dropped.load()));
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    allocations += counting;
+    if (void* pointer = std::malloc(size ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t passes = 1000000;
+    float rate = 5000.f;
+    double seconds = 1.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--passes") && i + 1 < argc)
+            passes = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--rate") && i + 1 < argc)
+            rate = static_cast<float>(std::atof(argv[++i]));
+        else if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = std::max(0.1, std::atof(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--passes n] [--rate hz] [--seconds s]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    gd::layout = &gd::layouts[0];
+
+    image_t image;
+    mem->set_base_address(image.base());
+
+    std::vector<object_t> objects(SLOT_MAX / 2);
+    std::vector<gd::ObjectDB::ObjectSlot> slots(SLOT_MAX);
+    std::vector<std::uint64_t> ids;
+
+    for (std::uint32_t i = 0; i < objects.size(); i++)
+    {
+        objects[i] = { image.vtable(), 1.5f * i, static_cast<std::int32_t>(i), (i & 1) != 0 };
+
+        slots[i].validator = 100 + i;
+        slots[i].object = reinterpret_cast<gd::Object*>(&objects[i]);
+        ids.push_back(gd::ObjectDB::get_instance_id(slots[i], i));
+    }
+
+    image.put<gd::ObjectDB::ObjectSlot*>(image_t::SLOTS_GLOBAL, slots.data());
+    image.put<std::uint32_t>(image_t::SLOT_MAX_GLOBAL, SLOT_MAX);
+
+    if (gd::ObjectDB::get_instance(ids[3]) != reinterpret_cast<gd::Object*>(&objects[3]))
+    {
+        std::printf("the ObjectDB wasn't found in the fake image\n");
+        return 1;
+    }
+
+    sampler_t bench;
+    bench.threaded = false;
+
+    // Faults the rings in, the first round isn't counted
+    bench_passes(bench, ids, sampler_t::MAX_WATCHES, sampler_t::RING_SIZE);
+
+    allocations = 0;
+    for (std::size_t count : { std::size_t(1), std::size_t(4), sampler_t::MAX_WATCHES })
+    {
+        const double pass = bench_passes(bench, ids, count, passes);
+        std::printf("%2zu watches: %7.1f ns per pass, %5.1f ns per field\n", count, pass, pass / count);
+    }
+
+    std::printf("%zu allocations while sampling\n", allocations.load());
+    check(allocations == 0, "the sample path doesn't allocate");
+
+    test_freed(bench, slots.data(), ids[5]);
+    test_decimate();
+    bench_thread(ids[1], rate, seconds);
+
+    if (failed)
+    {
+        std::printf("%d checks failed\n", failed);
+        return 1;
+    }
+
+    std::printf("every check passed\n");
+    return 0;
+}
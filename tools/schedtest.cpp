@@ -0,0 +1,235 @@
+// Test of the overlay loop's frame scheduler on a fake clock (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -I../GodotDumper schedtest.cpp ../GodotDumper/scheduler.cpp -o schedtest
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   schedtest
+//
+// The scheduler gets a clock that only moves when it sleeps or when the test says a frame took time, so every
+// frame interval is exact and the run takes no real time
+// Checks frame spacing at target_rate with and without render time, the switch to idle_rate and back on input
+// (polled and wake()), the wake_grace period, the 0.1 Hz floor on a rate of 0 or less, and that a stall is followed by
+// one frame right away and then the normal spacing instead of a burst of catch-up frames
+
+#include "scheduler.h"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    int failed = 0;
+
+    void check(bool passed, const char* what)
+    {
+        if (passed)
+            return;
+
+        std::printf("FAILED: %s\n", what);
+        failed++;
+    }
+
+    struct fake_clock_t {
+        std::chrono::nanoseconds now = 10s; // Well past wake_grace, the scheduler starts out idle when asked to
+        std::chrono::nanoseconds longest_sleep{ 0 };
+        std::size_t sleeps = 0;
+
+        // Called on every sleep, with the time the sleep starts at
+        std::function<void(std::chrono::nanoseconds)> on_sleep = nullptr;
+    };
+
+    frame_scheduler_t make_scheduler(fake_clock_t& clock)
+    {
+        return frame_scheduler_t(
+            [&clock]() { return clock.now; },
+            [&clock](std::chrono::nanoseconds duration)
+            {
+                if (clock.on_sleep)
+                    clock.on_sleep(clock.now);
+
+                clock.longest_sleep = std::max(clock.longest_sleep, duration);
+                clock.sleeps++;
+                clock.now += duration;
+            });
+    }
+
+    // Time between the ends of consecutive waits, render_time passes before each wait like a frame being drawn
+    std::vector<std::chrono::nanoseconds> run_frames(frame_scheduler_t& scheduler, fake_clock_t& clock, int frames, std::chrono::nanoseconds render_time = 0ns)
+    {
+        std::vector<std::chrono::nanoseconds> intervals;
+        std::chrono::nanoseconds last = clock.now;
+
+        for (int i = 0; i < frames; i++)
+        {
+            clock.now += render_time;
+            scheduler.wait();
+
+            intervals.push_back(clock.now - last);
+            last = clock.now;
+        }
+
+        return intervals;
+    }
+
+    bool all_equal(const std::vector<std::chrono::nanoseconds>& intervals, std::chrono::nanoseconds expected)
+    {
+        for (std::chrono::nanoseconds interval : intervals)
+        {
+            if (interval != expected)
+                return false;
+        }
+
+        return !intervals.empty();
+    }
+
+    std::chrono::nanoseconds period_of(float rate)
+    {
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(1e9f / rate));
+    }
+
+    void test_target_rate()
+    {
+        fake_clock_t clock;
+        frame_scheduler_t scheduler = make_scheduler(clock);
+        scheduler.target_rate = 144.f;
+
+        check(all_equal(run_frames(scheduler, clock, 100), period_of(144.f)), "frames spaced at target_rate");
+        check(all_equal(run_frames(scheduler, clock, 100, 3ms), period_of(144.f)), "render time is part of the period, not added to it");
+        check(clock.longest_sleep <= scheduler.poll_interval, "no sleep longer than poll_interval");
+
+        scheduler.target_rate = 60.f;
+        run_frames(scheduler, clock, 1); // The frame already due at 144 Hz
+        check(all_equal(run_frames(scheduler, clock, 10), period_of(60.f)), "a new target_rate applies on the next frame");
+    }
+
+    void test_idle()
+    {
+        fake_clock_t clock;
+        frame_scheduler_t scheduler = make_scheduler(clock);
+        scheduler.target_rate = 144.f;
+        scheduler.idle_rate = 4.f;
+
+        scheduler.set_idle(true);
+        check(scheduler.is_idle() && scheduler.get_period() == period_of(4.f), "idle_rate while idle");
+
+        clock.longest_sleep = 0ns;
+        check(all_equal(run_frames(scheduler, clock, 10), period_of(4.f)), "frames spaced at idle_rate");
+        check(clock.longest_sleep <= scheduler.poll_interval, "input is still polled every poll_interval while idle");
+
+        scheduler.set_idle(false);
+        run_frames(scheduler, clock, 1);
+        check(!scheduler.is_idle() && all_equal(run_frames(scheduler, clock, 10), period_of(144.f)), "back to target_rate once something is on screen");
+    }
+
+    void test_interaction()
+    {
+        fake_clock_t clock;
+        frame_scheduler_t scheduler = make_scheduler(clock);
+        scheduler.target_rate = 144.f;
+        scheduler.idle_rate = 4.f;
+        scheduler.set_idle(true);
+
+        run_frames(scheduler, clock, 2);
+
+        // Input 30ms into an idle frame
+        const std::chrono::nanoseconds input_at = clock.now + 30ms;
+        bool pending = true;
+        scheduler.interaction = [&]() { return pending && clock.now >= input_at ? (pending = false, true) : false; };
+
+        const std::chrono::nanoseconds start = clock.now;
+        const bool interrupted = scheduler.wait();
+
+        // The poll sees it at the first poll_interval boundary after it, the frame is long due at 144 Hz by then
+        check(interrupted && clock.now - start < 30ms + scheduler.poll_interval, "input cuts an idle wait short");
+        check(!scheduler.is_idle(), "full rate right after input, even with set_idle(true)");
+
+        check(all_equal(run_frames(scheduler, clock, 10), period_of(144.f)), "target_rate during wake_grace");
+
+        // Whatever is left of the grace period, then idle again after the frame already due
+        clock.now += scheduler.wake_grace;
+        check(scheduler.is_idle(), "idle again after wake_grace");
+        run_frames(scheduler, clock, 1);
+        check(all_equal(run_frames(scheduler, clock, 3), period_of(4.f)), "frames spaced at idle_rate again after wake_grace");
+
+        // wake() from another thread, simulated by calling it during a sleep 50ms in
+        scheduler.interaction = nullptr;
+        const std::chrono::nanoseconds wake_at = clock.now + 50ms;
+        bool woken = false;
+        clock.on_sleep = [&](std::chrono::nanoseconds now)
+        {
+            if (!woken && now >= wake_at)
+            {
+                scheduler.wake();
+                woken = true;
+            }
+        };
+
+        const std::chrono::nanoseconds wake_start = clock.now;
+        check(scheduler.wait() && clock.now - wake_start < 50ms + 2 * scheduler.poll_interval, "wake() cuts an idle wait short");
+        clock.on_sleep = nullptr;
+    }
+
+    void test_rate_floor()
+    {
+        fake_clock_t clock;
+        frame_scheduler_t scheduler = make_scheduler(clock);
+        scheduler.idle_rate = 0.f;
+        scheduler.target_rate = -5.f;
+
+        check(scheduler.get_period() == period_of(0.1f), "a target_rate below 0.1 Hz is clamped to 0.1 Hz");
+
+        scheduler.set_idle(true);
+        check(scheduler.get_period() == period_of(0.1f), "an idle_rate of 0 is clamped to 0.1 Hz");
+
+        const std::size_t sleeps = clock.sleeps;
+        check(all_equal(run_frames(scheduler, clock, 2), period_of(0.1f)), "frames spaced 10 s apart at the floor");
+        check(clock.sleeps - sleeps >= static_cast<std::size_t>(2 * 10s / scheduler.poll_interval), "the floor still polls every poll_interval");
+    }
+
+    void test_stall()
+    {
+        fake_clock_t clock;
+        frame_scheduler_t scheduler = make_scheduler(clock);
+        scheduler.target_rate = 100.f;
+
+        run_frames(scheduler, clock, 5);
+
+        // A 2 s frame (debugger, loading screen), 200 periods at 100 Hz
+        clock.now += 2s;
+        const std::size_t sleeps = clock.sleeps;
+        scheduler.wait();
+        check(clock.sleeps == sleeps, "the frame after a stall starts right away");
+
+        // A catching up scheduler would return immediately for the next 199 frames
+        check(all_equal(run_frames(scheduler, clock, 20), period_of(100.f)), "normal spacing right after a stall, no catch-up burst");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 1)
+    {
+        std::fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    test_target_rate();
+    test_idle();
+    test_interaction();
+    test_rate_floor();
+    test_stall();
+
+    if (failed)
+    {
+        std::printf("%d checks failed\n", failed);
+        return 1;
+    }
+
+    std::printf("every check passed\n");
+    return 0;
+}
@@ -0,0 +1,178 @@
+// Offline signature generator, runs against a Godot executable on disk (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -I../GodotDumper sigmaker.cpp ../GodotDumper/pe.cpp ../GodotDumper/x86.cpp ../GodotDumper/xref.cpp ../GodotDumper/signature.cpp ../GodotDumper/resolver.cpp ../GodotDumper/analysis.cpp ../GodotDumper/vtables.cpp -o sigmaker
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   sigmaker <image> <address>...           signature at each address (a function or an instruction)
+//   sigmaker <image> --ref <address>...     signature of an instruction referencing each address (a global or a function)
+//   sigmaker <image> --functions <count>    signatures of count functions spread over .pdata, to time the generator
+//   sigmaker <image> --xrefs <address>...   every instruction referencing each address
+//   sigmaker <image> --resolve              runs the string anchored rules of resolver.cpp
+//   sigmaker <image> --vtables [index]      vtables and the class names their get_class (slot index, 10 by default) returns
+//
+// Addresses are hex, either RVAs or virtual addresses at the image's preferred base
+
+#include "pe.h"
+#include "resolver.h"
+#include "signature.h"
+#include "vtables.h"
+#include "xref.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: %s <image> [--ref | --xrefs] <address>... | --functions <count> | --resolve | --vtables [index]\n", argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    pe_image_t image;
+    if (!image.load(argv[1]))
+    {
+        std::fprintf(stderr, "[-] Couldn't load %s as a PE32+ image\n", argv[1]);
+        return 1;
+    }
+
+    signature_generator_t generator;
+    if (!generator.build(image))
+    {
+        std::fprintf(stderr, "[-] %s has no executable section\n", argv[1]);
+        return 1;
+    }
+
+    std::fprintf(stderr, "[+] Loaded and indexed in %.2f s\n", seconds_since(start));
+
+    start = std::chrono::steady_clock::now();
+
+    xref_index_t xrefs;
+    if (xrefs.build(image))
+    {
+        generator.set_xrefs(&xrefs);
+        std::fprintf(stderr, "[+] %zu references in %zu instructions indexed in %.2f s\n", xrefs.size(), xrefs.get_instruction_count(), seconds_since(start));
+    }
+
+    if (std::strcmp(argv[2], "--resolve") == 0)
+    {
+        start = std::chrono::steady_clock::now();
+
+        resolver_t resolver;
+        resolver.resolve(image, xrefs);
+
+        std::fprintf(stderr, "[+] %zu rules resolved in %.3f s\n", resolver.rules.size(), seconds_since(start));
+
+        for (const resolver_t::result_t& result : resolver.get_results())
+        {
+            if (result.rva)
+                std::printf("%-24s %08X (%u of %u references agree)\n", result.rule->name, result.rva, result.votes, result.references);
+            else
+                std::printf("%-24s not found\n", result.rule->name);
+        }
+
+        return 0;
+    }
+
+    if (std::strcmp(argv[2], "--vtables") == 0)
+    {
+        start = std::chrono::steady_clock::now();
+
+        vtable_table_t table;
+        table.scan(image, xrefs, argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10);
+
+        std::fprintf(stderr, "[+] %zu vtables, %zu named (%zu classes) in %.3f s\n", table.get_vtable_count(), table.get_named_count(), table.get_names().size(), seconds_since(start));
+
+        std::vector<std::pair<std::uintptr_t, std::uint32_t>> sorted(table.get_table().begin(), table.get_table().end());
+        std::sort(sorted.begin(), sorted.end());
+
+        for (const auto& [vtable, name] : sorted)
+            std::printf("%016llX %s\n", static_cast<unsigned long long>(vtable), table.get_names()[name].c_str());
+
+        return 0;
+    }
+
+    if (std::strcmp(argv[2], "--xrefs") == 0)
+    {
+        static constexpr const char* kinds[] = { "read", "write", "address", "call", "call indirect", "jump", "jump indirect", "branch" };
+
+        for (int i = 3; i < argc; i++)
+        {
+            std::uint64_t address = std::strtoull(argv[i], nullptr, 16);
+            std::uint32_t rva = address >= image.get_image_base() ? image.to_rva(address) : static_cast<std::uint32_t>(address);
+
+            std::printf("%08X:\n", rva);
+            for (const xref_index_t::xref_t& xref : xrefs.get_references_to(rva))
+                std::printf("    %08X %s\n", xref.site, kinds[xref.kind]);
+        }
+
+        return 0;
+    }
+
+    if (std::strcmp(argv[2], "--functions") == 0)
+    {
+        const std::vector<pe_image_t::function_t>& functions = image.get_functions();
+        std::size_t count = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100;
+        if (functions.empty() || !count)
+            return 1;
+
+        std::size_t step = functions.size() > count ? functions.size() / count : 1;
+        std::size_t generated = 0, failed = 0, total_length = 0;
+
+        start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < functions.size() && generated + failed < count; i += step)
+        {
+            signature_generator_t::signature_t signature;
+            if (generator.generate(functions[i].begin, signature))
+            {
+                std::printf("%08X \"%s\"\n", functions[i].begin, signature.pattern.c_str());
+                total_length += signature.length;
+                generated++;
+            }
+            else
+            {
+                failed++;
+            }
+        }
+
+        std::fprintf(stderr, "[+] %zu signatures (%zu not unique within %zu bytes) in %.2f s, %.1f bytes on average\n",
+            generated, failed, generator.max_length, seconds_since(start), generated ? double(total_length) / generated : 0.0);
+        return 0;
+    }
+
+    const bool reference = std::strcmp(argv[2], "--ref") == 0;
+
+    for (int i = reference ? 3 : 2; i < argc; i++)
+    {
+        std::uint64_t address = std::strtoull(argv[i], nullptr, 16);
+        std::uint32_t rva = address >= image.get_image_base() ? image.to_rva(address) : static_cast<std::uint32_t>(address);
+
+        signature_generator_t::signature_t signature;
+        bool found = reference ? generator.generate_reference(rva, signature) : generator.generate(rva, signature);
+
+        if (!found)
+        {
+            std::printf("%08X: no unique signature\n", rva);
+            continue;
+        }
+
+        if (reference)
+            std::printf("%08X: \"%s\" at %08X, rva_offset = %u, rip_offset = %u\n", rva, signature.pattern.c_str(), signature.rva, signature.rva_offset, signature.rip_offset);
+        else
+            std::printf("%08X: \"%s\"\n", rva, signature.pattern.c_str());
+    }
+
+    return 0;
+}
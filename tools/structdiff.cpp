@@ -0,0 +1,126 @@
+// Offline structure offset finder, runs against object series recorded in game or memory snapshots (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -I../GodotDumper structdiff.cpp ../GodotDumper/structdiff.cpp ../GodotDumper/snapshot.cpp -o structdiff
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   structdiff <series> [--all]                                         fields that changed (every field with --all) and proposals
+//   structdiff build <address> <size> <series> <snapshot>...            series of one object out of snapshots taken in order
+//
+// Series are written by the node properties window (struct_<class>_<time>.gdss), addresses and sizes are hex
+
+#include "snapshot.h"
+#include "structdiff.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int build(int argc, char** argv)
+{
+    const std::uint64_t address = std::strtoull(argv[2], nullptr, 16);
+    const std::uint32_t size = static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 16));
+
+    struct_series_t series;
+    series.address = address;
+    series.reset(size);
+
+    std::vector<std::uint8_t> frame(size);
+
+    for (int i = 5; i < argc; i++)
+    {
+        memory_snapshot_t snapshot;
+        if (!snapshot.load(argv[i]))
+        {
+            std::fprintf(stderr, "[-] Couldn't read the snapshot %s\n", argv[i]);
+            return 1;
+        }
+
+        // The object has to sit in one captured region
+        const memory_snapshot_t::region_t* region = snapshot.get_region(address);
+        if (!region || !region->contains(address + size - 1))
+        {
+            std::fprintf(stderr, "[-] %llX+%X isn't in %s\n", static_cast<unsigned long long>(address), size, argv[i]);
+            return 1;
+        }
+
+        std::memcpy(frame.data(), snapshot.get_data(*region) + (address - region->base), size);
+        series.add(frame.data(), i - 5);
+    }
+
+    if (!series.save(argv[4]))
+    {
+        std::fprintf(stderr, "[-] Couldn't write %s\n", argv[4]);
+        return 1;
+    }
+
+    std::fprintf(stderr, "[+] %u frames of %X bytes\n", series.get_frame_count(), size);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <series> [--all] | build <address> <size> <series> <snapshot>...\n", argv[0]);
+        return 1;
+    }
+
+    if (std::strcmp(argv[1], "build") == 0)
+    {
+        if (argc < 7)
+        {
+            std::fprintf(stderr, "[-] build needs <address> <size> <series> and two snapshots or more\n");
+            return 1;
+        }
+
+        return build(argc, argv);
+    }
+
+    struct_series_t series;
+    if (!series.load(argv[1]))
+    {
+        std::fprintf(stderr, "[-] Couldn't read the series %s\n", argv[1]);
+        return 1;
+    }
+
+    const bool all = argc > 2 && std::strcmp(argv[2], "--all") == 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    struct_analyzer_t analyzer;
+    analyzer.analyze(series);
+    const std::vector<struct_analyzer_t::proposal_t> proposals = analyzer.propose(series);
+
+    std::fprintf(stderr, "[+] %s at %llX, %u frames of %X bytes analyzed in %.3f ms\n", series.class_name.c_str(), static_cast<unsigned long long>(series.address),
+        series.get_frame_count(), series.get_size(), seconds_since(start) * 1000.0);
+
+    std::printf("offset  size  kind     changes\n");
+    for (const struct_analyzer_t::field_t& field : analyzer.get_fields())
+    {
+        if (all || field.changes)
+            std::printf("%6X  %4X  %-7s  %u\n", field.offset, field.size, struct_analyzer_t::to_string(field.kind), field.changes);
+    }
+
+    std::printf("\n");
+    for (const struct_analyzer_t::proposal_t& proposal : proposals)
+    {
+        if (proposal.reference != UINT32_MAX)
+            std::printf("%-24s (was %X):", proposal.target->name, proposal.reference);
+        else
+            std::printf("%-24s:", proposal.target->name);
+
+        for (std::uint32_t offset : proposal.offsets)
+            std::printf(" %X", offset);
+
+        std::printf("\n");
+    }
+
+    return 0;
+}
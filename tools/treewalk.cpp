@@ -0,0 +1,216 @@
+// Scene tree traversal benchmark, walks a synthetic tree laid out like Godot's nodes (any OS)
+//
+// Build:
+//   g++ -std=c++20 -O2 -pthread -I../GodotDumper treewalk.cpp ../GodotDumper/work_pool.cpp ../GodotDumper/memory.cpp ../GodotDumper/godot.cpp ../GodotDumper/hierarchy.cpp ../GodotDumper/layout.cpp ../GodotDumper/analysis.cpp ../GodotDumper/resolver.cpp ../GodotDumper/vtables.cpp ../GodotDumper/pe.cpp ../GodotDumper/x86.cpp ../GodotDumper/xref.cpp ../GodotDumper/sdk.cpp -o treewalk
+//   (cl /std:c++20 /O2 /EHsc with the same files on Windows)
+//
+// Usage:
+//   treewalk [nodes] [--threads n] [--runs n]
+//
+// nodes defaults to 1000000, spread over the heap in random order like a procedurally generated level
+// Prints the serial stack walk the capture code used, the walker on the calling thread with and without prefetching,
+// then the walker on 1, 2, 4... threads up to --threads (one per hardware thread by default), checking every output
+// against the serial preorder
+
+#include "tree_walk.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace
+{
+    constexpr std::size_t NODE_SIZE = 0x200; // Past every layout's Node fields
+
+    struct record_t {
+        gd::Node* node;
+        gd::Node* parent;
+        std::uint32_t depth;
+        std::uint64_t name;
+
+        bool operator==(const record_t& other) const
+        {
+            return node == other.node && parent == other.parent && depth == other.depth && name == other.name;
+        }
+    };
+
+    struct tree_t {
+        std::vector<std::uint8_t> arena;
+        std::vector<std::vector<gd::Node*>> children;
+        gd::Node* root = nullptr;
+    };
+
+    // Wide near the root (chunks, rooms) and bushy below, node i lives at a random slot of the arena
+    void build(tree_t& tree, std::size_t count)
+    {
+        std::mt19937_64 random(1234);
+
+        std::vector<std::size_t> slots(count);
+        for (std::size_t i = 0; i < count; i++)
+            slots[i] = i;
+
+        std::shuffle(slots.begin(), slots.end(), random);
+
+        tree.arena.assign(count * NODE_SIZE, 0);
+        tree.children.assign(count, {});
+
+        const auto node_at = [&](std::size_t index)
+        {
+            return reinterpret_cast<gd::Node*>(tree.arena.data() + slots[index] * NODE_SIZE);
+        };
+
+        std::vector<std::pair<std::size_t, std::uint32_t>> queue = { { 0, 0 } };
+        std::size_t created = 1;
+
+        for (std::size_t head = 0; head < queue.size() && created < count; head++)
+        {
+            const auto [index, depth] = queue[head];
+            std::size_t fanout = depth == 0 ? 64 : depth == 1 ? 32 : std::uniform_int_distribution<std::size_t>(0, 7)(random);
+            fanout = std::min(fanout, count - created);
+
+            for (std::size_t i = 0; i < fanout; i++)
+            {
+                tree.children[index].push_back(node_at(created));
+                queue.push_back({ created++, depth + 1 });
+            }
+        }
+
+        // children_cache is { u32 count, u32 capacity, Node** data }, the name a pointer to tell records apart
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::uint8_t* node = reinterpret_cast<std::uint8_t*>(node_at(i));
+
+            const std::uint32_t size = static_cast<std::uint32_t>(tree.children[i].size());
+            gd::Node** data = tree.children[i].data();
+            std::memcpy(node + gd::layout->node_children_cache, &size, sizeof(size));
+            std::memcpy(node + gd::layout->node_children_cache + 4, &size, sizeof(size));
+            std::memcpy(node + gd::layout->node_children_cache + 8, &data, sizeof(data));
+
+            const std::uint64_t name = i;
+            std::memcpy(node + gd::layout->node_name, &name, sizeof(name));
+        }
+
+        tree.root = node_at(0);
+    }
+
+    std::uint64_t read_name(gd::Node* node)
+    {
+        std::uint64_t name;
+        std::memcpy(&name, reinterpret_cast<const std::uint8_t*>(node) + gd::layout->node_name, sizeof(name));
+        return name;
+    }
+
+    // What remote::capture and the recorder did before the walker
+    void serial_walk(gd::Node* root, std::vector<record_t>& out)
+    {
+        out.clear();
+
+        std::vector<record_t> stack = { { root, nullptr, 0, 0 } };
+        while (!stack.empty())
+        {
+            record_t entry = stack.back();
+            stack.pop_back();
+
+            entry.name = read_name(entry.node);
+            out.push_back(entry);
+
+            LocalVector<gd::Node*>& children = entry.node->get_children();
+            for (std::uint32_t i = children.size(); i-- > 0;)
+            {
+                if (children[i])
+                    stack.push_back({ children[i], entry.node, entry.depth + 1, 0 });
+            }
+        }
+    }
+
+    template <typename F>
+    double best_of(int runs, F&& run)
+    {
+        double best = 1e9;
+        for (int i = 0; i < runs; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t count = 1000000;
+    std::size_t max_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    int runs = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+            max_threads = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--runs") && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (argv[i][0] != '-')
+            count = std::max<std::size_t>(1, std::strtoull(argv[i], nullptr, 10));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [nodes] [--threads n] [--runs n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    gd::layout = &gd::layouts[0];
+
+    tree_t tree;
+    build(tree, count);
+
+    std::vector<record_t> expected;
+    const double serial = best_of(runs, [&]() { serial_walk(tree.root, expected); });
+    std::printf("%zu nodes\n", expected.size());
+    std::printf("serial stack walk      %8.2f ms\n", serial);
+
+    const auto visit = [](gd::Node* node, gd::Node* parent, std::uint32_t depth, record_t& record)
+    {
+        record = { node, parent, depth, read_name(node) };
+        return true;
+    };
+
+    tree_walker_t<record_t> walker;
+    std::vector<record_t> records;
+    bool all_match = true;
+
+    const auto check = [&](const char* what)
+    {
+        if (records == expected)
+            return;
+
+        std::printf("  %s: output differs from the serial preorder\n", what);
+        all_match = false;
+    };
+
+    walker.prefetch = false;
+    std::printf("walker, no prefetch    %8.2f ms\n", best_of(runs, [&]() { walker.walk(tree.root, nullptr, records, visit); }));
+    check("no prefetch");
+
+    walker.prefetch = true;
+    std::printf("walker, prefetch       %8.2f ms\n", best_of(runs, [&]() { walker.walk(tree.root, nullptr, records, visit); }));
+    check("prefetch");
+
+    for (std::size_t threads = 1; ; threads = std::min(threads * 2, max_threads))
+    {
+        work_pool_t pool(threads);
+        const double time = best_of(runs, [&]() { walker.walk(tree.root, &pool, records, visit); });
+
+        std::printf("walker, %2zu threads    %8.2f ms  x%.2f, %zu segments\n", threads, time, serial / time, walker.get_segment_count());
+        check("pool");
+
+        if (threads == max_threads)
+            break;
+    }
+
+    std::printf(all_match ? "every output matches the serial preorder\n" : "MISMATCH\n");
+    return all_match ? 0 : 1;
+}
@@ -0,0 +1,720 @@
+// Headless run of the overlay's UI against a synthetic scene, frame times and draw data sizes (any OS)
+//
+// Build:
+//   g++ -std=c++23 -O2 -pthread -DRENDER_HEADLESS -I../GodotDumper -I../GodotDumper/external -I../GodotDumper/external/imgui uibench.cpp ../GodotDumper/render.cpp ../GodotDumper/render_headless.cpp ../GodotDumper/visuals.cpp ../GodotDumper/objects.cpp ../GodotDumper/properties.cpp ../GodotDumper/sampler.cpp ../GodotDumper/recorder.cpp ../GodotDumper/pointerscan.cpp ../GodotDumper/valuescan.cpp ../GodotDumper/structdiff.cpp ../GodotDumper/snapshot.cpp ../GodotDumper/font_cache.cpp ../GodotDumper/math_batch.cpp ../GodotDumper/work_pool.cpp ../GodotDumper/memory.cpp ../GodotDumper/godot.cpp ../GodotDumper/hierarchy.cpp ../GodotDumper/layout.cpp ../GodotDumper/analysis.cpp ../GodotDumper/resolver.cpp ../GodotDumper/vtables.cpp ../GodotDumper/pe.cpp ../GodotDumper/x86.cpp ../GodotDumper/xref.cpp ../GodotDumper/sdk.cpp ../GodotDumper/external/imgui/imgui.cpp ../GodotDumper/external/imgui/imgui_draw.cpp ../GodotDumper/external/imgui/imgui_tables.cpp ../GodotDumper/external/imgui/imgui_widgets.cpp -o uibench
+//   (cl /std:c++latest /O2 /EHsc /DRENDER_HEADLESS with the same files on Windows, render.cpp needs <format>: g++ 13 or later)
+//
+// Usage:
+//   uibench [nodes] [--frames n] [--expand depth] [--no-visuals] [--no-class] [--frame-hook] [--version 4.x]
+//   uibench --labels [count] [--frames n] [--no-class]
+//
+// The scene lives in a fake image laid out like the game's: the layout's SceneTree and ObjectDB patterns in .text
+// point at globals in .data, every class has a vtable in .rdata whose get_class loads the class name, so the
+// pattern scan, the ObjectDB checks and the vtable table all take the same paths they take in the game
+// nodes (10000 by default) are mostly Node3D classes in front of the camera plus a Node2D HUD subtree
+// --expand opens the explorer's tree that many levels deep (2 by default), the last open node gets the properties window
+// --frame-hook runs visuals::capture before every frame like the game's thread does, its time is what the game pays
+// Fails if layout detection by signature, the vtable scan, the ObjectDB or visuals::collect don't see the scene that was built,
+// 3D positions included
+//
+// --labels times visuals::build alone, count labels (10000 by default) in front of a fixed camera, and counts the
+// heap allocations it makes (operator new and ImGui's allocator), fails if a frame past the warm up still allocates
+
+#include "render.h"
+#include "godot.h"
+#include "vtables.h"
+#include "analysis.h"
+#include "objects.h"
+#include "visuals.h"
+
+#include <imgui/imgui_internal.h>
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    constexpr std::size_t NODE_SIZE = 0x600; // Past every layout's Node3D, Node2D and Camera3D fields
+    constexpr std::size_t WINDOW_SIZE = 0x1000; // Same for the root Window's
+    constexpr std::size_t SCENE_TREE_SIZE = 0x800; // And the SceneTree's
+
+    const char* const CLASSES_3D[] = { "Node3D", "MeshInstance3D", "StaticBody3D", "CollisionShape3D", "OmniLight3D", "Area3D" };
+    const char* const CLASSES_2D[] = { "Node2D", "Sprite2D", "Area2D", "CollisionShape2D" };
+
+    std::size_t allocations = 0;
+    bool counting = false; // Only while build runs, everything is on the main thread
+
+    void* counted_alloc(std::size_t size, void*)
+    {
+        allocations += counting;
+        return std::malloc(size);
+    }
+
+    void counted_free(void* pointer, void*)
+    {
+        std::free(pointer);
+    }
+
+    Transform3D identity()
+    {
+        Transform3D transform;
+        transform.basis.rows[0] = Vector3(1.f, 0.f, 0.f);
+        transform.basis.rows[1] = Vector3(0.f, 1.f, 0.f);
+        transform.basis.rows[2] = Vector3(0.f, 0.f, 1.f);
+        transform.origin = Vector3(0.f, 0.f, 0.f);
+        return transform;
+    }
+
+    template <typename T>
+    T& field(void* object, std::uint32_t offset)
+    {
+        return *reinterpret_cast<T*>(static_cast<std::uint8_t*>(object) + offset);
+    }
+
+    /*
+     * Just enough of a PE32+ image for Memory, pe_image_t and xref_index_t: three sections, no .pdata (the xref pass
+     * decodes .text linearly, every site is followed by nops so a pattern ending mid-instruction resyncs)
+     * Nothing in it ever runs, vtable entries that aren't get_class point at a lone ret
+    */
+    class image_t {
+    public:
+        static constexpr std::uint32_t TEXT = 0x1000;
+        static constexpr std::uint32_t RDATA = 0x2000;
+        static constexpr std::uint32_t DATA = 0x3000;
+        static constexpr std::uint32_t SIZE = 0x4000;
+
+        static constexpr std::uint32_t VTABLE_ENTRIES = 16;
+
+        // .data globals the patterns resolve to
+        static constexpr std::uint32_t SCENE_TREE_GLOBAL = DATA;
+        static constexpr std::uint32_t SLOTS_GLOBAL = DATA + 0x8;
+        static constexpr std::uint32_t SLOT_MAX_GLOBAL = DATA + 0x10;
+
+        image_t() : bytes(SIZE, 0)
+        {
+            std::memset(bytes.data() + TEXT, 0xCC, RDATA - TEXT);
+
+            put<std::uint16_t>(0, 0x5A4D); // MZ
+            put<std::uint32_t>(0x3C, 0x40);
+            put<std::uint32_t>(0x40, 0x4550); // PE\0\0
+
+            put<std::uint16_t>(0x44, 0x8664); // Machine
+            put<std::uint16_t>(0x46, 3); // NumberOfSections
+            put<std::uint16_t>(0x54, 0xF0); // SizeOfOptionalHeader
+
+            put<std::uint16_t>(0x58, 0x20B); // PE32+
+            put<std::uint64_t>(0x58 + 24, 0x140000000); // ImageBase
+            put<std::uint32_t>(0x58 + 56, SIZE);
+            put<std::uint32_t>(0x58 + 60, TEXT); // SizeOfHeaders
+            put<std::uint32_t>(0x58 + 108, 16); // NumberOfRvaAndSizes
+
+            section(0, ".text", TEXT, RDATA - TEXT, 0x60000020); // CODE | EXECUTE | READ
+            section(1, ".rdata", RDATA, DATA - RDATA, 0x40000040); // INITIALIZED_DATA | READ
+            section(2, ".data", DATA, SIZE - DATA, 0xC0000040); // INITIALIZED_DATA | READ | WRITE
+
+            ret = text_end;
+            emit({ 0xC3 });
+        }
+
+        std::uint8_t* base() { return bytes.data(); }
+
+        // A site matching pattern whose rel32 resolves to target, like the instruction the layout describes
+        void add_site(const char* pattern, std::uint32_t rva_offset, std::uint32_t rip_offset, std::uint32_t target)
+        {
+            const std::uint32_t site = text_end;
+
+            std::vector<std::uint8_t> code;
+            for (const char* it = pattern; *it;)
+            {
+                if (*it == ' ')
+                    it++;
+                else if (*it == '?')
+                {
+                    code.push_back(0);
+                    it += it[1] == '?' ? 2 : 1;
+                }
+                else
+                {
+                    char* end = nullptr;
+                    code.push_back(static_cast<std::uint8_t>(std::strtoul(it, &end, 16)));
+                    it = end;
+                }
+            }
+
+            emit(code);
+            put<std::int32_t>(site + rva_offset, static_cast<std::int32_t>(target - (site + rip_offset)));
+            emit(std::vector<std::uint8_t>(16, 0x90));
+        }
+
+        // vtable whose get_class (at class_name_index) does lea rax, [rip + "name"], referenced by a constructor's lea
+        void* add_class(const std::string& name, std::size_t class_name_index)
+        {
+            const std::uint32_t literal = rdata_end;
+            std::memcpy(bytes.data() + literal, name.c_str(), name.size() + 1);
+            rdata_end = (literal + static_cast<std::uint32_t>(name.size()) + 1 + 7) & ~7u;
+
+            const std::uint32_t get_class = text_end;
+            emit_lea(literal);
+
+            const std::uint32_t vtable = rdata_end;
+            rdata_end += VTABLE_ENTRIES * sizeof(std::uint64_t);
+
+            for (std::uint32_t i = 0; i < VTABLE_ENTRIES; i++)
+                put<std::uint64_t>(vtable + i * sizeof(std::uint64_t), address(i == class_name_index ? get_class : ret));
+
+            emit_lea(vtable);
+            return bytes.data() + vtable;
+        }
+
+        template <typename T>
+        T& global(std::uint32_t rva)
+        {
+            return *reinterpret_cast<T*>(bytes.data() + rva);
+        }
+
+    private:
+        template <typename T>
+        void put(std::uint32_t rva, T value)
+        {
+            std::memcpy(bytes.data() + rva, &value, sizeof(value));
+        }
+
+        std::uint64_t address(std::uint32_t rva) const
+        {
+            return reinterpret_cast<std::uintptr_t>(bytes.data()) + rva;
+        }
+
+        void section(int index, const char* name, std::uint32_t rva, std::uint32_t size, std::uint32_t characteristics)
+        {
+            const std::uint32_t header = 0x58 + 0xF0 + index * 40;
+            std::memcpy(bytes.data() + header, name, std::strlen(name));
+            put<std::uint32_t>(header + 8, size); // VirtualSize
+            put<std::uint32_t>(header + 12, rva);
+            put<std::uint32_t>(header + 16, size); // SizeOfRawData
+            put<std::uint32_t>(header + 20, rva); // PointerToRawData
+            put<std::uint32_t>(header + 36, characteristics);
+        }
+
+        void emit(const std::vector<std::uint8_t>& code)
+        {
+            std::memcpy(bytes.data() + text_end, code.data(), code.size());
+            text_end += static_cast<std::uint32_t>(code.size());
+        }
+
+        // lea rax, [rip + target]; ret
+        void emit_lea(std::uint32_t target)
+        {
+            const std::uint32_t site = text_end;
+            emit({ 0x48, 0x8D, 0x05, 0, 0, 0, 0, 0xC3 });
+            put<std::int32_t>(site + 3, static_cast<std::int32_t>(target - (site + 7)));
+        }
+
+    private:
+        std::vector<std::uint8_t> bytes; // Never resized, vtable entries are absolute addresses into it
+        std::uint32_t text_end = TEXT;
+        std::uint32_t rdata_end = RDATA;
+        std::uint32_t ret = 0;
+    };
+
+    struct scene_t {
+        std::vector<std::uint8_t> arena; // Every node, NODE_SIZE apart
+        std::vector<std::uint8_t> window;
+        std::vector<std::uint8_t> scene_tree;
+
+        std::vector<std::vector<gd::Node*>> children;
+        std::vector<std::vector<std::uint32_t>> names; // String data, UTF-32
+        std::vector<std::vector<std::uint8_t>> name_data; // StringName::_Data
+        std::vector<gd::ObjectDB::ObjectSlot> slots;
+
+        std::unordered_map<std::string, void*> vtables;
+
+        gd::Node* level = nullptr;
+        std::size_t count_3d = 0;
+        std::size_t count_2d = 0;
+        std::size_t count = 0;
+    };
+
+    // Node i of the arena, the one past the arena is the root Window
+    gd::Node* node_at(scene_t& scene, std::size_t index)
+    {
+        if (index == scene.arena.size() / NODE_SIZE)
+            return reinterpret_cast<gd::Node*>(scene.window.data());
+
+        return reinterpret_cast<gd::Node*>(scene.arena.data() + index * NODE_SIZE);
+    }
+
+    void init_node(scene_t& scene, std::size_t index, const std::string& class_name, const std::string& name)
+    {
+        gd::Node* node = node_at(scene, index);
+        field<void*>(node, 0) = scene.vtables.at(class_name);
+
+        std::vector<std::uint32_t>& chars = scene.names[index];
+        chars.assign(name.begin(), name.end());
+        chars.push_back(0);
+
+        std::vector<std::uint8_t>& data = scene.name_data[index];
+        data.assign(0x20, 0);
+        field<std::uint32_t*>(data.data(), gd::layout->string_name_data_name) = chars.data();
+        field<void*>(node, gd::layout->node_name) = data.data();
+
+        const std::uint32_t slot = static_cast<std::uint32_t>(index) + 1;
+        scene.slots[slot].validator = slot;
+        scene.slots[slot].object = node;
+    }
+
+    void add_child(scene_t& scene, std::size_t parent, std::size_t child)
+    {
+        scene.children[parent].push_back(node_at(scene, child));
+        field<gd::Node*>(node_at(scene, child), gd::layout->node_parent) = node_at(scene, parent);
+    }
+
+    /*
+     * Window "root" -> Node3D "Level" -> Camera3D, a Node3D "World" with most of the nodes and a Node2D "Hud"
+     * Wide near the top (rooms, chunks) and bushy below like treewalk's tree, with the node's position in its transforms
+    */
+    void build(scene_t& scene, image_t& image, std::size_t count)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> spread(-60.f, 60.f);
+
+        scene.arena.assign(count * NODE_SIZE, 0);
+        scene.window.assign(WINDOW_SIZE, 0);
+        scene.scene_tree.assign(SCENE_TREE_SIZE, 0);
+        scene.children.assign(count + 1, {});
+        scene.names.assign(count + 1, {});
+        scene.name_data.assign(count + 1, {});
+
+        std::uint32_t slot_max = 1;
+        while (slot_max < count + 2)
+            slot_max <<= 1;
+
+        scene.slots.assign(slot_max, {});
+
+        for (const char* name : CLASSES_3D)
+            scene.vtables[name] = image.add_class(name, gd::Object::CLASS_NAME_INDEX);
+
+        for (const char* name : CLASSES_2D)
+            scene.vtables[name] = image.add_class(name, gd::Object::CLASS_NAME_INDEX);
+
+        for (const char* name : { "Window", "Camera3D" })
+            scene.vtables[name] = image.add_class(name, gd::Object::CLASS_NAME_INDEX);
+
+        const std::size_t window = count;
+        constexpr std::size_t LEVEL = 0, CAMERA = 1, WORLD = 2, HUD = 3;
+
+        init_node(scene, window, "Window", "root");
+        init_node(scene, LEVEL, "Node3D", "Level");
+        init_node(scene, CAMERA, "Camera3D", "Camera");
+        init_node(scene, WORLD, "Node3D", "World");
+        init_node(scene, HUD, "Node2D", "Hud");
+
+        add_child(scene, window, LEVEL);
+        add_child(scene, LEVEL, CAMERA);
+        add_child(scene, LEVEL, WORLD);
+        add_child(scene, LEVEL, HUD);
+
+        for (std::size_t i : { LEVEL, WORLD })
+        {
+            node_at(scene, i)->as<gd::Node3D>()->global_transform() = identity();
+            node_at(scene, i)->as<gd::Node3D>()->local_transform() = identity();
+        }
+
+        // At the front edge of the world looking down -Z
+        gd::Camera3D* camera = node_at(scene, CAMERA)->as<gd::Camera3D>();
+        camera->global_transform() = identity();
+        camera->global_transform().origin = Vector3(0.f, 5.f, 10.f);
+        camera->local_transform() = camera->global_transform();
+        camera->mode() = gd::Camera3D::PROJECTION_PERSPECTIVE;
+        camera->fov() = 75.f;
+        camera->_near() = 0.05f;
+        camera->_far() = 4000.f;
+        camera->keep_aspect() = gd::Camera3D::KEEP_HEIGHT;
+        camera->current() = true;
+
+        field<gd::Camera3D*>(node_at(scene, window), gd::layout->viewport_camera_3d) = camera;
+
+        // One node in eight goes to the HUD
+        std::vector<std::pair<std::size_t, std::uint32_t>> queue_3d = { { WORLD, 0 } };
+        std::vector<std::pair<std::size_t, std::uint32_t>> queue_2d = { { HUD, 0 } };
+        std::size_t head_3d = 0, head_2d = 0;
+        std::size_t created = HUD + 1;
+
+        scene.count_3d = 2;
+        scene.count_2d = 1;
+
+        while (created < count && (head_3d < queue_3d.size() || head_2d < queue_2d.size()))
+        {
+            const bool is_2d = (created % 8 == 0 && head_2d < queue_2d.size()) || head_3d == queue_3d.size();
+            auto& queue = is_2d ? queue_2d : queue_3d;
+            auto& head = is_2d ? head_2d : head_3d;
+
+            const auto [parent, depth] = queue[head++];
+            std::size_t fanout = depth == 0 ? (is_2d ? 8 : 32) : depth == 1 ? 16 : std::uniform_int_distribution<std::size_t>(0, 6)(random);
+            fanout = std::min(fanout, count - created);
+
+            for (std::size_t i = 0; i < fanout; i++, created++)
+            {
+                const char* class_name = is_2d ? CLASSES_2D[created % std::size(CLASSES_2D)] : CLASSES_3D[created % std::size(CLASSES_3D)];
+                init_node(scene, created, class_name, std::string(class_name) + "_" + std::to_string(created));
+                add_child(scene, parent, created);
+                queue.push_back({ created, depth + 1 });
+
+                if (is_2d)
+                {
+                    // Relative to the parent, the HUD's children spread over the screen
+                    const Vector2 position = depth == 0 ? Vector2(std::uniform_real_distribution<float>(40.f, 1880.f)(random), std::uniform_real_distribution<float>(40.f, 1040.f)(random))
+                        : Vector2(spread(random) * 0.5f, spread(random) * 0.5f);
+                    node_at(scene, created)->as<gd::Node2D>()->position() = position;
+                    scene.count_2d++;
+                }
+                else
+                {
+                    Transform3D transform = identity();
+                    transform.origin = Vector3(spread(random), std::uniform_real_distribution<float>(0.f, 10.f)(random), std::uniform_real_distribution<float>(-120.f, 0.f)(random));
+                    node_at(scene, created)->as<gd::Node3D>()->global_transform() = node_at(scene, parent)->as<gd::Node3D>()->global_transform() * transform;
+                    node_at(scene, created)->as<gd::Node3D>()->local_transform() = transform;
+                    scene.count_3d++;
+                }
+            }
+        }
+
+        scene.count_3d++; // The camera
+        scene.count = created;
+
+        // children_cache is { u32 count, u32 capacity, Node** data }
+        for (std::size_t i = 0; i <= count; i++)
+        {
+            const std::uint32_t size = static_cast<std::uint32_t>(scene.children[i].size());
+            std::uint8_t* node = reinterpret_cast<std::uint8_t*>(node_at(scene, i));
+
+            field<std::uint32_t>(node, gd::layout->node_children_cache) = size;
+            field<std::uint32_t>(node, gd::layout->node_children_cache + 4) = size;
+            field<gd::Node**>(node, gd::layout->node_children_cache + 8) = scene.children[i].data();
+        }
+
+        scene.level = node_at(scene, LEVEL);
+        field<gd::Window*>(scene.scene_tree.data(), gd::layout->scene_tree_root) = reinterpret_cast<gd::Window*>(scene.window.data());
+        field<gd::Node*>(scene.scene_tree.data(), gd::layout->scene_tree_current_scene) = scene.level;
+
+        image.global<void*>(image_t::SCENE_TREE_GLOBAL) = scene.scene_tree.data();
+        image.global<void*>(image_t::SLOTS_GLOBAL) = scene.slots.data();
+        image.global<std::uint32_t>(image_t::SLOT_MAX_GLOBAL) = slot_max;
+
+        image.add_site(gd::layout->scene_tree_pattern, gd::layout->scene_tree_rva_offset, gd::layout->scene_tree_rip_offset, image_t::SCENE_TREE_GLOBAL);
+        image.add_site(gd::layout->object_slots_pattern, gd::layout->object_slots_rva_offset, gd::layout->object_slots_rip_offset, image_t::SLOTS_GLOBAL);
+        image.add_site(gd::layout->slot_max_pattern, gd::layout->slot_max_rva_offset, gd::layout->slot_max_rip_offset, image_t::SLOT_MAX_GLOBAL);
+    }
+
+    // Opens the explorer's tree nodes down to depth, their ids are the ones recursive_draw's labels hash to
+    std::size_t expand(gd::Node* node, ImGuiWindow* window, ImGuiID seed, int depth)
+    {
+        if (depth <= 0 || !node)
+            return 0;
+
+        char label[512];
+        std::snprintf(label, sizeof(label), "%s (%s)##%" PRIuPTR, node->get_name().c_str(), node->get_class_name().c_str(), reinterpret_cast<std::uintptr_t>(node));
+
+        const ImGuiID id = ImHashStr(label, 0, seed);
+        window->StateStorage.SetInt(id, 1);
+
+        std::size_t opened = 1;
+        for (gd::Node* child : node->get_children())
+            opened += expand(child, window, id, depth - 1);
+
+        return opened;
+    }
+
+    struct timings_t {
+        std::vector<double> frame, menu, visuals, capture;
+        double vertices = 0.0, indices = 0.0, commands = 0.0;
+    };
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, static_cast<std::size_t>(p * (values.size() - 1) + 0.5))];
+    }
+
+    double ms_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void print_row(const char* name, const std::vector<double>& values)
+    {
+        std::printf("%-12s %8.3f %8.3f %8.3f ms\n", name, percentile(values, 0.5), percentile(values, 0.99), percentile(values, 1.0));
+    }
+
+    // One overlay frame the way dllmain's loop runs it, after the game's frame when visuals are captured on the frame hook
+    void frame(timings_t* timings)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (visuals->on_frame_hook)
+            visuals->capture(gd::SceneTree::get_singleton());
+        const double capture = ms_since(start);
+
+        render->start_render();
+
+        start = std::chrono::steady_clock::now();
+        if (render->running)
+            render->render_menu();
+        const double menu = ms_since(start);
+
+        start = std::chrono::steady_clock::now();
+        render->render_visuals();
+        const double visuals = ms_since(start);
+
+        render->end_render();
+
+        if (!timings)
+            return;
+
+        const frame_stats_t& stats = render->get_frame_stats();
+        timings->frame.push_back(stats.cpu_ms);
+        timings->menu.push_back(menu);
+        timings->visuals.push_back(visuals);
+        timings->capture.push_back(capture);
+        timings->vertices += stats.vertices;
+        timings->indices += stats.indices;
+        timings->commands += stats.commands;
+    }
+
+    // Every label on screen, names unique like the scene's, camera at the origin looking down -Z
+    int label_bench(std::size_t count, int frames, bool class_tags)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> depth(-80.f, -10.f);
+        std::uniform_real_distribution<float> side(-0.6f, 0.6f);
+
+        std::vector<visuals_t::item_t> items(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const float z = depth(random);
+            items[i].position = Vector3(side(random) * -z, side(random) * -z * 0.5f, z);
+            items[i].class_name = CLASSES_3D[i % std::size(CLASSES_3D)];
+            items[i].name = items[i].class_name + "_" + std::to_string(i);
+        }
+
+        visuals_t::camera_t camera;
+        camera.transform = identity();
+        camera.projection.set_perspective(75.f, 1920.f / 1080.f, 0.05f, 4000.f, false);
+        camera.z_near = 0.05f;
+        camera.valid = true;
+
+        render->create_imgui();
+        visuals->show_class = class_tags;
+
+        std::vector<double> build_ms, frame_ms;
+        std::size_t allocated = 0;
+        double vertices = 0.0;
+
+        for (int i = -10; i < frames; i++)
+        {
+            render->start_render();
+
+            allocations = 0;
+            counting = true;
+            const auto start = std::chrono::steady_clock::now();
+            visuals->build(ImGui::GetBackgroundDrawList(), items, camera, ImGui::GetIO().DisplaySize);
+            const double build = ms_since(start);
+            counting = false;
+
+            render->end_render();
+
+            // The first frames bake the glyphs, fill the label cache and grow the buffers
+            if (i < 0)
+                continue;
+
+            build_ms.push_back(build);
+            frame_ms.push_back(render->get_frame_stats().cpu_ms);
+            vertices += render->get_frame_stats().vertices;
+            allocated += allocations;
+        }
+
+        std::printf("%zu labels%s, %d frames\n", count, class_tags ? " with class tags" : "", frames);
+        std::printf("                 median      p99      max\n");
+        print_row("build", build_ms);
+        print_row("frame", frame_ms);
+        std::printf("%.0f vertices per frame, %zu allocations in build over %d frames\n", vertices / frames, allocated, frames);
+
+        if (allocated)
+        {
+            std::printf("build still allocates once warmed up\n");
+            return 1;
+        }
+
+        return 0;
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    allocations += counting;
+    if (void* pointer = std::malloc(size ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t count = 10000;
+    int frames = 300;
+    int depth = 2;
+    bool draw_visuals = true;
+    bool class_tags = true;
+    bool hooked = false;
+    const char* version = "4.3";
+    bool labels = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--labels"))
+            labels = true;
+        else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--expand") && i + 1 < argc)
+            depth = std::max(0, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--no-visuals"))
+            draw_visuals = false;
+        else if (!std::strcmp(argv[i], "--no-class"))
+            class_tags = false;
+        else if (!std::strcmp(argv[i], "--frame-hook"))
+            hooked = true;
+        else if (!std::strcmp(argv[i], "--version") && i + 1 < argc)
+            version = argv[++i];
+        else if (argv[i][0] != '-')
+            count = std::max<std::size_t>(8, std::strtoull(argv[i], nullptr, 10));
+        else
+        {
+            std::fprintf(stderr, "usage: %s [nodes] [--frames n] [--expand depth] [--no-visuals] [--no-class] [--frame-hook] [--version 4.x]\n"
+                "       %s --labels [count] [--frames n] [--no-class]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    ImGui::SetAllocatorFunctions(counted_alloc, counted_free);
+
+    if (labels)
+        return label_bench(count, frames, class_tags);
+
+    for (std::size_t i = 0; i < gd::layout_count; i++)
+    {
+        if (std::to_string(gd::layouts[i].major) + "." + std::to_string(gd::layouts[i].minor) == version)
+            gd::layout = &gd::layouts[i];
+    }
+
+    if (!gd::layout)
+    {
+        std::fprintf(stderr, "no layout for Godot %s\n", version);
+        return 1;
+    }
+
+    image_t image;
+    scene_t scene;
+    build(scene, image, count);
+
+    mem->set_base_address(image.base());
+
+    // The image has no version string, the signatures alone have to find the layout it was built with (4.4 and 4.5 share theirs)
+    const gd::layout_t* built = gd::layout;
+    if (gd::detect_layout() != built)
+    {
+        std::printf("signature detection didn't pick the Godot %d.%d layout\n", built->major, built->minor);
+        return 1;
+    }
+
+    // What the DLL does on its vtable thread, on this one
+    if (analysis->get(image.base()))
+        vtables->scan(analysis->get_image(), analysis->get_xrefs(), gd::Object::CLASS_NAME_INDEX);
+
+    objects->refresh();
+
+    std::vector<visuals_t::item_t> items;
+    visuals_t::camera_t camera;
+
+    render->create_imgui();
+    render->start_render();
+    visuals->collect(gd::SceneTree::get_singleton(), items, camera, ImGui::GetIO().DisplaySize);
+    render->end_render();
+
+    std::printf("%zu nodes (%zu Node3D, %zu Node2D), Godot %d.%d layout\n", scene.count + 1, scene.count_3d, scene.count_2d, gd::layout->major, gd::layout->minor);
+    std::printf("%zu vtables named, %zu objects in the ObjectDB, %zu visuals items\n", vtables->get_named_count(), objects->get_entries().size(), items.size());
+
+    // collect evaluates the local transform chains, the scene's globals were built as the same products
+    std::unordered_map<std::string, Vector3> globals;
+    for (std::size_t i = 0; i < scene.count; i++)
+    {
+        if (node_at(scene, i)->is_node3d())
+            globals[node_at(scene, i)->get_name()] = node_at(scene, i)->as<gd::Node3D>()->global_transform().origin;
+    }
+
+    const bool positions = std::all_of(items.begin(), items.end(), [&](const visuals_t::item_t& item)
+    {
+        auto it = globals.find(item.name);
+        return !item.is_3d || (it != globals.end() && it->second.x == item.position.x && it->second.y == item.position.y && it->second.z == item.position.z);
+    });
+
+    const bool scene_found = gd::SceneTree::get_singleton() && gd::SceneTree::get_singleton()->get_current_scene() == scene.level;
+    const bool expected = scene_found && vtables->get_named_count() == scene.vtables.size() && objects->get_entries().size() == scene.count + 1 &&
+        items.size() == std::min(scene.count_3d + scene.count_2d, visuals->max_items) && positions && camera.valid;
+
+    if (!expected)
+    {
+        std::printf("the scene read back differs from the one built\n");
+        return 1;
+    }
+
+    render->running = true;
+    visuals->enabled = draw_visuals;
+    visuals->show_class = class_tags;
+    visuals->on_frame_hook = hooked;
+
+    // The first frame creates the windows, the tree is opened before the second
+    frame(nullptr);
+
+    std::size_t opened = 0;
+    if (ImGuiWindow* window = ImGui::FindWindowByName("Godot Explorer"))
+        opened = expand(scene.level, window, window->ID, depth);
+
+    // Fonts are baked and the label cache filled while warming up
+    for (int i = 0; i < 10; i++)
+        frame(nullptr);
+
+    timings_t timings;
+    for (int i = 0; i < frames; i++)
+        frame(&timings);
+
+    std::printf("%d frames, %zu tree nodes open, menu %s, visuals %s\n", frames, opened, render->running ? "on" : "off", draw_visuals ? "on" : "off");
+    std::printf("                 median      p99      max\n");
+
+    print_row("frame", timings.frame);
+    print_row("render_menu", timings.menu);
+    print_row("visuals", timings.visuals);
+
+    if (hooked)
+        print_row("capture", timings.capture);
+
+    std::printf("%.0f vertices, %.0f indices, %.0f draw commands per frame\n", timings.vertices / frames, timings.indices / frames, timings.commands / frames);
+    return 0;
+}